@@ -0,0 +1,72 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// timing for the parts of core that don't need a device. BE_BENCH registers a benchmark, Measure runs a piece of it
+// repeatedly and reports the median against a budget. the results are only meaningful in release builds
+namespace BeBench {
+    struct Case {
+        std::string_view Name;
+        std::function<void()> Run;
+    };
+
+    inline auto Cases() -> std::vector<Case>& {
+        static auto cases = std::vector<Case>();
+        return cases;
+    }
+
+    inline auto OverBudget() -> size_t& {
+        static auto overBudget = size_t(0);
+        return overBudget;
+    }
+
+    // results that would otherwise be optimised away go in here
+    inline volatile uint64_t Sink = 0;
+    inline auto Keep(const uint64_t value) -> void { Sink = Sink + value; }
+
+    // median milliseconds of one call to run. a budget of 0 only reports
+    inline auto Measure(const std::string_view label, const uint32_t iterations, const double budgetMs, const std::function<void()>& run) -> double {
+        auto times = std::vector<double>();
+        times.reserve(iterations);
+        run(); // warm up
+        for (uint32_t i = 0; i < iterations; i++) {
+            const auto start = std::chrono::steady_clock::now();
+            run();
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::ranges::sort(times);
+        const auto median = times[times.size() / 2];
+
+        const auto over = budgetMs > 0.0 && median > budgetMs;
+        OverBudget() += over ? 1 : 0;
+        if (budgetMs > 0.0)
+            (void)std::printf("  %-48.*s %9.4f ms (min %.4f, budget %.4f)%s\n",
+                int(label.size()), label.data(), median, times.front(), budgetMs, over ? " OVER BUDGET" : "");
+        else
+            (void)std::printf("  %-48.*s %9.4f ms (min %.4f)\n", int(label.size()), label.data(), median, times.front());
+        return median;
+    }
+
+    // for rates, e.g. rays per second
+    inline auto Report(const std::string_view label, const double value, const std::string_view unit) -> void {
+        (void)std::printf("  %-48.*s %9.2f %.*s\n", int(label.size()), label.data(), value, int(unit.size()), unit.data());
+    }
+
+    struct Registrar {
+        Registrar(const std::string_view name, std::function<void()> run) {
+            Cases().push_back({ name, std::move(run) });
+        }
+    };
+}
+
+#define BE_BENCH_CONCAT_INNER(a, b) a##b
+#define BE_BENCH_CONCAT(a, b) BE_BENCH_CONCAT_INNER(a, b)
+
+#define BE_BENCH(name) \
+    static auto BE_BENCH_CONCAT(BeBenchRun_, __LINE__)() -> void; \
+    static const BeBench::Registrar BE_BENCH_CONCAT(BeBenchRegistrar_, __LINE__) { name, &BE_BENCH_CONCAT(BeBenchRun_, __LINE__) }; \
+    static auto BE_BENCH_CONCAT(BeBenchRun_, __LINE__)() -> void
@@ -0,0 +1,35 @@
+#include <random>
+
+#include "BeBench.h"
+#include "BeFrustumCuller.h"
+
+BE_BENCH("BeFrustumCuller: 100k boxes") {
+    constexpr auto BoxCount = 100'000;
+
+    // scattered around the camera, about a sixth of them end up in view
+    auto random = std::mt19937(42);
+    auto position = std::uniform_real_distribution(-200.f, 200.f);
+    auto size = std::uniform_real_distribution(0.1f, 4.f);
+
+    auto culler = BeFrustumCuller();
+    culler.Reserve(BoxCount);
+    for (auto i = 0; i < BoxCount; i++)
+        culler.Push(glm::vec3(position(random), position(random), position(random)), glm::vec3(size(random)));
+
+    const auto projection = glm::perspective(60_rad, 16.f / 9.f, 0.1f, 200.f);
+    const auto view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec3(0.f, 1.f, 0.f));
+    const auto planes = BeFrustumCuller::ExtractPlanes(projection * view);
+
+    // the 2.4 MB of boxes are read once per cull, six planes are 36 fmas per group of eight. about 0.15 ms at best and
+    // 0.25 ms typically on one shared core, the budget leaves room for that and stays within 3% of a 60 Hz frame
+    auto visible = size_t(0);
+    BeBench::Measure(BeFrustumCuller::HasAVX2() ? "frustum, avx2" : "frustum, sse", 1000, 0.5, [&] {
+        visible = culler.Cull(planes).size();
+        BeBench::Keep(visible);
+    });
+    BeBench::Report("visible", double(visible), "boxes");
+
+    BeBench::Measure("sphere of 50", 1000, 0.0, [&] {
+        BeBench::Keep(culler.CullSphere(glm::vec3(0.f, 0.f, 50.f), 50.f).size());
+    });
+}
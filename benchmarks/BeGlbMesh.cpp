@@ -0,0 +1,133 @@
+#include "BeGlbMesh.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <umbrellas/json.h>
+
+namespace {
+    struct Glb {
+        Json Document;
+        std::vector<uint8_t> Binary;
+    };
+
+    auto ReadGlb(const std::filesystem::path& path) -> std::optional<Glb> {
+        auto file = std::ifstream(path, std::ios::binary);
+        if (!file)
+            return std::nullopt;
+        const auto bytes = std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+
+        // 12 byte header, then chunks of length, type and data. json comes first, the binary one second
+        auto glb = Glb();
+        auto offset = size_t(12);
+        for (auto chunk = 0; chunk < 2 && offset + 8 <= bytes.size(); chunk++) {
+            uint32_t length;
+            std::memcpy(&length, bytes.data() + offset, 4);
+            const auto data = bytes.begin() + offset + 8;
+            if (chunk == 0)
+                glb.Document = Json::parse(data, data + length);
+            else
+                glb.Binary.assign(data, data + length);
+            offset += 8 + length;
+        }
+        if (glb.Document.is_null())
+            return std::nullopt;
+        return glb;
+    }
+
+    // calls read with the start of every element of an accessor, honouring the buffer view's stride
+    template <typename Read> auto ForEachElement(const Glb& glb, const Json& accessor, const size_t size, Read&& read) -> void {
+        const auto& view = glb.Document["bufferViews"][accessor["bufferView"].get<size_t>()];
+        const auto offset = view.value("byteOffset", size_t(0)) + accessor.value("byteOffset", size_t(0));
+        const auto stride = view.value("byteStride", size);
+        const auto count = accessor["count"].get<size_t>();
+        for (size_t i = 0; i < count; i++)
+            read(glb.Binary.data() + offset + i * stride);
+    }
+
+    auto ReadPositions(const Glb& glb, const Json& accessor) -> std::vector<glm::vec3> {
+        auto positions = std::vector<glm::vec3>();
+        ForEachElement(glb, accessor, sizeof(glm::vec3), [&](const uint8_t* element) {
+            auto& position = positions.emplace_back();
+            std::memcpy(&position, element, sizeof(glm::vec3));
+        });
+        return positions;
+    }
+
+    auto ReadIndices(const Glb& glb, const Json& accessor) -> std::vector<uint32_t> {
+        auto indices = std::vector<uint32_t>();
+        switch (accessor["componentType"].get<int>()) {
+            case 5121: ForEachElement(glb, accessor, 1, [&](const uint8_t* e) { indices.push_back(*e); }); break;
+            case 5123: ForEachElement(glb, accessor, 2, [&](const uint8_t* e) {
+                uint16_t index;
+                std::memcpy(&index, e, 2);
+                indices.push_back(index);
+            }); break;
+            case 5125: ForEachElement(glb, accessor, 4, [&](const uint8_t* e) {
+                uint32_t index;
+                std::memcpy(&index, e, 4);
+                indices.push_back(index);
+            }); break;
+            default: break;
+        }
+        return indices;
+    }
+
+    auto LocalTransform(const Json& node) -> glm::mat4 {
+        if (node.contains("matrix")) {
+            auto matrix = glm::mat4(1.f);
+            for (auto i = 0; i < 16; i++)
+                glm::value_ptr(matrix)[i] = node["matrix"][i].get<float>();
+            return matrix;
+        }
+
+        const auto t = node.value("translation", std::vector<float> { 0.f, 0.f, 0.f });
+        const auto r = node.value("rotation", std::vector<float> { 0.f, 0.f, 0.f, 1.f });
+        const auto s = node.value("scale", std::vector<float> { 1.f, 1.f, 1.f });
+        return glm::translate(glm::mat4(1.f), glm::vec3(t[0], t[1], t[2]))
+            * glm::mat4_cast(glm::quat(r[3], r[0], r[1], r[2]))
+            * glm::scale(glm::mat4(1.f), glm::vec3(s[0], s[1], s[2]));
+    }
+
+    auto AddNode(const Glb& glb, const size_t nodeIndex, const glm::mat4& parent, std::vector<glm::vec3>& corners) -> void {
+        const auto& node = glb.Document["nodes"][nodeIndex];
+        const auto transform = parent * LocalTransform(node);
+
+        if (node.contains("mesh")) {
+            for (const auto& primitive : glb.Document["meshes"][node["mesh"].get<size_t>()]["primitives"]) {
+                if (primitive.value("mode", 4) != 4)
+                    continue;
+
+                const auto positions = ReadPositions(glb, glb.Document["accessors"][primitive["attributes"]["POSITION"].get<size_t>()]);
+                auto indices = std::vector<uint32_t>();
+                if (primitive.contains("indices"))
+                    indices = ReadIndices(glb, glb.Document["accessors"][primitive["indices"].get<size_t>()]);
+                else
+                    for (uint32_t i = 0; i < positions.size(); i++)
+                        indices.push_back(i);
+
+                for (size_t i = 0; i + 2 < indices.size(); i += 3)
+                    for (size_t k = 0; k < 3; k++)
+                        corners.push_back(glm::vec3(transform * glm::vec4(positions[indices[i + k]], 1.f)));
+            }
+        }
+
+        for (const auto& child : node.value("children", std::vector<size_t>()))
+            AddNode(glb, child, transform, corners);
+    }
+}
+
+auto LoadGlbTriangles(const std::filesystem::path& path) -> std::vector<glm::vec3> {
+    const auto glb = ReadGlb(path);
+    if (!glb)
+        return {};
+
+    const auto& document = glb->Document;
+    auto corners = std::vector<glm::vec3>();
+    const auto scene = document.value("scene", size_t(0));
+    if (document.contains("scenes"))
+        for (const auto& node : document["scenes"][scene].value("nodes", std::vector<size_t>()))
+            AddNode(*glb, node, glm::mat4(1.f), corners);
+    return corners;
+}
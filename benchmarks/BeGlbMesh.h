@@ -0,0 +1,9 @@
+#pragma once
+#include <filesystem>
+#include <vector>
+#include <umbrellas/include-glm.h>
+
+// reads the triangles of a binary gltf without assimp, so the benchmarks stay free of core's dependencies. node
+// transforms are applied like aiProcess_PreTransformVertices does on import, only positions and triangle lists are
+// read. three corners per triangle, empty if the file can't be read
+auto LoadGlbTriangles(const std::filesystem::path& path) -> std::vector<glm::vec3>;
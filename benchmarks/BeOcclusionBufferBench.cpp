@@ -0,0 +1,64 @@
+#include <random>
+
+#include "BeBench.h"
+#include "BeOcclusionBuffer.h"
+
+// the twelve triangles of a unit cube around the origin
+static auto CubeTriangles() -> std::vector<glm::vec3> {
+    auto triangles = std::vector<glm::vec3>();
+    for (auto axis = 0; axis < 3; axis++) {
+        for (const auto side : { -0.5f, 0.5f }) {
+            auto corner = [&](const float u, const float v) {
+                auto point = glm::vec3(0.f);
+                point[axis] = side;
+                point[(axis + 1) % 3] = u;
+                point[(axis + 2) % 3] = v;
+                return point;
+            };
+            const auto a = corner(-0.5f, -0.5f), b = corner(0.5f, -0.5f), c = corner(0.5f, 0.5f), d = corner(-0.5f, 0.5f);
+            triangles.insert(triangles.end(), { a, b, c, a, c, d });
+        }
+    }
+    return triangles;
+}
+
+BE_BENCH("BeOcclusionBuffer: 64 occluders, 10k boxes") {
+    constexpr auto OccluderCount = 64;
+    constexpr auto BoxCount = 10'000;
+
+    // walls in a field in front of the camera, small boxes scattered among and behind them
+    auto random = std::mt19937(42);
+    auto spread = std::uniform_real_distribution(-40.f, 40.f);
+    auto distance = std::uniform_real_distribution(10.f, 120.f);
+    auto size = std::uniform_real_distribution(0.2f, 2.f);
+
+    const auto cube = CubeTriangles();
+    auto occluders = std::vector<glm::mat4>();
+    for (auto i = 0; i < OccluderCount; i++) {
+        const auto position = glm::vec3(spread(random), 0.f, distance(random) * 0.5f);
+        occluders.push_back(glm::scale(glm::translate(glm::mat4(1.f), position), glm::vec3(8.f, 6.f, 0.5f)));
+    }
+
+    auto boxes = std::vector<std::pair<glm::vec3, glm::vec3>>();
+    for (auto i = 0; i < BoxCount; i++)
+        boxes.emplace_back(glm::vec3(spread(random), spread(random) * 0.1f, distance(random)), glm::vec3(size(random)));
+
+    const auto projection = glm::perspective(60_rad, 16.f / 9.f, 0.1f, 200.f);
+    const auto view = glm::lookAt(glm::vec3(0.f, 1.f, -5.f), glm::vec3(0.f, 0.f, 1.f), glm::vec3(0.f, 1.f, 0.f));
+
+    auto buffer = BeOcclusionBuffer();
+    BeBench::Measure("rasterize occluders", 200, 0.0, [&] {
+        buffer.Begin(projection * view);
+        for (const auto& model : occluders)
+            buffer.RasterizeOccluder(cube, model);
+    });
+
+    auto hidden = 0;
+    BeBench::Measure("test boxes", 200, 0.0, [&] {
+        hidden = 0;
+        for (const auto& [center, extents] : boxes)
+            hidden += buffer.IsVisible(center, extents) ? 0 : 1;
+        BeBench::Keep(hidden);
+    });
+    BeBench::Report("hidden", double(hidden), "boxes");
+}
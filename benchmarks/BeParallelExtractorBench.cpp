@@ -0,0 +1,65 @@
+#include <random>
+#include <string>
+
+#include "BeBench.h"
+#include "BeTaskPool.h"
+#include "scenes/BeParallelExtractor.h"
+
+namespace {
+    struct BenchTransform {
+        glm::vec3 Position;
+        glm::quat Rotation;
+        glm::vec3 Scale;
+    };
+
+    struct BenchRender {
+        bool CastShadows;
+    };
+}
+
+BE_BENCH("BeParallelExtractor: 100k entities") {
+    constexpr auto EntityCount = 100'000;
+
+    auto random = std::mt19937(42);
+    auto unit = std::uniform_real_distribution(-1.f, 1.f);
+    auto registry = entt::registry();
+    for (auto i = 0; i < EntityCount; i++) {
+        const auto entity = registry.create();
+        registry.emplace<BenchTransform>(entity,
+            glm::vec3(unit(random), unit(random), unit(random)) * 200.f,
+            glm::normalize(glm::quat(unit(random), unit(random), unit(random), unit(random))),
+            glm::vec3(1.f));
+        registry.emplace<BenchRender>(entity, i % 2 == 0);
+    }
+    const auto view = registry.view<const BenchTransform, const BenchRender>();
+
+    // the single threaded loop it replaces, one push per entity
+    auto buffer = BeBRPSubmissionBuffer();
+    BeBench::Measure("serial loop", 50, 0.0, [&] {
+        buffer.ClearEntries();
+        view.each([&](const BenchTransform& transform, const BenchRender& render) {
+            auto entry = BeBRPGeometryEntry {};
+            entry.ModelMatrix = BeBRPGeometryEntry::CalculateModelMatrix(transform.Position, transform.Rotation, transform.Scale);
+            entry.CastShadows = render.CastShadows;
+            buffer.SubmitGeometry(entry);
+        });
+        BeBench::Keep(buffer.GetGeometryEntries().size());
+    });
+
+    // all on the calling thread, then one worker per other hardware thread if there are any
+    auto workerCounts = std::vector { 0u };
+    if (const auto hardwareWorkers = std::max(std::thread::hardware_concurrency(), 1u) - 1; hardwareWorkers > 0)
+        workerCounts.push_back(hardwareWorkers);
+    for (const auto workers : workerCounts) {
+        auto extractor = BeParallelExtractor(BeTaskPool::Create(workers));
+        BeBench::Measure("extractor, " + std::to_string(workers) + " workers", 50, 0.0, [&] {
+            buffer.ClearEntries();
+            BeBench::Keep(extractor.ExtractGeometry(view, buffer, [&](const entt::entity entity, BeBRPGeometryEntry& entry) {
+                const auto& [transform, render] = view.get<const BenchTransform, const BenchRender>(entity);
+                entry.ModelMatrix = BeBRPGeometryEntry::CalculateModelMatrix(transform.Position, transform.Rotation, transform.Scale);
+                entry.CastShadows = render.CastShadows;
+                return true;
+            }));
+        });
+    }
+}
@@ -0,0 +1,99 @@
+#include <array>
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "BeBench.h"
+#include "BeGlbMesh.h"
+#include "BeTriangleBVH.h"
+
+namespace {
+    // the bundled meshes, relative to the repository root the benchmarks run from
+    constexpr auto Meshes = std::array {
+        "example-sakura/assets/sakura.glb",
+        "example-game-1/assets/pagoda.glb",
+        "example-game-1/assets/floppy-disks.glb",
+        "example-game-1/assets/witch_items.glb",
+        "example-game-1/assets/lowpoly_rock_1.glb",
+    };
+    constexpr auto RayCount = 16'384u;
+
+    auto Rate(const double milliseconds) -> double {
+        return RayCount / (milliseconds * 1000.0);
+    }
+}
+
+BE_BENCH("BeTriangleBVH: rays on the bundled meshes") {
+    for (const auto* path : Meshes) {
+        const auto corners = LoadGlbTriangles(path);
+        if (corners.empty()) {
+            (void)std::printf("  %s not found, run from the repository root\n", path);
+            continue;
+        }
+
+        auto bvh = std::shared_ptr<BeTriangleBVH>();
+        BeBench::Measure(std::string(path) + ", build", 5, 0.0, [&] { bvh = BeTriangleBVH::Create(corners); });
+        BeBench::Report("triangles", double(bvh->GetTriangleCount()), "");
+
+        const auto& bounds = bvh->GetBounds();
+        const auto center = (bounds.Min + bounds.Max) * 0.5f;
+        const auto radius = glm::length(bounds.Max - bounds.Min) * 0.5f;
+
+        // incoherent: from random points on the bounding sphere to random points inside the box
+        auto random = std::mt19937(42);
+        auto unit = std::uniform_real_distribution(-1.f, 1.f);
+        auto incoherent = std::vector<BeRay>(RayCount);
+        for (auto& ray : incoherent) {
+            auto direction = glm::vec3(unit(random), unit(random), unit(random));
+            while (glm::length(direction) < 0.01f)
+                direction = glm::vec3(unit(random), unit(random), unit(random));
+            const auto origin = center + glm::normalize(direction) * radius;
+            const auto target = center + glm::vec3(unit(random), unit(random), unit(random)) * (bounds.Max - bounds.Min) * 0.5f;
+            ray = { .Origin = origin, .Direction = target - origin };
+        }
+
+        // coherent: a 128x128 pinhole camera in front of the mesh, in 2x2 pixel quads so packets get neighbours
+        auto camera = std::vector<BeRay>(RayCount);
+        const auto eye = center - glm::vec3(0.f, 0.f, radius * 2.f);
+        for (uint32_t i = 0; i < RayCount; i++) {
+            const auto quad = i / 4;
+            const auto x = (quad % 64) * 2 + (i & 1);
+            const auto y = (quad / 64) * 2 + ((i >> 1) & 1);
+            const auto pixel = glm::vec2(x + 0.5f, y + 0.5f) / 128.f * 2.f - 1.f;
+            camera[i] = { .Origin = eye, .Direction = glm::vec3(pixel * 0.5f, 1.f) };
+        }
+
+        const auto closest = BeBench::Measure("incoherent, closest hit", 20, 0.0, [&] {
+            auto hits = uint64_t(0);
+            for (const auto& ray : incoherent)
+                hits += bvh->Intersect(ray).has_value();
+            BeBench::Keep(hits);
+        });
+        BeBench::Report("  rate", Rate(closest), "Mrays/s");
+
+        const auto any = BeBench::Measure("incoherent, any hit", 20, 0.0, [&] {
+            auto occluded = uint64_t(0);
+            for (const auto& ray : incoherent)
+                occluded += bvh->IsOccluded(ray);
+            BeBench::Keep(occluded);
+        });
+        BeBench::Report("  rate", Rate(any), "Mrays/s");
+
+        const auto single = BeBench::Measure("camera, closest hit", 20, 0.0, [&] {
+            auto cameraHits = uint64_t(0);
+            for (const auto& ray : camera)
+                cameraHits += bvh->Intersect(ray).has_value();
+            BeBench::Keep(cameraHits);
+        });
+        BeBench::Report("  rate", Rate(single), "Mrays/s");
+
+        const auto packet = BeBench::Measure("camera, packets of 4", 20, 0.0, [&] {
+            auto cameraHits = uint64_t(0);
+            for (uint32_t i = 0; i < RayCount; i += 4)
+                for (const auto& hit : bvh->IntersectPacket(std::span<const BeRay, 4>(camera.data() + i, 4)))
+                    cameraHits += hit.has_value();
+            BeBench::Keep(cameraHits);
+        });
+        BeBench::Report("  rate", Rate(packet), "Mrays/s");
+    }
+}
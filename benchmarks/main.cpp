@@ -0,0 +1,21 @@
+#include <cstdio>
+#include <string_view>
+
+#include "BeBench.h"
+
+// benchmarks [name filter], runs the benchmarks whose name contains the filter. fails if any went over its budget
+int main(const int argc, char** argv) {
+    const auto filter = argc > 1 ? std::string_view(argv[1]) : std::string_view();
+
+    for (const auto& [name, bench] : BeBench::Cases()) {
+        if (!filter.empty() && name.find(filter) == std::string_view::npos)
+            continue;
+
+        (void)std::printf("%.*s\n", int(name.size()), name.data());
+        bench();
+    }
+
+    if (BeBench::OverBudget() > 0)
+        (void)std::printf("%zu over budget\n", BeBench::OverBudget());
+    return BeBench::OverBudget() == 0 ? 0 : 1;
+}
@@ -0,0 +1,42 @@
+#include <vector>
+
+#include "BeBench.h"
+#include "BeMaterial.h"
+#include "BeMaterialScheme.h"
+#include "BeRenderer.h"
+
+BE_BENCH("BeMaterial: 10k entries by name and by handle") {
+    constexpr auto EntryCount = 10'000;
+
+    // the object material the passes set per entry and per face. without a device nothing is uploaded, only the
+    // setters are measured
+    const auto scheme = BeMaterialScheme::CreateFromJson("object-material", Json::parse(R"([
+        "Model: matrix",
+        "ProjectionView: matrix",
+        "ViewerPosition: float3 = [0, 0, 0]"
+    ])"));
+    const auto renderer = BeRenderer(1, 1, nullptr);
+    const auto material = BeMaterial::Create("bench", scheme, true, renderer);
+
+    // every value differs from the last, so no set is skipped as unchanged
+    auto matrices = std::vector<glm::mat4>(EntryCount);
+    for (auto i = 0; i < EntryCount; i++)
+        matrices[i] = glm::translate(glm::mat4(1.f), glm::vec3(float(i), 0.f, 0.f));
+
+    const auto byName = BeBench::Measure("by name", 50, 0.0, [&] {
+        for (const auto& matrix : matrices) {
+            material->SetMatrix("Model", matrix);
+            material->SetFloat3("ViewerPosition", glm::vec3(matrix[3]));
+        }
+    });
+
+    const auto model = material->GetPropertyId("Model"_prop);
+    const auto viewerPosition = material->GetPropertyId("ViewerPosition"_prop);
+    const auto byHandle = BeBench::Measure("by handle", 50, 0.0, [&] {
+        for (const auto& matrix : matrices) {
+            material->SetMatrix(model, matrix);
+            material->SetFloat3(viewerPosition, glm::vec3(matrix[3]));
+        }
+    });
+    BeBench::Report("speedup", byName / byHandle, "x");
+}
@@ -0,0 +1,228 @@
+#include "BeAABBTree.h"
+
+#include <cassert>
+#include <utility>
+
+auto BeAABB::Transformed(const glm::mat4& transform) const -> BeAABB {
+    // the center goes through the whole transform, extents through the absolute rotation and scale
+    const auto center = glm::vec3(transform * glm::vec4((Min + Max) * 0.5f, 1.f));
+    const auto localExtents = (Max - Min) * 0.5f;
+    const auto extents =
+        glm::abs(glm::vec3(transform[0])) * localExtents.x +
+        glm::abs(glm::vec3(transform[1])) * localExtents.y +
+        glm::abs(glm::vec3(transform[2])) * localExtents.z;
+    return { center - extents, center + extents };
+}
+
+auto BeAABBTree::CreateProxy(const BeAABB& box, const uint32_t userData) -> int32_t {
+    const auto proxy = AllocateNode();
+    _nodes[proxy].Box = { box.Min - Margin, box.Max + Margin };
+    _nodes[proxy].UserData = userData;
+    _nodes[proxy].Height = 0;
+    InsertLeaf(proxy);
+    _proxyCount++;
+    return proxy;
+}
+
+auto BeAABBTree::DestroyProxy(const int32_t proxy) -> void {
+    assert(_nodes[proxy].IsLeaf());
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    _proxyCount--;
+}
+
+auto BeAABBTree::MoveProxy(const int32_t proxy, const BeAABB& box, const glm::vec3& displacement) -> bool {
+    assert(_nodes[proxy].IsLeaf());
+    if (_nodes[proxy].Box.Contains(box))
+        return false;
+
+    // fattened and stretched ahead in the direction it's moving, so the next few moves fit
+    auto fat = BeAABB { box.Min - Margin, box.Max + Margin };
+    const auto ahead = displacement * DisplacementScale;
+    fat.Min += glm::min(ahead, glm::vec3(0.f));
+    fat.Max += glm::max(ahead, glm::vec3(0.f));
+
+    RemoveLeaf(proxy);
+    _nodes[proxy].Box = fat;
+    InsertLeaf(proxy);
+    return true;
+}
+
+auto BeAABBTree::Clear() -> void {
+    _nodes.clear();
+    _root = Null;
+    _freeList = Null;
+    _proxyCount = 0;
+}
+
+auto BeAABBTree::GetAreaRatio() const -> float {
+    if (_root == Null)
+        return 0.f;
+
+    auto innerArea = 0.f;
+    for (const auto& node : _nodes)
+        if (node.Height > 0)
+            innerArea += node.Box.SurfaceArea();
+    return innerArea / _nodes[_root].Box.SurfaceArea();
+}
+
+auto BeAABBTree::AllocateNode() -> int32_t {
+    if (_freeList == Null) {
+        _nodes.emplace_back();
+        return static_cast<int32_t>(_nodes.size() - 1);
+    }
+
+    const auto node = _freeList;
+    _freeList = _nodes[node].Parent;
+    _nodes[node] = Node();
+    return node;
+}
+
+auto BeAABBTree::FreeNode(const int32_t node) -> void {
+    _nodes[node].Parent = _freeList;
+    _nodes[node].Height = -1;
+    _freeList = node;
+}
+
+auto BeAABBTree::InsertLeaf(const int32_t leaf) -> void {
+    if (_root == Null) {
+        _root = leaf;
+        _nodes[leaf].Parent = Null;
+        return;
+    }
+
+    // descend to the sibling that adds the least surface area. making it a sibling here costs the combined box, every
+    // ancestor inherits the growth, going down costs what the child would grow by on top of that
+    const auto leafBox = _nodes[leaf].Box;
+    auto index = _root;
+    while (!_nodes[index].IsLeaf()) {
+        const auto& node = _nodes[index];
+        const auto area = node.Box.SurfaceArea();
+        const auto combinedArea = node.Box.Union(leafBox).SurfaceArea();
+        const auto cost = 2.f * combinedArea;
+        const auto inheritance = 2.f * (combinedArea - area);
+
+        const auto descendCost = [&](const int32_t child) {
+            const auto& childBox = _nodes[child].Box;
+            const auto grown = childBox.Union(leafBox).SurfaceArea();
+            return (_nodes[child].IsLeaf() ? grown : grown - childBox.SurfaceArea()) + inheritance;
+        };
+        const auto cost1 = descendCost(node.Child1);
+        const auto cost2 = descendCost(node.Child2);
+        if (cost < cost1 && cost < cost2)
+            break;
+
+        index = cost1 < cost2 ? node.Child1 : node.Child2;
+    }
+
+    // a new parent for the sibling and the leaf
+    const auto sibling = index;
+    const auto oldParent = _nodes[sibling].Parent;
+    const auto newParent = AllocateNode();
+    _nodes[newParent].Parent = oldParent;
+    _nodes[newParent].Box = _nodes[sibling].Box.Union(leafBox);
+    _nodes[newParent].Height = _nodes[sibling].Height + 1;
+    _nodes[newParent].Child1 = sibling;
+    _nodes[newParent].Child2 = leaf;
+    _nodes[sibling].Parent = newParent;
+    _nodes[leaf].Parent = newParent;
+
+    if (oldParent == Null)
+        _root = newParent;
+    else if (_nodes[oldParent].Child1 == sibling)
+        _nodes[oldParent].Child1 = newParent;
+    else
+        _nodes[oldParent].Child2 = newParent;
+
+    RefitUpwards(_nodes[leaf].Parent);
+}
+
+auto BeAABBTree::RemoveLeaf(const int32_t leaf) -> void {
+    if (leaf == _root) {
+        _root = Null;
+        return;
+    }
+
+    // the sibling takes the parent's place
+    const auto parent = _nodes[leaf].Parent;
+    const auto grandParent = _nodes[parent].Parent;
+    const auto sibling = _nodes[parent].Child1 == leaf ? _nodes[parent].Child2 : _nodes[parent].Child1;
+    _nodes[sibling].Parent = grandParent;
+    FreeNode(parent);
+
+    if (grandParent == Null) {
+        _root = sibling;
+        return;
+    }
+
+    if (_nodes[grandParent].Child1 == parent)
+        _nodes[grandParent].Child1 = sibling;
+    else
+        _nodes[grandParent].Child2 = sibling;
+    RefitUpwards(grandParent);
+}
+
+auto BeAABBTree::RefitUpwards(int32_t node) -> void {
+    while (node != Null) {
+        auto& current = _nodes[node];
+        const auto& child1 = _nodes[current.Child1];
+        const auto& child2 = _nodes[current.Child2];
+        current.Box = child1.Box.Union(child2.Box);
+        current.Height = 1 + std::max(child1.Height, child2.Height);
+
+        Rotate(node);
+        node = _nodes[node].Parent;
+    }
+}
+
+auto BeAABBTree::Rotate(const int32_t a) -> void {
+    // with children b and c, a grandchild swaps places with its uncle if that shrinks the box it leaves. a's own box
+    // stays the same, so nothing above needs to know
+    const auto b = _nodes[a].Child1;
+    const auto c = _nodes[a].Child2;
+
+    struct Rotation {
+        int32_t Parent; // the child that gets a new box
+        int32_t Uncle; // moves down into Parent
+        int32_t Grandchild; // moves up into a
+        int32_t Stays; // Parent's other child
+    };
+    auto best = Rotation { Null, Null, Null, Null };
+    auto bestGain = 0.f;
+
+    const auto consider = [&](const int32_t parent, const int32_t uncle) {
+        const auto& node = _nodes[parent];
+        if (node.IsLeaf())
+            return;
+
+        const auto area = node.Box.SurfaceArea();
+        for (const auto& [grandchild, stays] : { std::pair(node.Child1, node.Child2), std::pair(node.Child2, node.Child1) }) {
+            const auto gain = area - _nodes[uncle].Box.Union(_nodes[stays].Box).SurfaceArea();
+            if (gain > bestGain) {
+                bestGain = gain;
+                best = { parent, uncle, grandchild, stays };
+            }
+        }
+    };
+    consider(b, c);
+    consider(c, b);
+    if (best.Parent == Null)
+        return;
+
+    auto& parent = _nodes[best.Parent];
+    if (_nodes[a].Child1 == best.Uncle)
+        _nodes[a].Child1 = best.Grandchild;
+    else
+        _nodes[a].Child2 = best.Grandchild;
+    _nodes[best.Grandchild].Parent = a;
+
+    if (parent.Child1 == best.Grandchild)
+        parent.Child1 = best.Uncle;
+    else
+        parent.Child2 = best.Uncle;
+    _nodes[best.Uncle].Parent = best.Parent;
+
+    parent.Box = _nodes[best.Uncle].Box.Union(_nodes[best.Stays].Box);
+    parent.Height = 1 + std::max(_nodes[best.Uncle].Height, _nodes[best.Stays].Height);
+    _nodes[a].Height = 1 + std::max(_nodes[_nodes[a].Child1].Height, _nodes[_nodes[a].Child2].Height);
+}
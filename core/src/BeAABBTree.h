@@ -0,0 +1,205 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <umbrellas/access-modifiers.hpp>
+#include <umbrellas/include-glm.h>
+
+struct BeAABB {
+    glm::vec3 Min;
+    glm::vec3 Max;
+
+    // the box around this one after a transform
+    auto Transformed(const glm::mat4& transform) const -> BeAABB;
+    auto Union(const BeAABB& other) const -> BeAABB { return { glm::min(Min, other.Min), glm::max(Max, other.Max) }; }
+    auto Contains(const BeAABB& other) const -> bool { return glm::all(glm::lessThanEqual(Min, other.Min)) && glm::all(glm::greaterThanEqual(Max, other.Max)); }
+    auto Overlaps(const BeAABB& other) const -> bool { return glm::all(glm::lessThanEqual(Min, other.Max)) && glm::all(glm::greaterThanEqual(Max, other.Min)); }
+    auto SurfaceArea() const -> float {
+        const auto size = Max - Min;
+        return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+};
+
+// bounding volume hierarchy over boxes that come, go and move. leaves hold fattened boxes, so an object moving a
+// little stays in its leaf and costs nothing. one that leaves it is reinserted, descending by the surface area
+// heuristic, and the path back up is refit and rotated where a rotation makes the tree cheaper. queries take a
+// callback with the leaf's user data and stop early when it returns false
+class BeAABBTree {
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose static constexpr int32_t Null = -1;
+    expose static constexpr float Margin = 0.1f; // fattening on every side
+    expose static constexpr float DisplacementScale = 4.f; // how far ahead a moving box is fattened, in moves
+
+
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide struct Node {
+        BeAABB Box;
+        int32_t Parent = Null; // next free node while the node is free
+        int32_t Child1 = Null;
+        int32_t Child2 = Null;
+        int32_t Height = 0; // 0 for leaves, -1 for free nodes
+        uint32_t UserData = 0;
+
+        auto IsLeaf() const -> bool { return Child1 == Null; }
+    };
+
+    // each query has its own, so queries on a const tree can run on several threads. the rotations keep the tree
+    // shallow enough to fit the array, a degenerate one spills onto the heap
+    hide struct TraversalStack {
+        std::array<int32_t, 64> Inline;
+        std::vector<int32_t> Spilled;
+        uint32_t Size = 0;
+
+        auto Push(const int32_t node) -> void {
+            if (Size < Inline.size())
+                Inline[Size] = node;
+            else
+                Spilled.push_back(node);
+            Size++;
+        }
+        auto Pop() -> int32_t {
+            Size--;
+            if (Size < Inline.size())
+                return Inline[Size];
+            const auto node = Spilled.back();
+            Spilled.pop_back();
+            return node;
+        }
+        auto IsEmpty() const -> bool { return Size == 0; }
+    };
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide std::vector<Node> _nodes;
+    hide int32_t _root = Null;
+    hide int32_t _freeList = Null;
+    hide uint32_t _proxyCount = 0;
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    // returns the proxy id, stable until the proxy is destroyed
+    expose auto CreateProxy(const BeAABB& box, uint32_t userData) -> int32_t;
+    expose auto DestroyProxy(int32_t proxy) -> void;
+    // false if the box still fits in the fattened one and nothing changed. displacement is how far the object moved
+    expose auto MoveProxy(int32_t proxy, const BeAABB& box, const glm::vec3& displacement) -> bool;
+    expose auto Clear() -> void;
+
+    expose auto GetUserData(const int32_t proxy) const -> uint32_t { return _nodes[proxy].UserData; }
+    expose auto GetFatBox(const int32_t proxy) const -> const BeAABB& { return _nodes[proxy].Box; }
+    expose auto GetProxyCount() const -> uint32_t { return _proxyCount; }
+    expose auto GetHeight() const -> int32_t { return _root == Null ? 0 : _nodes[_root].Height; }
+    // surface area of all inner nodes over the root's, what insertion and rotations keep low
+    expose auto GetAreaRatio() const -> float;
+
+    // callback(uint32_t userData) -> bool, false stops the query
+    template <typename Callback> auto QueryBox(const BeAABB& box, Callback&& callback) const -> void;
+    template <typename Callback> auto QuerySphere(const glm::vec3& center, float radius, Callback&& callback) const -> void;
+    // planes point inwards like BeFrustumCuller::ExtractPlanes. subtrees entirely inside are reported without tests
+    template <typename Callback> auto QueryFrustum(std::span<const glm::vec4> planes, Callback&& callback) const -> void;
+    // callback(uint32_t userData, float distance) -> bool, with the distance the ray enters the fattened box at
+    template <typename Callback> auto QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Callback&& callback) const -> void;
+
+    hide auto AllocateNode() -> int32_t;
+    hide auto FreeNode(int32_t node) -> void;
+    hide auto InsertLeaf(int32_t leaf) -> void;
+    hide auto RemoveLeaf(int32_t leaf) -> void;
+    hide auto RefitUpwards(int32_t node) -> void;
+    hide auto Rotate(int32_t node) -> void;
+    template <typename Overlaps, typename Callback> auto Traverse(Overlaps&& overlaps, Callback&& callback) const -> void;
+};
+
+template <typename Overlaps, typename Callback>
+auto BeAABBTree::Traverse(Overlaps&& overlaps, Callback&& callback) const -> void {
+    if (_root == Null)
+        return;
+
+    auto stack = TraversalStack();
+    stack.Push(_root);
+    while (!stack.IsEmpty()) {
+        const auto& node = _nodes[stack.Pop()];
+        if (!overlaps(node.Box))
+            continue;
+
+        if (node.IsLeaf()) {
+            if (!callback(node.UserData))
+                return;
+            continue;
+        }
+        stack.Push(node.Child1);
+        stack.Push(node.Child2);
+    }
+}
+
+template <typename Callback>
+auto BeAABBTree::QueryBox(const BeAABB& box, Callback&& callback) const -> void {
+    Traverse([&box](const BeAABB& nodeBox) { return nodeBox.Overlaps(box); }, callback);
+}
+
+template <typename Callback>
+auto BeAABBTree::QuerySphere(const glm::vec3& center, const float radius, Callback&& callback) const -> void {
+    Traverse([&center, radius](const BeAABB& nodeBox) {
+        const auto gap = glm::max(glm::max(nodeBox.Min - center, center - nodeBox.Max), glm::vec3(0.f));
+        return glm::dot(gap, gap) <= radius * radius;
+    }, callback);
+}
+
+template <typename Callback>
+auto BeAABBTree::QueryFrustum(const std::span<const glm::vec4> planes, Callback&& callback) const -> void {
+    if (_root == Null)
+        return;
+
+    // a node entirely inside every plane has its whole subtree reported, the flag rides along on the stack
+    auto stack = TraversalStack();
+    stack.Push(_root);
+    while (!stack.IsEmpty()) {
+        const auto entry = stack.Pop();
+        const auto inside = entry < 0;
+        const auto& node = _nodes[inside ? ~entry : entry];
+
+        auto fullyInside = inside;
+        if (!inside) {
+            const auto center = (node.Box.Min + node.Box.Max) * 0.5f;
+            const auto extents = (node.Box.Max - node.Box.Min) * 0.5f;
+            auto outside = false;
+            fullyInside = true;
+            for (const auto& plane : planes) {
+                const auto distance = glm::dot(glm::vec3(plane), center) + plane.w;
+                const auto radius = glm::dot(glm::abs(glm::vec3(plane)), extents);
+                outside |= distance + radius < 0.f;
+                fullyInside &= distance - radius >= 0.f;
+            }
+            if (outside)
+                continue;
+        }
+
+        if (node.IsLeaf()) {
+            if (!callback(node.UserData))
+                return;
+            continue;
+        }
+        stack.Push(fullyInside ? ~node.Child1 : node.Child1);
+        stack.Push(fullyInside ? ~node.Child2 : node.Child2);
+    }
+}
+
+template <typename Callback>
+auto BeAABBTree::QueryRay(
+    const glm::vec3& origin,
+    const glm::vec3& direction,
+    const float maxDistance,
+    Callback&& callback
+) const -> void {
+    const auto inverse = 1.f / direction;
+    auto enter = 0.f;
+    Traverse([&](const BeAABB& nodeBox) {
+        // slabs, an axis the ray is parallel to gives infinities that min and max sort out
+        const auto t0 = (nodeBox.Min - origin) * inverse;
+        const auto t1 = (nodeBox.Max - origin) * inverse;
+        const auto near = glm::min(t0, t1);
+        const auto far = glm::max(t0, t1);
+        enter = std::max({ near.x, near.y, near.z, 0.f });
+        const auto exit = std::min({ far.x, far.y, far.z, maxDistance });
+        return enter <= exit;
+    }, [&](const uint32_t userData) { return callback(userData, enter); });
+}
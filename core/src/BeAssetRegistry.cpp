@@ -1,22 +1,34 @@
 #include "BeAssetRegistry.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 
+#include "BeMappedFile.h"
 #include "BeShader.h"
+#include "BeShaderHotReload.h"
+#include "BeShaderPackage.h"
 #include "BeShaderTools.h"
 #include "BeRenderer.h"
+#include "Utils.h"
 
 std::weak_ptr<BeRenderer> BeAssetRegistry::_renderer;
 
 std::unordered_map<std::filesystem::path, std::string> BeAssetRegistry::_shaderSources;
 
 std::unordered_map<std::string, std::shared_ptr<BeShader>> BeAssetRegistry::_shaders;
-std::unordered_map<std::string, BeMaterialScheme> BeAssetRegistry::_materialSchemes;
-std::unordered_map<std::string, ComPtr<ID3D11SamplerState>> BeAssetRegistry::_samplers;
+std::unordered_map<std::string, std::shared_ptr<const BeMaterialScheme>> BeAssetRegistry::_materialSchemes;
+std::unordered_map<std::string, Json> BeAssetRegistry::_materialSchemeJsons;
+std::unordered_map<uint64_t, ComPtr<ID3D11SamplerState>> BeAssetRegistry::_samplers;
+std::vector<BeAssetRegistry::InputLayoutEntry> BeAssetRegistry::_inputLayouts;
+std::unordered_multimap<uint64_t, size_t> BeAssetRegistry::_inputLayoutIndicesByHash;
 std::unordered_map<std::string, std::shared_ptr<BeMaterial>> BeAssetRegistry::_materials;
 std::unordered_map<std::string, std::shared_ptr<BeTexture>> BeAssetRegistry::_textures;
 std::unordered_map<std::string, std::shared_ptr<BeModel>> BeAssetRegistry::_models;
 
+std::unique_ptr<BeShaderHotReload> BeAssetRegistry::_shaderHotReload;
+
 auto BeAssetRegistry::IndexShaderFiles(const std::vector<std::filesystem::path>& filePaths) -> void {
     
     // collect sources
@@ -38,44 +50,8 @@ auto BeAssetRegistry::IndexShaderFiles(const std::vector<std::filesystem::path>&
     
     
     // index material schemes
-    for (const auto& src : sourcesToIndex | std::views::values) {
-        
-        auto startPos = src.find("@be-material:");
-        while (startPos != std::string::npos) {
-            auto endPos = src.find("@be-end", startPos);
-            assert(endPos != std::string::npos);
-            
-            auto nameStart = src.find(" ", startPos);
-            assert(nameStart != std::string::npos);
-            nameStart++;
-            auto jsonStart = src.find('\n', startPos);
-            assert(jsonStart != std::string::npos && jsonStart < endPos);
-            
-            auto materialNameRaw = src.substr(nameStart, jsonStart - nameStart);
-            auto materialName = std::string(BeShaderTools::Trim(materialNameRaw, " \t"));
-            
-            jsonStart++; // Move past newline
-            auto jsonContent = src.substr(jsonStart, endPos - jsonStart);
-    
-            jsonContent.erase(0, jsonContent.find_first_not_of(" \t\r\n"));
-            jsonContent.erase(jsonContent.find_last_not_of(" \t\r\n") + 1);
-            
-            auto json = Json();
-            
-            try {
-                json = Json::parse(jsonContent, nullptr, true, true, true);
-            } catch (const Json::parse_error& e) {
-                const auto msg = e.what();
-                assert(false);
-            }
-            
-            auto materialScheme = BeMaterialScheme::CreateFromJson(materialName, json);
-            _materialSchemes[materialName] = materialScheme;
-            
-            startPos = src.find("@be-material:", endPos);
-        }
-        
-    } 
+    for (const auto& src : sourcesToIndex | std::views::values)
+        IndexMaterialSchemes(src);
     
     // index shaders
     for (const auto& [path, src] : sourcesToIndex) {
@@ -87,87 +63,302 @@ auto BeAssetRegistry::IndexShaderFiles(const std::vector<std::filesystem::path>&
     }
 }
 
-auto BeAssetRegistry::GetSampler(std::string_view samplerDescString) -> ComPtr<ID3D11SamplerState> {
+auto BeAssetRegistry::IndexMaterialSchemes(const std::string& src) -> std::vector<std::string> {
+    auto replaced = std::vector<std::string>();
+    for (const auto& [materialName, json] : ParseMaterialSchemes(src)) {
+        if (RegisterMaterialScheme(materialName, json))
+            replaced.push_back(materialName);
+    }
+    return replaced;
+}
 
-    auto key = std::string(samplerDescString);
+auto BeAssetRegistry::ParseMaterialSchemes(const std::string& src) -> std::vector<std::pair<std::string, Json>> {
+    auto schemes = std::vector<std::pair<std::string, Json>>();
+    
+    auto startPos = src.find("@be-material:");
+    while (startPos != std::string::npos) {
+        auto endPos = src.find("@be-end", startPos);
+        assert(endPos != std::string::npos);
+        
+        auto nameStart = src.find(" ", startPos);
+        assert(nameStart != std::string::npos);
+        nameStart++;
+        auto jsonStart = src.find('\n', startPos);
+        assert(jsonStart != std::string::npos && jsonStart < endPos);
+        
+        auto materialNameRaw = src.substr(nameStart, jsonStart - nameStart);
+        auto materialName = std::string(BeShaderTools::Trim(materialNameRaw, " \t"));
+        
+        jsonStart++; // Move past newline
+        auto jsonContent = src.substr(jsonStart, endPos - jsonStart);
 
-    if (_samplers.contains(key)) {
-        return _samplers[key];
+        jsonContent.erase(0, jsonContent.find_first_not_of(" \t\r\n"));
+        jsonContent.erase(jsonContent.find_last_not_of(" \t\r\n") + 1);
+        
+        auto json = Json();
+        
+        try {
+            json = Json::parse(jsonContent, nullptr, true, true, true);
+        } catch (const Json::parse_error& e) {
+            const auto msg = e.what();
+            assert(false);
+        }
+        
+        schemes.emplace_back(std::move(materialName), std::move(json));
+        startPos = src.find("@be-material:", endPos);
     }
+    return schemes;
+}
 
-    auto tokens = BeShaderTools::Split(samplerDescString, "-");
-    be_assert(
-        tokens.size() == 2 || tokens.size() == 3, 
-        "Invalid samplerDescString. Expected format: filter-address[-cmp]", 
-        samplerDescString, 
-        tokens.size()
-    );
-
-    auto filterToken = std::string(tokens[0]);
-    auto addressToken = std::string(tokens[1]);
-    auto hasComparison = tokens.size() == 3 && tokens[2] == "cmp";
+auto BeAssetRegistry::RegisterMaterialScheme(const std::string& name, const Json& json) -> bool {
+    // unchanged schemes keep their object, materials and shaders compare them by pointer
+    const auto previous = _materialSchemeJsons.find(name);
+    if (previous != _materialSchemeJsons.end() && previous->second == json)
+        return false;
+    
+    const auto replaced = previous != _materialSchemeJsons.end();
+    _materialSchemes[name] = BeMaterialScheme::CreateFromJson(name, json);
+    _materialSchemeJsons[name] = json;
+    return replaced;
+}
 
+auto BeAssetRegistry::CookShaderPackage(
+    const std::vector<std::filesystem::path>& filePaths,
+    const std::filesystem::path& packagePath
+) -> bool {
+    // everything the package views point into
+    auto compiledShaders = std::vector<BeShader::Compiled>();
+    auto schemes = std::vector<std::pair<std::string, std::vector<uint8_t>>>();
+    compiledShaders.reserve(filePaths.size());
     
-    D3D11_FILTER filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-    if (filterToken == "point") {
-        filter = D3D11_FILTER_MIN_MAG_MIP_POINT;
-    } else if (filterToken == "linear") {
-        filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-    // todo: add anisotropic
-    } else {
-        be_assert(false, "Unknown filter token", filterToken);
+    auto succeeded = true;
+    for (const auto& path : filePaths) {
+        const auto src = BeShaderTools::ReadFile(path);
+        for (const auto& [materialName, json] : ParseMaterialSchemes(src))
+            schemes.emplace_back(materialName, Json::to_msgpack(json));
+        
+        if (src.find("@be-shader:") == std::string::npos)
+            continue;
+        
+        auto compiled = BeShader::Compile(path);
+        if (!compiled) {
+            (void)std::fprintf(stderr, "Shader cook failed: %s\n", compiled.error().c_str());
+            succeeded = false;
+            continue;
+        }
+        compiledShaders.push_back(std::move(compiled.value()));
     }
+    if (!succeeded)
+        return false;
     
+    auto filePathStrings = std::vector<std::string>();
+    filePathStrings.reserve(compiledShaders.size());
+    
+    auto contents = BeShaderPackage::Contents();
+    for (const auto& compiled : compiledShaders) {
+        const auto stageTable = [](const auto& stages) {
+            return std::span(reinterpret_cast<const uint8_t*>(stages.data()), stages.size());
+        };
+        
+        auto& shader = contents.Shaders.emplace_back();
+        shader.Name = compiled.Name;
+        shader.FilePath = filePathStrings.emplace_back(compiled.FilePath.generic_string());
+        shader.Blend = uint8_t(compiled.State.Blend);
+        shader.Cull = uint8_t(compiled.State.Cull);
+        shader.Depth = uint8_t(compiled.State.Depth);
+        shader.Topology = uint32_t(compiled.State.Topology);
+        shader.AnimatesGeometry = compiled.AnimatesGeometry;
+        
+        shader.VertexBytecode = compiled.VertexBytecode;
+        shader.HullBytecode = compiled.HullBytecode;
+        shader.DomainBytecode = compiled.DomainBytecode;
+        shader.PixelBytecode = compiled.PixelBytecode;
+        shader.InputSignature = compiled.InputSignature;
+        
+        shader.VertexLayout.assign(compiled.VertexLayout.begin(), compiled.VertexLayout.end());
+        for (const auto& [linkName, schemeName, slot] : compiled.MaterialLinks)
+            shader.MaterialLinks.push_back({ linkName, schemeName, slot });
+        for (const auto& [targetName, slot] : compiled.PixelTargets)
+            shader.Targets.push_back({ targetName, slot });
+        
+        shader.ConstantBufferStages = stageTable(compiled.ConstantBufferStages);
+        shader.ResourceStages = stageTable(compiled.ResourceStages);
+        shader.SamplerStages = stageTable(compiled.SamplerStages);
+    }
+    for (const auto& [name, msgpack] : schemes)
+        contents.Schemes.push_back({ name, msgpack });
     
-    D3D11_TEXTURE_ADDRESS_MODE addressMode = D3D11_TEXTURE_ADDRESS_CLAMP;
-    if (addressToken == "wrap") {
-        addressMode = D3D11_TEXTURE_ADDRESS_WRAP;
-    } else if (addressToken == "clamp") {
-        addressMode = D3D11_TEXTURE_ADDRESS_CLAMP;
-    } else if (addressToken == "mirror") {
-        addressMode = D3D11_TEXTURE_ADDRESS_MIRROR;
-    } else {
-        be_assert(false, "Unknown address token", addressToken);
+    const auto bytes = BeShaderPackage::Write(contents);
+    auto file = std::ofstream(packagePath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file) {
+        (void)std::fprintf(stderr, "Shader cook failed: couldn't write %s\n", packagePath.string().c_str());
+        return false;
     }
+    return true;
+}
+
+auto BeAssetRegistry::LoadShaderPackage(const std::filesystem::path& packagePath) -> void {
+    const auto mapped = BeMappedFile::Open(packagePath);
+    be_assert(mapped, "Couldn't map shader package", packagePath);
     
+    const auto contents = BeShaderPackage::Read(mapped->GetBytes());
+    be_assert(contents, contents.error(), packagePath);
     
-    if (hasComparison) {
-        if (filter == D3D11_FILTER_MIN_MAG_MIP_POINT) {
-            filter = D3D11_FILTER_COMPARISON_MIN_MAG_MIP_POINT;
-        } else if (filter == D3D11_FILTER_MIN_MAG_MIP_LINEAR) {
-            filter = D3D11_FILTER_COMPARISON_MIN_MAG_MIP_LINEAR;
-        } else if (filter == D3D11_FILTER_ANISOTROPIC) {
-            filter = D3D11_FILTER_COMPARISON_ANISOTROPIC;
-        } else {
-            be_assert(false, "Unreachable, wrong filter", filter);
-        }
-    }
+    // schemes first, shaders resolve their material links against the registry
+    for (const auto& scheme : contents->Schemes)
+        RegisterMaterialScheme(std::string(scheme.Name), Json::from_msgpack(scheme.Json));
+    
+    auto renderer = _renderer.lock();
+    be_assert(renderer, "Renderer couldn't be locked");
     
-    D3D11_SAMPLER_DESC samplerDesc = {};
-    samplerDesc.Filter = filter;
-    samplerDesc.AddressU = addressMode;
-    samplerDesc.AddressV = addressMode;
-    samplerDesc.AddressW = addressMode;
-    samplerDesc.MipLODBias = 0.0f;
-    samplerDesc.MaxAnisotropy = 1;
-    samplerDesc.ComparisonFunc = hasComparison ? D3D11_COMPARISON_LESS : D3D11_COMPARISON_NEVER;
-    samplerDesc.BorderColor[0] = 0.0f;
-    samplerDesc.BorderColor[1] = 0.0f;
-    samplerDesc.BorderColor[2] = 0.0f;
-    samplerDesc.BorderColor[3] = 0.0f;
-    samplerDesc.MinLOD = 0.0f;
-    samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+    for (const auto& shader : contents->Shaders) {
+        const auto stageTable = [](auto& stages, const std::span<const uint8_t> cooked) {
+            for (size_t slot = 0; slot < stages.size() && slot < cooked.size(); slot++)
+                stages[slot] = BeShaderType(cooked[slot]);
+        };
+        
+        // bytecode stays a view into the mapping, the device copies it in Create
+        auto compiled = BeShader::Compiled();
+        compiled.FilePath = std::filesystem::path(shader.FilePath);
+        compiled.Name = std::string(shader.Name);
+        compiled.State.Blend = BeBlendMode(shader.Blend);
+        compiled.State.Cull = BeCullMode(shader.Cull);
+        compiled.State.Depth = BeDepthMode(shader.Depth);
+        compiled.State.Topology = D3D11_PRIMITIVE_TOPOLOGY(shader.Topology);
+        compiled.AnimatesGeometry = shader.AnimatesGeometry;
+        
+        compiled.VertexBytecode = shader.VertexBytecode;
+        compiled.HullBytecode = shader.HullBytecode;
+        compiled.DomainBytecode = shader.DomainBytecode;
+        compiled.PixelBytecode = shader.PixelBytecode;
+        compiled.InputSignature = shader.InputSignature;
+        
+        compiled.VertexLayout.assign(shader.VertexLayout.begin(), shader.VertexLayout.end());
+        for (const auto& [linkName, schemeName, slot] : shader.MaterialLinks)
+            compiled.MaterialLinks.push_back({ std::string(linkName), std::string(schemeName), slot });
+        for (const auto& [targetName, slot] : shader.Targets)
+            compiled.PixelTargets.emplace_back(std::string(targetName), slot);
+        
+        stageTable(compiled.ConstantBufferStages, shader.ConstantBufferStages);
+        stageTable(compiled.ResourceStages, shader.ResourceStages);
+        stageTable(compiled.SamplerStages, shader.SamplerStages);
+        
+        auto created = BeShader::Create(compiled, *renderer);
+        _shaders[created->Name] = created;
+    }
+}
+
+auto BeAssetRegistry::EnableShaderHotReload() -> void {
+#if BE_SHADER_COMPILER
+    if (!_shaderHotReload)
+        _shaderHotReload = BeShaderHotReload::Create();
+#endif
+}
+
+auto BeAssetRegistry::ApplyShaderHotReload() -> void {
+    if (!_shaderHotReload)
+        return;
+
+    auto renderer = _renderer.lock();
+    be_assert(renderer, "Renderer couldn't be locked");
+    _shaderHotReload->Apply(*renderer);
+}
+
+auto BeAssetRegistry::GetSampler(std::string_view samplerDescString) -> ComPtr<ID3D11SamplerState> {
+    return GetSampler(BeSamplerDesc::Parse(samplerDescString));
+}
 
+auto BeAssetRegistry::GetSampler(const BeSamplerDesc& desc) -> ComPtr<ID3D11SamplerState> {
+    const auto key = desc.Key();
+    if (const auto it = _samplers.find(key); it != _samplers.end()) {
+        return it->second;
+    }
     
     auto renderer = _renderer.lock();
     be_assert(renderer, "Renderer couldn't be locked");
 
-    auto device = renderer->GetDevice();
+    const auto samplerDesc = desc.ToD3D();
     ComPtr<ID3D11SamplerState> samplerState;
-
-    auto hr = device->CreateSamplerState(&samplerDesc, &samplerState);
-    be_assert(SUCCEEDED(hr), "Failed to create sampler state", samplerDescString);
+    auto hr = renderer->GetDevice()->CreateSamplerState(&samplerDesc, &samplerState);
+    be_assert(SUCCEEDED(hr), "Failed to create sampler state", key);
 
     _samplers[key] = samplerState;
     return samplerState;
 }
+
+auto BeAssetRegistry::GetInputLayout(
+    const std::span<const D3D11_INPUT_ELEMENT_DESC> elements,
+    const std::span<const uint8_t> inputSignature
+) -> ComPtr<ID3D11InputLayout> {
+    // fnv-1a over the elements (semantic names by value) and the signature bytes
+    uint64_t key = 14695981039346656037ull;
+    const auto hashBytes = [&key](const void* data, const size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            key ^= bytes[i];
+            key *= 1099511628211ull;
+        }
+    };
+    for (const auto& element : elements) {
+        hashBytes(element.SemanticName, strlen(element.SemanticName) + 1);
+        hashBytes(&element.SemanticIndex, sizeof(element.SemanticIndex));
+        hashBytes(&element.Format, sizeof(element.Format));
+        hashBytes(&element.InputSlot, sizeof(element.InputSlot));
+        hashBytes(&element.AlignedByteOffset, sizeof(element.AlignedByteOffset));
+        hashBytes(&element.InputSlotClass, sizeof(element.InputSlotClass));
+        hashBytes(&element.InstanceDataStepRate, sizeof(element.InstanceDataStepRate));
+    }
+    hashBytes(inputSignature.data(), inputSignature.size());
+
+    const auto matches = [&](const InputLayoutEntry& entry) {
+        if (entry.Elements.size() != elements.size() || !std::ranges::equal(entry.InputSignature, inputSignature))
+            return false;
+        for (size_t i = 0; i < elements.size(); i++) {
+            const auto& cached = entry.Elements[i];
+            const auto& element = elements[i];
+            const auto same =
+                entry.SemanticNames[i] == element.SemanticName &&
+                cached.SemanticIndex == element.SemanticIndex &&
+                cached.Format == element.Format &&
+                cached.InputSlot == element.InputSlot &&
+                cached.AlignedByteOffset == element.AlignedByteOffset &&
+                cached.InputSlotClass == element.InputSlotClass &&
+                cached.InstanceDataStepRate == element.InstanceDataStepRate;
+            if (!same)
+                return false;
+        }
+        return true;
+    };
+
+    const auto [begin, end] = _inputLayoutIndicesByHash.equal_range(key);
+    for (auto it = begin; it != end; ++it) {
+        if (matches(_inputLayouts[it->second]))
+            return _inputLayouts[it->second].Layout;
+    }
+
+    auto renderer = _renderer.lock();
+    be_assert(renderer, "Renderer couldn't be locked");
+
+    ComPtr<ID3D11InputLayout> inputLayout;
+    Utils::Check << renderer->GetDevice()->CreateInputLayout(
+        elements.data(),
+        static_cast<UINT>(elements.size()),
+        inputSignature.data(),
+        inputSignature.size(),
+        &inputLayout);
+
+    auto entry = InputLayoutEntry {
+        .Elements = { elements.begin(), elements.end() },
+        .InputSignature = { inputSignature.begin(), inputSignature.end() },
+        .Layout = inputLayout,
+    };
+    for (auto& element : entry.Elements) {
+        entry.SemanticNames.emplace_back(element.SemanticName);
+        element.SemanticName = nullptr;
+    }
+
+    _inputLayoutIndicesByHash.emplace(key, _inputLayouts.size());
+    _inputLayouts.push_back(std::move(entry));
+    return inputLayout;
+}
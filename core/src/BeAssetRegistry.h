@@ -3,11 +3,14 @@
 #include <cassert>
 #include <d3d11.h>
 #include <memory>
+#include <span>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <wrl/client.h>
 
 #include "BeMaterialScheme.h"
+#include "BeSamplerDesc.h"
 #include "umbrellas/include-libassert.h"
 
 class BeRenderer;
@@ -15,23 +18,46 @@ class BeTexture;
 class BeShader;
 class BeMaterial;
 struct BeModel;
+class BeShaderHotReload;
 
 using Microsoft::WRL::ComPtr;
 
 class BeAssetRegistry {
+    friend class BeShaderHotReload;
     
     hide
+    // the whole key is kept, the hash only narrows the search. semantic names are copied, the caller's go away
+    struct InputLayoutEntry {
+        std::vector<D3D11_INPUT_ELEMENT_DESC> Elements; // SemanticName unset, see SemanticNames
+        std::vector<std::string> SemanticNames;
+        std::vector<uint8_t> InputSignature;
+        ComPtr<ID3D11InputLayout> Layout;
+    };
+
     static std::weak_ptr<BeRenderer> _renderer;
     
     static std::unordered_map<std::filesystem::path, std::string> _shaderSources;
     
     static std::unordered_map<std::string, std::shared_ptr<BeShader>> _shaders;
-    static std::unordered_map<std::string, BeMaterialScheme> _materialSchemes;
-    static std::unordered_map<std::string, ComPtr<ID3D11SamplerState>> _samplers;
+    static std::unordered_map<std::string, std::shared_ptr<const BeMaterialScheme>> _materialSchemes;
+    static std::unordered_map<std::string, Json> _materialSchemeJsons; // what each scheme was created from
+    static std::unordered_map<uint64_t, ComPtr<ID3D11SamplerState>> _samplers; // by BeSamplerDesc::Key
+    static std::vector<InputLayoutEntry> _inputLayouts; // by element list and vs input signature
+    static std::unordered_multimap<uint64_t, size_t> _inputLayoutIndicesByHash; // fnv-1a of the same
     static std::unordered_map<std::string, std::shared_ptr<BeMaterial>> _materials;
     static std::unordered_map<std::string, std::shared_ptr<BeTexture>> _textures;
     static std::unordered_map<std::string, std::shared_ptr<BeModel>> _models;
 
+    static std::unique_ptr<BeShaderHotReload> _shaderHotReload;
+
+    // registers the @be-material blocks of src, keeping schemes whose json didn't change.
+    // returns the names of schemes that replaced a different earlier version
+    static auto IndexMaterialSchemes (const std::string& src) -> std::vector<std::string>;
+    // name and json of every @be-material block in src
+    static auto ParseMaterialSchemes (const std::string& src) -> std::vector<std::pair<std::string, Json>>;
+    // true if a different earlier version was replaced
+    static auto RegisterMaterialScheme (const std::string& name, const Json& json) -> bool;
+
     expose
     //BeAssetRegistry() = default;
     //~BeAssetRegistry() = default;
@@ -49,10 +75,32 @@ class BeAssetRegistry {
     }
     static auto HasShader(std::string_view name) -> bool { return _shaders.contains(std::string(name)); }
 
-    static auto GetMaterialScheme(std::string_view name) -> BeMaterialScheme { be_assert(_materialSchemes.contains(std::string(name))); return _materialSchemes.at(std::string(name)); }
+    // compiles every shader and extracts every material scheme of the files into one BeShaderPackage, needs no device.
+    // returns false if a shader didn't compile or the package couldn't be written
+    static auto CookShaderPackage (
+        const std::vector<std::filesystem::path>& filePaths,
+        const std::filesystem::path& packagePath
+    ) -> bool;
+    // registers everything in a cooked package, the file is mapped once and bytecode goes from the mapping to the device
+    static auto LoadShaderPackage (const std::filesystem::path& packagePath) -> void;
+
+    // watches the indexed files and their includes, changed shaders get recompiled in the background
+    static auto EnableShaderHotReload() -> void;
+    // swaps in what finished recompiling, the renderer calls it between frames
+    static auto ApplyShaderHotReload() -> void;
+
+    static auto GetMaterialScheme(std::string_view name) -> std::shared_ptr<const BeMaterialScheme> { be_assert(_materialSchemes.contains(std::string(name))); return _materialSchemes.at(std::string(name)); }
     static auto HasMaterialScheme(std::string_view name) -> bool { return _materialSchemes.contains(std::string(name)); }
     
     static auto GetSampler (std::string_view samplerDescString) -> ComPtr<ID3D11SamplerState>;
+    static auto GetSampler (const BeSamplerDesc& desc) -> ComPtr<ID3D11SamplerState>;
+
+    // Input layouts, shared between vertex shaders with the same elements and input signature
+    static auto GetInputLayout (
+        std::span<const D3D11_INPUT_ELEMENT_DESC> elements,
+        std::span<const uint8_t> inputSignature
+    ) -> ComPtr<ID3D11InputLayout>;
+    static auto GetInputLayoutCount() -> size_t { return _inputLayouts.size(); }
     
     // Material
     static auto AddMaterial(std::string_view name, std::shared_ptr<BeMaterial> material) -> void { _materials[std::string(name)] = material; }
@@ -9,6 +9,7 @@ struct BeUniformData {
     glm::mat4 ProjectionView {1.0f};
     glm::vec2 NearFarPlane {0.1f, 100.0f};
     glm::vec3 CameraPosition {0.0f, 0.0f, 0.0f};
+    float ScreenScale {0.0f}; // pixels per unit at distance 1, see BeCamera::GetScreenScale. 0 turns screen size policies off
     
     glm::vec3 AmbientColor {0.0f, 0.0f, 0.0f};
 
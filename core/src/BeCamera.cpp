@@ -23,4 +23,5 @@ void BeCamera::Update() {
     const float width  = static_cast<float>(Width);
     const float height = static_cast<float>(Height);
     _projectionMatrix = glm::perspectiveFovLH_ZO(fov, width, height, NearPlane, FarPlane);
+    _screenScale = height / (2.0f * tan(fov * 0.5f));
 }
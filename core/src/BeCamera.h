@@ -29,6 +29,7 @@ class BeCamera {
 
     glm::mat4 _viewMatrix{1.0f};
     glm::mat4 _projectionMatrix{1.0f};
+    float _screenScale{0.0f};
     
 
     
@@ -45,6 +46,8 @@ class BeCamera {
 
     [[nodiscard]] glm::mat4 GetViewMatrix() const { return _viewMatrix; }
     [[nodiscard]] glm::mat4 GetProjectionMatrix() const { return _projectionMatrix; }
+    // pixels a unit long object spans at distance 1, divide by the distance for anything further
+    [[nodiscard]] float GetScreenScale() const { return _screenScale; }
 
     void Update();
 };
@@ -0,0 +1,57 @@
+#include "BeConstantRing.h"
+
+#include <cassert>
+
+#include "Utils.h"
+
+auto BeConstantRing::Create(
+    const ComPtr<ID3D11Device>& device,
+    const uint32_t capacityBytes,
+    const bool supportsNoOverwrite
+) -> std::shared_ptr<BeConstantRing> {
+    auto ring = std::shared_ptr<BeConstantRing>(new BeConstantRing());
+    ring->_ring = BeLinearRing(capacityBytes);
+    ring->_supportsNoOverwrite = supportsNoOverwrite;
+
+    D3D11_BUFFER_DESC bufferDesc = {};
+    bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    bufferDesc.ByteWidth = capacityBytes;
+    bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    Utils::Check << device->CreateBuffer(&bufferDesc, nullptr, &ring->_buffer);
+
+    return ring;
+}
+
+auto BeConstantRing::Map(
+    ID3D11DeviceContext* context,
+    const uint32_t count,
+    const uint32_t blockBytes
+) -> std::optional<Blocks> {
+    assert(!_mapped);
+
+    const auto stride = (blockBytes + WindowAlignment - 1) / WindowAlignment * WindowAlignment;
+    if (!_supportsNoOverwrite)
+        _ring.Reset();
+
+    const auto allocation = _ring.Allocate(uint64_t(stride) * count, WindowAlignment);
+    if (!allocation)
+        return std::nullopt;
+
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    const auto mapType = allocation->Wrapped ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+    Utils::Check << context->Map(_buffer.Get(), 0, mapType, 0, &mappedResource);
+    _mapped = true;
+
+    return Blocks {
+        .Data = static_cast<std::byte*>(mappedResource.pData) + allocation->Offset,
+        .FirstConstant = static_cast<uint32_t>(allocation->Offset / 16),
+        .Stride = stride,
+    };
+}
+
+auto BeConstantRing::Unmap(ID3D11DeviceContext* context) -> void {
+    assert(_mapped);
+    context->Unmap(_buffer.Get(), 0);
+    _mapped = false;
+}
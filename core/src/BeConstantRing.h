@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <d3d11.h>
+#include <memory>
+#include <optional>
+#include <umbrellas/access-modifiers.hpp>
+#include <wrl/client.h>
+
+#include "BeLinearRing.h"
+
+using Microsoft::WRL::ComPtr;
+
+// one large dynamic constant buffer that small per-draw blocks are packed into. a pass maps room for all of its
+// blocks at once and binds each as a window with BePipeline::BindConstantRange. maps don't overwrite while the ring
+// has room and discard when it wraps, so draws issued earlier keep reading what they were given
+class BeConstantRing {
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // count blocks of Stride bytes each, Stride a multiple of the 256 bytes windows have to be aligned to
+    expose struct Blocks {
+        std::byte* Data = nullptr;
+        uint32_t FirstConstant = 0; // of block 0, in 16 byte constants
+        uint32_t Stride = 0;
+
+        template <typename T> auto At(const uint32_t index) const -> T& { return *reinterpret_cast<T*>(Data + index * Stride); }
+        auto ConstantOf(const uint32_t index) const -> uint32_t { return FirstConstant + index * (Stride / 16); }
+        auto ConstantCount() const -> uint32_t { return Stride / 16; }
+    };
+
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose static constexpr uint32_t WindowAlignment = 256;
+    // without no-overwrite maps on constant buffers (11.1 drivers may lack it) every map discards and starts at 0
+    expose static auto Create(
+        const ComPtr<ID3D11Device>& device,
+        uint32_t capacityBytes,
+        bool supportsNoOverwrite
+    ) -> std::shared_ptr<BeConstantRing>;
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide ComPtr<ID3D11Buffer> _buffer;
+    hide BeLinearRing _ring { 0 };
+    hide bool _supportsNoOverwrite = false;
+    hide bool _mapped = false;
+
+    // lifetime ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide BeConstantRing() = default;
+    expose ~BeConstantRing() = default;
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    // blockBytes is rounded up to the window alignment. the blocks stay writable until Unmap. empty and nothing is
+    // mapped if they don't fit in the whole ring, the caller falls back to its own buffer then
+    expose auto Map(ID3D11DeviceContext* context, uint32_t count, uint32_t blockBytes) -> std::optional<Blocks>;
+    expose auto Unmap(ID3D11DeviceContext* context) -> void;
+    expose auto GetBuffer() const -> ID3D11Buffer* { return _buffer.Get(); }
+};
@@ -0,0 +1,120 @@
+#include "BeFileWatcher.h"
+
+#include <string_view>
+
+auto BeFileWatcher::Create(const std::vector<std::filesystem::path>& directories) -> std::unique_ptr<BeFileWatcher> {
+    auto watcher = std::unique_ptr<BeFileWatcher>(new BeFileWatcher());
+    watcher->_stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+    for (const auto& path : directories) {
+        if (!std::filesystem::is_directory(path))
+            continue;
+
+        auto directory = std::make_unique<Directory>();
+        directory->Path = std::filesystem::weakly_canonical(path);
+        directory->Handle = CreateFileW(
+            directory->Path.wstring().c_str(),
+            FILE_LIST_DIRECTORY,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+            nullptr);
+        if (directory->Handle == INVALID_HANDLE_VALUE)
+            continue;
+
+        directory->Overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!watcher->Issue(*directory)) {
+            CloseHandle(directory->Overlapped.hEvent);
+            CloseHandle(directory->Handle);
+            continue;
+        }
+        watcher->_directories.push_back(std::move(directory));
+    }
+
+    watcher->_thread = std::thread([watcher = watcher.get()] { watcher->Run(); });
+    return watcher;
+}
+
+BeFileWatcher::~BeFileWatcher() {
+    SetEvent(_stopEvent);
+    if (_thread.joinable())
+        _thread.join();
+
+    for (const auto& directory : _directories) {
+        // the kernel writes into Buffer until the cancellation completes
+        DWORD bytes = 0;
+        CancelIoEx(directory->Handle, &directory->Overlapped);
+        GetOverlappedResult(directory->Handle, &directory->Overlapped, &bytes, TRUE);
+        CloseHandle(directory->Overlapped.hEvent);
+        CloseHandle(directory->Handle);
+    }
+    CloseHandle(_stopEvent);
+}
+
+auto BeFileWatcher::TakeSettledChanges() -> std::vector<std::filesystem::path> {
+    const auto now = std::chrono::steady_clock::now();
+    auto settled = std::vector<std::filesystem::path>();
+
+    std::scoped_lock lock(_mutex);
+    for (auto it = _changes.begin(); it != _changes.end();) {
+        if (now - it->second < SettleTime) {
+            ++it;
+            continue;
+        }
+        settled.push_back(it->first);
+        it = _changes.erase(it);
+    }
+    return settled;
+}
+
+auto BeFileWatcher::Run() -> void {
+    auto handles = std::vector<HANDLE> { _stopEvent };
+    for (const auto& directory : _directories)
+        handles.push_back(directory->Overlapped.hEvent);
+
+    while (true) {
+        const auto result = WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(), FALSE, INFINITE);
+        const auto index = result - WAIT_OBJECT_0;
+        if (index == 0 || index >= handles.size())
+            return; // stop requested or the wait failed
+
+        auto& directory = *_directories[index - 1];
+        DWORD bytes = 0;
+        // zero bytes means the buffer overflowed and the names are lost, the next save reports them again
+        if (GetOverlappedResult(directory.Handle, &directory.Overlapped, &bytes, FALSE) && bytes > 0)
+            Collect(directory, bytes);
+
+        if (!Issue(directory))
+            return;
+    }
+}
+
+auto BeFileWatcher::Issue(Directory& directory) -> bool {
+    // editors usually save through a temporary file and a rename, so names count as well as writes
+    return ReadDirectoryChangesW(
+        directory.Handle,
+        directory.Buffer.data(),
+        static_cast<DWORD>(directory.Buffer.size()),
+        FALSE,
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME,
+        nullptr,
+        &directory.Overlapped,
+        nullptr) != FALSE;
+}
+
+auto BeFileWatcher::Collect(const Directory& directory, const DWORD bytes) -> void {
+    const auto now = std::chrono::steady_clock::now();
+
+    std::scoped_lock lock(_mutex);
+    size_t offset = 0;
+    while (offset < bytes) {
+        const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(directory.Buffer.data() + offset);
+        const auto name = std::wstring_view(info->FileName, info->FileNameLength / sizeof(WCHAR));
+        _changes[(directory.Path / name).lexically_normal()] = now;
+
+        if (info->NextEntryOffset == 0)
+            break;
+        offset += info->NextEntryOffset;
+    }
+}
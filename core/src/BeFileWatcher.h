@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <windows.h>
+#include <umbrellas/access-modifiers.hpp>
+
+// watches directories for writes and renames on a background thread (ReadDirectoryChangesW).
+// editors save in bursts, so a file is only reported once it has been quiet for SettleTime
+class BeFileWatcher {
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+    struct Directory {
+        std::filesystem::path Path;
+        HANDLE Handle = INVALID_HANDLE_VALUE;
+        OVERLAPPED Overlapped = {};
+        alignas(DWORD) std::array<std::byte, 16 * 1024> Buffer;
+    };
+
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose static constexpr auto SettleTime = std::chrono::milliseconds(100);
+    // directories that don't exist are skipped, subdirectories aren't watched
+    expose static auto Create(const std::vector<std::filesystem::path>& directories) -> std::unique_ptr<BeFileWatcher>;
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide std::vector<std::unique_ptr<Directory>> _directories;
+    hide HANDLE _stopEvent = nullptr;
+    hide std::thread _thread;
+
+    hide std::mutex _mutex;
+    hide std::unordered_map<std::filesystem::path, std::chrono::steady_clock::time_point> _changes; // by last change
+
+    // lifetime ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide BeFileWatcher() = default;
+    expose ~BeFileWatcher();
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    // absolute, normalised paths of the files that changed and settled since the last call
+    expose auto TakeSettledChanges() -> std::vector<std::filesystem::path>;
+
+    hide auto Run() -> void;
+    hide auto Issue(Directory& directory) -> bool;
+    hide auto Collect(const Directory& directory, DWORD bytes) -> void;
+};
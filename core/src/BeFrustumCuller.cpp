@@ -0,0 +1,290 @@
+#include "BeFrustumCuller.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <umbrellas/include-simd.h>
+
+auto BeFrustumCuller::ExtractPlanes(const glm::mat4& projectionView) -> std::array<glm::vec4, 6> {
+    const auto row = [&projectionView](const int i) {
+        return glm::vec4(projectionView[0][i], projectionView[1][i], projectionView[2][i], projectionView[3][i]);
+    };
+    const auto x = row(0), y = row(1), z = row(2), w = row(3);
+
+    auto planes = std::array {w + x, w - x, w + y, w - y, z, w - z};
+    for (auto& plane : planes)
+        plane /= glm::length(glm::vec3(plane));
+    return planes;
+}
+
+auto BeFrustumCuller::HasAVX2() -> bool {
+    static const bool hasAVX2 = [] {
+#if defined(_MSC_VER)
+        // the cpu has to support it and the os has to save the ymm registers
+        int info[4];
+        __cpuid(info, 1);
+        const auto osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+        const auto hasFMA = (info[2] & (1 << 12)) != 0;
+        __cpuidex(info, 7, 0);
+        return osSavesYmm && hasFMA && (info[1] & (1 << 5));
+#else
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    }();
+    return hasAVX2;
+}
+
+auto BeFrustumCuller::Clear() -> void {
+    _groups.clear();
+    _count = 0;
+}
+
+auto BeFrustumCuller::Reserve(const size_t count) -> void {
+    _groups.reserve((count + 7) / 8);
+}
+
+auto BeFrustumCuller::Push(const glm::vec3& center, const glm::vec3& extents) -> uint32_t {
+    const auto lane = _count % 8;
+    if (lane == 0)
+        _groups.push_back({});
+
+    auto& group = _groups.back();
+    group.CentersX[lane] = center.x;
+    group.CentersY[lane] = center.y;
+    group.CentersZ[lane] = center.z;
+    group.ExtentsX[lane] = extents.x;
+    group.ExtentsY[lane] = extents.y;
+    group.ExtentsZ[lane] = extents.z;
+    return _count++;
+}
+
+auto BeFrustumCuller::PushTransformed(
+    const glm::vec3& localMin,
+    const glm::vec3& localMax,
+    const glm::mat4& model
+) -> uint32_t {
+    if (localMin.x > localMax.x)
+        return Push(glm::vec3(model[3]), glm::vec3(std::numeric_limits<float>::max()));
+
+    // the box around a transformed box, extents go through the absolute rotation and scale
+    const auto localCenter = (localMin + localMax) * 0.5f;
+    const auto localExtents = (localMax - localMin) * 0.5f;
+    const auto center = glm::vec3(model * glm::vec4(localCenter, 1.f));
+    const auto extents =
+        glm::abs(glm::vec3(model[0])) * localExtents.x +
+        glm::abs(glm::vec3(model[1])) * localExtents.y +
+        glm::abs(glm::vec3(model[2])) * localExtents.z;
+    return Push(center, extents);
+}
+
+auto BeFrustumCuller::GetBox(const uint32_t index) const -> std::pair<glm::vec3, glm::vec3> {
+    const auto& group = _groups[index / 8];
+    const auto lane = index % 8;
+    return {
+        glm::vec3(group.CentersX[lane], group.CentersY[lane], group.CentersZ[lane]),
+        glm::vec3(group.ExtentsX[lane], group.ExtentsY[lane], group.ExtentsZ[lane]),
+    };
+}
+
+auto BeFrustumCuller::UsesAVX2(const Path path) -> bool {
+    assert(path != Path::AVX2 || HasAVX2());
+    return path == Path::AVX2 || (path == Path::Best && HasAVX2());
+}
+
+auto BeFrustumCuller::Cull(const std::span<const glm::vec4> planes, const Path path) -> std::span<const uint32_t> {
+    // the splats live on the stack, planes past what they have room for are dropped
+    const auto used = planes.first(std::min(planes.size(), MaxPlanes));
+
+    // a whole group is stored at a time, so there's room for one past the end
+    _visible.resize(_count + 8);
+    const auto visibleCount = UsesAVX2(path) ? CullAVX2(used) : CullSSE(used);
+    return std::span(_visible).first(visibleCount);
+}
+
+auto BeFrustumCuller::CullSphere(const glm::vec3& center, const float radius, const Path path) -> std::span<const uint32_t> {
+    _visible.resize(_count + 8);
+    const auto visibleCount = UsesAVX2(path) ? CullSphereAVX2(center, radius) : CullSphereSSE(center, radius);
+    return std::span(_visible).first(visibleCount);
+}
+
+// for each mask of visible lanes, the lanes in order
+static constexpr auto CompactLanes = [] {
+    std::array<std::array<uint8_t, 8>, 256> table = {};
+    for (uint32_t mask = 0; mask < 256; mask++) {
+        uint8_t count = 0;
+        for (uint8_t lane = 0; lane < 8; lane++)
+            if (mask & (1u << lane))
+                table[mask][count++] = lane;
+    }
+    return table;
+}();
+
+// a box is in front of a plane when the center's distance plus the extents projected on the normal isn't negative.
+// the planes are splatted once up front, the absolute normal is what the extents project on. lanes past the count
+// were zeroed by Push and get masked out
+struct SplatPlaneSSE {
+    __m128 X, Y, Z, W;
+    __m128 AbsX, AbsY, AbsZ;
+};
+
+struct SplatPlaneAVX2 {
+    __m256 X, Y, Z, W;
+    __m256 AbsX, AbsY, AbsZ;
+};
+
+auto BeFrustumCuller::CullSSE(const std::span<const glm::vec4> planes) -> uint32_t {
+    SplatPlaneSSE splats[MaxPlanes];
+    for (size_t i = 0; i < planes.size(); i++) {
+        const auto& plane = planes[i];
+        splats[i] = {
+            _mm_set1_ps(plane.x), _mm_set1_ps(plane.y), _mm_set1_ps(plane.z), _mm_set1_ps(plane.w),
+            _mm_set1_ps(std::abs(plane.x)), _mm_set1_ps(std::abs(plane.y)), _mm_set1_ps(std::abs(plane.z)),
+        };
+    }
+
+    const auto zero = _mm_setzero_ps();
+    uint32_t visibleCount = 0;
+
+    for (uint32_t first = 0; first < _count; first += 4) {
+        const auto& group = _groups[first / 8];
+        const auto lane = first % 8;
+        const auto centerX = _mm_load_ps(group.CentersX + lane);
+        const auto centerY = _mm_load_ps(group.CentersY + lane);
+        const auto centerZ = _mm_load_ps(group.CentersZ + lane);
+        const auto extentX = _mm_load_ps(group.ExtentsX + lane);
+        const auto extentY = _mm_load_ps(group.ExtentsY + lane);
+        const auto extentZ = _mm_load_ps(group.ExtentsZ + lane);
+
+        auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (size_t i = 0; i < planes.size(); i++) {
+            const auto& plane = splats[i];
+            const auto distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(plane.X, centerX), _mm_mul_ps(plane.Y, centerY)),
+                _mm_add_ps(_mm_mul_ps(plane.Z, centerZ), plane.W));
+            const auto radius = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(plane.AbsX, extentX), _mm_mul_ps(plane.AbsY, extentY)),
+                _mm_mul_ps(plane.AbsZ, extentZ));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+            if (_mm_movemask_ps(inside) == 0)
+                break;
+        }
+
+        auto mask = static_cast<uint32_t>(_mm_movemask_ps(inside));
+        if (_count - first < 4)
+            mask &= (1u << (_count - first)) - 1;
+        while (mask) {
+            _visible[visibleCount++] = first + std::countr_zero(mask);
+            mask &= mask - 1;
+        }
+    }
+
+    return visibleCount;
+}
+
+BE_TARGET_AVX2 auto BeFrustumCuller::CullAVX2(const std::span<const glm::vec4> planes) -> uint32_t {
+    SplatPlaneAVX2 splats[MaxPlanes];
+    for (size_t i = 0; i < planes.size(); i++) {
+        const auto& plane = planes[i];
+        splats[i] = {
+            _mm256_set1_ps(plane.x), _mm256_set1_ps(plane.y), _mm256_set1_ps(plane.z), _mm256_set1_ps(plane.w),
+            _mm256_set1_ps(std::abs(plane.x)), _mm256_set1_ps(std::abs(plane.y)), _mm256_set1_ps(std::abs(plane.z)),
+        };
+    }
+
+    const auto zero = _mm256_setzero_ps();
+    uint32_t visibleCount = 0;
+
+    for (uint32_t first = 0; first < _count; first += 8) {
+        const auto& group = _groups[first / 8];
+        const auto centerX = _mm256_load_ps(group.CentersX);
+        const auto centerY = _mm256_load_ps(group.CentersY);
+        const auto centerZ = _mm256_load_ps(group.CentersZ);
+        const auto extentX = _mm256_load_ps(group.ExtentsX);
+        const auto extentY = _mm256_load_ps(group.ExtentsY);
+        const auto extentZ = _mm256_load_ps(group.ExtentsZ);
+
+        auto inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t i = 0; i < planes.size(); i++) {
+            const auto& plane = splats[i];
+            const auto distance = _mm256_fmadd_ps(plane.X, centerX, _mm256_fmadd_ps(plane.Y, centerY, _mm256_fmadd_ps(plane.Z, centerZ, plane.W)));
+            const auto reach = _mm256_fmadd_ps(plane.AbsX, extentX, _mm256_fmadd_ps(plane.AbsY, extentY, _mm256_fmadd_ps(plane.AbsZ, extentZ, distance)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(reach, zero, _CMP_GE_OQ));
+        }
+
+        // branchless compaction, the visible lanes' indices are packed to the front and stored whole
+        auto mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+        if (_count - first < 8)
+            mask &= (1u << (_count - first)) - 1;
+        const auto lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(CompactLanes[mask].data())));
+        const auto indices = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first)), lanes);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_visible.data() + visibleCount), indices);
+        visibleCount += std::popcount(mask);
+    }
+
+    return visibleCount;
+}
+
+// a box touches a sphere when the squared distance from the sphere's center to the box, per axis how far the center is
+// past the extents, is at most the squared radius
+auto BeFrustumCuller::CullSphereSSE(const glm::vec3& center, const float radius) -> uint32_t {
+    const auto sphereX = _mm_set1_ps(center.x), sphereY = _mm_set1_ps(center.y), sphereZ = _mm_set1_ps(center.z);
+    const auto radiusSquared = _mm_set1_ps(radius * radius);
+    const auto zero = _mm_setzero_ps();
+    const auto signBit = _mm_set1_ps(-0.f);
+    uint32_t visibleCount = 0;
+
+    for (uint32_t first = 0; first < _count; first += 4) {
+        const auto& group = _groups[first / 8];
+        const auto lane = first % 8;
+        const auto gap = [zero, signBit](const __m128 sphere, const __m128 boxCenter, const __m128 extent) {
+            const auto offset = _mm_andnot_ps(signBit, _mm_sub_ps(sphere, boxCenter));
+            return _mm_max_ps(_mm_sub_ps(offset, extent), zero);
+        };
+        const auto gapX = gap(sphereX, _mm_load_ps(group.CentersX + lane), _mm_load_ps(group.ExtentsX + lane));
+        const auto gapY = gap(sphereY, _mm_load_ps(group.CentersY + lane), _mm_load_ps(group.ExtentsY + lane));
+        const auto gapZ = gap(sphereZ, _mm_load_ps(group.CentersZ + lane), _mm_load_ps(group.ExtentsZ + lane));
+        const auto distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(gapX, gapX), _mm_mul_ps(gapY, gapY)), _mm_mul_ps(gapZ, gapZ));
+
+        auto mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(distanceSquared, radiusSquared)));
+        if (_count - first < 4)
+            mask &= (1u << (_count - first)) - 1;
+        while (mask) {
+            _visible[visibleCount++] = first + std::countr_zero(mask);
+            mask &= mask - 1;
+        }
+    }
+
+    return visibleCount;
+}
+
+BE_TARGET_AVX2 auto BeFrustumCuller::CullSphereAVX2(const glm::vec3& center, const float radius) -> uint32_t {
+    const auto sphereX = _mm256_set1_ps(center.x), sphereY = _mm256_set1_ps(center.y), sphereZ = _mm256_set1_ps(center.z);
+    const auto radiusSquared = _mm256_set1_ps(radius * radius);
+    const auto zero = _mm256_setzero_ps();
+    const auto signBit = _mm256_set1_ps(-0.f);
+    uint32_t visibleCount = 0;
+
+    for (uint32_t first = 0; first < _count; first += 8) {
+        const auto& group = _groups[first / 8];
+        const auto gap = [zero, signBit](const __m256 sphere, const __m256 boxCenter, const __m256 extent) BE_TARGET_AVX2 {
+            const auto offset = _mm256_andnot_ps(signBit, _mm256_sub_ps(sphere, boxCenter));
+            return _mm256_max_ps(_mm256_sub_ps(offset, extent), zero);
+        };
+        const auto gapX = gap(sphereX, _mm256_load_ps(group.CentersX), _mm256_load_ps(group.ExtentsX));
+        const auto gapY = gap(sphereY, _mm256_load_ps(group.CentersY), _mm256_load_ps(group.ExtentsY));
+        const auto gapZ = gap(sphereZ, _mm256_load_ps(group.CentersZ), _mm256_load_ps(group.ExtentsZ));
+        const auto distanceSquared = _mm256_fmadd_ps(gapX, gapX, _mm256_fmadd_ps(gapY, gapY, _mm256_mul_ps(gapZ, gapZ)));
+
+        auto mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(distanceSquared, radiusSquared, _CMP_LE_OQ)));
+        if (_count - first < 8)
+            mask &= (1u << (_count - first)) - 1;
+        const auto lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(CompactLanes[mask].data())));
+        const auto indices = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first)), lanes);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_visible.data() + visibleCount), indices);
+        visibleCount += std::popcount(mask);
+    }
+
+    return visibleCount;
+}
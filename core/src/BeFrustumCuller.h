@@ -0,0 +1,68 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+#include <umbrellas/access-modifiers.hpp>
+#include <umbrellas/include-glm.h>
+
+// tests world space boxes against a set of planes or a sphere, eight at a time with avx2 and fma, four at a time with sse otherwise.
+// boxes are kept as centers and half extents in separate arrays per group of eight, so a lane is one box and a group
+// is one contiguous read. planes point inwards, a box is culled once it's entirely behind any one of them
+class BeFrustumCuller {
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    // left, right, bottom, top, near, far of a projection with 0..1 depth, normalised
+    expose static auto ExtractPlanes(const glm::mat4& projectionView) -> std::array<glm::vec4, 6>;
+    // avx2 and fma, checked once
+    expose static auto HasAVX2() -> bool;
+    // planes past this many are ignored, which only keeps boxes that they would have culled
+    expose static constexpr size_t MaxPlanes = 8;
+
+
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Best picks avx2 where the cpu has it. the others are for comparing the paths, AVX2 needs HasAVX2
+    expose enum class Path : uint8_t {
+        Best,
+        SSE,
+        AVX2,
+    };
+
+    hide struct alignas(32) BoxGroup {
+        float CentersX[8];
+        float CentersY[8];
+        float CentersZ[8];
+        float ExtentsX[8];
+        float ExtentsY[8];
+        float ExtentsZ[8];
+    };
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide std::vector<BoxGroup> _groups;
+    hide uint32_t _count = 0;
+    hide std::vector<uint32_t> _visible;
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose auto Clear() -> void;
+    expose auto Reserve(size_t count) -> void;
+    // both return the index of the box, boxes are numbered in the order they're pushed
+    expose auto Push(const glm::vec3& center, const glm::vec3& extents) -> uint32_t;
+    // an inverted local box (see BeModel::HasBounds) is pushed as one that's never culled
+    expose auto PushTransformed(const glm::vec3& localMin, const glm::vec3& localMax, const glm::mat4& model) -> uint32_t;
+
+    // ascending indices of the boxes in front of or crossing every plane, valid until the next Cull
+    expose auto Cull(std::span<const glm::vec4> planes, Path path = Path::Best) -> std::span<const uint32_t>;
+    // same, for the boxes that touch a sphere
+    expose auto CullSphere(const glm::vec3& center, float radius, Path path = Path::Best) -> std::span<const uint32_t>;
+
+    expose auto GetCount() const -> uint32_t { return _count; }
+    // center and half extents
+    expose auto GetBox(uint32_t index) const -> std::pair<glm::vec3, glm::vec3>;
+
+    hide static auto UsesAVX2(Path path) -> bool;
+    hide auto CullSSE(std::span<const glm::vec4> planes) -> uint32_t;
+    hide auto CullAVX2(std::span<const glm::vec4> planes) -> uint32_t;
+    hide auto CullSphereSSE(const glm::vec3& center, float radius) -> uint32_t;
+    hide auto CullSphereAVX2(const glm::vec3& center, float radius) -> uint32_t;
+};
@@ -0,0 +1,16 @@
+#include "BeLinearRing.h"
+
+auto BeLinearRing::Allocate(const uint64_t size, const uint64_t alignment) -> std::optional<Allocation> {
+    if (size > _capacity)
+        return std::nullopt;
+
+    const auto aligned = (_head + alignment - 1) & ~(alignment - 1);
+    if (_wrapPending || aligned > _capacity - size) {
+        _wrapPending = false;
+        _head = size;
+        return Allocation { .Offset = 0, .Wrapped = true };
+    }
+
+    _head = aligned + size;
+    return Allocation { .Offset = aligned, .Wrapped = false };
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <umbrellas/access-modifiers.hpp>
+
+// hands out ranges of a fixed size buffer front to back. a request that doesn't fit in what's left starts over at 0
+// and says so, the caller then orphans the buffer (a discard map) before writing. only does arithmetic, so it
+// doesn't care what the buffer is
+class BeLinearRing {
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose struct Allocation {
+        uint64_t Offset = 0;
+        bool Wrapped = false; // everything handed out before is gone
+    };
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide uint64_t _capacity = 0;
+    hide uint64_t _head = 0;
+    hide bool _wrapPending = true; // nothing was handed out yet or Reset was called
+
+    // lifetime ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose explicit BeLinearRing(const uint64_t capacity) : _capacity(capacity) {}
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    // alignment has to be a power of two. empty if the size is larger than the whole ring
+    expose auto Allocate(uint64_t size, uint64_t alignment) -> std::optional<Allocation>;
+    // the next allocation starts at 0 and reports a wrap
+    expose auto Reset() -> void { _wrapPending = true; }
+
+    expose auto GetCapacity() const -> uint64_t { return _capacity; }
+    expose auto GetHead() const -> uint64_t { return _head; }
+};
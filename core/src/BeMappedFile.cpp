@@ -0,0 +1,81 @@
+#include "BeMappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+auto BeMappedFile::Open(const std::filesystem::path& path) -> std::unique_ptr<BeMappedFile> {
+    auto mapped = std::unique_ptr<BeMappedFile>(new BeMappedFile());
+
+    const auto file = CreateFileW(
+        path.wstring().c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+    mapped->_file = file;
+
+    auto size = LARGE_INTEGER();
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        return nullptr;
+
+    mapped->_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapped->_mapping)
+        return nullptr;
+
+    mapped->_data = static_cast<const uint8_t*>(MapViewOfFile(mapped->_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!mapped->_data)
+        return nullptr;
+    mapped->_size = static_cast<size_t>(size.QuadPart);
+    return mapped;
+}
+
+BeMappedFile::~BeMappedFile() {
+    if (_data)
+        UnmapViewOfFile(_data);
+    if (_mapping)
+        CloseHandle(_mapping);
+    if (_file)
+        CloseHandle(_file);
+}
+
+#else
+
+auto BeMappedFile::Open(const std::filesystem::path& path) -> std::unique_ptr<BeMappedFile> {
+    auto mapped = std::unique_ptr<BeMappedFile>(new BeMappedFile());
+
+    mapped->_file = open(path.c_str(), O_RDONLY);
+    if (mapped->_file < 0)
+        return nullptr;
+
+    struct stat status = {};
+    if (fstat(mapped->_file, &status) != 0 || status.st_size == 0)
+        return nullptr;
+
+    const auto data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, mapped->_file, 0);
+    if (data == MAP_FAILED)
+        return nullptr;
+    mapped->_data = static_cast<const uint8_t*>(data);
+    mapped->_size = static_cast<size_t>(status.st_size);
+    return mapped;
+}
+
+BeMappedFile::~BeMappedFile() {
+    if (_data)
+        munmap(const_cast<uint8_t*>(_data), _size);
+    if (_file >= 0)
+        close(_file);
+}
+
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <umbrellas/access-modifiers.hpp>
+
+// whole file mapped read-only, the bytes stay valid for the lifetime of the object
+class BeMappedFile {
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    // nullptr if the file can't be opened or is empty
+    expose static auto Open(const std::filesystem::path& path) -> std::unique_ptr<BeMappedFile>;
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide const uint8_t* _data = nullptr;
+    hide size_t _size = 0;
+#ifdef _WIN32
+    hide void* _file = nullptr;
+    hide void* _mapping = nullptr;
+#else
+    hide int _file = -1;
+#endif
+
+    // lifetime ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide BeMappedFile() = default;
+    expose ~BeMappedFile();
+    expose BeMappedFile(const BeMappedFile&) = delete;
+    expose auto operator=(const BeMappedFile&) -> BeMappedFile& = delete;
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose auto GetBytes() const -> std::span<const uint8_t> { return { _data, _size }; }
+};
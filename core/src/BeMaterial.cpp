@@ -1,8 +1,11 @@
 #include "BeMaterial.h"
 
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 #include <iomanip>
+#include <ranges>
+#include <stdexcept>
 
 #include "BeAssetRegistry.h"
 #include "BeRenderer.h"
@@ -11,7 +14,7 @@
 
 auto BeMaterial::Create(
     std::string_view name,
-    const BeMaterialScheme& scheme,
+    const std::shared_ptr<const BeMaterialScheme>& scheme,
     bool frequentlyUsed,
     const BeRenderer& renderer
 )
@@ -21,226 +24,527 @@ auto BeMaterial::Create(
     return material;
 }
 
+static auto NextMaterialBlockID() -> uint32_t {
+    static uint32_t blockCount = 0;
+    return ++blockCount;
+}
+
 BeMaterial::BeMaterial(
     std::string name,
     const bool frequentlyUsed,
-    BeMaterialScheme descriptor,
+    std::shared_ptr<const BeMaterialScheme> scheme,
     const BeRenderer& renderer
 )
     : Name(std::move(name))
     , _isFrequentlyUsed(frequentlyUsed)
-    , _scheme(std::move(descriptor))
+    , _context1(renderer.GetContext1())
+    , _scheme(std::move(scheme))
+    , _parameters(std::make_shared<ParameterBlock>())
+    , _resources(std::make_shared<ResourceBlock>())
 {
-    static uint32_t materialCount = 0;
-    _uniqueID = ++materialCount;
+    _parameters->UniqueID = NextMaterialBlockID();
     
-    if (_scheme.Properties.empty())
+    if (_scheme->Properties.empty())
         return;
     
-    AssembleData();
-
-    D3D11_BUFFER_DESC bufferDesc = {};
-    bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-    const uint32_t sizeInBytes = static_cast<uint32_t>(_bufferData.size() * sizeof(float));
-    bufferDesc.ByteWidth = ((sizeInBytes + 15) / 16) * 16;
-    if (_isFrequentlyUsed) {
-        bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-        bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    }
-    else {
-        bufferDesc.Usage = D3D11_USAGE_DEFAULT;
-        bufferDesc.CPUAccessFlags = 0;
-    }
-
-    D3D11_SUBRESOURCE_DATA data = {};
-    data.pSysMem = _bufferData.data();
-
-    Utils::Check << renderer.GetDevice()->CreateBuffer(&bufferDesc, &data, _cbuffer.GetAddressOf());
-
-    _cbufferDirty = false;
+    // without a device yet the buffer is made on the first upload, like a diverged instance's
+    _parameters->Data = _scheme->DefaultBuffer;
+    if (const auto device = renderer.GetDevice())
+        CreateBuffer(device.Get());
 }
 
+BeMaterial::BeMaterial(
+    std::string name,
+    std::shared_ptr<BeMaterial> parent
+)
+    : Name(std::move(name))
+    , _isFrequentlyUsed(parent->_isFrequentlyUsed)
+    , _context1(parent->_context1)
+    , _scheme(parent->_scheme)
+    , _parameters(parent->_parameters)
+    , _resources(parent->_resources)
+    , _parent(std::move(parent))
+{}
+
 //BeMaterial::BeMaterial() = default;
 BeMaterial::~BeMaterial() = default;
 
 auto BeMaterial::InitialiseSlotMaps() -> void {
-    for (const auto& property : _scheme.Textures) {
+    for (const auto& property : _scheme->Textures) {
         auto texWeak = BeAssetRegistry::GetTexture(property.DefaultTexturePath);
         be_assert(
             !texWeak.expired(), 
             "Texture not found in registry: " + property.DefaultTexturePath
         );
 
-        _textures[property.Name] = {texWeak.lock(), property.SlotIndex};
+        _resources->Textures[property.Name] = {texWeak.lock(), property.SlotIndex};
     }
 
-    for (const auto& property : _scheme.Samplers) {
-        auto sampler = BeAssetRegistry::GetSampler(property.DefaultSamplerDescString);
+    for (const auto& property : _scheme->Samplers) {
+        auto sampler = BeAssetRegistry::GetSampler(property.DefaultSampler);
         be_assert(sampler, "Invalid behaviour: BeAssetRegistry::GetSampler returned nullptr. This should never happen");
-        _samplers[property.Name] = { sampler, property.SlotIndex };
+        _resources->Samplers[property.Name] = { sampler, property.SlotIndex };
     }
 }
 
-auto BeMaterial::SetFloat(const std::string& propertyName, float value) -> void {
-    assert(_propertyOffsets.contains(propertyName));
-    const uint32_t offset = _propertyOffsets.at(propertyName);
-    memcpy(_bufferData.data() + offset, &value, sizeof(float));
-    _cbufferDirty = true;
+auto BeMaterial::GetPropertyId(const BeMaterialPropertyKey key) const -> BeMaterialPropertyId {
+    return _scheme->GetPropertyId(key);
 }
 
-auto BeMaterial::SetFloat2(const std::string& propertyName, glm::vec2 value) -> void {
-    assert(_propertyOffsets.contains(propertyName));
-    const uint32_t offset = _propertyOffsets.at(propertyName);
-    memcpy(_bufferData.data() + offset, &value, sizeof(glm::vec2));
-    _cbufferDirty = true;
+auto BeMaterial::GetPropertyId(const std::string_view propertyName) const -> BeMaterialPropertyId {
+    return GetPropertyId(BeMaterialPropertyKey::Of(propertyName));
 }
+
+auto BeMaterial::WriteProperty(
+    const BeMaterialPropertyId id,
+    const BeMaterialPropertyDescriptor::Type type,
+    const float* data,
+    const size_t count
+) -> void {
+    // a missing property or another type is the caller's bug, release builds drop the write rather than go past the
+    // buffer
+    const auto valid = id.IsValid() && id.PropertyType == type && id.Offset + count <= _parameters->Data.size();
+    assert(valid);
+    if (!valid)
+        return;
+    
+    // rewriting the same value neither dirties the buffer nor makes an instance diverge
+    if (memcmp(_parameters->Data.data() + id.Offset, data, count * sizeof(float)) == 0)
+        return;
     
-auto BeMaterial::SetFloat3(const std::string& propertyName, glm::vec3 value) -> void {
-    assert(_propertyOffsets.contains(propertyName));
-    const uint32_t offset = _propertyOffsets.at(propertyName);
-    memcpy(_bufferData.data() + offset, &value, sizeof(glm::vec3));
-    _cbufferDirty = true;
+    const uint32_t end = id.Offset + static_cast<uint32_t>(count);
+    memcpy(BeginWrite(id.Offset, end) + id.Offset, data, count * sizeof(float));
+    PushParametersToInstances(id.Offset, end);
 }
 
-auto BeMaterial::SetFloat4(const std::string& propertyName, glm::vec4 value) -> void {
-    assert(_propertyOffsets.contains(propertyName));
-    const uint32_t offset = _propertyOffsets.at(propertyName);
-    memcpy(_bufferData.data() + offset, &value, sizeof(glm::vec4));
-    _cbufferDirty = true;
+auto BeMaterial::ReadProperty(
+    const BeMaterialPropertyId id,
+    const BeMaterialPropertyDescriptor::Type type,
+    float* data,
+    const size_t count
+) const -> void {
+    const auto valid = id.IsValid() && id.PropertyType == type && id.Offset + count <= _parameters->Data.size();
+    assert(valid);
+    if (!valid) {
+        std::fill_n(data, count, 0.f);
+        return;
+    }
+    memcpy(data, _parameters->Data.data() + id.Offset, count * sizeof(float));
 }
 
-auto BeMaterial::SetMatrix(const std::string& propertyName, glm::mat4x4 value) -> void {
-    assert(_propertyOffsets.contains(propertyName));
-    const uint32_t offset = _propertyOffsets.at(propertyName);
-    memcpy(_bufferData.data() + offset, glm::value_ptr(value), sizeof(glm::mat4x4));
-    _cbufferDirty = true;
+auto BeMaterial::SetFloat(const BeMaterialPropertyId id, const float value) -> void {
+    WriteProperty(id, BeMaterialPropertyDescriptor::Type::Float, &value, 1);
 }
 
-auto BeMaterial::GetFloat(const std::string& propertyName) const -> float {
-    assert(_propertyOffsets.contains(propertyName));
-    const uint32_t offset = _propertyOffsets.at(propertyName);
+auto BeMaterial::SetFloat2(const BeMaterialPropertyId id, const glm::vec2 value) -> void {
+    WriteProperty(id, BeMaterialPropertyDescriptor::Type::Float2, glm::value_ptr(value), 2);
+}
+
+auto BeMaterial::SetFloat3(const BeMaterialPropertyId id, const glm::vec3 value) -> void {
+    WriteProperty(id, BeMaterialPropertyDescriptor::Type::Float3, glm::value_ptr(value), 3);
+}
+
+auto BeMaterial::SetFloat4(const BeMaterialPropertyId id, const glm::vec4 value) -> void {
+    WriteProperty(id, BeMaterialPropertyDescriptor::Type::Float4, glm::value_ptr(value), 4);
+}
+
+auto BeMaterial::SetMatrix(const BeMaterialPropertyId id, const glm::mat4x4& value) -> void {
+    WriteProperty(id, BeMaterialPropertyDescriptor::Type::Matrix, glm::value_ptr(value), 16);
+}
+
+auto BeMaterial::GetFloat(const BeMaterialPropertyId id) const -> float {
     float value;
-    memcpy(&value, _bufferData.data() + offset, sizeof(float));
+    ReadProperty(id, BeMaterialPropertyDescriptor::Type::Float, &value, 1);
     return value;
 }
 
-auto BeMaterial::GetFloat2(const std::string& propertyName) const -> glm::vec2 {
-    assert(_propertyOffsets.contains(propertyName));
-    const uint32_t offset = _propertyOffsets.at(propertyName);
+auto BeMaterial::GetFloat2(const BeMaterialPropertyId id) const -> glm::vec2 {
     glm::vec2 value;
-    memcpy(&value, _bufferData.data() + offset, sizeof(glm::vec2));
+    ReadProperty(id, BeMaterialPropertyDescriptor::Type::Float2, glm::value_ptr(value), 2);
     return value;
 }
 
-auto BeMaterial::GetFloat3(const std::string& propertyName) const -> glm::vec3 {
-    assert(_propertyOffsets.contains(propertyName));
-    const uint32_t offset = _propertyOffsets.at(propertyName);
+auto BeMaterial::GetFloat3(const BeMaterialPropertyId id) const -> glm::vec3 {
     glm::vec3 value;
-    memcpy(&value, _bufferData.data() + offset, sizeof(glm::vec3));
+    ReadProperty(id, BeMaterialPropertyDescriptor::Type::Float3, glm::value_ptr(value), 3);
     return value;
 }
 
-auto BeMaterial::GetFloat4(const std::string& propertyName) const -> glm::vec4 {
-    assert(_propertyOffsets.contains(propertyName));
-    const uint32_t offset = _propertyOffsets.at(propertyName);
+auto BeMaterial::GetFloat4(const BeMaterialPropertyId id) const -> glm::vec4 {
     glm::vec4 value;
-    memcpy(&value, _bufferData.data() + offset, sizeof(glm::vec4));
+    ReadProperty(id, BeMaterialPropertyDescriptor::Type::Float4, glm::value_ptr(value), 4);
     return value;
 }
 
-auto BeMaterial::GetMatrix(const std::string& propertyName) const -> glm::mat4x4 {
-    assert(_propertyOffsets.contains(propertyName));
-    const uint32_t offset = _propertyOffsets.at(propertyName);
+auto BeMaterial::GetMatrix(const BeMaterialPropertyId id) const -> glm::mat4x4 {
     glm::mat4x4 value;
-    memcpy(glm::value_ptr(value), _bufferData.data() + offset, sizeof(glm::mat4x4));
+    ReadProperty(id, BeMaterialPropertyDescriptor::Type::Matrix, glm::value_ptr(value), 16);
     return value;
 }
 
+// string overloads resolve the id on every call. fine for setup code, use ids on hot paths
+
+auto BeMaterial::RequirePropertyId(const std::string& propertyName) const -> BeMaterialPropertyId {
+    const auto id = GetPropertyId(propertyName);
+    if (!id.IsValid())
+        throw std::out_of_range("Material '" + Name + "' has no property '" + propertyName + "'");
+    return id;
+}
+
+auto BeMaterial::SetFloat(const std::string& propertyName, const float value) -> void {
+    SetFloat(RequirePropertyId(propertyName), value);
+}
+
+auto BeMaterial::SetFloat2(const std::string& propertyName, const glm::vec2 value) -> void {
+    SetFloat2(RequirePropertyId(propertyName), value);
+}
+    
+auto BeMaterial::SetFloat3(const std::string& propertyName, const glm::vec3 value) -> void {
+    SetFloat3(RequirePropertyId(propertyName), value);
+}
+
+auto BeMaterial::SetFloat4(const std::string& propertyName, const glm::vec4 value) -> void {
+    SetFloat4(RequirePropertyId(propertyName), value);
+}
+
+auto BeMaterial::SetMatrix(const std::string& propertyName, const glm::mat4x4 value) -> void {
+    SetMatrix(RequirePropertyId(propertyName), value);
+}
+
+auto BeMaterial::GetFloat(const std::string& propertyName) const -> float {
+    return GetFloat(RequirePropertyId(propertyName));
+}
+
+auto BeMaterial::GetFloat2(const std::string& propertyName) const -> glm::vec2 {
+    return GetFloat2(RequirePropertyId(propertyName));
+}
+
+auto BeMaterial::GetFloat3(const std::string& propertyName) const -> glm::vec3 {
+    return GetFloat3(RequirePropertyId(propertyName));
+}
+
+auto BeMaterial::GetFloat4(const std::string& propertyName) const -> glm::vec4 {
+    return GetFloat4(RequirePropertyId(propertyName));
+}
+
+auto BeMaterial::GetMatrix(const std::string& propertyName) const -> glm::mat4x4 {
+    return GetMatrix(RequirePropertyId(propertyName));
+}
+
 
 
 auto BeMaterial::SetTexture(const std::string& propertyName, const std::shared_ptr<BeTexture>& texture) -> void {
-    assert(_textures.contains(propertyName));
-    _textures.at(propertyName).first = texture;
+    assert(_resources->Textures.contains(propertyName));
+    if (_resources->Textures.at(propertyName).first == texture)
+        return;
+    
+    OverrideResource(propertyName);
+    _resources->Textures.at(propertyName).first = texture;
+    _resources->BindingsDirty = true;
+    PushResourceToInstances(propertyName);
 }
 
 auto BeMaterial::GetTexture(const std::string& propertyName) const -> std::shared_ptr<BeTexture> {
-    assert(_textures.contains(propertyName));
-    return _textures.at(propertyName).first;
+    assert(_resources->Textures.contains(propertyName));
+    return _resources->Textures.at(propertyName).first;
 }
 
 
 
 auto BeMaterial::SetSampler(const std::string& propertyName, const ComPtr<ID3D11SamplerState>& sampler) -> void {
-    assert(_samplers.contains(propertyName));
-    _samplers.at(propertyName).first = sampler;
+    assert(_resources->Samplers.contains(propertyName));
+    if (_resources->Samplers.at(propertyName).first == sampler)
+        return;
+    
+    OverrideResource(propertyName);
+    _resources->Samplers.at(propertyName).first = sampler;
+    _resources->BindingsDirty = true;
+    PushResourceToInstances(propertyName);
 }
 
 auto BeMaterial::GetSampler(const std::string& propertyName) const -> ComPtr<ID3D11SamplerState> {
-    assert(_samplers.contains(propertyName));
-    return _samplers.at(propertyName).first;
+    assert(_resources->Samplers.contains(propertyName));
+    return _resources->Samplers.at(propertyName).first;
 }
 
 
 auto BeMaterial::UpdateGPUBuffers(const ComPtr<ID3D11DeviceContext>& context) -> bool {
-    if (!_cbufferDirty) return false;
+    auto& block = *_parameters;
+    if (block.Data.empty())
+        return false;
+    
+    // diverged instances get their buffer on first use
+    if (!block.Buffer) {
+        ComPtr<ID3D11Device> device;
+        context->GetDevice(device.GetAddressOf());
+        CreateBuffer(device.Get());
+        return true;
+    }
+    
+    if (!block.IsDirty()) return false;
 
     if (_isFrequentlyUsed) {
+        // a discard map rewrites the whole buffer anyway, unchanged values were already filtered out on set
         D3D11_MAPPED_SUBRESOURCE mappedResource;
-        Utils::Check << context->Map(_cbuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-        memcpy(mappedResource.pData, _bufferData.data(), _bufferData.size() * sizeof(float));
-        context->Unmap(_cbuffer.Get(), 0);
+        Utils::Check << context->Map(block.Buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+        memcpy(mappedResource.pData, block.Data.data(), block.Data.size() * sizeof(float));
+        context->Unmap(block.Buffer.Get(), 0);
     }
     else {
-        context->UpdateSubresource(_cbuffer.Get(), 0, nullptr, _bufferData.data(), 0, 0);
+        // partial constant buffer updates have to cover whole 16 byte registers
+        constexpr uint32_t FloatsPerRegister = 4;
+        constexpr uint32_t RegisterBytes = 16;
+        const uint32_t begin = block.DirtyBegin / FloatsPerRegister * RegisterBytes;
+        const uint32_t end = std::min(
+            (block.DirtyEnd + FloatsPerRegister - 1) / FloatsPerRegister * RegisterBytes,
+            _scheme->BufferSizeBytes
+        );
+        
+        if (_context1 && (begin > 0 || end < _scheme->BufferSizeBytes)) {
+            const D3D11_BOX box = { begin, 0, 0, end, 1, 1 };
+            const auto* source = reinterpret_cast<const uint8_t*>(block.Data.data()) + begin;
+            _context1->UpdateSubresource1(block.Buffer.Get(), 0, &box, source, 0, 0, 0);
+        }
+        else {
+            context->UpdateSubresource(block.Buffer.Get(), 0, nullptr, block.Data.data(), 0, 0);
+        }
     }
 
-    _cbufferDirty = false;
+    block.ClearDirty();
     return true;
 }
 
-auto BeMaterial::AssembleData() -> void {
-    uint32_t offsetBytes = 0;
+auto BeMaterial::Print() const -> std::string {
+    std::stringstream ss;
+    constexpr uint32_t FLOATS_PER_LINE = 4;
+
+    const auto& data = _parameters->Data;
+    for (size_t i = 0; i < data.size(); ++i) {
+        ss << std::fixed << std::setprecision(3) << data[i] << "f ";
+        if ((i + 1) % FLOATS_PER_LINE == 0) {
+            ss << "\n";
+        }
+    }
+
+    return ss.str();
+}
+
+
+
+auto BeMaterial::CreateInstance(const std::string_view name) -> std::shared_ptr<BeMaterial> {
+    auto instance = std::make_shared<BeMaterial>(std::string(name), shared_from_this());
+    std::erase_if(_instances, [](const auto& weak) { return weak.expired(); });
+    _instances.push_back(instance);
+    return instance;
+}
+
+auto BeMaterial::HasSameContent(const BeMaterial& other) const -> bool {
+    const auto& data = _parameters->Data;
+    const auto& otherData = other._parameters->Data;
+    
+    return _scheme == other._scheme
+        && data.size() == otherData.size()
+        && memcmp(data.data(), otherData.data(), data.size() * sizeof(float)) == 0
+        && _resources->Textures == other._resources->Textures
+        && _resources->Samplers == other._resources->Samplers;
+}
+
+auto BeMaterial::CreateBuffer(ID3D11Device* device) -> void {
+    D3D11_BUFFER_DESC bufferDesc = {};
+    bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    bufferDesc.ByteWidth = _scheme->BufferSizeBytes;
+    if (_isFrequentlyUsed) {
+        bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+        bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    }
+    else {
+        bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+        bufferDesc.CPUAccessFlags = 0;
+    }
+
+    D3D11_SUBRESOURCE_DATA data = {};
+    data.pSysMem = _parameters->Data.data();
+
+    Utils::Check << device->CreateBuffer(&bufferDesc, &data, _parameters->Buffer.ReleaseAndGetAddressOf());
+    _parameters->ClearDirty();
+}
+
+auto BeMaterial::BeginWrite(const uint32_t begin, const uint32_t end) -> float* {
+    if (_parent) {
+        if (SharesParametersWithParent())
+            DivergeParameters();
+
+        // insert [begin, end) and merge whatever it touches
+        auto merged = std::pair(begin, end);
+        std::erase_if(_overriddenRanges, [&merged](const auto& range) {
+            if (range.second < merged.first || range.first > merged.second)
+                return false;
+            merged.first = std::min(merged.first, range.first);
+            merged.second = std::max(merged.second, range.second);
+            return true;
+        });
+        _overriddenRanges.insert(std::ranges::lower_bound(_overriddenRanges, merged), merged);
+    }
+    
+    _parameters->MarkDirty(begin, end);
+    return _parameters->Data.data();
+}
 
-    for (const auto& property : _scheme.Properties) {
-        constexpr uint32_t registerSizeBytes = 16;
+auto BeMaterial::BeginWriteAll() -> float* {
+    be_assert(
+        std::ranges::all_of(_instances, [](const auto& weak) { return weak.expired(); }),
+        "Typed material data views don't propagate to instances", Name
+    );
+    return BeginWrite(0, static_cast<uint32_t>(_parameters->Data.size()));
+}
 
-        static const std::unordered_map<BeMaterialPropertyDescriptor::Type, uint32_t> SizeMap = {
-            {BeMaterialPropertyDescriptor::Type::Float,  uint32_t(1 * sizeof(float))},
-            {BeMaterialPropertyDescriptor::Type::Float2, uint32_t(2 * sizeof(float))},
-            {BeMaterialPropertyDescriptor::Type::Float3, uint32_t(3 * sizeof(float))},
-            {BeMaterialPropertyDescriptor::Type::Float4, uint32_t(4 * sizeof(float))},
-            {BeMaterialPropertyDescriptor::Type::Matrix, uint32_t(16 * sizeof(float))},
+auto BeMaterial::DivergeParameters() -> void {
+    const auto shared = _parameters;
+    _parameters = std::make_shared<ParameterBlock>(ParameterBlock {
+        .Data = shared->Data,
+        .Buffer = nullptr,
+        .UniqueID = NextMaterialBlockID(),
+    });
+    
+    // instances that followed this one through the shared block keep following it
+    ReplaceSharedParameters(shared, _parameters);
+}
+
+auto BeMaterial::DivergeResources() -> void {
+    const auto shared = _resources;
+    _resources = std::make_shared<ResourceBlock>(*shared);
+    ReplaceSharedResources(shared, _resources);
+}
+
+auto BeMaterial::ReplaceSharedParameters(
+    const std::shared_ptr<ParameterBlock>& from,
+    const std::shared_ptr<ParameterBlock>& to
+) -> void {
+    for (const auto& weak : _instances) {
+        const auto instance = weak.lock();
+        if (!instance || instance->_parameters != from)
+            continue;
+        instance->_parameters = to;
+        instance->ReplaceSharedParameters(from, to);
+    }
+}
+
+auto BeMaterial::ReplaceSharedResources(
+    const std::shared_ptr<ResourceBlock>& from,
+    const std::shared_ptr<ResourceBlock>& to
+) -> void {
+    for (const auto& weak : _instances) {
+        const auto instance = weak.lock();
+        if (!instance || instance->_resources != from)
+            continue;
+        instance->_resources = to;
+        instance->ReplaceSharedResources(from, to);
+    }
+}
+
+auto BeMaterial::PushParametersToInstances(const uint32_t begin, const uint32_t end) -> void {
+    for (const auto& weak : _instances) {
+        if (const auto instance = weak.lock())
+            instance->InheritParameters(begin, end);
+    }
+}
+
+auto BeMaterial::PushResourceToInstances(const std::string& name) -> void {
+    for (const auto& weak : _instances) {
+        if (const auto instance = weak.lock())
+            instance->InheritResource(name);
+    }
+}
+
+auto BeMaterial::InheritParameters(const uint32_t begin, const uint32_t end) -> void {
+    // instances still sharing the block already see the write
+    if (!SharesParametersWithParent()) {
+        const auto& source = _parent->_parameters->Data;
+        auto& target = _parameters->Data;
+        const auto copy = [&](const uint32_t from, const uint32_t to) {
+            memcpy(target.data() + from, source.data() + from, (to - from) * sizeof(float));
         };
         
-        const uint32_t elementSizeBytes = SizeMap.at(property.PropertyType);
-        const uint32_t positionInRegister = offsetBytes % registerSizeBytes;
-        
-        if (positionInRegister + elementSizeBytes > registerSizeBytes && positionInRegister != 0) {
-            offsetBytes = ((offsetBytes / registerSizeBytes) + 1) * registerSizeBytes;
+        uint32_t cursor = begin;
+        for (const auto& [overrideBegin, overrideEnd] : _overriddenRanges) {
+            if (overrideEnd <= cursor) continue;
+            if (overrideBegin >= end) break;
+            if (overrideBegin > cursor) copy(cursor, overrideBegin);
+            cursor = overrideEnd;
         }
-
-        _propertyOffsets[property.Name] = offsetBytes / sizeof(float);
-        offsetBytes += elementSizeBytes;
+        if (cursor < end) copy(cursor, end);
+        
+        _parameters->MarkDirty(begin, end);
     }
+    
+    PushParametersToInstances(begin, end);
+}
 
-    _bufferData.resize(offsetBytes / 4);
-    for (const auto& property : _scheme.Properties) {
-        const uint32_t propertyOffset = _propertyOffsets.at(property.Name);
-        const auto& defaultValue = property.DefaultValue;
-        memcpy(_bufferData.data() + propertyOffset, defaultValue.data(), defaultValue.size() * sizeof(float));
+auto BeMaterial::InheritResource(const std::string& name) -> void {
+    if (_resources != _parent->_resources && std::ranges::find(_overriddenResources, name) == _overriddenResources.end()) {
+        const auto& source = *_parent->_resources;
+        if (source.Textures.contains(name)) _resources->Textures[name] = source.Textures.at(name);
+        if (source.Samplers.contains(name)) _resources->Samplers[name] = source.Samplers.at(name);
+        _resources->BindingsDirty = true;
     }
+    
+    PushResourceToInstances(name);
 }
 
-auto BeMaterial::Print() const -> std::string {
-    std::stringstream ss;
-    constexpr uint32_t FLOATS_PER_LINE = 4;
+auto BeMaterial::OverrideResource(const std::string& name) -> void {
+    if (!_parent)
+        return;
+    
+    if (_resources == _parent->_resources)
+        DivergeResources();
+    if (std::ranges::find(_overriddenResources, name) == _overriddenResources.end())
+        _overriddenResources.push_back(name);
+}
 
-    for (size_t i = 0; i < _bufferData.size(); ++i) {
-        ss << std::fixed << std::setprecision(3) << _bufferData[i] << "f ";
-        if ((i + 1) % FLOATS_PER_LINE == 0) {
-            ss << "\n";
-        }
+auto BeMaterial::RebuildBindings() -> void {
+    auto& [textureSlots, textureViews, textureIDs, samplerSlots, samplers] = _resources->Bindings;
+    
+    auto textures = std::vector<std::pair<uint8_t, const BeTexture*>>();
+    textures.reserve(_resources->Textures.size());
+    for (const auto& [texture, slot] : _resources->Textures | std::views::values)
+        textures.emplace_back(slot, texture.get());
+    std::ranges::sort(textures, {}, &std::pair<uint8_t, const BeTexture*>::first);
+
+    textureSlots.clear();
+    textureViews.clear();
+    textureIDs.clear();
+    for (const auto& [slot, texture] : textures) {
+        textureSlots.push_back(slot);
+        textureViews.push_back(texture ? texture->GetSRV().Get() : nullptr);
+        textureIDs.push_back(texture ? texture->UniqueID : 0);
     }
 
-    return ss.str();
+    auto samplerPairs = std::vector<std::pair<uint8_t, ID3D11SamplerState*>>();
+    samplerPairs.reserve(_resources->Samplers.size());
+    for (const auto& [sampler, slot] : _resources->Samplers | std::views::values)
+        samplerPairs.emplace_back(slot, sampler.Get());
+    std::ranges::sort(samplerPairs, {}, &std::pair<uint8_t, ID3D11SamplerState*>::first);
+
+    samplerSlots.clear();
+    samplers.clear();
+    for (const auto& [slot, sampler] : samplerPairs) {
+        samplerSlots.push_back(slot);
+        samplers.push_back(sampler);
+    }
+
+    _resources->BindingsDirty = false;
+}
+
+auto BeMaterial::GetBindings() -> const ResourceBindings& {
+    if (_resources->BindingsDirty)
+        RebuildBindings();
+    return _resources->Bindings;
+}
+
+auto BeMaterial::GetSlotIn(const BeShader& shader) -> uint8_t {
+    if (_slotShaderID != shader.UniqueID) {
+        _slot = shader.GetMaterialSlotByScheme(*_scheme);
+        _slotShaderID = shader.UniqueID;
+    }
+    return _slot;
 }
@@ -1,11 +1,14 @@
 #pragma once
+#include <algorithm>
 #include <d3d11.h>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <umbrellas/include-glm.h>
 #include <umbrellas/access-modifiers.hpp>
+#include <umbrellas/include-libassert.h>
 #include <wrl/client.h>
 
 #include "BeMaterialScheme.h"
@@ -15,12 +18,12 @@ class BeRenderer;
 class BeTexture;
 using Microsoft::WRL::ComPtr;
 
-class BeMaterial {
+class BeMaterial : public std::enable_shared_from_this<BeMaterial> {
     // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
     expose
     static auto Create(
         std::string_view name,
-        const BeMaterialScheme& scheme,
+        const std::shared_ptr<const BeMaterialScheme>& scheme,
         bool frequentlyUsed,
         const BeRenderer& renderer
     ) -> std::shared_ptr<BeMaterial>;
@@ -29,43 +32,118 @@ class BeMaterial {
     expose
     std::string Name;
     
+    using TextureMap = std::unordered_map<std::string, std::pair<std::shared_ptr<BeTexture>, uint8_t>>;
+    using SamplerMap = std::unordered_map<std::string, std::pair<ComPtr<ID3D11SamplerState>, uint8_t>>;
+
+    // the maps flattened and sorted by slot, parallel arrays so runs of slots bind with one call
+    // raw pointers stay alive through the maps of the same block
+    struct ResourceBindings {
+        std::vector<uint8_t> TextureSlots;
+        std::vector<ID3D11ShaderResourceView*> TextureViews;
+        std::vector<uint32_t> TextureIDs;
+        std::vector<uint8_t> SamplerSlots;
+        std::vector<ID3D11SamplerState*> Samplers;
+    };
+    
     hide
+    // an instance shares its parent's blocks until the first write that changes a value
+    struct ParameterBlock {
+        std::vector<float> Data;
+        ComPtr<ID3D11Buffer> Buffer = nullptr;
+        uint32_t UniqueID = 0;
+        
+        // [DirtyBegin, DirtyEnd) in floats, what the next upload has to cover
+        uint32_t DirtyBegin = 0;
+        uint32_t DirtyEnd = 0;
+
+        auto IsDirty() const -> bool { return DirtyBegin < DirtyEnd; }
+        auto ClearDirty() -> void { DirtyBegin = DirtyEnd = 0; }
+        auto MarkDirty(const uint32_t begin, const uint32_t end) -> void {
+            DirtyBegin = IsDirty() ? std::min(DirtyBegin, begin) : begin;
+            DirtyEnd = std::max(DirtyEnd, end);
+        }
+    };
+
+    struct ResourceBlock {
+        TextureMap Textures;
+        SamplerMap Samplers;
+        ResourceBindings Bindings;
+        bool BindingsDirty = true;
+    };
+    
     bool _isFrequentlyUsed;
-    BeMaterialScheme _scheme;
-    uint32_t _uniqueID;
+    ComPtr<ID3D11DeviceContext1> _context1; // the renderer's, null without partial updates
+    std::shared_ptr<const BeMaterialScheme> _scheme;
 
-    std::unordered_map<std::string, std::pair<std::shared_ptr<BeTexture>, uint8_t>> _textures;
-    std::unordered_map<std::string, std::pair<ComPtr<ID3D11SamplerState>, uint8_t>> _samplers;
+    std::shared_ptr<ParameterBlock> _parameters;
+    std::shared_ptr<ResourceBlock> _resources;
 
-    std::unordered_map<std::string, uint32_t> _propertyOffsets;
-    std::vector<float> _bufferData;
-    ComPtr<ID3D11Buffer> _cbuffer = nullptr;
-    bool _cbufferDirty;
+    std::shared_ptr<BeMaterial> _parent;
+    std::vector<std::weak_ptr<BeMaterial>> _instances;
+    std::vector<std::pair<uint32_t, uint32_t>> _overriddenRanges; // [begin, end) in floats, sorted and disjoint
+    std::vector<std::string> _overriddenResources;
+
+    // slot of the scheme in the last shader this was bound with
+    uint32_t _slotShaderID = 0;
+    uint8_t _slot = 0;
 
     // lifetime ////////////////////////////////////////////////////////////////////////////////////////////////////////
     expose
     //BeMaterial();
     ~BeMaterial();
 
-    BeMaterial(const BeMaterial& other) = default;
+    BeMaterial(const BeMaterial& other) = delete;
     BeMaterial(BeMaterial&& other) noexcept = default;
-    BeMaterial& operator=(const BeMaterial& other) = default;
+    BeMaterial& operator=(const BeMaterial& other) = delete;
     BeMaterial& operator=(BeMaterial&& other) noexcept = default;
 
     explicit BeMaterial(
         std::string name,
         const bool frequentlyUsed,
-        BeMaterialScheme descriptor,
+        std::shared_ptr<const BeMaterialScheme> scheme,
         const BeRenderer& renderer
     );
 
+    explicit BeMaterial(
+        std::string name,
+        std::shared_ptr<BeMaterial> parent
+    );
+
     hide
     auto InitialiseSlotMaps() -> void;
 
     // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
     expose
-    auto GetSchemeName () const -> std::string { return _scheme.Name; }
-    auto GetUniqueID () const -> uint32_t { return _uniqueID; }
+    auto GetScheme () const -> const std::shared_ptr<const BeMaterialScheme>& { return _scheme; }
+    auto GetSchemeName () const -> const std::string& { return _scheme->Name; }
+    auto GetUniqueID () const -> uint32_t { return _parameters->UniqueID; }
+
+    // instances inherit everything from the parent except the values written on them
+    auto CreateInstance (std::string_view name) -> std::shared_ptr<BeMaterial>;
+    auto GetParent () const -> const std::shared_ptr<BeMaterial>& { return _parent; }
+    auto SharesParametersWithParent () const -> bool { return _parent && _parent->_parameters == _parameters; }
+    auto HasSameContent (const BeMaterial& other) const -> bool;
+
+    auto GetPropertyId (BeMaterialPropertyKey key) const -> BeMaterialPropertyId;
+    auto GetPropertyId (std::string_view propertyName) const -> BeMaterialPropertyId;
+    
+    // an id that's invalid or of another type asserts. in release the set does nothing and the get returns zeros
+    auto SetFloat  (BeMaterialPropertyId id, float value) -> void;
+    auto SetFloat2 (BeMaterialPropertyId id, glm::vec2 value) -> void;
+    auto SetFloat3 (BeMaterialPropertyId id, glm::vec3 value) -> void;
+    auto SetFloat4 (BeMaterialPropertyId id, glm::vec4 value) -> void;
+    auto SetMatrix (BeMaterialPropertyId id, const glm::mat4x4& value) -> void;
+
+    auto GetFloat  (BeMaterialPropertyId id) const -> float;
+    auto GetFloat2 (BeMaterialPropertyId id) const -> glm::vec2;
+    auto GetFloat3 (BeMaterialPropertyId id) const -> glm::vec3;
+    auto GetFloat4 (BeMaterialPropertyId id) const -> glm::vec4;
+    auto GetMatrix (BeMaterialPropertyId id) const -> glm::mat4x4;
+
+    // typed view over the buffer. T is a struct generated by `premake5 materials` (see BeMaterialData)
+    // writes through it override the whole block and aren't pushed to instances
+    template <typename T> auto Data() -> T&;
+    template <typename T> auto Data() const -> const T&;
     
     auto SetFloat  (const std::string& propertyName, float value) -> void;
     auto SetFloat2 (const std::string& propertyName, glm::vec2 value) -> void;
@@ -86,12 +164,50 @@ class BeMaterial {
     auto GetSampler(const std::string& propertyName) const -> ComPtr<ID3D11SamplerState>;
     
     auto UpdateGPUBuffers (const ComPtr<ID3D11DeviceContext>& context) -> bool;
-    auto GetBuffer () const -> const ComPtr<ID3D11Buffer>& { return _cbuffer; }
-    auto GetTexturePairs () const -> const std::unordered_map<std::string, std::pair<std::shared_ptr<BeTexture>, uint8_t>>& { return _textures; }
-    auto GetSamplerPairs () const -> const std::unordered_map<std::string, std::pair<ComPtr<ID3D11SamplerState>, uint8_t>>& { return _samplers; }
+    auto GetBuffer () const -> const ComPtr<ID3D11Buffer>& { return _parameters->Buffer; }
+    auto GetTexturePairs () const -> const TextureMap& { return _resources->Textures; }
+    auto GetSamplerPairs () const -> const SamplerMap& { return _resources->Samplers; }
+    auto GetBindings () -> const ResourceBindings&;
+    auto GetSlotIn (const BeShader& shader) -> uint8_t;
     
     auto Print() const -> std::string;
 
     // internal ////////////////////////////////////////////////////////////////////////////////////////////////////////
-    hide auto AssembleData() -> void;
+    hide
+    auto RequirePropertyId(const std::string& propertyName) const -> BeMaterialPropertyId;
+    auto WriteProperty(BeMaterialPropertyId id, BeMaterialPropertyDescriptor::Type type, const float* data, size_t count) -> void;
+    auto ReadProperty(BeMaterialPropertyId id, BeMaterialPropertyDescriptor::Type type, float* data, size_t count) const -> void;
+
+    auto CreateBuffer(ID3D11Device* device) -> void;
+    auto BeginWrite(uint32_t begin, uint32_t end) -> float*;
+    auto BeginWriteAll() -> float*;
+    auto DivergeParameters() -> void;
+    auto DivergeResources() -> void;
+    auto ReplaceSharedParameters(const std::shared_ptr<ParameterBlock>& from, const std::shared_ptr<ParameterBlock>& to) -> void;
+    auto ReplaceSharedResources(const std::shared_ptr<ResourceBlock>& from, const std::shared_ptr<ResourceBlock>& to) -> void;
+    auto PushParametersToInstances(uint32_t begin, uint32_t end) -> void;
+    auto PushResourceToInstances(const std::string& name) -> void;
+    auto InheritParameters(uint32_t begin, uint32_t end) -> void;
+    auto InheritResource(const std::string& name) -> void;
+    auto OverrideResource(const std::string& name) -> void;
+    auto RebuildBindings() -> void;
 };
+
+
+template <typename T>
+auto BeMaterial::Data() -> T& {
+    BeginWriteAll();
+    return const_cast<T&>(std::as_const(*this).Data<T>());
+}
+
+template <typename T>
+auto BeMaterial::Data() const -> const T& {
+    be_assert(T::SchemeName == _scheme->Name, "Material data struct doesn't match the scheme", _scheme->Name);
+    be_assert(sizeof(T) == _parameters->Data.size() * sizeof(float), "Generated material struct is out of date", _scheme->Name);
+    for (const auto& [name, offset] : T::Fields()) {
+        const auto id = _scheme->GetPropertyId(BeMaterialPropertyKey::Of(name));
+        be_assert(id.IsValid() && id.Offset * sizeof(float) == offset, "Generated material struct is out of date", _scheme->Name, name);
+    }
+    be_assert(reinterpret_cast<uintptr_t>(_parameters->Data.data()) % alignof(T) == 0);
+    return *reinterpret_cast<const T*>(_parameters->Data.data());
+}
@@ -1,10 +1,12 @@
 #include "BeMaterialScheme.h"
 
+#include <cstring>
+
 
 auto BeMaterialScheme::CreateFromJson(
     const std::string& name, 
     const Json& json
-) -> BeMaterialScheme {
+) -> std::shared_ptr<const BeMaterialScheme> {
     
     auto materialScheme = BeMaterialScheme();
     materialScheme.Name = name;
@@ -24,7 +26,7 @@ auto BeMaterialScheme::CreateFromJson(
             auto descriptor = BeMaterialSamplerDescriptor();
             descriptor.Name = parsedProperty.Name;
             descriptor.SlotIndex = parsedProperty.Slot;
-            descriptor.DefaultSamplerDescString = parsedProperty.Default;
+            descriptor.DefaultSampler = BeSamplerDesc::Parse(parsedProperty.Default);
             materialScheme.Samplers.push_back(descriptor);
         }
         else if (parsedProperty.Type == "float") {
@@ -83,5 +85,57 @@ auto BeMaterialScheme::CreateFromJson(
         }
     }
     
-    return materialScheme;
+    materialScheme.AssembleLayout();
+    return std::make_shared<const BeMaterialScheme>(std::move(materialScheme));
+}
+
+auto BeMaterialScheme::GetPropertyId(const BeMaterialPropertyKey key) const -> BeMaterialPropertyId {
+    for (size_t i = 0; i < PropertyKeys.size(); ++i) {
+        if (PropertyKeys[i] == key)
+            return PropertyIds[i];
+    }
+    return {};
+}
+
+auto BeMaterialScheme::AssembleLayout() -> void {
+    constexpr uint32_t registerSizeBytes = 16;
+    
+    static constexpr auto SizeOf = [](const BeMaterialPropertyDescriptor::Type type) -> uint32_t {
+        switch (type) {
+            case BeMaterialPropertyDescriptor::Type::Float:  return 1 * sizeof(float);
+            case BeMaterialPropertyDescriptor::Type::Float2: return 2 * sizeof(float);
+            case BeMaterialPropertyDescriptor::Type::Float3: return 3 * sizeof(float);
+            case BeMaterialPropertyDescriptor::Type::Float4: return 4 * sizeof(float);
+            case BeMaterialPropertyDescriptor::Type::Matrix: return 16 * sizeof(float);
+        }
+        return 0;
+    };
+    
+    PropertyKeys.clear();
+    PropertyIds.clear();
+    uint32_t offsetBytes = 0;
+
+    for (const auto& property : Properties) {
+        const uint32_t elementSizeBytes = SizeOf(property.PropertyType);
+        const uint32_t positionInRegister = offsetBytes % registerSizeBytes;
+        
+        if (positionInRegister + elementSizeBytes > registerSizeBytes && positionInRegister != 0) {
+            offsetBytes = ((offsetBytes / registerSizeBytes) + 1) * registerSizeBytes;
+        }
+
+        PropertyKeys.push_back(BeMaterialPropertyKey::Of(property.Name));
+        PropertyIds.push_back({
+            .Offset = offsetBytes / static_cast<uint32_t>(sizeof(float)),
+            .PropertyType = property.PropertyType
+        });
+        offsetBytes += elementSizeBytes;
+    }
+
+    // the cbuffer is created with a 16 byte aligned size, so the blob covers the padding as well
+    BufferSizeBytes = ((offsetBytes + registerSizeBytes - 1) / registerSizeBytes) * registerSizeBytes;
+    DefaultBuffer.assign(BufferSizeBytes / sizeof(float), 0.0f);
+    for (size_t i = 0; i < Properties.size(); ++i) {
+        const auto& defaultValue = Properties[i].DefaultValue;
+        memcpy(DefaultBuffer.data() + PropertyIds[i].Offset, defaultValue.data(), defaultValue.size() * sizeof(float));
+    }
 }
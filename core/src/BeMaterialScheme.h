@@ -1,9 +1,13 @@
 #pragma once
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <string_view>
 #include <vector>
 #include <nlohmann/json.hpp>
 #include <umbrellas/access-modifiers.hpp>
 
+#include "BeSamplerDesc.h"
 #include "BeShaderTools.h"
 
 
@@ -21,6 +25,37 @@ struct BeMaterialPropertyDescriptor {
     std::vector<float> DefaultValue;
 };
 
+// compile-time hashed property name. used to resolve a BeMaterialPropertyId once, outside the hot path
+struct BeMaterialPropertyKey {
+    uint64_t Hash = 0;
+
+    static constexpr auto Of(const std::string_view name) -> BeMaterialPropertyKey {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        for (const char c : name) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+        return { hash };
+    }
+
+    constexpr auto operator==(const BeMaterialPropertyKey& other) const -> bool = default;
+};
+
+consteval auto operator""_prop(const char* name, const size_t length) -> BeMaterialPropertyKey {
+    return BeMaterialPropertyKey::Of(std::string_view(name, length));
+}
+
+// resolved location of a property inside the material buffer. valid for every material of the same scheme
+struct BeMaterialPropertyId {
+    static constexpr uint32_t InvalidOffset = UINT32_MAX;
+    
+    uint32_t Offset = InvalidOffset; // in floats
+    BeMaterialPropertyDescriptor::Type PropertyType = BeMaterialPropertyDescriptor::Type::Float;
+
+    constexpr auto IsValid() const -> bool { return Offset != InvalidOffset; }
+};
+
 struct BeMaterialTextureDescriptor {
     std::string Name;
     uint8_t SlotIndex;
@@ -30,18 +65,30 @@ struct BeMaterialTextureDescriptor {
 struct BeMaterialSamplerDescriptor {
     std::string Name;
     uint8_t SlotIndex;
-    std::string DefaultSamplerDescString;
+    BeSamplerDesc DefaultSampler;
 };
 
 class BeMaterialScheme {
     expose static auto CreateFromJson (
         const std::string& name, 
         const Json& json
-    ) -> BeMaterialScheme;
+    ) -> std::shared_ptr<const BeMaterialScheme>;
     
     expose 
     std::string Name;
     std::vector<BeMaterialPropertyDescriptor> Properties;
     std::vector<BeMaterialTextureDescriptor> Textures;
     std::vector<BeMaterialSamplerDescriptor> Samplers;
+
+    // packed cbuffer layout, computed once per scheme. PropertyKeys and PropertyIds are parallel to Properties
+    std::vector<BeMaterialPropertyKey> PropertyKeys;
+    std::vector<BeMaterialPropertyId> PropertyIds;
+    uint32_t BufferSizeBytes = 0;
+    std::vector<float> DefaultBuffer;
+
+    expose
+    auto GetPropertyId (BeMaterialPropertyKey key) const -> BeMaterialPropertyId;
+
+    hide
+    auto AssembleLayout() -> void;
 };
@@ -3,6 +3,7 @@
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
+#include <algorithm>
 #include <unordered_set>
 
 #include "stb_image/stb_image.h"
@@ -12,6 +13,7 @@
 #include "BeMaterial.h"
 #include "BeRenderer.h"
 #include "BeTexture.h"
+#include "BeTriangleBVH.h"
 #include "Utils.h"
 
 auto BeModel::Create(
@@ -39,6 +41,7 @@ auto BeModel::Create(
     model->Shader = usedShaderForMaterials.lock();
     model->DrawSlices.reserve(scene->mNumMeshes);
     const auto& materialScheme = BeAssetRegistry::GetMaterialScheme(model->Shader->GetMaterialSchemeName("geometry-main"));
+    model->BaseMaterial = BeMaterial::Create(modelPath.stem().string(), materialScheme, true, renderer);
 
     std::unordered_map<uint32_t, std::shared_ptr<BeMaterial>> assimpIndexToMaterial;
     std::unordered_set<uint32_t> assimpIndexToTwoSided;
@@ -50,8 +53,7 @@ auto BeModel::Create(
         if (it != assimpIndexToMaterial.end())
             continue;
 
-        auto material = BeMaterial::Create("mat" + std::to_string(assimpMaterialIndex), materialScheme, true, renderer);
-        assimpIndexToMaterial[assimpMaterialIndex] = material;
+        auto material = model->BaseMaterial->CreateInstance("mat" + std::to_string(assimpMaterialIndex));
 
         const auto meshMaterial = scene->mMaterials[assimpMaterialIndex];
 
@@ -83,11 +85,19 @@ auto BeModel::Create(
         if (meshMaterial->Get(AI_MATKEY_SHININESS, shininess) == AI_SUCCESS) {
             material->SetFloat("Shininess", shininess);
         }
-    }
 
-    for (const auto & material : assimpIndexToMaterial | std::views::values) {
+        // collapse byte-identical materials, the dropped instance releases its buffer with it
+        const auto duplicate = std::ranges::find_if(model->Materials, [&material](const auto& existing) {
+            return existing->HasSameContent(*material);
+        });
+        if (duplicate != model->Materials.end()) {
+            assimpIndexToMaterial[assimpMaterialIndex] = *duplicate;
+            continue;
+        }
+        
+        assimpIndexToMaterial[assimpMaterialIndex] = material;
         model->Materials.push_back(material);
-    } 
+    }
     
     size_t numVertices = 0;
     size_t numIndices = 0;
@@ -142,9 +152,38 @@ auto BeModel::Create(
         indexOffset += mesh->mNumFaces * 3;
     }
 
+    model->CalculateBounds();
+    model->BuildTriangleBVH();
     return model;
 }
 
+auto BeModel::CalculateBounds() -> void {
+    BoundsMin = glm::vec3(std::numeric_limits<float>::max());
+    BoundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+    for (const auto& vertex : FullVertices) {
+        BoundsMin = glm::min(BoundsMin, vertex.Position);
+        BoundsMax = glm::max(BoundsMax, vertex.Position);
+    }
+}
+
+auto BeModel::IsInstanced() const -> bool {
+    return Shader && Shader->IsInstanced;
+}
+
+auto BeModel::BuildTriangleBVH() -> void {
+    auto corners = std::vector<glm::vec3>();
+    corners.reserve(Indices.size());
+    for (const auto& slice : DrawSlices) {
+        for (uint32_t i = 0; i + 2 < slice.IndexCount; i += 3) {
+            for (uint32_t k = 0; k < 3; k++) {
+                const auto index = Indices[slice.StartIndexLocation + i + k];
+                corners.push_back(FullVertices[slice.BaseVertexLocation + index].Position);
+            }
+        }
+    }
+    TriangleBVH = BeTriangleBVH::Create(corners);
+}
+
 auto BeModel::LoadTextureFromAssimpPath(
     const aiString& texPath,
     const aiScene* scene,
@@ -1,6 +1,9 @@
 #pragma once
 #include <filesystem>
+#include <limits>
 #include <memory>
+#include <utility>
+#include <vector>
 #include <wrl/client.h>
 #include <umbrellas/include-glm.h>
 
@@ -10,6 +13,7 @@ class BeTexture;
 class BeShader;
 class BeMaterial;
 class BeRenderer;
+class BeTriangleBVH;
 using Microsoft::WRL::ComPtr;
 
 struct BeFullVertex {
@@ -47,9 +51,23 @@ struct BeModel {
     std::vector<BeDrawSlice> DrawSlices;
     std::vector<BeFullVertex> FullVertices;
     std::vector<uint32_t> Indices;
-    std::vector<std::shared_ptr<BeMaterial>> Materials;
+    std::vector<std::shared_ptr<BeMaterial>> Materials; // unique instances of BaseMaterial
+    std::shared_ptr<BeMaterial> BaseMaterial;
     std::shared_ptr<BeShader> Shader;
 
+    // local space box around FullVertices. models built by hand leave it inverted and are never culled
+    glm::vec3 BoundsMin { std::numeric_limits<float>::max() };
+    glm::vec3 BoundsMax { std::numeric_limits<float>::lowest() };
+    // for ray casts on the cpu, built at import. models built by hand call BuildTriangleBVH themselves
+    std::shared_ptr<const BeTriangleBVH> TriangleBVH;
+
     BeModel() = default;
     ~BeModel() = default;
+
+    auto CalculateBounds() -> void;
+    auto HasBounds() const -> bool { return BoundsMin.x <= BoundsMax.x; }
+    auto GetBounds() const -> std::pair<glm::vec3, glm::vec3> { return { BoundsMin, BoundsMax }; }
+    auto BuildTriangleBVH() -> void;
+    // its shader reads the model matrix from the instance stream, see BeBRPInstanceBatcher
+    auto IsInstanced() const -> bool;
 };
@@ -0,0 +1,309 @@
+#include "BeOcclusionBuffer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <umbrellas/include-simd.h>
+
+#include "BeFrustumCuller.h"
+
+BeOcclusionBuffer::BeOcclusionBuffer()
+    : _tiles(TilesX * TilesY)
+{}
+
+auto BeOcclusionBuffer::Begin(const glm::mat4& projectionView) -> void {
+    _projectionView = projectionView;
+    std::ranges::fill(_tiles, Tile());
+}
+
+auto BeOcclusionBuffer::RasterizeOccluder(const std::span<const glm::vec3> triangles, const glm::mat4& model) -> void {
+    const auto modelProjectionView = _projectionView * model;
+    const auto toScreen = [](const glm::vec4& clip) {
+        const auto ndc = glm::vec3(clip) / clip.w;
+        return glm::vec3((ndc.x * 0.5f + 0.5f) * Width, (0.5f - ndc.y * 0.5f) * Height, ndc.z);
+    };
+
+    for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+        const auto a = modelProjectionView * glm::vec4(triangles[i + 0], 1.f);
+        const auto b = modelProjectionView * glm::vec4(triangles[i + 1], 1.f);
+        const auto c = modelProjectionView * glm::vec4(triangles[i + 2], 1.f);
+
+        // no clipping, a triangle reaching in front of the near plane just doesn't occlude
+        if (a.z < 0.f || b.z < 0.f || c.z < 0.f)
+            continue;
+
+        RasterizeTriangle(toScreen(a), toScreen(b), toScreen(c));
+    }
+}
+
+// screen rectangle and nearest depth of a box's eight corners, empty if a corner is in front of the near plane
+struct ProjectedBox {
+    glm::vec2 Min;
+    glm::vec2 Max;
+    float Nearest;
+};
+
+static auto ProjectBoxScalar(
+    const glm::mat4& projectionView,
+    const glm::vec3& center,
+    const glm::vec3& extents,
+    const glm::vec2 screenSize
+) -> std::optional<ProjectedBox> {
+    // corners in clip space from the center and the three scaled axes
+    const auto clipCenter = projectionView * glm::vec4(center, 1.f);
+    const auto axisX = projectionView[0] * extents.x;
+    const auto axisY = projectionView[1] * extents.y;
+    const auto axisZ = projectionView[2] * extents.z;
+
+    auto box = ProjectedBox {
+        .Min = glm::vec2(std::numeric_limits<float>::max()),
+        .Max = glm::vec2(std::numeric_limits<float>::lowest()),
+        .Nearest = std::numeric_limits<float>::max(),
+    };
+    for (uint32_t corner = 0; corner < 8; corner++) {
+        const auto clip = clipCenter
+            + (corner & 1 ? axisX : -axisX)
+            + (corner & 2 ? axisY : -axisY)
+            + (corner & 4 ? axisZ : -axisZ);
+        if (clip.z < 0.f)
+            return std::nullopt;
+
+        const auto ndc = glm::vec3(clip) / clip.w;
+        const auto screen = glm::vec2(ndc.x * 0.5f + 0.5f, 0.5f - ndc.y * 0.5f) * screenSize;
+        box.Min = glm::min(box.Min, screen);
+        box.Max = glm::max(box.Max, screen);
+        box.Nearest = std::min(box.Nearest, ndc.z);
+    }
+    return box;
+}
+
+BE_TARGET_AVX2 static auto HorizontalMinAVX2(__m256 lanes) -> float {
+    lanes = _mm256_min_ps(lanes, _mm256_permute2f128_ps(lanes, lanes, 1));
+    lanes = _mm256_min_ps(lanes, _mm256_shuffle_ps(lanes, lanes, _MM_SHUFFLE(1, 0, 3, 2)));
+    lanes = _mm256_min_ps(lanes, _mm256_shuffle_ps(lanes, lanes, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm256_cvtss_f32(lanes);
+}
+
+BE_TARGET_AVX2 static auto HorizontalMaxAVX2(__m256 lanes) -> float {
+    lanes = _mm256_max_ps(lanes, _mm256_permute2f128_ps(lanes, lanes, 1));
+    lanes = _mm256_max_ps(lanes, _mm256_shuffle_ps(lanes, lanes, _MM_SHUFFLE(1, 0, 3, 2)));
+    lanes = _mm256_max_ps(lanes, _mm256_shuffle_ps(lanes, lanes, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm256_cvtss_f32(lanes);
+}
+
+// the same with one corner per lane
+BE_TARGET_AVX2 static auto ProjectBoxAVX2(
+    const glm::mat4& projectionView,
+    const glm::vec3& center,
+    const glm::vec3& extents,
+    const glm::vec2 screenSize
+) -> std::optional<ProjectedBox> {
+    const auto signX = _mm256_setr_ps(-1, 1, -1, 1, -1, 1, -1, 1);
+    const auto signY = _mm256_setr_ps(-1, -1, 1, 1, -1, -1, 1, 1);
+    const auto signZ = _mm256_setr_ps(-1, -1, -1, -1, 1, 1, 1, 1);
+    const auto clipCenter = projectionView * glm::vec4(center, 1.f);
+    const auto axisX = projectionView[0] * extents.x;
+    const auto axisY = projectionView[1] * extents.y;
+    const auto axisZ = projectionView[2] * extents.z;
+    const auto component = [&](const int i) BE_TARGET_AVX2 {
+        return _mm256_fmadd_ps(signX, _mm256_set1_ps(axisX[i]),
+            _mm256_fmadd_ps(signY, _mm256_set1_ps(axisY[i]),
+                _mm256_fmadd_ps(signZ, _mm256_set1_ps(axisZ[i]), _mm256_set1_ps(clipCenter[i]))));
+    };
+    const auto clipX = component(0), clipY = component(1), clipZ = component(2), clipW = component(3);
+    if (_mm256_movemask_ps(_mm256_cmp_ps(clipZ, _mm256_setzero_ps(), _CMP_LT_OQ)))
+        return std::nullopt;
+
+    const auto inverseW = _mm256_div_ps(_mm256_set1_ps(1.f), clipW);
+    const auto half = _mm256_set1_ps(0.5f);
+    const auto screenX = _mm256_mul_ps(_mm256_fmadd_ps(_mm256_mul_ps(clipX, inverseW), half, half), _mm256_set1_ps(screenSize.x));
+    const auto screenY = _mm256_mul_ps(_mm256_fnmadd_ps(_mm256_mul_ps(clipY, inverseW), half, half), _mm256_set1_ps(screenSize.y));
+    const auto depth = _mm256_mul_ps(clipZ, inverseW);
+
+    return ProjectedBox {
+        .Min = glm::vec2(HorizontalMinAVX2(screenX), HorizontalMinAVX2(screenY)),
+        .Max = glm::vec2(HorizontalMaxAVX2(screenX), HorizontalMaxAVX2(screenY)),
+        .Nearest = HorizontalMinAVX2(depth),
+    };
+}
+
+auto BeOcclusionBuffer::IsVisible(const glm::vec3& center, const glm::vec3& extents) const -> bool {
+    // crossing the near plane, it's right at the camera
+    const auto screenSize = glm::vec2(Width, Height);
+    const auto projected = BeFrustumCuller::HasAVX2()
+        ? ProjectBoxAVX2(_projectionView, center, extents, screenSize)
+        : ProjectBoxScalar(_projectionView, center, extents, screenSize);
+    if (!projected)
+        return true;
+    const auto [minScreen, maxScreen, nearest] = *projected;
+
+    // every pixel the box touches, even partly. being off screen isn't for this culler to decide
+    const auto x0 = std::max(0, static_cast<int>(std::floor(minScreen.x)));
+    const auto y0 = std::max(0, static_cast<int>(std::floor(minScreen.y)));
+    const auto x1 = std::min(static_cast<int>(Width) - 1, static_cast<int>(std::ceil(maxScreen.x)) - 1);
+    const auto y1 = std::min(static_cast<int>(Height) - 1, static_cast<int>(std::ceil(maxScreen.y)) - 1);
+    if (x0 > x1 || y0 > y1)
+        return true;
+
+    constexpr auto Size = static_cast<int>(TileSize);
+    for (int tileY = y0 / Size; tileY <= y1 / Size; tileY++) {
+        for (int tileX = x0 / Size; tileX <= x1 / Size; tileX++) {
+            const auto& tile = _tiles[tileY * TilesX + tileX];
+            if (tile.Reference < nearest)
+                continue;
+            if (tile.Mask == 0 || tile.Working >= nearest)
+                return true;
+
+            // the working layer decides if it has all of the box's pixels in the tile
+            const auto columnBegin = std::max(x0 - tileX * Size, 0), columnEnd = std::min(x1 - tileX * Size, Size - 1);
+            const auto rowBegin = std::max(y0 - tileY * Size, 0), rowEnd = std::min(y1 - tileY * Size, Size - 1);
+            const auto columns = uint64_t((1u << (columnEnd + 1)) - (1u << columnBegin));
+            auto touched = uint64_t(0);
+            for (int row = rowBegin; row <= rowEnd; row++)
+                touched |= columns << (row * Size);
+            if (touched & ~tile.Mask)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+// edge functions and depth as planes over the screen. edges are moved inwards by half a pixel and a little more for
+// rounding, so a pixel center on the inner side of all three means the whole pixel is. depth is linear in screen
+// space after the divide
+struct TriangleSetup {
+    std::array<glm::vec3, 3> Edges; // x * e.x + y * e.y + e.z
+    glm::vec3 Depth;
+    float Farthest;
+    int MinX, MinY, MaxX, MaxY; // pixels that can be covered entirely
+};
+
+static auto CoverageScalar(const TriangleSetup& setup, const int tileX, const int tileY, const int tileSize) -> uint64_t {
+    auto coverage = uint64_t(0);
+    for (int row = 0; row < tileSize; row++) {
+        const auto centerY = static_cast<float>(tileY * tileSize + row) + 0.5f;
+        for (int column = 0; column < tileSize; column++) {
+            const auto pixel = glm::vec3(static_cast<float>(tileX * tileSize + column) + 0.5f, centerY, 1.f);
+            if (glm::dot(setup.Edges[0], pixel) >= 0.f && glm::dot(setup.Edges[1], pixel) >= 0.f && glm::dot(setup.Edges[2], pixel) >= 0.f)
+                coverage |= uint64_t(1) << (row * tileSize + column);
+        }
+    }
+    return coverage;
+}
+
+// one row of the tile per step, eight pixels wide
+BE_TARGET_AVX2 static auto CoverageAVX2(const TriangleSetup& setup, const int tileX, const int tileY, const int tileSize) -> uint64_t {
+    const auto& [e0, e1, e2] = setup.Edges;
+    const auto centerX = _mm256_add_ps(
+        _mm256_set1_ps(static_cast<float>(tileX * tileSize)),
+        _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f));
+    const auto column0 = _mm256_mul_ps(_mm256_set1_ps(e0.x), centerX);
+    const auto column1 = _mm256_mul_ps(_mm256_set1_ps(e1.x), centerX);
+    const auto column2 = _mm256_mul_ps(_mm256_set1_ps(e2.x), centerX);
+    const auto zero = _mm256_setzero_ps();
+
+    auto coverage = uint64_t(0);
+    for (int row = 0; row < tileSize; row++) {
+        const auto centerY = static_cast<float>(tileY * tileSize + row) + 0.5f;
+        const auto edge0 = _mm256_add_ps(column0, _mm256_set1_ps(e0.y * centerY + e0.z));
+        const auto edge1 = _mm256_add_ps(column1, _mm256_set1_ps(e1.y * centerY + e1.z));
+        const auto edge2 = _mm256_add_ps(column2, _mm256_set1_ps(e2.y * centerY + e2.z));
+        const auto inside = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(edge0, zero, _CMP_GE_OQ), _mm256_cmp_ps(edge1, zero, _CMP_GE_OQ)),
+            _mm256_cmp_ps(edge2, zero, _CMP_GE_OQ));
+        coverage |= uint64_t(_mm256_movemask_ps(inside)) << (row * tileSize);
+    }
+    return coverage;
+}
+
+auto BeOcclusionBuffer::RasterizeTriangle(const glm::vec3 a, glm::vec3 b, glm::vec3 c) -> void {
+    // occluders are rasterized from both sides, the winding is made consistent instead
+    auto area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (area < 0.f) {
+        std::swap(b, c);
+        area = -area;
+    }
+    if (area < 1e-6f)
+        return;
+
+    auto setup = TriangleSetup();
+    setup.MinX = std::max(0, static_cast<int>(std::ceil(std::min({a.x, b.x, c.x}))));
+    setup.MinY = std::max(0, static_cast<int>(std::ceil(std::min({a.y, b.y, c.y}))));
+    setup.MaxX = std::min(static_cast<int>(Width) - 1, static_cast<int>(std::floor(std::max({a.x, b.x, c.x}))) - 1);
+    setup.MaxY = std::min(static_cast<int>(Height) - 1, static_cast<int>(std::floor(std::max({a.y, b.y, c.y}))) - 1);
+    if (setup.MinX > setup.MaxX || setup.MinY > setup.MaxY)
+        return;
+
+    // the edge from p to q, positive on the side of the third corner
+    const auto edge = [](const glm::vec3& p, const glm::vec3& q) {
+        const auto ex = -(q.y - p.y);
+        const auto ey = q.x - p.x;
+        return glm::vec3(ex, ey, -(ex * p.x + ey * p.y));
+    };
+    setup.Edges = { edge(a, b), edge(b, c), edge(c, a) };
+
+    // barycentrics are the opposite edges over the area
+    setup.Depth = (setup.Edges[1] * a.z + setup.Edges[2] * b.z + setup.Edges[0] * c.z) / area;
+    setup.Farthest = std::max({a.z, b.z, c.z});
+
+    constexpr auto InwardPixels = 0.5f + 1.f / 64.f;
+    for (auto& e : setup.Edges)
+        e.z -= InwardPixels * (std::abs(e.x) + std::abs(e.y));
+
+    constexpr auto Size = static_cast<int>(TileSize);
+    const auto hasAVX2 = BeFrustumCuller::HasAVX2();
+    for (int tileY = setup.MinY / Size; tileY <= setup.MaxY / Size; tileY++) {
+        for (int tileX = setup.MinX / Size; tileX <= setup.MaxX / Size; tileX++) {
+            const auto coverage = hasAVX2
+                ? CoverageAVX2(setup, tileX, tileY, Size)
+                : CoverageScalar(setup, tileX, tileY, Size);
+            if (coverage == 0)
+                continue;
+
+            // the farthest the plane gets over the covered part of the tile, at one of the corners of its bounds
+            const auto x0 = static_cast<float>(std::max(tileX * Size, setup.MinX));
+            const auto x1 = static_cast<float>(std::min((tileX + 1) * Size, setup.MaxX + 1));
+            const auto y0 = static_cast<float>(std::max(tileY * Size, setup.MinY));
+            const auto y1 = static_cast<float>(std::min((tileY + 1) * Size, setup.MaxY + 1));
+            const auto planeFarthest = setup.Depth.z
+                + setup.Depth.x * (setup.Depth.x > 0.f ? x1 : x0)
+                + setup.Depth.y * (setup.Depth.y > 0.f ? y1 : y0);
+            Merge(_tiles[tileY * TilesX + tileX], coverage, std::min(planeFarthest, setup.Farthest));
+        }
+    }
+}
+
+auto BeOcclusionBuffer::Merge(Tile& tile, const uint64_t coverage, const float depth) -> void {
+    // behind what the whole tile already has, nothing gets nearer
+    if (depth >= tile.Reference)
+        return;
+
+    if (coverage == FullMask) {
+        tile.Reference = depth;
+        if (tile.Working >= depth)
+            tile.Mask = 0;
+        return;
+    }
+
+    if (tile.Mask == 0) {
+        tile.Mask = coverage;
+        tile.Working = depth;
+    }
+    // much nearer than the working layer, the layer is dropped and its pixels fall back to the reference
+    else if (tile.Working - depth > tile.Reference - tile.Working) {
+        tile.Mask = coverage;
+        tile.Working = depth;
+    }
+    else {
+        tile.Working = (tile.Mask & ~coverage) ? std::max(tile.Working, depth) : depth;
+        tile.Mask |= coverage;
+    }
+
+    if (tile.Mask == FullMask) {
+        tile.Reference = tile.Working;
+        tile.Mask = 0;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <umbrellas/access-modifiers.hpp>
+#include <umbrellas/include-glm.h>
+
+// a masked hierarchical depth buffer for occlusion culling on the cpu, deterministic and without a device. there are no
+// per pixel depths, every 8x8 tile keeps a coverage mask and two farthest depths: the reference one, which holds for
+// the whole tile, and a working one for the pixels in the mask. occluders merge into the working layer until it covers
+// the tile and becomes the reference, or is thrown away when a much nearer triangle comes along.
+// both sides stay conservative: occluders only cover the pixels they cover entirely, with the farthest depth they
+// reach there, and boxes are tested on every pixel they touch with their nearest depth
+class BeOcclusionBuffer {
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose static constexpr uint32_t Width = 256;
+    expose static constexpr uint32_t Height = 144;
+    expose static constexpr uint32_t TileSize = 8;
+    expose static constexpr uint32_t TilesX = Width / TileSize;
+    expose static constexpr uint32_t TilesY = Height / TileSize;
+    expose static constexpr uint64_t FullMask = ~uint64_t(0);
+
+
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // bit y * 8 + x is the pixel x, y of the tile. 0 is near
+    expose struct Tile {
+        uint64_t Mask = 0;
+        float Reference = 1.f; // every pixel is at most this far
+        float Working = 0.f; // the pixels in the mask are at most this far, below the reference while there are any
+    };
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide glm::mat4 _projectionView = glm::mat4(1.f);
+    hide std::vector<Tile> _tiles;
+
+    // lifetime ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose BeOcclusionBuffer();
+    expose ~BeOcclusionBuffer() = default;
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    // clears the tiles, depth is that of the projection, 0..1
+    expose auto Begin(const glm::mat4& projectionView) -> void;
+    // three corners per triangle in model space, either winding. triangles reaching in front of the near plane are
+    // left out rather than clipped
+    expose auto RasterizeOccluder(std::span<const glm::vec3> triangles, const glm::mat4& model) -> void;
+    // false only if the whole box is behind what was rasterized
+    expose auto IsVisible(const glm::vec3& center, const glm::vec3& extents) const -> bool;
+
+    expose auto GetTiles() const -> std::span<const Tile> { return _tiles; }
+
+    // screen space corners, z is depth
+    hide auto RasterizeTriangle(glm::vec3 a, glm::vec3 b, glm::vec3 c) -> void;
+    hide static auto Merge(Tile& tile, uint64_t coverage, float depth) -> void;
+};
@@ -1,138 +1,463 @@
 #include "BePipeline.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "BeAssetRegistry.h"
 #include "BeMaterial.h"
+#include "BeStateCache.h"
 #include "BeTexture.h"
 
-auto BePipeline::Create(const ComPtr<ID3D11DeviceContext>& context)-> std::shared_ptr<BePipeline> {
+namespace {
+    // the view keeps its resource alive, so the pointer stays good for as long as the view is bound
+    auto ResourceOf(ID3D11View* view) -> ID3D11Resource* {
+        if (view == nullptr)
+            return nullptr;
+        auto resource = ComPtr<ID3D11Resource>();
+        view->GetResource(&resource);
+        return resource.Get();
+    }
+
+    // walks slot-sorted bindings and calls bind(firstSlot, count, firstIndex) once per run of consecutive slots
+    // the stage reads, skipping runs whose cached values are all current. the cache is written before the bind,
+    // so bind can still forget slots the runtime refused
+    template <typename T, size_t CacheSize, size_t StageCount, typename Bind>
+    auto BindRuns(
+        const std::vector<uint8_t>& slots,
+        const std::vector<T>& values,
+        std::array<T, CacheSize>& cache,
+        const std::array<BeShaderType, StageCount>& slotStages,
+        const BeShaderType stage,
+        BePipeline::Stats& stats,
+        Bind&& bind
+    ) -> void {
+        const size_t count = slots.size();
+        size_t first = 0;
+        while (first < count) {
+            if (!HasAny(slotStages[slots[first]], stage)) {
+                first++;
+                continue;
+            }
+
+            auto end = first + 1;
+            while (end < count && slots[end] == slots[end - 1] + 1 && HasAny(slotStages[slots[end]], stage))
+                end++;
+
+            bool stale = false;
+            for (auto i = first; i < end; i++)
+                stale |= cache[slots[i]] != values[i];
+
+            if (stale) {
+                for (auto i = first; i < end; i++)
+                    cache[slots[i]] = values[i];
+                bind(slots[first], static_cast<UINT>(end - first), first);
+                stats.IssuedCalls++;
+            } else {
+                stats.FilteredCalls++;
+            }
+            first = end;
+        }
+    }
+}
+
+auto BePipeline::Create(
+    const ComPtr<ID3D11DeviceContext>& context,
+    const std::shared_ptr<BeStateCache>& stateCache
+) -> std::shared_ptr<BePipeline> {
     auto pipeline = std::shared_ptr<BePipeline>(new BePipeline());
 
     pipeline->_context = context;
+    (void)context.As(&pipeline->_context1);
+    pipeline->_stateCache = stateCache;
+    pipeline->ClearCache();
 
     return pipeline;
 }
 
-auto BePipeline::BindShader(const std::shared_ptr<BeShader>& shader, BeShaderType shaderType) -> void {
+auto BePipeline::BindShader(const std::shared_ptr<BeShader>& shader, const BeShaderType shaderType) -> void {
+    BindShader(shader, shaderType, shader->State);
+}
+
+auto BePipeline::BindShader(
+    const std::shared_ptr<BeShader>& shader,
+    const BeShaderType shaderType,
+    const BePipelineState& state
+) -> void {
     assert(_boundShaderType == BeShaderType::None);
     assert(_boundShader == nullptr);
-    assert(shader->Topology != D3D_PRIMITIVE_TOPOLOGY_UNDEFINED);
+    assert(state.Topology != D3D_PRIMITIVE_TOPOLOGY_UNDEFINED);
 
-    _context->IASetPrimitiveTopology(shader->Topology);
+    SetState(state);
     
     const auto boundType = shader->ShaderType & shaderType;
-    
-    if (HasAny(boundType, BeShaderType::Vertex)) {
-        if (shader->ComputedInputLayout)
-            _context->IASetInputLayout(shader->ComputedInputLayout.Get());
-        _context->VSSetShader(shader->VertexShader.Get(), nullptr, 0);
-    }
-    if (HasAny(boundType, BeShaderType::Tesselation)) {
-        _context->HSSetShader(shader->HullShader.Get(), nullptr, 0);
-        _context->DSSetShader(shader->DomainShader.Get(), nullptr, 0);
-    }
-    if (HasAny(boundType, BeShaderType::Pixel)) {
-        _context->PSSetShader(shader->PixelShader.Get(), nullptr, 0);
+
+    // stages the shader doesn't cover are unbound, so nothing from the previous shader leaks into the draw
+    const bool vertex = HasAny(boundType, BeShaderType::Vertex);
+    const bool tess = HasAny(boundType, BeShaderType::Tesselation);
+    const bool pixel = HasAny(boundType, BeShaderType::Pixel);
+    _pending.VertexShader = vertex ? shader->VertexShader.Get() : nullptr;
+    _pending.HullShader = tess ? shader->HullShader.Get() : nullptr;
+    _pending.DomainShader = tess ? shader->DomainShader.Get() : nullptr;
+    _pending.PixelShader = pixel ? shader->PixelShader.Get() : nullptr;
+    _pendingBits |= DirtyVertexShader | DirtyHullShader | DirtyDomainShader | DirtyPixelShader;
+
+    // shaders without vertex input leave the previous layout bound, it's validated against nothing.
+    // layouts come shared from the registry, so consecutive shaders with the same inputs commit nothing here
+    if (vertex && shader->ComputedInputLayout) {
+        _pending.InputLayout = shader->ComputedInputLayout.Get();
+        _pendingBits |= DirtyInputLayout;
     }
     
     _boundShaderType = boundType;
     _boundShader = shader;
 }
 
+auto BePipeline::SetState(const BePipelineState& state) -> void {
+    _state = state;
+    
+    const auto& resolved = _stateCache->Resolve(state);
+    _pending.BlendState = resolved.Blend;
+    _pending.RasterizerState = resolved.Rasterizer;
+    _pending.DepthStencilState = resolved.DepthStencil;
+    _pending.Topology = state.Topology;
+    _pendingBits |= DirtyBlendState | DirtyRasterizerState | DirtyDepthStencilState | DirtyTopology;
+}
+
 auto BePipeline::BindMaterialAutomatic(const std::shared_ptr<BeMaterial>& material) -> void {
     assert(_boundShader);
-    const uint8_t slot = _boundShader->GetMaterialSlotByScheme(material->GetSchemeName());
-    BindMaterialManual(material, slot);
+    BindMaterialManual(material, material->GetSlotIn(*_boundShader));
 }
 
 auto BePipeline::BindMaterialManual(const std::shared_ptr<BeMaterial>& material, const uint8_t materialSlot) -> void {
+    // update first, instances that diverged from their parent create their buffer here.
+    // an update writes into the same buffer object, so it doesn't need a re-bind
+    material->UpdateGPUBuffers(_context);
     const auto& buffer = material->GetBuffer();
     if (buffer != nullptr) {
-        auto updated = material->UpdateGPUBuffers(_context);
-        auto id = material->GetUniqueID();
+        const auto id = material->GetUniqueID();
+        const auto stages = _boundShaderType & _boundShader->ConstantBufferStages[materialSlot];
+
+        const auto bindStage = [&](BeShaderType stage, uint32_t& cached, auto&& bind) {
+            if (!HasAny(stages, stage))
+                return;
+            if (cached == id) {
+                _stats.FilteredCalls++;
+                return;
+            }
+            bind();
+            cached = id;
+            _stats.IssuedCalls++;
+        };
         
-        if (HasAny(_boundShaderType, BeShaderType::Vertex) && (updated || _vertexCBufferIDCache[materialSlot] != id)) {
+        bindStage(BeShaderType::Vertex, _vertexCBufferIDCache[materialSlot], [&] {
             _context->VSSetConstantBuffers(materialSlot, 1, buffer.GetAddressOf());
-            _vertexCBufferIDCache[materialSlot] = id;
-        }
-        if (HasAny(_boundShaderType, BeShaderType::Tesselation) && (updated || _tessCBufferIDCache[materialSlot] != id)) {
+        });
+        bindStage(BeShaderType::Tesselation, _tessCBufferIDCache[materialSlot], [&] {
             _context->HSSetConstantBuffers(materialSlot, 1, buffer.GetAddressOf());
             _context->DSSetConstantBuffers(materialSlot, 1, buffer.GetAddressOf());
-            _tessCBufferIDCache[materialSlot] = id;
-        }
-        if (HasAny(_boundShaderType, BeShaderType::Pixel) && (updated || _pixelCBufferIDCache[materialSlot] != id)) {
+        });
+        bindStage(BeShaderType::Pixel, _pixelCBufferIDCache[materialSlot], [&] {
             _context->PSSetConstantBuffers(materialSlot, 1, buffer.GetAddressOf());
-            _pixelCBufferIDCache[materialSlot] = id;
-        }
+        });
     }
 
-    BindMaterialTextures(*material);
+    BindMaterialResources(*material);
+}
 
-    const auto& samplerSlots = material->GetSamplerPairs();
-    for (auto& [sampler, slot] : samplerSlots | std::views::values) {
-        auto sampPtr = sampler.Get();
-        if (HasAny(_boundShaderType, BeShaderType::Vertex) && _vertexSamplerCache[slot] != sampPtr) {
-            _context->VSSetSamplers(slot, 1, sampler.GetAddressOf());
-            _vertexSamplerCache[slot] = sampPtr;
-        }
-        if (HasAny(_boundShaderType, BeShaderType::Tesselation) && _tessSamplerCache[slot] != sampPtr) {
-            _context->HSSetSamplers(slot, 1, sampler.GetAddressOf());
-            _context->DSSetSamplers(slot, 1, sampler.GetAddressOf());
-            _tessSamplerCache[slot] = sampPtr;
-        }
-        if (HasAny(_boundShaderType, BeShaderType::Pixel) && _pixelSamplerCache[slot] != sampPtr) {
-            _context->PSSetSamplers(slot, 1, sampler.GetAddressOf());
-            _pixelSamplerCache[slot] = sampPtr;
-        }
+auto BePipeline::BindConstantRange(
+    const uint8_t slot,
+    ID3D11Buffer* buffer,
+    const UINT firstConstant,
+    const UINT constantCount
+) -> void {
+    assert(_boundShader);
+    assert(_context1);
+
+    // every block is its own window, there's nothing to filter against. the id caches just forget the slot,
+    // so the next material bound there goes out again
+    const auto stages = _boundShaderType & _boundShader->ConstantBufferStages[slot];
+    if (HasAny(stages, BeShaderType::Vertex)) {
+        _context1->VSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &constantCount);
+        _vertexCBufferIDCache[slot] = 0;
+        _stats.IssuedCalls++;
+    }
+    if (HasAny(stages, BeShaderType::Tesselation)) {
+        _context1->HSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &constantCount);
+        _context1->DSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &constantCount);
+        _tessCBufferIDCache[slot] = 0;
+        _stats.IssuedCalls++;
+    }
+    if (HasAny(stages, BeShaderType::Pixel)) {
+        _context1->PSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &constantCount);
+        _pixelCBufferIDCache[slot] = 0;
+        _stats.IssuedCalls++;
+    }
+}
+
+auto BePipeline::SetVertexBuffer(ID3D11Buffer* buffer, const UINT stride, const UINT offset) -> void {
+    _pending.VertexBuffer = buffer;
+    _pending.VertexStride = stride;
+    _pending.VertexOffset = offset;
+    _pendingBits |= DirtyVertexBuffer;
+}
+
+auto BePipeline::SetIndexBuffer(ID3D11Buffer* buffer, const DXGI_FORMAT format, const UINT offset) -> void {
+    _pending.IndexBuffer = buffer;
+    _pending.IndexFormat = format;
+    _pending.IndexOffset = offset;
+    _pendingBits |= DirtyIndexBuffer;
+}
+
+auto BePipeline::SetInstanceBuffer(ID3D11Buffer* buffer, const UINT stride, const UINT offset) -> void {
+    _pending.InstanceBuffer = buffer;
+    _pending.InstanceStride = stride;
+    _pending.InstanceOffset = offset;
+    _pendingBits |= DirtyInstanceBuffer;
+}
+
+auto BePipeline::SetRenderTargets(
+    const std::span<ID3D11RenderTargetView* const> renderTargets,
+    ID3D11DepthStencilView* depthStencil
+) -> void {
+    assert(renderTargets.size() <= D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT);
+
+    // trailing nulls bind the same thing as a shorter list
+    auto count = renderTargets.size();
+    while (count > 0 && renderTargets[count - 1] == nullptr)
+        count--;
+
+    OutputState outputs;
+    std::ranges::copy(renderTargets.first(count), outputs.RenderTargets.begin());
+    outputs.RenderTargetCount = static_cast<uint32_t>(count);
+    outputs.DepthStencil = depthStencil;
+
+    if (_outputsKnown && outputs == _outputs) {
+        _stats.FilteredCalls++;
+        return;
     }
+
+    _context->OMSetRenderTargets(outputs.RenderTargetCount, outputs.RenderTargets.data(), outputs.DepthStencil);
+    _outputs = outputs;
+    _outputsKnown = true;
+    _stats.IssuedCalls++;
+
+    _outputResources.fill(nullptr);
+    for (uint32_t i = 0; i < outputs.RenderTargetCount; i++)
+        _outputResources[i] = ResourceOf(outputs.RenderTargets[i]);
+    _outputResources.back() = ResourceOf(outputs.DepthStencil);
+
+    // the runtime silently unbinds inputs that alias the new outputs
+    ForgetAliasedResources();
+}
+
+auto BePipeline::SetRenderTarget(ID3D11RenderTargetView* renderTarget, ID3D11DepthStencilView* depthStencil) -> void {
+    SetRenderTargets({&renderTarget, 1}, depthStencil);
+}
+
+auto BePipeline::SetViewport(const D3D11_VIEWPORT& viewport) -> void {
+    if (_viewportKnown && memcmp(&viewport, &_viewport, sizeof(D3D11_VIEWPORT)) == 0) {
+        _stats.FilteredCalls++;
+        return;
+    }
+
+    _context->RSSetViewports(1, &viewport);
+    _viewport = viewport;
+    _viewportKnown = true;
+    _stats.IssuedCalls++;
+}
+
+auto BePipeline::Draw(const UINT vertexCount, const UINT startVertex) -> void {
+    Commit();
+    _context->Draw(vertexCount, startVertex);
+    _stats.Draws++;
+}
+
+auto BePipeline::DrawIndexed(const UINT indexCount, const UINT startIndex, const INT baseVertex) -> void {
+    Commit();
+    _context->DrawIndexed(indexCount, startIndex, baseVertex);
+    _stats.Draws++;
+}
+
+auto BePipeline::DrawIndexedInstanced(
+    const UINT indexCount,
+    const UINT instanceCount,
+    const UINT startIndex,
+    const INT baseVertex,
+    const UINT startInstance
+) -> void {
+    Commit();
+    _context->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+    _stats.Draws++;
 }
 
 auto BePipeline::Clear() -> void {
     assert(_boundShaderType != BeShaderType::None);
     assert(_boundShader != nullptr);
 
-    _context->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_UNDEFINED);
-    
-    _context->IASetInputLayout(nullptr);
-    _context->VSSetShader(nullptr, nullptr, 0);
-    _context->HSSetShader(nullptr, nullptr, 0);
-    _context->DSSetShader(nullptr, nullptr, 0);
-    _context->PSSetShader(nullptr, nullptr, 0);
+    _pending.VertexShader = nullptr;
+    _pending.HullShader = nullptr;
+    _pending.DomainShader = nullptr;
+    _pending.PixelShader = nullptr;
+    _pendingBits |= DirtyVertexShader | DirtyHullShader | DirtyDomainShader | DirtyPixelShader;
     
     _boundShaderType = BeShaderType::None;
     _boundShader.reset();
-    _boundShader = nullptr;
 }
 
 auto BePipeline::ClearCache() -> void {
-    _vertexResCache.fill(0);
-    _tessResCache.fill(0);
-    _pixelResCache.fill(0);
+    InvalidateResourceCaches();
+    _outputResources.fill(nullptr);
     _vertexCBufferIDCache.fill(0);
     _tessCBufferIDCache.fill(0);
     _pixelCBufferIDCache.fill(0);
+    _vertexSamplerCache.fill(nullptr);
+    _tessSamplerCache.fill(nullptr);
+    _pixelSamplerCache.fill(nullptr);
+
+    // everything pending is re-issued on the next draw, outputs and viewport on their next set
+    _committedKnown = false;
+    _pendingBits = ~uint16_t(0);
+    _outputsKnown = false;
+    _viewportKnown = false;
 }
 
-auto BePipeline::BindMaterialTextures(const BeMaterial& material) -> void {
-    
-    const auto& textureSlots = material.GetTexturePairs();
+auto BePipeline::EndFrame() -> void {
+    _lastFrameStats = _stats;
+    _stats = {};
+}
+
+auto BePipeline::BindMaterialResources(BeMaterial& material) -> void {
+    const auto& bindings = material.GetBindings();
+    const auto& shader = *_boundShader;
+    const auto& views = bindings.TextureViews;
+    const auto& samplers = bindings.Samplers;
     
-    for (const auto& [texture, slot] : textureSlots | std::views::values) {
+    if (HasAny(_boundShaderType, BeShaderType::Vertex)) {
+        BindRuns(bindings.TextureSlots, bindings.TextureIDs, _vertexResCache, shader.ResourceStages, BeShaderType::Vertex, _stats,
+            [&](UINT slot, UINT count, size_t index) {
+                _context->VSSetShaderResources(slot, count, &views[index]);
+                TrackResources(_vertexResCache, _vertexResources, slot, count, &views[index]);
+            });
+        BindRuns(bindings.SamplerSlots, samplers, _vertexSamplerCache, shader.SamplerStages, BeShaderType::Vertex, _stats,
+            [&](UINT slot, UINT count, size_t index) { _context->VSSetSamplers(slot, count, &samplers[index]); });
+    }
+    if (HasAny(_boundShaderType, BeShaderType::Tesselation)) {
+        BindRuns(bindings.TextureSlots, bindings.TextureIDs, _tessResCache, shader.ResourceStages, BeShaderType::Tesselation, _stats,
+            [&](UINT slot, UINT count, size_t index) {
+                _context->HSSetShaderResources(slot, count, &views[index]);
+                _context->DSSetShaderResources(slot, count, &views[index]);
+                TrackResources(_tessResCache, _tessResources, slot, count, &views[index]);
+            });
+        BindRuns(bindings.SamplerSlots, samplers, _tessSamplerCache, shader.SamplerStages, BeShaderType::Tesselation, _stats,
+            [&](UINT slot, UINT count, size_t index) {
+                _context->HSSetSamplers(slot, count, &samplers[index]);
+                _context->DSSetSamplers(slot, count, &samplers[index]);
+            });
+    }
+    if (HasAny(_boundShaderType, BeShaderType::Pixel)) {
+        BindRuns(bindings.TextureSlots, bindings.TextureIDs, _pixelResCache, shader.ResourceStages, BeShaderType::Pixel, _stats,
+            [&](UINT slot, UINT count, size_t index) {
+                _context->PSSetShaderResources(slot, count, &views[index]);
+                TrackResources(_pixelResCache, _pixelResources, slot, count, &views[index]);
+            });
+        BindRuns(bindings.SamplerSlots, samplers, _pixelSamplerCache, shader.SamplerStages, BeShaderType::Pixel, _stats,
+            [&](UINT slot, UINT count, size_t index) { _context->PSSetSamplers(slot, count, &samplers[index]); });
+    }
+}
 
-        const auto srv = texture->GetSRV();
-        const auto id = texture->UniqueID;
-        
-        if (HasAny(_boundShaderType, BeShaderType::Vertex) && _vertexResCache[slot] != id) {
-            _context->VSSetShaderResources(slot, 1, srv.GetAddressOf());
-            _vertexResCache[slot] = id;
+auto BePipeline::Commit() -> void {
+    const auto changed = [&](const DrawStateBit bit, const bool differs) {
+        if (!(_pendingBits & bit))
+            return false;
+        if (_committedKnown && !differs) {
+            _stats.FilteredCalls++;
+            return false;
         }
-        if (HasAny(_boundShaderType, BeShaderType::Tesselation) && _tessResCache[slot] != id) {
-            _context->HSSetShaderResources(slot, 1, srv.GetAddressOf());
-            _context->DSSetShaderResources(slot, 1, srv.GetAddressOf());
-            _tessResCache[slot] = id;
+        _stats.IssuedCalls++;
+        return true;
+    };
+    const auto& p = _pending;
+    const auto& c = _committed;
+
+    if (changed(DirtyVertexShader, p.VertexShader != c.VertexShader))
+        _context->VSSetShader(p.VertexShader, nullptr, 0);
+    if (changed(DirtyHullShader, p.HullShader != c.HullShader))
+        _context->HSSetShader(p.HullShader, nullptr, 0);
+    if (changed(DirtyDomainShader, p.DomainShader != c.DomainShader))
+        _context->DSSetShader(p.DomainShader, nullptr, 0);
+    if (changed(DirtyPixelShader, p.PixelShader != c.PixelShader))
+        _context->PSSetShader(p.PixelShader, nullptr, 0);
+
+    if (changed(DirtyInputLayout, p.InputLayout != c.InputLayout))
+        _context->IASetInputLayout(p.InputLayout);
+    if (changed(DirtyTopology, p.Topology != c.Topology))
+        _context->IASetPrimitiveTopology(p.Topology);
+    if (changed(DirtyVertexBuffer,
+        p.VertexBuffer != c.VertexBuffer || p.VertexStride != c.VertexStride || p.VertexOffset != c.VertexOffset))
+        _context->IASetVertexBuffers(0, 1, &p.VertexBuffer, &p.VertexStride, &p.VertexOffset);
+    if (changed(DirtyInstanceBuffer,
+        p.InstanceBuffer != c.InstanceBuffer || p.InstanceStride != c.InstanceStride || p.InstanceOffset != c.InstanceOffset))
+        _context->IASetVertexBuffers(1, 1, &p.InstanceBuffer, &p.InstanceStride, &p.InstanceOffset);
+    if (changed(DirtyIndexBuffer,
+        p.IndexBuffer != c.IndexBuffer || p.IndexFormat != c.IndexFormat || p.IndexOffset != c.IndexOffset))
+        _context->IASetIndexBuffer(p.IndexBuffer, p.IndexFormat, p.IndexOffset);
+
+    if (changed(DirtyBlendState, p.BlendState != c.BlendState))
+        _context->OMSetBlendState(p.BlendState, nullptr, 0xFFFFFFFF);
+    if (changed(DirtyRasterizerState, p.RasterizerState != c.RasterizerState))
+        _context->RSSetState(p.RasterizerState);
+    if (changed(DirtyDepthStencilState, p.DepthStencilState != c.DepthStencilState))
+        _context->OMSetDepthStencilState(p.DepthStencilState, 0);
+
+    // bits that weren't pending keep their committed value, so copying the whole thing is fine
+    _committed = _pending;
+    _committedKnown = true;
+    _pendingBits = 0;
+}
+
+auto BePipeline::InvalidateResourceCaches() -> void {
+    _vertexResCache.fill(0);
+    _tessResCache.fill(0);
+    _pixelResCache.fill(0);
+    _vertexResources.fill(nullptr);
+    _tessResources.fill(nullptr);
+    _pixelResources.fill(nullptr);
+}
+
+// whole resources are compared, so different mips of one texture count as aliasing too. that only costs a re-bind
+auto BePipeline::IsOutput(const ID3D11Resource* resource) const -> bool {
+    return resource != nullptr && std::ranges::find(_outputResources, resource) != _outputResources.end();
+}
+
+auto BePipeline::ForgetAliasedResources() -> void {
+    const auto forget = [&](auto& cache, auto& resources) {
+        for (size_t slot = 0; slot < resources.size(); slot++) {
+            if (IsOutput(resources[slot])) {
+                cache[slot] = 0;
+                resources[slot] = nullptr;
+            }
         }
-        if (HasAny(_boundShaderType, BeShaderType::Pixel) && _pixelResCache[slot] != id) {
-            _context->PSSetShaderResources(slot, 1, srv.GetAddressOf());
-            _pixelResCache[slot] = id;
+    };
+    forget(_vertexResCache, _vertexResources);
+    forget(_tessResCache, _tessResources);
+    forget(_pixelResCache, _pixelResources);
+}
+
+auto BePipeline::TrackResources(
+    std::array<uint32_t, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT>& cache,
+    std::array<ID3D11Resource*, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT>& resources,
+    const UINT slot,
+    const UINT count,
+    ID3D11ShaderResourceView* const* views
+) -> void {
+    for (UINT i = 0; i < count; i++) {
+        resources[slot + i] = ResourceOf(views[i]);
+
+        // a resource still bound as an output is refused, the runtime binds null in its place.
+        // forgetting the slot makes the next bind after the output moves on go out again
+        if (IsOutput(resources[slot + i])) {
+            cache[slot + i] = 0;
+            resources[slot + i] = nullptr;
         }
     }
 }
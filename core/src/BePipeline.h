@@ -1,24 +1,106 @@
 #pragma once
+#include <array>
 #include <d3d11.h>
+#include <d3d11_1.h>
 #include <memory>
+#include <span>
 #include <umbrellas/access-modifiers.hpp>
 #include <wrl/client.h>
 
+#include "BePipelineState.h"
 #include "BeShader.h"
 
 class BeMaterial;
+class BeStateCache;
 using Microsoft::WRL::ComPtr;
 
+// shadow copy of the context state. everything set through here is filtered against what the context already has:
+// shaders, input assembly and fixed function states are committed lazily on Draw/DrawIndexed,
+// outputs, viewports and material bindings go out immediately (outputs unbind aliasing inputs, so order matters)
 class BePipeline {
 
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose struct Stats {
+        uint32_t IssuedCalls = 0;
+        uint32_t FilteredCalls = 0; // requested changes that matched the context
+        uint32_t Draws = 0;
+    };
+
+    hide
+    struct DrawState {
+        ID3D11VertexShader* VertexShader = nullptr;
+        ID3D11HullShader* HullShader = nullptr;
+        ID3D11DomainShader* DomainShader = nullptr;
+        ID3D11PixelShader* PixelShader = nullptr;
+
+        ID3D11InputLayout* InputLayout = nullptr;
+        D3D11_PRIMITIVE_TOPOLOGY Topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+        ID3D11Buffer* VertexBuffer = nullptr;
+        UINT VertexStride = 0;
+        UINT VertexOffset = 0;
+        ID3D11Buffer* InstanceBuffer = nullptr;
+        UINT InstanceStride = 0;
+        UINT InstanceOffset = 0;
+        ID3D11Buffer* IndexBuffer = nullptr;
+        DXGI_FORMAT IndexFormat = DXGI_FORMAT_UNKNOWN;
+        UINT IndexOffset = 0;
+
+        ID3D11BlendState* BlendState = nullptr;
+        ID3D11RasterizerState* RasterizerState = nullptr;
+        ID3D11DepthStencilState* DepthStencilState = nullptr;
+    };
+
+    enum DrawStateBit : uint16_t {
+        DirtyVertexShader = 1 << 0,
+        DirtyHullShader = 1 << 1,
+        DirtyDomainShader = 1 << 2,
+        DirtyPixelShader = 1 << 3,
+        DirtyInputLayout = 1 << 4,
+        DirtyTopology = 1 << 5,
+        DirtyVertexBuffer = 1 << 6,
+        DirtyIndexBuffer = 1 << 7,
+        DirtyBlendState = 1 << 8,
+        DirtyRasterizerState = 1 << 9,
+        DirtyDepthStencilState = 1 << 10,
+        DirtyInstanceBuffer = 1 << 11,
+    };
+
+    struct OutputState {
+        std::array<ID3D11RenderTargetView*, D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT> RenderTargets {};
+        uint32_t RenderTargetCount = 0;
+        ID3D11DepthStencilView* DepthStencil = nullptr;
+
+        auto operator==(const OutputState& other) const -> bool = default;
+    };
+
+
     // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
     expose
-    static auto Create (const ComPtr<ID3D11DeviceContext>& context) -> std::shared_ptr<BePipeline>;
+    static auto Create (
+        const ComPtr<ID3D11DeviceContext>& context,
+        const std::shared_ptr<BeStateCache>& stateCache
+    ) -> std::shared_ptr<BePipeline>;
+
 
-    
     // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
     hide
     ComPtr<ID3D11DeviceContext> _context;
+    ComPtr<ID3D11DeviceContext1> _context1; // null without the 11.1 runtime, BindConstantRange needs it
+    std::shared_ptr<BeStateCache> _stateCache;
+
+    BePipelineState _state;
+    DrawState _pending;
+    DrawState _committed;
+    uint16_t _pendingBits = 0;    // DrawStateBit fields set since the last commit
+    bool _committedKnown = false; // false until the first commit and after ClearCache
+
+    OutputState _outputs;
+    bool _outputsKnown = false;
+    D3D11_VIEWPORT _viewport = {};
+    bool _viewportKnown = false;
+
+    Stats _stats;
+    Stats _lastFrameStats;
 
     BeShaderType _boundShaderType = BeShaderType::None;
     std::shared_ptr<BeShader> _boundShader;
@@ -27,30 +109,76 @@ class BePipeline {
     std::array<uint32_t, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT> _tessResCache;
     std::array<uint32_t, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT> _pixelResCache;
 
+    // resources behind the outputs and the resource slots, an output change only forgets the inputs it aliases
+    std::array<ID3D11Resource*, D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT + 1> _outputResources {};
+    std::array<ID3D11Resource*, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT> _vertexResources {};
+    std::array<ID3D11Resource*, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT> _tessResources {};
+    std::array<ID3D11Resource*, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT> _pixelResources {};
+
     std::array<uint32_t, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT> _vertexCBufferIDCache;
     std::array<uint32_t, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT>   _tessCBufferIDCache;
     std::array<uint32_t, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT>  _pixelCBufferIDCache;
-    
+
     std::array<ID3D11SamplerState*, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT> _vertexSamplerCache;
     std::array<ID3D11SamplerState*, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT>   _tessSamplerCache;
     std::array<ID3D11SamplerState*, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT>  _pixelSamplerCache;
-    
+
     // lifetime ////////////////////////////////////////////////////////////////////////////////////////////////////////
     hide BePipeline() = default;
     expose ~BePipeline() = default;
 
-    
+
     // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
     expose
     auto GetRawContext () -> ComPtr<ID3D11DeviceContext> { return _context; }
-    
+
     expose
     auto BindShader (const std::shared_ptr<BeShader>& shader, BeShaderType shaderType) -> void;
+    // binds the shader with a pass-specific state instead of the one it declares
+    auto BindShader (const std::shared_ptr<BeShader>& shader, BeShaderType shaderType, const BePipelineState& state) -> void;
+    auto SetState (const BePipelineState& state) -> void;
+    auto GetState () const -> const BePipelineState& { return _state; }
     auto BindMaterialAutomatic (const std::shared_ptr<BeMaterial>& material) -> void;
     auto BindMaterialManual (const std::shared_ptr<BeMaterial>& material, const uint8_t materialSlot) -> void;
+    // a window of a constant buffer, e.g. a BeConstantRing block, in place of a material's buffer.
+    // goes to the bound stages that read the slot, firstConstant and constantCount are multiples of 16
+    auto BindConstantRange (uint8_t slot, ID3D11Buffer* buffer, UINT firstConstant, UINT constantCount) -> void;
+
+    auto SetVertexBuffer (ID3D11Buffer* buffer, UINT stride, UINT offset = 0) -> void;
+    auto SetIndexBuffer (ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset = 0) -> void;
+    // per-instance vertex stream in slot 1, shaders with "instance-model" in their vertexLayout read it
+    auto SetInstanceBuffer (ID3D11Buffer* buffer, UINT stride, UINT offset = 0) -> void;
+
+    auto SetRenderTargets (std::span<ID3D11RenderTargetView* const> renderTargets, ID3D11DepthStencilView* depthStencil) -> void;
+    auto SetRenderTarget (ID3D11RenderTargetView* renderTarget, ID3D11DepthStencilView* depthStencil = nullptr) -> void;
+    auto ClearRenderTargets () -> void { SetRenderTargets({}, nullptr); }
+    auto SetViewport (const D3D11_VIEWPORT& viewport) -> void;
+    auto GetViewport () const -> const D3D11_VIEWPORT& { return _viewport; }
+
+    auto Draw (UINT vertexCount, UINT startVertex) -> void;
+    auto DrawIndexed (UINT indexCount, UINT startIndex, INT baseVertex) -> void;
+    auto DrawIndexedInstanced (UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) -> void;
+
+    // unbinds the shader logically, the stages are only touched by the next draw that needs something else
     auto Clear() -> void;
+    // forgets everything known about the context, for when something else has changed it
     auto ClearCache() -> void;
-    
+
+    auto EndFrame() -> void;
+    auto GetStats() const -> const Stats& { return _stats; }
+    auto GetLastFrameStats() const -> const Stats& { return _lastFrameStats; }
+
     hide
-    auto BindMaterialTextures (const BeMaterial& material) -> void;
+    auto BindMaterialResources (BeMaterial& material) -> void;
+    auto Commit() -> void;
+    auto InvalidateResourceCaches() -> void;
+    auto IsOutput(const ID3D11Resource* resource) const -> bool;
+    auto ForgetAliasedResources() -> void;
+    auto TrackResources(
+        std::array<uint32_t, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT>& cache,
+        std::array<ID3D11Resource*, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT>& resources,
+        UINT slot,
+        UINT count,
+        ID3D11ShaderResourceView* const* views
+    ) -> void;
 };
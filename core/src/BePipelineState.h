@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <d3d11.h>
+
+enum class BeBlendMode : uint8_t {
+    Opaque,
+    Additive,           // one + one on color and alpha
+    AdditiveKeepAlpha,  // one + one on color, destination alpha untouched
+};
+
+enum class BeCullMode : uint8_t {
+    Back,
+    None,
+    Front,
+};
+
+enum class BeDepthMode : uint8_t {
+    LessWrite,
+    LessReadOnly,
+    Off,
+};
+
+// compact description of the fixed function state, declared by shaders (see "state" in @be-shader) or passes.
+// BeStateCache turns it into state objects, BePipeline only re-binds the parts whose key changed
+struct BePipelineState {
+    BeBlendMode Blend = BeBlendMode::Opaque;
+    BeCullMode Cull = BeCullMode::Back;
+    BeDepthMode Depth = BeDepthMode::LessWrite;
+    D3D11_PRIMITIVE_TOPOLOGY Topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+
+    constexpr auto Key() const -> uint32_t {
+        return uint32_t(Blend)
+             | uint32_t(Cull) << 8
+             | uint32_t(Depth) << 16
+             | uint32_t(Topology) << 24;
+    }
+
+    // blend, cull and depth in one byte, topology comes with the shader. for sort keys, see BeRenderQueue
+    constexpr auto FixedFunctionBits() const -> uint8_t {
+        return uint8_t(uint32_t(Blend) | uint32_t(Cull) << 2 | uint32_t(Depth) << 4);
+    }
+
+    constexpr auto WithCull(const BeCullMode cull) const -> BePipelineState {
+        auto state = *this;
+        state.Cull = cull;
+        return state;
+    }
+
+    constexpr auto WithBlend(const BeBlendMode blend) const -> BePipelineState {
+        auto state = *this;
+        state.Blend = blend;
+        return state;
+    }
+
+    constexpr auto operator==(const BePipelineState& other) const -> bool { return Key() == other.Key(); }
+};
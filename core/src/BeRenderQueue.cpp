@@ -0,0 +1,86 @@
+#include "BeRenderQueue.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace {
+    struct Switches {
+        uint32_t Shader = 0;
+        uint32_t State = 0;
+        uint32_t Material = 0;
+    };
+
+    auto CountSwitches(const std::span<const BeRenderQueue::Item> items) -> Switches {
+        const auto field = [](const uint64_t key, const uint32_t bits, const uint32_t shift) {
+            return key >> shift & ((1ull << bits) - 1);
+        };
+
+        auto switches = Switches();
+        for (size_t i = 0; i < items.size(); i++) {
+            const auto key = items[i].Key;
+            const auto previous = i == 0 ? ~key : items[i - 1].Key;
+            // a different pass rebinds everything
+            const auto passChanged = field(key, BeRenderQueue::PassBits, BeRenderQueue::PassShift) !=
+                                     field(previous, BeRenderQueue::PassBits, BeRenderQueue::PassShift);
+            const auto shaderChanged = passChanged ||
+                field(key, BeRenderQueue::ShaderBits, BeRenderQueue::ShaderShift) !=
+                field(previous, BeRenderQueue::ShaderBits, BeRenderQueue::ShaderShift);
+
+            switches.Shader += shaderChanged;
+            switches.State += shaderChanged ||
+                field(key, BeRenderQueue::StateBits, BeRenderQueue::StateShift) !=
+                field(previous, BeRenderQueue::StateBits, BeRenderQueue::StateShift);
+            switches.Material += shaderChanged ||
+                field(key, BeRenderQueue::MaterialBits, BeRenderQueue::MaterialShift) !=
+                field(previous, BeRenderQueue::MaterialBits, BeRenderQueue::MaterialShift);
+        }
+        return switches;
+    }
+}
+
+auto BeRenderQueue::DepthBucket(const float distance) -> uint32_t {
+    // 4096 buckets per doubling, saturates at 2^16 units
+    constexpr auto MaxBucket = float((1u << DepthBits) - 1);
+    const auto bucket = std::log2(1.f + std::max(distance, 0.f)) * 4096.f;
+    return static_cast<uint32_t>(std::min(bucket, MaxBucket));
+}
+
+auto BeRenderQueue::Sort() -> void {
+    const auto unsorted = CountSwitches(_items);
+
+    // one histogram per key byte, all gathered in a single read of the keys
+    auto histograms = std::array<std::array<uint32_t, 256>, 8>();
+    for (const auto& item : _items) {
+        for (size_t byte = 0; byte < 8; byte++)
+            histograms[byte][item.Key >> byte * 8 & 0xFF]++;
+    }
+
+    _scratch.resize(_items.size());
+    for (size_t byte = 0; byte < 8; byte++) {
+        auto& histogram = histograms[byte];
+        if (std::ranges::find(histogram, static_cast<uint32_t>(_items.size())) != histogram.end())
+            continue;
+
+        // counts to offsets
+        uint32_t offset = 0;
+        for (auto& count : histogram)
+            offset += std::exchange(count, offset);
+
+        for (const auto& item : _items)
+            _scratch[histogram[item.Key >> byte * 8 & 0xFF]++] = item;
+        _items.swap(_scratch);
+    }
+
+    const auto sorted = CountSwitches(_items);
+    _stats = {
+        .Items = static_cast<uint32_t>(_items.size()),
+        .UnsortedShaderSwitches = unsorted.Shader,
+        .UnsortedStateSwitches = unsorted.State,
+        .UnsortedMaterialSwitches = unsorted.Material,
+        .ShaderSwitches = sorted.Shader,
+        .StateSwitches = sorted.State,
+        .MaterialSwitches = sorted.Material,
+    };
+}
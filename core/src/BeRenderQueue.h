@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <umbrellas/access-modifiers.hpp>
+
+// draw items of one pass and frame, ordered by a 64 bit key so neighbours share as much state as possible.
+// the key, high to low: pass (4 bits), shader (16), fixed function state (8), material (20), depth bucket (16).
+// items only carry indices, what they refer to stays with the pass that filled the queue
+class BeRenderQueue {
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose struct Item {
+        uint64_t Key = 0;
+        uint32_t Entry = 0; // caller's index, e.g. into the submitted entries
+        uint32_t Slice = 0; // caller's sub-index, e.g. into the entry's draw slices
+    };
+
+    // switches are counted from the keys, once in submission order and once sorted
+    expose struct Stats {
+        uint32_t Items = 0;
+        uint32_t UnsortedShaderSwitches = 0;
+        uint32_t UnsortedStateSwitches = 0;
+        uint32_t UnsortedMaterialSwitches = 0;
+        uint32_t ShaderSwitches = 0;
+        uint32_t StateSwitches = 0;
+        uint32_t MaterialSwitches = 0;
+    };
+
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose static constexpr uint32_t DepthBits = 16;
+    expose static constexpr uint32_t MaterialBits = 20;
+    expose static constexpr uint32_t StateBits = 8;
+    expose static constexpr uint32_t ShaderBits = 16;
+    expose static constexpr uint32_t PassBits = 4;
+
+    expose static constexpr uint32_t MaterialShift = DepthBits;
+    expose static constexpr uint32_t StateShift = MaterialShift + MaterialBits;
+    expose static constexpr uint32_t ShaderShift = StateShift + StateBits;
+    expose static constexpr uint32_t PassShift = ShaderShift + ShaderBits;
+    static_assert(PassShift + PassBits == 64);
+
+    // ids wrap into their field, a collision only costs an extra switch, never a wrong bind.
+    // stateBits is BePipelineState::FixedFunctionBits, the queue itself doesn't depend on d3d
+    expose static constexpr auto MakeKey(
+        const uint32_t pass,
+        const uint32_t shaderID,
+        const uint32_t stateBits,
+        const uint32_t materialID,
+        const uint32_t depthBucket
+    ) -> uint64_t {
+        const auto field = [](const uint64_t value, const uint32_t bits, const uint32_t shift) {
+            return (value & ((1ull << bits) - 1)) << shift;
+        };
+        return field(pass, PassBits, PassShift)
+             | field(shaderID, ShaderBits, ShaderShift)
+             | field(stateBits, StateBits, StateShift)
+             | field(materialID, MaterialBits, MaterialShift)
+             | field(depthBucket, DepthBits, 0);
+    }
+
+    // logarithmic in the distance to the viewer, near objects get the finer buckets
+    expose static auto DepthBucket(float distance) -> uint32_t;
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide std::vector<Item> _items;
+    hide std::vector<Item> _scratch;
+    hide Stats _stats;
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose auto Clear() -> void { _items.clear(); }
+    expose auto Reserve(const size_t count) -> void { _items.reserve(count); }
+    expose auto Push(const Item& item) -> void { _items.push_back(item); }
+
+    // stable lsd radix sort over the key bytes, bytes every key shares are skipped
+    expose auto Sort() -> void;
+    expose auto GetItems() const -> std::span<const Item> { return _items; }
+    expose auto GetStats() const -> const Stats& { return _stats; }
+};
@@ -4,10 +4,13 @@
 #include <scope_guard/scope_guard.hpp>
 #include <dxgi1_6.h>
 
+#include "BeAssetRegistry.h"
+#include "BeConstantRing.h"
 #include "BeModel.h"
 #include "BePipeline.h"
 #include "BeRenderPass.h"
 #include "BeShader.h"
+#include "BeStateCache.h"
 #include "Utils.h"
 
 auto BeRenderer::GetBestAdapter() -> ComPtr<IDXGIAdapter1> {
@@ -82,6 +85,20 @@ auto BeRenderer::LaunchDevice() -> void {
         &_context
     );
 
+    // partial constant buffer uploads (UpdateSubresource1 with a box) and constant buffer windows
+    // (*SetConstantBuffers1) need 11.1 runtime and driver support
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+    {
+        ComPtr<ID3D11DeviceContext1> context1;
+        const auto hasOptions =
+            SUCCEEDED(_context.As(&context1)) &&
+            SUCCEEDED(_device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options)));
+        if (!hasOptions)
+            options = {};
+        if (options.ConstantBufferPartialUpdate)
+            _context1 = std::move(context1);
+    }
+
     
     // DXGI interfaces
     Utils::Check
@@ -106,7 +123,10 @@ auto BeRenderer::LaunchDevice() -> void {
     Utils::Check << _factory->CreateSwapChainForHwnd(_device.Get(), hwnd, &scDesc, nullptr, nullptr, &_swapchain);
     Utils::Check << _factory->MakeWindowAssociation(hwnd, DXGI_MWA_NO_ALT_ENTER);
 
-    _pipeline = BePipeline::Create(_context);
+    _stateCache = BeStateCache::Create(_device);
+    _pipeline = BePipeline::Create(_context, _stateCache);
+    if (options.ConstantBufferOffsetting)
+        _constantRing = BeConstantRing::Create(_device, ConstantRingBytes, options.MapNoOverwriteOnDynamicConstantBuffer);
     
     ComPtr<ID3D11Texture2D> backBuffer;
     Utils::Check
@@ -120,25 +140,8 @@ auto BeRenderer::LaunchDevice() -> void {
     uniformBufferDescriptor.ByteWidth = sizeof(BeUniformBufferGPU);
     Utils::Check << _device->CreateBuffer(&uniformBufferDescriptor, nullptr, &_uniformBuffer);
     
-    D3D11_DEPTH_STENCIL_DESC depthStencilStateDescriptor = {};
-    depthStencilStateDescriptor.DepthEnable = true;
-    depthStencilStateDescriptor.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
-    depthStencilStateDescriptor.DepthFunc = D3D11_COMPARISON_LESS;
-    depthStencilStateDescriptor.StencilEnable = false;
-    Utils::Check << _device->CreateDepthStencilState(&depthStencilStateDescriptor, _defaultDepthStencilState.GetAddressOf());
-    _context->OMSetDepthStencilState(_defaultDepthStencilState.Get(), 1);
-
-    D3D11_RASTERIZER_DESC rasterDesc = {};
-    rasterDesc.FillMode = D3D11_FILL_SOLID;
-    rasterDesc.CullMode = D3D11_CULL_BACK;
-    rasterDesc.FrontCounterClockwise = FALSE;
-    rasterDesc.DepthClipEnable = TRUE;
-    Utils::Check << _device->CreateRasterizerState(&rasterDesc, _rasterizerCullBack.GetAddressOf());
-
-    rasterDesc.CullMode = D3D11_CULL_NONE;
-    Utils::Check << _device->CreateRasterizerState(&rasterDesc, _rasterizerCullNone.GetAddressOf());
-
-    _context->RSSetState(_rasterizerCullBack.Get());
+    // default blend/raster/depth, shaders and passes override them through BePipelineState
+    _pipeline->SetState(BePipelineState());
 }
 
 auto BeRenderer::AddRenderPass(BeRenderPass* renderPass) -> void {
@@ -161,6 +164,9 @@ auto BeRenderer::InitialisePasses() const -> void {
 auto BeRenderer::Render() -> void {
     Utils::BeDebugAnnotation frameAnnotation(_context, "Frame");
 
+    // between frames nothing is bound, recompiled shaders can be swapped in safely
+    BeAssetRegistry::ApplyShaderHotReload();
+
     // Set viewport
     D3D11_VIEWPORT viewport;
     viewport.TopLeftX = 0;
@@ -169,7 +175,7 @@ auto BeRenderer::Render() -> void {
     viewport.Height = static_cast<FLOAT>(_height);
     viewport.MinDepth = 0.0f;
     viewport.MaxDepth = 1.0f;
-    _context->RSSetViewports(1, &viewport);
+    _pipeline->SetViewport(viewport);
 
 
     const BeUniformBufferGPU uniformDataGpu(UniformData);
@@ -193,7 +199,7 @@ auto BeRenderer::Render() -> void {
     _context->DSSetConstantBuffers(0, 1, emptyBuffers);
     _context->PSSetConstantBuffers(0, 1, emptyBuffers);
 
-    _pipeline->ClearCache();
+    _pipeline->EndFrame();
     _drawEntries.clear();
     
     _swapchain->Present(1, 0);
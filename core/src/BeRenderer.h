@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include <d3d11.h>
+#include <d3d11_1.h>
 #include <dxgi1_2.h>
 #include <vector>
 #include <wrl/client.h>
@@ -12,7 +13,9 @@
 #include "BeBuffers.h"
 
 class BeWindow;
+class BeConstantRing;
 class BePipeline;
+class BeStateCache;
 class BeRenderPass;
 class BeShader;
 struct BeDrawSlice;
@@ -34,6 +37,8 @@ class BeRenderer {
     
     // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
     hide static auto GetBestAdapter() -> ComPtr<IDXGIAdapter1>;
+    // per-draw constants of a frame, 4096 blocks of 256 bytes
+    expose static constexpr uint32_t ConstantRingBytes = 1024 * 1024;
     
     
     // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -47,17 +52,17 @@ class BeRenderer {
     // dx11 core components
     ComPtr<ID3D11Device> _device;
     ComPtr<ID3D11DeviceContext> _context;
+    ComPtr<ID3D11DeviceContext1> _context1; // null without partial constant buffer updates
     ComPtr<IDXGIDevice> _dxgiDevice;
     ComPtr<IDXGIAdapter> _adapter;
     ComPtr<IDXGIFactory2> _factory;
     ComPtr<IDXGISwapChain1> _swapchain;
     ComPtr<ID3D11RenderTargetView> _backbufferTarget;
+    std::shared_ptr<BeStateCache> _stateCache = nullptr;
     std::shared_ptr<BePipeline> _pipeline = nullptr;
+    std::shared_ptr<BeConstantRing> _constantRing = nullptr; // null without constant buffer offsetting
 
     ComPtr<ID3D11Buffer> _uniformBuffer;
-    ComPtr<ID3D11DepthStencilState> _defaultDepthStencilState;
-    ComPtr<ID3D11RasterizerState> _rasterizerCullBack;
-    ComPtr<ID3D11RasterizerState> _rasterizerCullNone;
 
     ComPtr<ID3D11Buffer> _sharedVertexBuffer;
     ComPtr<ID3D11Buffer> _sharedIndexBuffer;
@@ -90,13 +95,15 @@ class BeRenderer {
 
     [[nodiscard]] auto GetDevice() const -> ComPtr<ID3D11Device> { return _device; }
     [[nodiscard]] auto GetContext() const -> ComPtr<ID3D11DeviceContext> { return _context; }
+    [[nodiscard]] auto GetContext1() const -> ComPtr<ID3D11DeviceContext1> { return _context1; }
+    [[nodiscard]] auto SupportsPartialConstantBufferUpdates() const -> bool { return _context1 != nullptr; }
     [[nodiscard]] auto GetPipeline() const -> std::shared_ptr<BePipeline> { return _pipeline; }
+    [[nodiscard]] auto GetStateCache() const -> std::shared_ptr<BeStateCache> { return _stateCache; }
+    [[nodiscard]] auto GetConstantRing() const -> std::shared_ptr<BeConstantRing> { return _constantRing; }
     [[nodiscard]] auto GetBackbufferTarget() const -> ComPtr<ID3D11RenderTargetView> { return _backbufferTarget; }
 
     [[nodiscard]] auto GetWidth () const -> uint32_t { return _width; }
     [[nodiscard]] auto GetHeight () const -> uint32_t { return _height; }
-    [[nodiscard]] auto GetRasterizerCullBack () const -> ComPtr<ID3D11RasterizerState> { return _rasterizerCullBack; }
-    [[nodiscard]] auto GetRasterizerCullNone () const -> ComPtr<ID3D11RasterizerState> { return _rasterizerCullNone; }
 
     expose
     auto SetModels(const std::vector<std::shared_ptr<BeModel>>& models) -> void;
@@ -0,0 +1,221 @@
+#pragma once
+#include <cstdint>
+#include <d3d11.h>
+#include <stdexcept>
+#include <string_view>
+
+// value type for sampler states. the string form used in @be-material declarations is
+//   filter-address[-cmp][-bias(x)][-black|-white|-transparent]
+//   filter:  point | linear | aniso | anisoN (N in 1..16, plain aniso is 16)
+//   address: wrap | clamp | mirror | border (the color token only matters for border)
+// e.g. "linear-clamp", "aniso8-wrap", "point-border-cmp-white", "linear-wrap-bias(-0.5)"
+struct BeSamplerDesc {
+    enum class Filter : uint8_t {
+        Point,
+        Linear,
+        Anisotropic,
+    };
+
+    enum class Address : uint8_t {
+        Wrap,
+        Clamp,
+        Mirror,
+        Border,
+    };
+
+    enum class BorderColor : uint8_t {
+        TransparentBlack,
+        OpaqueBlack,
+        OpaqueWhite,
+    };
+
+    Filter FilterMode = Filter::Linear;
+    Address AddressMode = Address::Clamp;
+    BorderColor Border = BorderColor::TransparentBlack;
+    bool Comparison = false;
+    uint8_t MaxAnisotropy = 1;
+    int16_t MipLODBias256 = 0; // lod bias in 1/256 steps, so the key stays exact
+
+    static constexpr uint8_t MaxSupportedAnisotropy = 16;
+
+    // throws std::invalid_argument, which fails compilation when evaluated at compile time
+    static constexpr auto Parse(std::string_view text) -> BeSamplerDesc;
+
+    // every field fits, so equal keys mean equal samplers
+    constexpr auto Key() const -> uint64_t {
+        return uint64_t(FilterMode)
+             | uint64_t(AddressMode) << 2
+             | uint64_t(Border) << 4
+             | uint64_t(Comparison) << 6
+             | uint64_t(MaxAnisotropy) << 8
+             | uint64_t(uint16_t(MipLODBias256)) << 16;
+    }
+
+    constexpr auto GetMipLODBias() const -> float { return float(MipLODBias256) / 256.0f; }
+
+    constexpr auto operator==(const BeSamplerDesc& other) const -> bool { return Key() == other.Key(); }
+
+    auto ToD3D() const -> D3D11_SAMPLER_DESC;
+
+    // parsing helpers /////////////////////////////////////////////////////////////////////////////////////////////////
+    static constexpr auto NextToken(std::string_view& text) -> std::string_view;
+    static constexpr auto ParseUnsigned(std::string_view text) -> uint32_t;
+    static constexpr auto ParseBias(std::string_view text) -> int16_t;
+};
+
+
+constexpr auto BeSamplerDesc::NextToken(std::string_view& text) -> std::string_view {
+    // '-' inside parentheses belongs to the argument, e.g. bias(-1)
+    size_t depth = 0;
+    size_t end = 0;
+    for (; end < text.size(); end++) {
+        if (text[end] == '(') depth++;
+        else if (text[end] == ')' && depth > 0) depth--;
+        else if (text[end] == '-' && depth == 0) break;
+    }
+
+    const auto token = text.substr(0, end);
+    text.remove_prefix(end < text.size() ? end + 1 : end);
+    return token;
+}
+
+constexpr auto BeSamplerDesc::ParseUnsigned(const std::string_view text) -> uint32_t {
+    if (text.empty())
+        throw std::invalid_argument("Sampler desc: expected a number");
+
+    uint32_t value = 0;
+    for (const char c : text) {
+        if (c < '0' || c > '9')
+            throw std::invalid_argument("Sampler desc: expected a number");
+        if (value > (UINT32_MAX - uint32_t(c - '0')) / 10)
+            throw std::invalid_argument("Sampler desc: number out of range");
+        value = value * 10 + uint32_t(c - '0');
+    }
+    return value;
+}
+
+constexpr auto BeSamplerDesc::ParseBias(std::string_view text) -> int16_t {
+    bool negative = false;
+    if (!text.empty() && (text.front() == '-' || text.front() == '+')) {
+        negative = text.front() == '-';
+        text.remove_prefix(1);
+    }
+
+    const auto dot = text.find('.');
+    const auto whole = ParseUnsigned(text.substr(0, dot));
+
+    // fraction rounded to 1/256
+    uint32_t fraction256 = 0;
+    if (dot != std::string_view::npos) {
+        const auto digits = text.substr(dot + 1);
+        uint64_t numerator = ParseUnsigned(digits);
+        uint64_t denominator = 1;
+        for (size_t i = 0; i < digits.size(); i++) denominator *= 10;
+        fraction256 = uint32_t((numerator * 256 + denominator / 2) / denominator);
+    }
+
+    // d3d clamps the bias to [-16, 15.99]
+    const auto magnitude = whole * 256 + fraction256;
+    if (magnitude > (negative ? 16u * 256 : 16u * 256 - 1))
+        throw std::invalid_argument("Sampler desc: bias out of range [-16, 16)");
+
+    return int16_t(negative ? -int32_t(magnitude) : int32_t(magnitude));
+}
+
+constexpr auto BeSamplerDesc::Parse(std::string_view text) -> BeSamplerDesc {
+    auto desc = BeSamplerDesc();
+
+    const auto filterToken = NextToken(text);
+    if (filterToken == "point") {
+        desc.FilterMode = Filter::Point;
+    } else if (filterToken == "linear") {
+        desc.FilterMode = Filter::Linear;
+    } else if (filterToken.starts_with("aniso")) {
+        desc.FilterMode = Filter::Anisotropic;
+        const auto level = filterToken.substr(5);
+        // range checked before narrowing, so aniso257 fails instead of wrapping around to 1
+        const auto anisotropy = level.empty() ? uint32_t(MaxSupportedAnisotropy) : ParseUnsigned(level);
+        if (anisotropy < 1 || anisotropy > MaxSupportedAnisotropy)
+            throw std::invalid_argument("Sampler desc: anisotropy must be in [1, 16]");
+        desc.MaxAnisotropy = uint8_t(anisotropy);
+    } else {
+        throw std::invalid_argument("Sampler desc: unknown filter, expected point, linear or anisoN");
+    }
+
+    const auto addressToken = NextToken(text);
+    if (addressToken == "wrap") {
+        desc.AddressMode = Address::Wrap;
+    } else if (addressToken == "clamp") {
+        desc.AddressMode = Address::Clamp;
+    } else if (addressToken == "mirror") {
+        desc.AddressMode = Address::Mirror;
+    } else if (addressToken == "border") {
+        desc.AddressMode = Address::Border;
+    } else {
+        throw std::invalid_argument("Sampler desc: unknown address, expected wrap, clamp, mirror or border");
+    }
+
+    while (!text.empty()) {
+        const auto token = NextToken(text);
+        if (token == "cmp") {
+            desc.Comparison = true;
+        } else if (token.starts_with("bias(") && token.ends_with(")")) {
+            desc.MipLODBias256 = ParseBias(token.substr(5, token.size() - 6));
+        } else if (token == "transparent") {
+            desc.Border = BorderColor::TransparentBlack;
+        } else if (token == "black") {
+            desc.Border = BorderColor::OpaqueBlack;
+        } else if (token == "white") {
+            desc.Border = BorderColor::OpaqueWhite;
+        } else {
+            throw std::invalid_argument("Sampler desc: unknown modifier, expected cmp, bias(x) or a border color");
+        }
+    }
+
+    return desc;
+}
+
+inline auto BeSamplerDesc::ToD3D() const -> D3D11_SAMPLER_DESC {
+    auto filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    switch (FilterMode) {
+        case Filter::Point:
+            filter = Comparison ? D3D11_FILTER_COMPARISON_MIN_MAG_MIP_POINT : D3D11_FILTER_MIN_MAG_MIP_POINT;
+            break;
+        case Filter::Linear:
+            filter = Comparison ? D3D11_FILTER_COMPARISON_MIN_MAG_MIP_LINEAR : D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+            break;
+        case Filter::Anisotropic:
+            filter = Comparison ? D3D11_FILTER_COMPARISON_ANISOTROPIC : D3D11_FILTER_ANISOTROPIC;
+            break;
+    }
+
+    auto address = D3D11_TEXTURE_ADDRESS_CLAMP;
+    switch (AddressMode) {
+        case Address::Wrap:   address = D3D11_TEXTURE_ADDRESS_WRAP;   break;
+        case Address::Clamp:  address = D3D11_TEXTURE_ADDRESS_CLAMP;  break;
+        case Address::Mirror: address = D3D11_TEXTURE_ADDRESS_MIRROR; break;
+        case Address::Border: address = D3D11_TEXTURE_ADDRESS_BORDER; break;
+    }
+
+    D3D11_SAMPLER_DESC samplerDesc = {};
+    samplerDesc.Filter = filter;
+    samplerDesc.AddressU = address;
+    samplerDesc.AddressV = address;
+    samplerDesc.AddressW = address;
+    samplerDesc.MipLODBias = GetMipLODBias();
+    samplerDesc.MaxAnisotropy = FilterMode == Filter::Anisotropic ? MaxAnisotropy : 1;
+    samplerDesc.ComparisonFunc = Comparison ? D3D11_COMPARISON_LESS : D3D11_COMPARISON_NEVER;
+    const float borderAlpha = Border == BorderColor::TransparentBlack ? 0.0f : 1.0f;
+    const float borderColor = Border == BorderColor::OpaqueWhite ? 1.0f : 0.0f;
+    samplerDesc.BorderColor[0] = borderColor;
+    samplerDesc.BorderColor[1] = borderColor;
+    samplerDesc.BorderColor[2] = borderColor;
+    samplerDesc.BorderColor[3] = borderAlpha;
+    samplerDesc.MinLOD = 0.0f;
+    samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+    return samplerDesc;
+}
+
+consteval auto operator""_sampler(const char* text, const size_t length) -> BeSamplerDesc {
+    return BeSamplerDesc::Parse(std::string_view(text, length));
+}
@@ -1,11 +1,16 @@
 ﻿#include "BeShader.h"
 
 #include <cassert>
-#include <d3dcompiler.h>
 #include <umbrellas/include-glm.h>
 
-#include "BeRenderer.h"
+#if BE_SHADER_COMPILER
+#include <d3dcompiler.h>
+#include <d3d11shader.h>
 #include "BeShaderIncludeHandler.hpp"
+#endif
+
+#include "BeAssetRegistry.h"
+#include "BeRenderer.h"
 #include "BeShaderTools.h"
 #include "Utils.h"
 #include <umbrellas/include-libassert.h>
@@ -13,36 +18,30 @@
 std::string BeShader::StandardShaderIncludePath = "src/shaders/";
 
 auto BeShader::Create(const std::filesystem::path& filePath, const BeRenderer& renderer) -> std::shared_ptr<BeShader> {
-    be_assert(
-        std::filesystem::exists(filePath), 
-        "Shader file doesn't exist: " + filePath.string()
-    );
+    auto compiled = Compile(filePath);
+    be_assert(compiled, compiled.error());
+    return Create(compiled.value(), renderer);
+}
+
+auto BeShader::Compile(const std::filesystem::path& filePath) -> std::expected<Compiled, std::string> {
+#if BE_SHADER_COMPILER
+    if (!std::filesystem::exists(filePath))
+        return std::unexpected("Shader file doesn't exist: " + filePath.string());
     
-    const auto& device = renderer.GetDevice();
-    auto shader = std::make_shared<BeShader>();
+    auto compiled = Compiled();
+    compiled.FilePath = filePath;
     
-    auto src = BeShaderTools::ReadFile(filePath);
+    const auto src = BeShaderTools::ReadFile(filePath);
     auto [header, shaderName] = BeShaderTools::ParseFor(src, "@be-shader:");
-    shader->Name = shaderName;
-    
-    BeShaderIncludeHandler includeHandler(
-        filePath.parent_path().string(),
-        StandardShaderIncludePath
-    );
+    compiled.Name = shaderName;
     
     if (header.contains("materials")) {
-        shader->HasMaterial = true;
-        const auto& materialLinksJson = header.at("materials");
-
-        for (const auto& materialLinkJson : materialLinksJson.items()) {
-
-            auto linkName = std::string(materialLinkJson.key());
-            auto schemeName = std::string(materialLinkJson.value()["scheme"]);
-            auto schemeSlot = uint8_t(materialLinkJson.value()["slot"]);
-
-            shader->_materialSchemeNames[linkName] = schemeName;
-            shader->_materialSlots[linkName] = schemeSlot;
-            shader->_materialSlotsByScheme[schemeName] = schemeSlot;
+        for (const auto& materialLinkJson : header.at("materials").items()) {
+            compiled.MaterialLinks.push_back({
+                .LinkName = std::string(materialLinkJson.key()),
+                .SchemeName = std::string(materialLinkJson.value()["scheme"]),
+                .Slot = uint8_t(materialLinkJson.value()["slot"]),
+            });
         }
     }
     
@@ -51,18 +50,60 @@ auto BeShader::Create(const std::filesystem::path& filePath, const BeRenderer& r
         const auto& topology = header.at("topology");
 
         if (topology == "triangle-list") {
-            shader->Topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+            compiled.State.Topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
         }
         else if (topology == "triangle-strip") {
-            shader->Topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+            compiled.State.Topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
         }
         else if (topology == "patch-list-3") {
-            shader->Topology = D3D11_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST;
+            compiled.State.Topology = D3D11_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST;
         }
         else {
             be_assert(false, "Unsupported topology", filePath);
         }
     }
+
+    if (header.contains("state")) {
+        const auto& state = header.at("state");
+        
+        if (state.contains("blend")) {
+            const auto& blend = state.at("blend");
+            if (blend == "opaque") compiled.State.Blend = BeBlendMode::Opaque;
+            else if (blend == "additive") compiled.State.Blend = BeBlendMode::Additive;
+            else if (blend == "additive-keep-alpha") compiled.State.Blend = BeBlendMode::AdditiveKeepAlpha;
+            else be_assert(false, "Unsupported blend mode", filePath);
+        }
+        if (state.contains("cull")) {
+            const auto& cull = state.at("cull");
+            if (cull == "back") compiled.State.Cull = BeCullMode::Back;
+            else if (cull == "none") compiled.State.Cull = BeCullMode::None;
+            else if (cull == "front") compiled.State.Cull = BeCullMode::Front;
+            else be_assert(false, "Unsupported cull mode", filePath);
+        }
+        if (state.contains("depth")) {
+            const auto& depth = state.at("depth");
+            if (depth == "less-write") compiled.State.Depth = BeDepthMode::LessWrite;
+            else if (depth == "less-read-only") compiled.State.Depth = BeDepthMode::LessReadOnly;
+            else if (depth == "off") compiled.State.Depth = BeDepthMode::Off;
+            else be_assert(false, "Unsupported depth mode", filePath);
+        }
+    }
+
+    if (header.contains("vertexLayout")) {
+        for (const std::string vertexSemanticName : header.at("vertexLayout"))
+            compiled.VertexLayout.push_back(vertexSemanticName);
+    }
+
+    if (header.contains("pixel")) {
+        be_assert(header.contains("targets"), "", filePath);
+        for (const auto& target : header.at("targets").items())
+            compiled.PixelTargets.emplace_back(target.key(), target.value().get<uint32_t>());
+    }
+    
+    BeShaderIncludeHandler includeHandler(
+        filePath.parent_path().string(),
+        StandardShaderIncludePath
+    );
     
     auto shaderErrMsgLambda = [&](const std::pair<HRESULT, ComPtr<ID3DBlob>>& err, const std::string& shaderStage) -> std::string {
         auto hrText = std::string (BeShaderTools::Trim(Utils::HResultToStr(err.first), " \n\r\t"));
@@ -79,24 +120,113 @@ auto BeShader::Create(const std::filesystem::path& filePath, const BeRenderer& r
         "\n"
         "Source code:\n\n" + src + "\n\n Source code end.";
     };
+
+    // keeps the blob alive in compiled and points the bytecode view at it
+    const auto keep = [&compiled](const ComPtr<ID3DBlob>& blob, std::span<const uint8_t>& view) {
+        compiled.Blobs.push_back(blob);
+        view = { static_cast<const uint8_t*>(blob->GetBufferPointer()), blob->GetBufferSize() };
+    };
     
     if (header.contains("vertex")) {
+        auto result = CompileBlob(src, std::string(header.at("vertex")).c_str(), "vs_5_0", &includeHandler);
+        if (!result)
+            return std::unexpected(shaderErrMsgLambda(result.error(), "vertex"));
+        keep(result.value(), compiled.VertexBytecode);
+        ReflectBindings(result.value(), BeShaderType::Vertex, compiled);
+
+        // the layout is validated against the input signature only, packages carry just that part
+        ComPtr<ID3DBlob> signature;
+        Utils::Check << D3DGetInputSignatureBlob(
+            result.value()->GetBufferPointer(),
+            result.value()->GetBufferSize(),
+            signature.GetAddressOf());
+        keep(signature, compiled.InputSignature);
+    }
+
+    if (header.contains("tesselation")) {
+        auto& tesselation = header.at("tesselation");
+        
+        auto hullResult = CompileBlob(src, std::string(tesselation.at("hull")).c_str(), "hs_5_0", &includeHandler);
+        if (!hullResult)
+            return std::unexpected(shaderErrMsgLambda(hullResult.error(), "hull"));
+        auto domainResult = CompileBlob(src, std::string(tesselation.at("domain")).c_str(), "ds_5_0", &includeHandler);
+        if (!domainResult)
+            return std::unexpected(shaderErrMsgLambda(domainResult.error(), "domain"));
+        keep(hullResult.value(), compiled.HullBytecode);
+        keep(domainResult.value(), compiled.DomainBytecode);
+        ReflectBindings(hullResult.value(), BeShaderType::Tesselation, compiled);
+        ReflectBindings(domainResult.value(), BeShaderType::Tesselation, compiled);
+    }
+
+    if (header.contains("pixel")) {
+        auto result = CompileBlob(src, std::string(header.at("pixel")).c_str(), "ps_5_0", &includeHandler);
+        if (!result)
+            return std::unexpected(shaderErrMsgLambda(result.error(), "pixel"));
+        keep(result.value(), compiled.PixelBytecode);
+        ReflectBindings(result.value(), BeShaderType::Pixel, compiled);
+    }
+
+    compiled.Includes = includeHandler.GetOpenedFiles();
+    return compiled;
+#else
+    return std::unexpected("Built without the shader compiler, can't compile " + filePath.string());
+#endif
+}
+
+auto BeShader::Create(const Compiled& compiled, const BeRenderer& renderer) -> std::shared_ptr<BeShader> {
+    const auto& filePath = compiled.FilePath;
+    
+    const auto& device = renderer.GetDevice();
+    auto shader = std::make_shared<BeShader>();
+    static uint32_t shaderCount = 0;
+    shader->UniqueID = ++shaderCount;
+    shader->Name = compiled.Name;
+    shader->FilePath = filePath;
+    shader->Includes = compiled.Includes;
+    shader->State = compiled.State;
+    shader->AnimatesGeometry = compiled.AnimatesGeometry;
+    shader->ConstantBufferStages = compiled.ConstantBufferStages;
+    shader->ResourceStages = compiled.ResourceStages;
+    shader->SamplerStages = compiled.SamplerStages;
+    
+    shader->HasMaterial = !compiled.MaterialLinks.empty();
+    for (const auto& [linkName, schemeName, schemeSlot] : compiled.MaterialLinks) {
+        shader->_materialSchemeNames[linkName] = schemeName;
+        shader->_materialSlots[linkName] = schemeSlot;
+        shader->_materialSlotsByScheme[schemeName] = schemeSlot;
+        if (BeAssetRegistry::HasMaterialScheme(schemeName))
+            shader->_materialSlotsBySchemePtr.emplace_back(BeAssetRegistry::GetMaterialScheme(schemeName), schemeSlot);
+    }
+    
+    if (!compiled.VertexBytecode.empty()) {
         shader->ShaderType = BeShaderType::Vertex;
 
-        auto vertexFunctionName = std::string(header.at("vertex"));
-        auto result = CompileBlob(src, vertexFunctionName.c_str(), "vs_5_0", &includeHandler);
-        be_assert(result, shaderErrMsgLambda(result.error(), "vertex"));
-        auto blob = result.value();
-        Utils::Check << device->CreateVertexShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, &shader->VertexShader);
+        const auto& bytecode = compiled.VertexBytecode;
+        Utils::Check << device->CreateVertexShader(bytecode.data(), bytecode.size(), nullptr, &shader->VertexShader);
 
         //input layout
-        if (header.contains("vertexLayout")) {
-            auto vertexLayoutJson = header["vertexLayout"];
-
+        if (!compiled.VertexLayout.empty()) {
             auto inputLayout = std::vector<D3D11_INPUT_ELEMENT_DESC>();
-            inputLayout.reserve(vertexLayoutJson.size());
+            inputLayout.reserve(compiled.VertexLayout.size());
+
+            for (const auto& vertexSemanticName : compiled.VertexLayout) {
+                // rows of the model matrix from the instance stream, see BePipeline::SetInstanceBuffer
+                if (vertexSemanticName == "instance-model") {
+                    for (UINT row = 0; row < 4; row++) {
+                        inputLayout.push_back({
+                            .SemanticName = "INSTANCE_MODEL",
+                            .SemanticIndex = row,
+                            .Format = DXGI_FORMAT_R32G32B32A32_FLOAT,
+                            .InputSlot = 1,
+                            .AlignedByteOffset = row * 16,
+                            .InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA,
+                            .InstanceDataStepRate = 1,
+                        });
+                    }
+                    shader->IsInstanced = true;
+                    continue;
+                }
 
-            for (const std::string vertexSemanticName : vertexLayoutJson) {
                 static const std::unordered_map<std::string, const char*> SemanticNames = {
                     {"position", "POSITION"},
                     {"normal", "NORMAL"},
@@ -137,48 +267,26 @@ auto BeShader::Create(const std::filesystem::path& filePath, const BeRenderer& r
                 inputLayout.push_back(elementDesc);
             }
 
-            Utils::Check << renderer.GetDevice()->CreateInputLayout(
-                inputLayout.data(),
-                static_cast<UINT>(inputLayout.size()),
-                blob->GetBufferPointer(),
-                blob->GetBufferSize(),
-                &shader->ComputedInputLayout);
+            shader->ComputedInputLayout = BeAssetRegistry::GetInputLayout(inputLayout, compiled.InputSignature);
         }
     }
 
-    if (header.contains("tesselation")) {
+    if (!compiled.HullBytecode.empty()) {
         shader->ShaderType = shader->ShaderType | BeShaderType::Tesselation;
 
-        auto& tesselation = header.at("tesselation");
-        auto hullFunctionName = std::string(tesselation.at("hull"));
-        auto domainFunctionName = std::string(tesselation.at("domain"));
-
-
-        auto hullResult = CompileBlob(src, hullFunctionName.c_str(), "hs_5_0", &includeHandler);
-        be_assert(hullResult, shaderErrMsgLambda(hullResult.error(), "hull"));
-        auto domainResult = CompileBlob(src, domainFunctionName.c_str(), "ds_5_0", &includeHandler); 
-        be_assert(domainResult, shaderErrMsgLambda(domainResult.error(), "domain"));
-        ComPtr<ID3DBlob> hullBlob = hullResult.value();
-        ComPtr<ID3DBlob> domainBlob = domainResult.value();
-        Utils::Check << device->CreateHullShader(hullBlob->GetBufferPointer(), hullBlob->GetBufferSize(), nullptr, &shader->HullShader);
-        Utils::Check << device->CreateDomainShader(domainBlob->GetBufferPointer(), domainBlob->GetBufferSize(), nullptr, &shader->DomainShader);
+        const auto& hullBytecode = compiled.HullBytecode;
+        const auto& domainBytecode = compiled.DomainBytecode;
+        Utils::Check << device->CreateHullShader(hullBytecode.data(), hullBytecode.size(), nullptr, &shader->HullShader);
+        Utils::Check << device->CreateDomainShader(domainBytecode.data(), domainBytecode.size(), nullptr, &shader->DomainShader);
     }
     
-    if (header.contains("pixel")) {
-        be_assert(header.contains("targets"), "", filePath);
+    if (!compiled.PixelBytecode.empty()) {
         shader->ShaderType = shader->ShaderType | BeShaderType::Pixel;
 
-        std::string pixelFunctionName = header.at("pixel");
-        auto result = CompileBlob(src, pixelFunctionName.c_str(), "ps_5_0", &includeHandler);
-        be_assert(result, shaderErrMsgLambda(result.error(), "pixel"));
-        auto blob = result.value();
-        Utils::Check << device->CreatePixelShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, &shader->PixelShader);
-
-        Json targets = header.at("targets");
-        for (const auto& target : targets.items()) {
-            const std::string& targetName = target.key();
-            uint32_t targetSlot = target.value().get<uint32_t>();
-            
+        const auto& bytecode = compiled.PixelBytecode;
+        Utils::Check << device->CreatePixelShader(bytecode.data(), bytecode.size(), nullptr, &shader->PixelShader);
+
+        for (const auto& [targetName, targetSlot] : compiled.PixelTargets) {
             be_assert(!shader->PixelTargets.contains(targetName), "", filePath);
             be_assert(!shader->PixelTargetsInverse.contains(targetSlot), "", filePath);
 
@@ -190,6 +298,58 @@ auto BeShader::Create(const std::filesystem::path& filePath, const BeRenderer& r
     return shader;
 }
 
+auto BeShader::GetMaterialSlotByScheme(const BeMaterialScheme& scheme) const -> uint8_t {
+    for (const auto& [registered, slot] : _materialSlotsBySchemePtr) {
+        if (registered.get() == &scheme)
+            return slot;
+    }
+    return GetMaterialSlotByScheme(scheme.Name);
+}
+
+#if BE_SHADER_COMPILER
+auto BeShader::ReflectBindings(const ComPtr<ID3DBlob>& blob, const BeShaderType stage, Compiled& compiled) -> void {
+    ComPtr<ID3D11ShaderReflection> reflection;
+    Utils::Check << D3DReflect(blob->GetBufferPointer(), blob->GetBufferSize(), IID_PPV_ARGS(&reflection));
+
+    D3D11_SHADER_DESC desc;
+    Utils::Check << reflection->GetDesc(&desc);
+
+    const auto mark = [stage](auto& stages, const UINT first, const UINT count) {
+        for (UINT slot = first; slot < first + count && slot < stages.size(); slot++)
+            stages[slot] = stages[slot] | stage;
+    };
+    
+    for (UINT i = 0; i < desc.BoundResources; i++) {
+        D3D11_SHADER_INPUT_BIND_DESC bindDesc;
+        Utils::Check << reflection->GetResourceBindingDesc(i, &bindDesc);
+
+        switch (bindDesc.Type) {
+            case D3D_SIT_CBUFFER:
+                mark(compiled.ConstantBufferStages, bindDesc.BindPoint, bindDesc.BindCount);
+                break;
+            case D3D_SIT_SAMPLER:
+                mark(compiled.SamplerStages, bindDesc.BindPoint, bindDesc.BindCount);
+                break;
+            case D3D_SIT_TBUFFER:
+            case D3D_SIT_TEXTURE:
+            case D3D_SIT_STRUCTURED:
+            case D3D_SIT_BYTEADDRESS:
+                mark(compiled.ResourceStages, bindDesc.BindPoint, bindDesc.BindCount);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // stages that place vertices and read the time move them with it
+    if (stage == BeShaderType::Vertex || stage == BeShaderType::Tesselation) {
+        D3D11_SHADER_VARIABLE_DESC variableDesc;
+        const auto time = reflection->GetVariableByName("_Time");
+        if (SUCCEEDED(time->GetDesc(&variableDesc)) && variableDesc.uFlags & D3D_SVF_USED)
+            compiled.AnimatesGeometry = true;
+    }
+}
+
 auto BeShader::CompileBlob(
     const std::string& src,
     const char* entrypointName,
@@ -221,3 +381,4 @@ std::expected <
     
     return shaderBlob;
 }
+#endif
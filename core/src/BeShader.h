@@ -1,18 +1,30 @@
 ﻿#pragma once
 
+#include <array>
 #include <d3d11.h>
 #include <expected>
 #include <filesystem>
+#include <memory>
+#include <span>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <nlohmann/json.hpp>
 #include <wrl/client.h>
 #include <umbrellas/access-modifiers.hpp>
+#include <umbrellas/json.h>
 
+#include "BePipelineState.h"
 #include "Utils.h"
 
+// 0 builds without d3dcompiler, shaders then only come from a cooked package (see BeAssetRegistry::LoadShaderPackage)
+#ifndef BE_SHADER_COMPILER
+#define BE_SHADER_COMPILER 1
+#endif
+
 class BeShaderIncludeHandler;
 class BeRenderer;
+class BeMaterialScheme;
 using Microsoft::WRL::ComPtr;
 
 enum class BeShaderType : uint8_t {
@@ -47,9 +59,46 @@ struct BeVertexElementDescriptor {
 };
 
 class BeShader {
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose struct MaterialLink {
+        std::string LinkName;
+        std::string SchemeName;
+        uint8_t Slot = 0;
+    };
+
+    // everything Create needs, resolved from the header and the compiled blobs. doesn't touch the device or the
+    // registry, so it can be produced off the main thread. comes from Compile or from a cooked BeShaderPackage
+    expose struct Compiled {
+        std::filesystem::path FilePath;
+        std::string Name;
+        BePipelineState State;
+
+        // views into Blobs when compiled from source, into the package otherwise
+        std::span<const uint8_t> VertexBytecode;
+        std::span<const uint8_t> HullBytecode;
+        std::span<const uint8_t> DomainBytecode;
+        std::span<const uint8_t> PixelBytecode;
+        std::span<const uint8_t> InputSignature;
+        std::vector<ComPtr<ID3DBlob>> Blobs;
+
+        std::vector<std::string> VertexLayout; // element names as written in the header, e.g. "position"
+        std::vector<MaterialLink> MaterialLinks;
+        std::vector<std::pair<std::string, uint32_t>> PixelTargets;
+        bool AnimatesGeometry = false; // a vertex or tesselation stage reads _Time
+
+        std::array<BeShaderType, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT> ConstantBufferStages {};
+        std::array<BeShaderType, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT> ResourceStages {};
+        std::array<BeShaderType, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT> SamplerStages {};
+
+        std::vector<std::filesystem::path> Includes;
+    };
+    
     // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
     expose static std::string StandardShaderIncludePath;
     expose static auto Create(const std::filesystem::path& filePath, const BeRenderer& renderer) -> std::shared_ptr<BeShader>;
+    expose static auto Create(const Compiled& compiled, const BeRenderer& renderer) -> std::shared_ptr<BeShader>;
+    // on error returns the message with the compiler output. always fails without BE_SHADER_COMPILER
+    expose static auto Compile(const std::filesystem::path& filePath) -> std::expected<Compiled, std::string>;
     
     /// @brief: What a hairy function, compiles shader source code
     /// @return std::expected. 
@@ -68,8 +117,12 @@ class BeShader {
     
     // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
     expose std::string Name;
+    expose uint32_t UniqueID = 0;
+    expose std::filesystem::path FilePath;
+    expose std::vector<std::filesystem::path> Includes; // files the compiler opened through the include handler
     expose BeShaderType ShaderType = BeShaderType::None;
-    expose D3D11_PRIMITIVE_TOPOLOGY Topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    expose BePipelineState State; // topology plus the optional "state" block of the header
+    expose bool AnimatesGeometry = false; // moves vertices over time, so its shadows change without its model changing
     expose ComPtr<ID3D11InputLayout> ComputedInputLayout;
     expose ComPtr<ID3D11VertexShader> VertexShader;
     expose ComPtr<ID3D11HullShader> HullShader;
@@ -77,11 +130,18 @@ class BeShader {
     expose ComPtr<ID3D11PixelShader> PixelShader;
     expose std::unordered_map<std::string, uint32_t> PixelTargets;
     expose std::unordered_map<uint32_t, std::string> PixelTargetsInverse;
+
+    // stages that actually read each slot, reflected from the compiled blobs
+    expose std::array<BeShaderType, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT> ConstantBufferStages {};
+    expose std::array<BeShaderType, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT> ResourceStages {};
+    expose std::array<BeShaderType, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT> SamplerStages {};
     
     expose bool HasMaterial = false;
+    expose bool IsInstanced = false; // reads its model matrix from the instance stream ("instance-model" in vertexLayout)
     hide std::unordered_map<std::string, std::string> _materialSchemeNames;
     hide std::unordered_map<std::string, uint8_t> _materialSlots;
     hide std::unordered_map<std::string, uint8_t> _materialSlotsByScheme;
+    hide std::vector<std::pair<std::shared_ptr<const BeMaterialScheme>, uint8_t>> _materialSlotsBySchemePtr;
 
     // lifecycle ///////////////////////////////////////////////////////////////////////////////////////////////////////
     expose BeShader() = default;
@@ -97,5 +157,10 @@ class BeShader {
     expose auto GetMaterialSlotByScheme (const std::string& schemeName) const -> uint8_t {
         return _materialSlotsByScheme.at(schemeName);
     }
+    // pointer compare over the registry schemes, falls back to the name for unregistered ones
+    expose auto GetMaterialSlotByScheme (const BeMaterialScheme& scheme) const -> uint8_t;
+
+    // internal ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide static auto ReflectBindings (const ComPtr<ID3DBlob>& blob, BeShaderType stage, Compiled& compiled) -> void;
 };
 
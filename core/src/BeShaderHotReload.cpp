@@ -0,0 +1,155 @@
+#include "BeShaderHotReload.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ranges>
+#include <utility>
+
+#include "BeAssetRegistry.h"
+#include "BeFileWatcher.h"
+#include "BePipeline.h"
+#include "BeRenderer.h"
+#include "BeShaderTools.h"
+
+auto BeShaderHotReload::Create() -> std::unique_ptr<BeShaderHotReload> {
+    auto reload = std::unique_ptr<BeShaderHotReload>(new BeShaderHotReload());
+    reload->RebuildDependencies();
+    return reload;
+}
+
+// out of line, the header only forward declares the watcher
+BeShaderHotReload::~BeShaderHotReload() = default;
+
+auto BeShaderHotReload::Apply(BeRenderer& renderer) -> void {
+    // IndexShaderFiles may have been called again since the graph was built
+    if (BeAssetRegistry::_shaderSources.size() != _indexedSourceCount)
+        RebuildDependencies();
+
+    for (const auto& file : _watcher->TakeSettledChanges()) {
+        const auto it = _dependents.find(file);
+        if (it == _dependents.end())
+            continue;
+
+        for (const auto& source : it->second) {
+            const auto running = std::ranges::any_of(_jobs, [&](const Job& job) { return job.Source == source; });
+            if (running)
+                _staleSources.insert(source);
+            else
+                StartJob(source);
+        }
+    }
+
+    if (_jobs.empty())
+        return;
+
+    // all or nothing, a change to a shared include never shows up in half of its shaders
+    for (const auto& job : _jobs) {
+        if (job.Result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return;
+    }
+    Swap(renderer);
+
+    for (const auto& source : std::exchange(_staleSources, {}))
+        StartJob(source);
+}
+
+auto BeShaderHotReload::RebuildDependencies() -> void {
+    const auto canonical = [](const std::filesystem::path& path) { return std::filesystem::weakly_canonical(path); };
+
+    _dependents.clear();
+    for (const auto& source : BeAssetRegistry::_shaderSources | std::views::keys)
+        _dependents[canonical(source)].insert(source);
+    for (const auto& shader : BeAssetRegistry::_shaders | std::views::values) {
+        for (const auto& include : shader->Includes)
+            _dependents[canonical(include)].insert(shader->FilePath);
+    }
+    _indexedSourceCount = BeAssetRegistry::_shaderSources.size();
+
+    auto directories = std::vector<std::filesystem::path>();
+    for (const auto& file : _dependents | std::views::keys)
+        directories.push_back(file.parent_path());
+    std::ranges::sort(directories);
+    const auto [first, last] = std::ranges::unique(directories);
+    directories.erase(first, last);
+
+    // a new watcher would drop the changes the old one hasn't reported yet
+    if (_watcher && directories == _watchedDirectories)
+        return;
+    _watcher = BeFileWatcher::Create(directories);
+    _watchedDirectories = std::move(directories);
+}
+
+auto BeShaderHotReload::StartJob(const std::filesystem::path& source) -> void {
+    auto result = std::async(std::launch::async, [source]() -> std::expected<Reloaded, std::string> {
+        // renames may leave the file missing for a moment
+        if (!std::filesystem::exists(source))
+            return std::unexpected("Source is gone: " + source.string());
+
+        auto reloaded = Reloaded();
+        reloaded.Source = BeShaderTools::ReadFile(source);
+        if (reloaded.Source.find("@be-shader:") == std::string::npos)
+            return reloaded;
+
+        auto compiled = BeShader::Compile(source);
+        if (!compiled)
+            return std::unexpected(compiled.error());
+        reloaded.Shader = std::move(compiled.value());
+        return reloaded;
+    });
+    _jobs.push_back({ source, std::move(result) });
+}
+
+auto BeShaderHotReload::Swap(BeRenderer& renderer) -> void {
+    auto results = std::vector<std::pair<std::filesystem::path, Reloaded>>();
+    for (auto& job : _jobs) {
+        auto result = job.Result.get();
+        if (!result) {
+            // the previous version stays in use until the source compiles again
+            (void)std::fprintf(stderr, "Shader hot reload failed: %s\n", result.error().c_str());
+            continue;
+        }
+        results.emplace_back(job.Source, std::move(result.value()));
+    }
+    _jobs.clear();
+
+    // materials are laid out after the scheme they were created with and can't follow a changed one.
+    // a batch that changes a scheme is refused as a whole, the old shaders and schemes stay in use
+    auto refused = false;
+    for (const auto& reloaded : results | std::views::values) {
+        for (const auto& [schemeName, json] : BeAssetRegistry::ParseMaterialSchemes(reloaded.Source)) {
+            const auto previous = BeAssetRegistry::_materialSchemeJsons.find(schemeName);
+            if (previous == BeAssetRegistry::_materialSchemeJsons.end() || previous->second == json)
+                continue;
+            (void)std::fprintf(stderr,
+                "Shader hot reload: material scheme '%s' changed, reload refused. restart to apply it\n",
+                schemeName.c_str());
+            refused = true;
+        }
+    }
+    if (refused)
+        return;
+
+    // schemes first, shaders resolve their material links against the registry. only new ones can be added here
+    for (const auto& [source, reloaded] : results) {
+        BeAssetRegistry::_shaderSources[source] = reloaded.Source;
+        (void)BeAssetRegistry::IndexMaterialSchemes(reloaded.Source);
+    }
+
+    for (const auto& [source, reloaded] : results) {
+        if (!reloaded.Shader)
+            continue;
+
+        const auto fresh = BeShader::Create(*reloaded.Shader, renderer);
+        // the copy takes the fresh UniqueID along, so whatever was cached against the old shader sees a new one
+        auto& registered = BeAssetRegistry::_shaders[fresh->Name];
+        if (registered)
+            *registered = *fresh;
+        else
+            registered = fresh;
+    }
+
+    // the shadow state may point at objects of the replaced shaders
+    renderer.GetPipeline()->ClearCache();
+    RebuildDependencies();
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <expected>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <umbrellas/access-modifiers.hpp>
+
+#include "BeShader.h"
+
+class BeFileWatcher;
+class BeRenderer;
+
+// recompiles indexed shader sources when they or anything they include change on disk.
+// compilation runs on worker threads, Apply swaps all finished results into the registry at once between frames.
+// shaders are overwritten in place, so models and passes holding them draw with the new version right away.
+// changing an existing material scheme isn't reloadable, materials can't follow it, such a batch is refused
+class BeShaderHotReload {
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+    struct Reloaded {
+        std::string Source;
+        std::optional<BeShader::Compiled> Shader; // empty for sources that only declare material schemes
+    };
+
+    struct Job {
+        std::filesystem::path Source; // as indexed
+        std::future<std::expected<Reloaded, std::string>> Result;
+    };
+
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose static auto Create() -> std::unique_ptr<BeShaderHotReload>;
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide std::unique_ptr<BeFileWatcher> _watcher;
+    hide std::vector<std::filesystem::path> _watchedDirectories;
+    hide size_t _indexedSourceCount = 0;
+
+    // canonical file path -> indexed sources that read it, themselves included
+    hide std::unordered_map<std::filesystem::path, std::unordered_set<std::filesystem::path>> _dependents;
+
+    hide std::vector<Job> _jobs;
+    hide std::unordered_set<std::filesystem::path> _staleSources; // changed again while their job was running
+
+    // lifetime ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide BeShaderHotReload() = default;
+    expose ~BeShaderHotReload();
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    // only call between frames, nothing may be bound through the pipeline
+    expose auto Apply(BeRenderer& renderer) -> void;
+
+    hide auto RebuildDependencies() -> void;
+    hide auto StartJob(const std::filesystem::path& source) -> void;
+    hide auto Swap(BeRenderer& renderer) -> void;
+};
@@ -3,12 +3,14 @@
 #include <string>
 #include <fstream>
 #include <filesystem>
+#include <vector>
 
 class BeShaderIncludeHandler : public ID3DInclude
 {
 private:
     std::filesystem::path _shaderDir;
     std::filesystem::path _globalIncludeDir;
+    std::vector<std::filesystem::path> _openedFiles;
 
 public:
     BeShaderIncludeHandler(const std::string& shaderDir, const std::string& globalIncludeDir)
@@ -50,6 +52,7 @@ public:
 
         *ppData = buffer.release();  // Transfer ownership
         *pBytes = static_cast<UINT>(fileSize);
+        _openedFiles.push_back(filePath);
         return S_OK;
     }
 
@@ -57,4 +60,7 @@ public:
         delete[] static_cast<const char*>(pData);
         return S_OK;
     }
+
+    // every file opened so far, with repeats when several stages include the same file
+    const std::vector<std::filesystem::path>& GetOpenedFiles() const { return _openedFiles; }
 };
@@ -0,0 +1,190 @@
+#include "BeShaderPackage.h"
+
+namespace {
+    // bounds checked cursor, the first failure sticks and every later read returns empty values
+    class PackageReader {
+    public:
+        explicit PackageReader(const std::span<const uint8_t> bytes) : _bytes(bytes) {}
+
+        auto Failed() const -> bool { return _failed; }
+        auto GetOffset() const -> size_t { return _offset; }
+
+        auto U8() -> uint8_t {
+            const auto bytes = Take(1);
+            return bytes.empty() ? 0 : bytes[0];
+        }
+
+        auto U32() -> uint32_t {
+            const auto bytes = Take(4);
+            if (bytes.empty())
+                return 0;
+            return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+        }
+
+        auto Bytes() -> std::span<const uint8_t> {
+            return Take(U32());
+        }
+
+        auto String() -> std::string_view {
+            const auto bytes = Bytes();
+            return { reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+        }
+
+        // counts come from the file, anything larger than the remaining bytes can't be real
+        auto Count() -> uint32_t {
+            const auto count = U32();
+            if (count > _bytes.size() - _offset)
+                _failed = true;
+            return _failed ? 0 : count;
+        }
+
+    private:
+        auto Take(const size_t size) -> std::span<const uint8_t> {
+            if (_failed || size > _bytes.size() - _offset) {
+                _failed = true;
+                return {};
+            }
+            const auto bytes = _bytes.subspan(_offset, size);
+            _offset += size;
+            return bytes;
+        }
+
+        std::span<const uint8_t> _bytes;
+        size_t _offset = 0;
+        bool _failed = false;
+    };
+
+    class PackageWriter {
+    public:
+        auto U8(const uint8_t value) -> void { _bytes.push_back(value); }
+
+        auto U32(const uint32_t value) -> void {
+            for (int shift = 0; shift < 32; shift += 8)
+                _bytes.push_back(uint8_t(value >> shift));
+        }
+
+        auto Bytes(const std::span<const uint8_t> bytes) -> void {
+            U32(static_cast<uint32_t>(bytes.size()));
+            _bytes.insert(_bytes.end(), bytes.begin(), bytes.end());
+        }
+
+        auto String(const std::string_view text) -> void {
+            Bytes({ reinterpret_cast<const uint8_t*>(text.data()), text.size() });
+        }
+
+        auto Take() -> std::vector<uint8_t> { return std::move(_bytes); }
+
+    private:
+        std::vector<uint8_t> _bytes;
+    };
+}
+
+auto BeShaderPackage::Read(const std::span<const uint8_t> bytes) -> std::expected<Contents, std::string> {
+    auto reader = PackageReader(bytes);
+    if (reader.U32() != Magic)
+        return std::unexpected("Not a shader package");
+    if (const auto version = reader.U32(); version != Version)
+        return std::unexpected("Shader package version " + std::to_string(version) + ", expected " + std::to_string(Version));
+
+    auto contents = Contents();
+    contents.Shaders.resize(reader.Count());
+    contents.Schemes.resize(reader.Count());
+
+    for (auto& shader : contents.Shaders) {
+        shader.Name = reader.String();
+        shader.FilePath = reader.String();
+        shader.Blend = reader.U8();
+        shader.Cull = reader.U8();
+        shader.Depth = reader.U8();
+        shader.Topology = reader.U32();
+        shader.AnimatesGeometry = reader.U8() != 0;
+
+        shader.VertexBytecode = reader.Bytes();
+        shader.HullBytecode = reader.Bytes();
+        shader.DomainBytecode = reader.Bytes();
+        shader.PixelBytecode = reader.Bytes();
+        shader.InputSignature = reader.Bytes();
+
+        shader.VertexLayout.resize(reader.Count());
+        for (auto& element : shader.VertexLayout)
+            element = reader.String();
+
+        shader.MaterialLinks.resize(reader.Count());
+        for (auto& link : shader.MaterialLinks) {
+            link.LinkName = reader.String();
+            link.SchemeName = reader.String();
+            link.Slot = reader.U8();
+        }
+
+        shader.Targets.resize(reader.Count());
+        for (auto& target : shader.Targets) {
+            target.Name = reader.String();
+            target.Slot = reader.U32();
+        }
+
+        shader.ConstantBufferStages = reader.Bytes();
+        shader.ResourceStages = reader.Bytes();
+        shader.SamplerStages = reader.Bytes();
+    }
+
+    for (auto& scheme : contents.Schemes) {
+        scheme.Name = reader.String();
+        scheme.Json = reader.Bytes();
+    }
+
+    if (reader.Failed())
+        return std::unexpected("Shader package is truncated or corrupt near byte " + std::to_string(reader.GetOffset()));
+    return contents;
+}
+
+auto BeShaderPackage::Write(const Contents& contents) -> std::vector<uint8_t> {
+    auto writer = PackageWriter();
+    writer.U32(Magic);
+    writer.U32(Version);
+    writer.U32(static_cast<uint32_t>(contents.Shaders.size()));
+    writer.U32(static_cast<uint32_t>(contents.Schemes.size()));
+
+    for (const auto& shader : contents.Shaders) {
+        writer.String(shader.Name);
+        writer.String(shader.FilePath);
+        writer.U8(shader.Blend);
+        writer.U8(shader.Cull);
+        writer.U8(shader.Depth);
+        writer.U32(shader.Topology);
+        writer.U8(shader.AnimatesGeometry ? 1 : 0);
+
+        writer.Bytes(shader.VertexBytecode);
+        writer.Bytes(shader.HullBytecode);
+        writer.Bytes(shader.DomainBytecode);
+        writer.Bytes(shader.PixelBytecode);
+        writer.Bytes(shader.InputSignature);
+
+        writer.U32(static_cast<uint32_t>(shader.VertexLayout.size()));
+        for (const auto& element : shader.VertexLayout)
+            writer.String(element);
+
+        writer.U32(static_cast<uint32_t>(shader.MaterialLinks.size()));
+        for (const auto& link : shader.MaterialLinks) {
+            writer.String(link.LinkName);
+            writer.String(link.SchemeName);
+            writer.U8(link.Slot);
+        }
+
+        writer.U32(static_cast<uint32_t>(shader.Targets.size()));
+        for (const auto& target : shader.Targets) {
+            writer.String(target.Name);
+            writer.U32(target.Slot);
+        }
+
+        writer.Bytes(shader.ConstantBufferStages);
+        writer.Bytes(shader.ResourceStages);
+        writer.Bytes(shader.SamplerStages);
+    }
+
+    for (const auto& scheme : contents.Schemes) {
+        writer.String(scheme.Name);
+        writer.Bytes(scheme.Json);
+    }
+
+    return writer.Take();
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <umbrellas/access-modifiers.hpp>
+
+// cooked shaders and material schemes in one binary file, so loading them needs neither the sources nor d3dcompiler.
+// only deals with bytes and doesn't include anything platform specific, the format is little endian without padding:
+//   header:  magic u32, version u32, shader count u32, scheme count u32
+//   shader:  name, file path, blend u8, cull u8, depth u8, topology u32, animates geometry u8,
+//            vs, hs, ds, ps bytecode, vs input signature, vertex layout, material links, targets,
+//            constant buffer, resource and sampler stage tables (BeShaderType per slot)
+//   scheme:  name, @be-material json as msgpack
+//   strings and byte arrays are a u32 size followed by the bytes, lists a u32 count followed by the items
+class BeShaderPackage {
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose struct MaterialLink {
+        std::string_view LinkName;
+        std::string_view SchemeName;
+        uint8_t Slot = 0;
+    };
+
+    expose struct Target {
+        std::string_view Name;
+        uint32_t Slot = 0;
+    };
+
+    expose struct Shader {
+        std::string_view Name;
+        std::string_view FilePath;
+        uint8_t Blend = 0;
+        uint8_t Cull = 0;
+        uint8_t Depth = 0;
+        uint32_t Topology = 0;
+        bool AnimatesGeometry = false;
+
+        std::span<const uint8_t> VertexBytecode;
+        std::span<const uint8_t> HullBytecode;
+        std::span<const uint8_t> DomainBytecode;
+        std::span<const uint8_t> PixelBytecode;
+        std::span<const uint8_t> InputSignature;
+
+        std::vector<std::string_view> VertexLayout;
+        std::vector<MaterialLink> MaterialLinks;
+        std::vector<Target> Targets;
+
+        std::span<const uint8_t> ConstantBufferStages;
+        std::span<const uint8_t> ResourceStages;
+        std::span<const uint8_t> SamplerStages;
+    };
+
+    expose struct Scheme {
+        std::string_view Name;
+        std::span<const uint8_t> Json; // msgpack
+    };
+
+    // views only, whatever they point into has to outlive the contents
+    expose struct Contents {
+        std::vector<Shader> Shaders;
+        std::vector<Scheme> Schemes;
+    };
+
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose static constexpr uint32_t Magic = 'B' | 'E' << 8 | 'S' << 16 | 'P' << 24;
+    expose static constexpr uint32_t Version = 2;
+
+    // on error returns what was wrong and where, the bytes are never trusted
+    expose static auto Read(std::span<const uint8_t> bytes) -> std::expected<Contents, std::string>;
+    expose static auto Write(const Contents& contents) -> std::vector<uint8_t>;
+};
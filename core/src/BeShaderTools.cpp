@@ -14,6 +14,20 @@ auto BeShaderTools::ReadFile(const std::filesystem::path& path) -> std::string {
     return src;
 }
 
+auto BeShaderTools::ReadPathList(const std::filesystem::path& path) -> std::vector<std::filesystem::path> {
+    const auto src = ReadFile(path);
+    
+    auto paths = std::vector<std::filesystem::path>();
+    for (const auto line : Split(src, "\r\n")) {
+        if (line.find_first_not_of(" \t") == std::string_view::npos)
+            continue;
+        const auto trimmed = Trim(line, " \t");
+        if (trimmed.front() != '#')
+            paths.emplace_back(trimmed);
+    }
+    return paths;
+}
+
 auto BeShaderTools::ParseMaterialProperty(const std::string& text) -> ParsedMaterialProperty {
     auto result = ParsedMaterialProperty();
     
@@ -9,6 +9,8 @@
 class BeShaderTools {
     expose
     static auto ReadFile (const std::filesystem::path& path) -> std::string;
+    // one path per line, blank lines and lines starting with # are skipped
+    static auto ReadPathList (const std::filesystem::path& path) -> std::vector<std::filesystem::path>;
 
     struct ParsedMaterialProperty {
         std::string Name;
@@ -0,0 +1,124 @@
+#include "BeStateCache.h"
+
+#include "Utils.h"
+
+auto BeStateCache::Create(const ComPtr<ID3D11Device>& device) -> std::shared_ptr<BeStateCache> {
+    auto cache = std::shared_ptr<BeStateCache>(new BeStateCache());
+    cache->_device = device;
+    return cache;
+}
+
+auto BeStateCache::BlendDesc(const BeBlendMode mode) -> D3D11_BLEND_DESC {
+    D3D11_BLEND_DESC desc = {};
+    auto& target = desc.RenderTarget[0];
+    target.BlendEnable = FALSE;
+    target.SrcBlend = D3D11_BLEND_ONE;
+    target.DestBlend = D3D11_BLEND_ZERO;
+    target.BlendOp = D3D11_BLEND_OP_ADD;
+    target.SrcBlendAlpha = D3D11_BLEND_ONE;
+    target.DestBlendAlpha = D3D11_BLEND_ZERO;
+    target.BlendOpAlpha = D3D11_BLEND_OP_ADD;
+    target.RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+
+    switch (mode) {
+        case BeBlendMode::Opaque:
+            break;
+        case BeBlendMode::Additive:
+            target.BlendEnable = TRUE;
+            target.DestBlend = D3D11_BLEND_ONE;
+            target.DestBlendAlpha = D3D11_BLEND_ONE;
+            break;
+        case BeBlendMode::AdditiveKeepAlpha:
+            target.BlendEnable = TRUE;
+            target.DestBlend = D3D11_BLEND_ONE;
+            target.SrcBlendAlpha = D3D11_BLEND_ZERO;
+            target.DestBlendAlpha = D3D11_BLEND_ONE;
+            break;
+    }
+    return desc;
+}
+
+auto BeStateCache::RasterizerDesc(const BeCullMode cull) -> D3D11_RASTERIZER_DESC {
+    D3D11_RASTERIZER_DESC desc = {};
+    desc.FillMode = D3D11_FILL_SOLID;
+    desc.FrontCounterClockwise = FALSE;
+    desc.DepthClipEnable = TRUE;
+
+    switch (cull) {
+        case BeCullMode::Back:  desc.CullMode = D3D11_CULL_BACK;  break;
+        case BeCullMode::None:  desc.CullMode = D3D11_CULL_NONE;  break;
+        case BeCullMode::Front: desc.CullMode = D3D11_CULL_FRONT; break;
+    }
+    return desc;
+}
+
+auto BeStateCache::DepthStencilDesc(const BeDepthMode mode) -> D3D11_DEPTH_STENCIL_DESC {
+    D3D11_DEPTH_STENCIL_DESC desc = {};
+    desc.DepthEnable = TRUE;
+    desc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+    desc.DepthFunc = D3D11_COMPARISON_LESS;
+    desc.StencilEnable = FALSE;
+
+    switch (mode) {
+        case BeDepthMode::LessWrite:
+            break;
+        case BeDepthMode::LessReadOnly:
+            desc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+            break;
+        case BeDepthMode::Off:
+            desc.DepthEnable = FALSE;
+            desc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+            break;
+    }
+    return desc;
+}
+
+auto BeStateCache::GetBlendState(const D3D11_BLEND_DESC& desc) -> ID3D11BlendState* {
+    const auto hash = HashDesc(desc);
+    if (const auto state = _blendStates.Find(hash, desc))
+        return state;
+
+    ComPtr<ID3D11BlendState> state;
+    Utils::Check << _device->CreateBlendState(&desc, state.GetAddressOf());
+    _blendStates.IndicesByHash.emplace(hash, _blendStates.Entries.size());
+    _blendStates.Entries.emplace_back(desc, state);
+    return state.Get();
+}
+
+auto BeStateCache::GetRasterizerState(const D3D11_RASTERIZER_DESC& desc) -> ID3D11RasterizerState* {
+    const auto hash = HashDesc(desc);
+    if (const auto state = _rasterizerStates.Find(hash, desc))
+        return state;
+
+    ComPtr<ID3D11RasterizerState> state;
+    Utils::Check << _device->CreateRasterizerState(&desc, state.GetAddressOf());
+    _rasterizerStates.IndicesByHash.emplace(hash, _rasterizerStates.Entries.size());
+    _rasterizerStates.Entries.emplace_back(desc, state);
+    return state.Get();
+}
+
+auto BeStateCache::GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC& desc) -> ID3D11DepthStencilState* {
+    const auto hash = HashDesc(desc);
+    if (const auto state = _depthStencilStates.Find(hash, desc))
+        return state;
+
+    ComPtr<ID3D11DepthStencilState> state;
+    Utils::Check << _device->CreateDepthStencilState(&desc, state.GetAddressOf());
+    _depthStencilStates.IndicesByHash.emplace(hash, _depthStencilStates.Entries.size());
+    _depthStencilStates.Entries.emplace_back(desc, state);
+    return state.Get();
+}
+
+auto BeStateCache::Resolve(const BePipelineState& state) -> const ResolvedState& {
+    // topology doesn't take part in the objects, resolve under a key without it
+    const auto key = state.Key() & 0x00FFFFFFu;
+    if (const auto it = _resolvedByKey.find(key); it != _resolvedByKey.end())
+        return it->second;
+
+    const auto resolved = ResolvedState {
+        .Blend = GetBlendState(BlendDesc(state.Blend)),
+        .Rasterizer = GetRasterizerState(RasterizerDesc(state.Cull)),
+        .DepthStencil = GetDepthStencilState(DepthStencilDesc(state.Depth)),
+    };
+    return _resolvedByKey.emplace(key, resolved).first->second;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstring>
+#include <d3d11.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <wrl/client.h>
+#include <umbrellas/access-modifiers.hpp>
+
+#include "BePipelineState.h"
+
+using Microsoft::WRL::ComPtr;
+
+// deduplicates immutable d3d state objects by their full description.
+// descriptions are hashed bytewise, so build them zero-initialised ( = {} ) before filling them in
+class BeStateCache {
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template <typename TDesc, typename TState>
+    struct Table {
+        std::unordered_multimap<uint64_t, size_t> IndicesByHash; // fnv-1a of the description bytes
+        std::vector<std::pair<TDesc, ComPtr<TState>>> Entries;
+
+        auto Find(uint64_t hash, const TDesc& desc) const -> TState*;
+    };
+    
+    expose struct ResolvedState {
+        ID3D11BlendState* Blend = nullptr;
+        ID3D11RasterizerState* Rasterizer = nullptr;
+        ID3D11DepthStencilState* DepthStencil = nullptr;
+    };
+
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose static auto Create(const ComPtr<ID3D11Device>& device) -> std::shared_ptr<BeStateCache>;
+
+    expose static auto BlendDesc(BeBlendMode mode) -> D3D11_BLEND_DESC;
+    expose static auto RasterizerDesc(BeCullMode cull) -> D3D11_RASTERIZER_DESC;
+    expose static auto DepthStencilDesc(BeDepthMode mode) -> D3D11_DEPTH_STENCIL_DESC;
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide ComPtr<ID3D11Device> _device;
+    hide Table<D3D11_BLEND_DESC, ID3D11BlendState> _blendStates;
+    hide Table<D3D11_RASTERIZER_DESC, ID3D11RasterizerState> _rasterizerStates;
+    hide Table<D3D11_DEPTH_STENCIL_DESC, ID3D11DepthStencilState> _depthStencilStates;
+    hide std::unordered_map<uint32_t, ResolvedState> _resolvedByKey;
+
+    template <typename TDesc>
+    static auto HashDesc(const TDesc& desc) -> uint64_t;
+
+    // lifetime ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide BeStateCache() = default;
+    expose ~BeStateCache() = default;
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    // returned pointers stay valid for the lifetime of the cache
+    expose auto GetBlendState(const D3D11_BLEND_DESC& desc) -> ID3D11BlendState*;
+    expose auto GetRasterizerState(const D3D11_RASTERIZER_DESC& desc) -> ID3D11RasterizerState*;
+    expose auto GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC& desc) -> ID3D11DepthStencilState*;
+
+    // topology isn't a state object, it's ignored here
+    expose auto Resolve(const BePipelineState& state) -> const ResolvedState&;
+
+    expose auto GetStateObjectCount() const -> size_t {
+        return _blendStates.Entries.size() + _rasterizerStates.Entries.size() + _depthStencilStates.Entries.size();
+    }
+};
+
+
+template <typename TDesc, typename TState>
+auto BeStateCache::Table<TDesc, TState>::Find(const uint64_t hash, const TDesc& desc) const -> TState* {
+    const auto [begin, end] = IndicesByHash.equal_range(hash);
+    for (auto it = begin; it != end; ++it) {
+        const auto& [entryDesc, state] = Entries[it->second];
+        if (memcmp(&entryDesc, &desc, sizeof(TDesc)) == 0)
+            return state.Get();
+    }
+    return nullptr;
+}
+
+template <typename TDesc>
+auto BeStateCache::HashDesc(const TDesc& desc) -> uint64_t {
+    // fnv-1a
+    uint64_t hash = 14695981039346656037ull;
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&desc);
+    for (size_t i = 0; i < sizeof(TDesc); i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
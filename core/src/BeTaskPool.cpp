@@ -0,0 +1,80 @@
+#include "BeTaskPool.h"
+
+#include <algorithm>
+
+auto BeTaskPool::Create() -> std::shared_ptr<BeTaskPool> {
+    return Create(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+}
+
+auto BeTaskPool::Create(const uint32_t workerCount) -> std::shared_ptr<BeTaskPool> {
+    auto pool = std::shared_ptr<BeTaskPool>(new BeTaskPool());
+    pool->_workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; i++)
+        pool->_workers.emplace_back([pool = pool.get()] { pool->Run(); });
+    return pool;
+}
+
+BeTaskPool::~BeTaskPool() {
+    {
+        std::scoped_lock lock(_mutex);
+        _stopping = true;
+    }
+    _wake.notify_all();
+    for (auto& worker : _workers)
+        worker.join();
+}
+
+auto BeTaskPool::ParallelFor(const uint32_t chunkCount, const std::function<void(uint32_t)>& task) -> void {
+    if (_workers.empty() || chunkCount <= 1) {
+        for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+            task(chunk);
+        return;
+    }
+
+    {
+        std::scoped_lock lock(_mutex);
+        _task = &task;
+        _chunkCount = chunkCount;
+        _nextChunk = 0;
+        _doneChunks = 0;
+        _generation++;
+    }
+    _wake.notify_all();
+    RunChunks();
+
+    // workers that wake up late find no task and go back to sleep, the ones inside still hold on to it
+    std::unique_lock lock(_mutex);
+    _finished.wait(lock, [this] { return _doneChunks == _chunkCount; });
+    _task = nullptr;
+    _finished.wait(lock, [this] { return _activeWorkers == 0; });
+}
+
+auto BeTaskPool::Run() -> void {
+    auto seen = uint64_t(0);
+    while (true) {
+        std::unique_lock lock(_mutex);
+        _wake.wait(lock, [&] { return _stopping || (_task && _generation != seen); });
+        if (_stopping)
+            return;
+
+        seen = _generation;
+        _activeWorkers++;
+        lock.unlock();
+
+        RunChunks();
+
+        lock.lock();
+        if (--_activeWorkers == 0)
+            _finished.notify_all();
+    }
+}
+
+auto BeTaskPool::RunChunks() -> void {
+    for (auto chunk = _nextChunk++; chunk < _chunkCount; chunk = _nextChunk++) {
+        (*_task)(chunk);
+        if (++_doneChunks == _chunkCount) {
+            std::scoped_lock lock(_mutex);
+            _finished.notify_all();
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <umbrellas/access-modifiers.hpp>
+
+// a fixed set of worker threads for data parallel loops. the calling thread works along, so a pool of n workers runs
+// n + 1 chunks at once. one loop at a time, ParallelFor isn't reentrant and is meant to be called from one thread
+class BeTaskPool {
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    // one worker per hardware thread besides the calling one. 0 workers runs every loop on the calling thread
+    expose static auto Create() -> std::shared_ptr<BeTaskPool>;
+    expose static auto Create(uint32_t workerCount) -> std::shared_ptr<BeTaskPool>;
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide std::vector<std::thread> _workers;
+
+    hide std::mutex _mutex;
+    hide std::condition_variable _wake; // a loop started or the pool stops
+    hide std::condition_variable _finished; // a loop's last chunk is done or a worker left it
+    hide bool _stopping = false;
+    hide uint64_t _generation = 0; // loops started so far
+    hide const std::function<void(uint32_t)>* _task = nullptr; // while a loop runs
+    hide uint32_t _chunkCount = 0;
+    hide uint32_t _activeWorkers = 0; // inside the current loop
+    hide std::atomic<uint32_t> _nextChunk = 0;
+    hide std::atomic<uint32_t> _doneChunks = 0;
+
+    // lifetime ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide BeTaskPool() = default;
+    expose ~BeTaskPool();
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    // task(chunk) for every chunk below chunkCount, in any order and on any thread. returns once all of them are done
+    expose auto ParallelFor(uint32_t chunkCount, const std::function<void(uint32_t)>& task) -> void;
+
+    expose auto GetWorkerCount() const -> uint32_t { return static_cast<uint32_t>(_workers.size()); }
+
+    hide auto Run() -> void;
+    hide auto RunChunks() -> void;
+};
@@ -132,6 +132,7 @@ BeTexture::~BeTexture() = default;
 
 
 auto BeTexture::GetMipViewport(const uint32_t mip) const -> const D3D11_VIEWPORT& { return _mipViewports[mip]; }
+auto BeTexture::GetTexture() const -> ComPtr<ID3D11Texture2D> { return _texture; }
 auto BeTexture::GetSRV() const -> ComPtr<ID3D11ShaderResourceView> { return _srv; }
 auto BeTexture::GetDSV() const -> ComPtr<ID3D11DepthStencilView> { return _dsv; }
 auto BeTexture::GetRTV(const uint32_t mip) const -> ComPtr<ID3D11RenderTargetView> {
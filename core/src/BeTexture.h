@@ -87,6 +87,7 @@ class BeTexture {
 
     // public interface ////////////////////////////////////////////////////////////////////////////////////////////////
     expose auto GetMipViewport (const uint32_t mip) const              -> const D3D11_VIEWPORT&;
+    expose auto GetTexture     () const                                -> ComPtr<ID3D11Texture2D>;
     expose auto GetSRV         () const                                -> ComPtr<ID3D11ShaderResourceView>;
     expose auto GetDSV         () const                                -> ComPtr<ID3D11DepthStencilView>;
     expose auto GetRTV         (const uint32_t mip = 0) const          -> ComPtr<ID3D11RenderTargetView>;
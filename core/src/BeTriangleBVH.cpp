@@ -0,0 +1,427 @@
+#include "BeTriangleBVH.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <umbrellas/include-simd.h>
+
+// slab tests round, a box exactly touching the ray could otherwise be missed. 1 + 2 * gamma(3) as in pbrt
+static constexpr float RobustExit = 1.f + 2.f * 3.f * 0.5f * std::numeric_limits<float>::epsilon();
+static constexpr float Miss = std::numeric_limits<float>::infinity();
+
+auto BeTriangleBVH::Create(const std::span<const glm::vec3> corners) -> std::shared_ptr<BeTriangleBVH> {
+    auto bvh = std::shared_ptr<BeTriangleBVH>(new BeTriangleBVH());
+    const auto count = static_cast<uint32_t>(corners.size() / 3);
+    if (count == 0)
+        return bvh;
+    assert(count <= FirstMask + 1);
+
+    auto buildTriangles = std::vector<BuildTriangle>(count);
+    auto ids = std::vector<uint32_t>(count);
+    bvh->_bounds = buildTriangles[0].Box = { corners[0], corners[0] };
+    for (uint32_t i = 0; i < count; i++) {
+        const auto box = BeAABB { corners[i * 3], corners[i * 3] }
+            .Union({ corners[i * 3 + 1], corners[i * 3 + 1] })
+            .Union({ corners[i * 3 + 2], corners[i * 3 + 2] });
+        buildTriangles[i] = { .Box = box, .Centroid = (box.Min + box.Max) * 0.5f };
+        bvh->_bounds = bvh->_bounds.Union(box);
+        ids[i] = i;
+    }
+
+    bvh->_triangles.reserve(count);
+    bvh->_triangleIds.reserve(count);
+    bvh->_nodes.reserve(count * 2 / 3 + 1);
+    const auto root = bvh->BuildChild(buildTriangles, ids, corners, bvh->_bounds, 0);
+
+    // a mesh small enough to be one leaf still gets a root node, traversal always starts at one
+    if (root & LeafBit) {
+        auto& node = bvh->_nodes.emplace_back();
+        node.Children[0] = root;
+        node.Children[1] = LeafBit;
+        std::ranges::copy(std::array<uint16_t, 6> {0, 0, 0, 65535, 65535, 65535}, node.ChildBounds[0]);
+        std::ranges::fill(node.ChildBounds[1], uint16_t(0));
+    }
+    return bvh;
+}
+
+auto BeTriangleBVH::Quantize(const BeAABB& frame, const BeAABB& box, uint16_t (&bounds)[6]) -> void {
+    const auto step = (frame.Max - frame.Min) * (1.f / 65535.f);
+    for (int axis = 0; axis < 3; axis++) {
+        const auto steps = [&](const float distance) {
+            return step[axis] > 0.f ? std::clamp(std::floor(distance / step[axis]), 0.f, 65535.f) : 0.f;
+        };
+        bounds[axis] = static_cast<uint16_t>(steps(box.Min[axis] - frame.Min[axis]));
+        bounds[axis + 3] = static_cast<uint16_t>(65535.f - steps(frame.Max[axis] - box.Max[axis]));
+    }
+
+    // the estimate may be a step off after rounding, walk outwards until the box is covered
+    for (auto covered = false; !covered;) {
+        const auto dequantized = Dequantize(frame, bounds);
+        covered = true;
+        for (int axis = 0; axis < 3; axis++) {
+            if (dequantized.Min[axis] > box.Min[axis] && bounds[axis] > 0) {
+                bounds[axis]--;
+                covered = false;
+            }
+            if (dequantized.Max[axis] < box.Max[axis] && bounds[axis + 3] < 65535) {
+                bounds[axis + 3]++;
+                covered = false;
+            }
+        }
+    }
+}
+
+auto BeTriangleBVH::BuildChild(
+    const std::span<const BuildTriangle> buildTriangles,
+    const std::span<uint32_t> ids,
+    const std::span<const glm::vec3> corners,
+    const BeAABB& frame,
+    const uint32_t depth
+) -> uint32_t {
+    const auto count = static_cast<uint32_t>(ids.size());
+    const auto makeLeaf = [&] {
+        const auto first = static_cast<uint32_t>(_triangles.size());
+        for (const auto id : ids) {
+            const auto& a = corners[id * 3];
+            _triangles.push_back({ .Corner = a, .Edge1 = corners[id * 3 + 1] - a, .Edge2 = corners[id * 3 + 2] - a });
+            _triangleIds.push_back(id);
+        }
+        return LeafBit | count << CountShift | first;
+    };
+    if (count <= 2)
+        return makeLeaf();
+
+    auto box = buildTriangles[ids[0]].Box;
+    auto centroids = BeAABB { buildTriangles[ids[0]].Centroid, buildTriangles[ids[0]].Centroid };
+    for (const auto id : ids) {
+        box = box.Union(buildTriangles[id].Box);
+        centroids = centroids.Union({ buildTriangles[id].Centroid, buildTriangles[id].Centroid });
+    }
+
+    // binned sah: centroids go into bins along each axis, a split between two bins costs the area of either side
+    // times the triangles on it. traversing a node counts as much as testing one triangle
+    struct Bin {
+        BeAABB Box { glm::vec3(Miss), glm::vec3(-Miss) };
+        uint32_t Count = 0;
+    };
+    const auto extent = centroids.Max - centroids.Min;
+    const auto binOf = [&](const uint32_t id, const int axis) {
+        const auto relative = (buildTriangles[id].Centroid[axis] - centroids.Min[axis]) / extent[axis];
+        return std::min(static_cast<uint32_t>(relative * Bins), Bins - 1);
+    };
+
+    auto bestCost = Miss;
+    auto bestAxis = -1;
+    auto bestBin = 0u; // the last bin on the left side
+    for (int axis = 0; axis < 3 && depth < MaxDepth / 2; axis++) {
+        if (extent[axis] <= 0.f)
+            continue;
+
+        auto bins = std::array<Bin, Bins>();
+        for (const auto id : ids) {
+            auto& bin = bins[binOf(id, axis)];
+            bin.Box = bin.Box.Union(buildTriangles[id].Box);
+            bin.Count++;
+        }
+
+        auto rightCosts = std::array<float, Bins>();
+        auto rightBox = bins[Bins - 1].Box;
+        auto rightCount = 0u;
+        for (uint32_t i = Bins - 1; i > 0; i--) {
+            rightBox = rightBox.Union(bins[i].Box);
+            rightCount += bins[i].Count;
+            rightCosts[i - 1] = rightCount ? rightBox.SurfaceArea() * static_cast<float>(rightCount) : 0.f;
+        }
+
+        auto leftBox = bins[0].Box;
+        auto leftCount = 0u;
+        for (uint32_t i = 0; i + 1 < Bins; i++) {
+            leftBox = leftBox.Union(bins[i].Box);
+            leftCount += bins[i].Count;
+            if (leftCount == 0 || leftCount == count)
+                continue;
+
+            const auto cost = leftBox.SurfaceArea() * static_cast<float>(leftCount) + rightCosts[i];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = i;
+            }
+        }
+    }
+
+    const auto area = box.SurfaceArea();
+    const auto splitCost = area > 0.f ? 1.f + bestCost / area : Miss;
+    if (count <= MaxLeafTriangles && splitCost >= static_cast<float>(count))
+        return makeLeaf();
+
+    auto middle = ids.begin();
+    if (bestAxis >= 0) {
+        middle = std::partition(ids.begin(), ids.end(), [&](const uint32_t id) { return binOf(id, bestAxis) <= bestBin; });
+    }
+    else {
+        // nothing to bin on or deep enough that depth matters more than cost, halve along the widest axis
+        const auto axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+        middle = ids.begin() + count / 2;
+        std::nth_element(ids.begin(), middle, ids.end(), [&](const uint32_t a, const uint32_t b) {
+            return buildTriangles[a].Centroid[axis] < buildTriangles[b].Centroid[axis];
+        });
+    }
+
+    const auto node = static_cast<uint32_t>(_nodes.size());
+    _nodes.emplace_back();
+    const std::span<uint32_t> sides[2] = { { ids.begin(), middle }, { middle, ids.end() } };
+    for (int side = 0; side < 2; side++) {
+        auto sideBox = buildTriangles[sides[side][0]].Box;
+        for (const auto id : sides[side])
+            sideBox = sideBox.Union(buildTriangles[id].Box);
+
+        uint16_t bounds[6];
+        Quantize(frame, sideBox, bounds);
+        const auto child = BuildChild(buildTriangles, sides[side], corners, Dequantize(frame, bounds), depth + 1);
+        std::ranges::copy(bounds, _nodes[node].ChildBounds[side]);
+        _nodes[node].Children[side] = child;
+    }
+    return node;
+}
+
+auto BeTriangleBVH::Intersect(const BeRay& ray) const -> std::optional<BeRayHit> {
+    return Traverse<false>(ray);
+}
+
+auto BeTriangleBVH::IsOccluded(const BeRay& ray) const -> bool {
+    return Traverse<true>(ray).has_value();
+}
+
+template <bool AnyHit>
+auto BeTriangleBVH::Traverse(const BeRay& ray) const -> std::optional<BeRayHit> {
+    if (_nodes.empty())
+        return std::nullopt;
+
+    const auto inverse = 1.f / ray.Direction;
+    auto closest = ray.MaxDistance;
+    auto hit = std::optional<BeRayHit>();
+
+    // where the ray enters the box, Miss if it doesn't or only beyond the closest hit
+    const auto enter = [&](const BeAABB& box) {
+        const auto t0 = (box.Min - ray.Origin) * inverse;
+        const auto t1 = (box.Max - ray.Origin) * inverse;
+        const auto near = glm::min(t0, t1);
+        const auto far = glm::max(t0, t1);
+        const auto in = std::max(std::max(near.x, near.y), std::max(near.z, 0.f));
+        const auto out = std::min(std::min(far.x, far.y), far.z) * RobustExit;
+        return in <= out && in <= closest ? in : Miss;
+    };
+
+    // möller trumbore, both sides
+    const auto testLeaf = [&](const uint32_t leaf) {
+        const auto first = leaf & FirstMask;
+        const auto count = (leaf & ~LeafBit) >> CountShift;
+        for (auto i = first; i < first + count; i++) {
+            const auto& triangle = _triangles[i];
+            const auto p = glm::cross(ray.Direction, triangle.Edge2);
+            const auto determinant = glm::dot(triangle.Edge1, p);
+            if (determinant == 0.f)
+                continue;
+
+            const auto inverseDeterminant = 1.f / determinant;
+            const auto s = ray.Origin - triangle.Corner;
+            const auto u = glm::dot(s, p) * inverseDeterminant;
+            if (u < 0.f || u > 1.f)
+                continue;
+
+            const auto q = glm::cross(s, triangle.Edge1);
+            const auto v = glm::dot(ray.Direction, q) * inverseDeterminant;
+            if (v < 0.f || u + v > 1.f)
+                continue;
+
+            const auto t = glm::dot(triangle.Edge2, q) * inverseDeterminant;
+            if (t <= 0.f || t >= closest)
+                continue;
+
+            closest = t;
+            hit = BeRayHit { .Distance = t, .Triangle = _triangleIds[i], .Barycentrics = { u, v } };
+            if constexpr (AnyHit)
+                return;
+        }
+    };
+
+    struct Entry {
+        uint32_t Node;
+        BeAABB Frame;
+        float Enter;
+    };
+    std::array<Entry, MaxDepth> stack;
+    auto size = 0u;
+    if (const auto rootEnter = enter(_bounds); rootEnter != Miss)
+        stack[size++] = { 0, _bounds, rootEnter };
+
+    while (size > 0) {
+        const auto [index, frame, entered] = stack[--size];
+        if (entered > closest)
+            continue;
+
+        const auto& node = _nodes[index];
+        const BeAABB boxes[2] = { Dequantize(frame, node.ChildBounds[0]), Dequantize(frame, node.ChildBounds[1]) };
+        const float enters[2] = { enter(boxes[0]), enter(boxes[1]) };
+        const auto near = enters[0] <= enters[1] ? 0 : 1;
+
+        // leaves right away, nearer first. inner nodes onto the stack, nearer on top
+        for (const auto child : { near, 1 - near }) {
+            if (enters[child] == Miss || !(node.Children[child] & LeafBit))
+                continue;
+
+            testLeaf(node.Children[child]);
+            if (AnyHit && hit)
+                return hit;
+        }
+        for (const auto child : { 1 - near, near }) {
+            if (enters[child] > closest || node.Children[child] & LeafBit)
+                continue;
+
+            assert(size < MaxDepth);
+            stack[size++] = { node.Children[child], boxes[child], enters[child] };
+        }
+    }
+    return hit;
+}
+
+auto BeTriangleBVH::IntersectPacket(const std::span<const BeRay, 4> rays) const -> std::array<std::optional<BeRayHit>, 4> {
+    auto hits = std::array<std::optional<BeRayHit>, 4>();
+    if (_nodes.empty())
+        return hits;
+
+    // the four rays across the lanes of each register
+    const auto lanes = [&rays](auto member) {
+        return _mm_setr_ps(member(rays[0]), member(rays[1]), member(rays[2]), member(rays[3]));
+    };
+    const auto originX = lanes([](const BeRay& r) { return r.Origin.x; });
+    const auto originY = lanes([](const BeRay& r) { return r.Origin.y; });
+    const auto originZ = lanes([](const BeRay& r) { return r.Origin.z; });
+    const auto directionX = lanes([](const BeRay& r) { return r.Direction.x; });
+    const auto directionY = lanes([](const BeRay& r) { return r.Direction.y; });
+    const auto directionZ = lanes([](const BeRay& r) { return r.Direction.z; });
+    const auto one = _mm_set1_ps(1.f);
+    const auto zero = _mm_setzero_ps();
+    const auto inverseX = _mm_div_ps(one, directionX);
+    const auto inverseY = _mm_div_ps(one, directionY);
+    const auto inverseZ = _mm_div_ps(one, directionZ);
+    const auto robustExit = _mm_set1_ps(RobustExit);
+
+    auto closest = lanes([](const BeRay& r) { return r.MaxDistance; });
+    auto hitU = zero;
+    auto hitV = zero;
+    auto hitTriangle = _mm_set1_epi32(-1);
+    auto hitMask = zero;
+
+    // per lane entry distance, and which lanes enter at all
+    const auto enter = [&](const BeAABB& box, __m128& in) {
+        const auto slab = [](const float min, const float max, const __m128 origin, const __m128 inverse, __m128& near, __m128& far) {
+            const auto t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(min), origin), inverse);
+            const auto t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(max), origin), inverse);
+            near = _mm_max_ps(near, _mm_min_ps(t0, t1));
+            far = _mm_min_ps(far, _mm_max_ps(t0, t1));
+        };
+        auto near = zero;
+        auto far = _mm_set1_ps(Miss);
+        slab(box.Min.x, box.Max.x, originX, inverseX, near, far);
+        slab(box.Min.y, box.Max.y, originY, inverseY, near, far);
+        slab(box.Min.z, box.Max.z, originZ, inverseZ, near, far);
+        in = near;
+        return _mm_and_ps(_mm_cmple_ps(near, _mm_mul_ps(far, robustExit)), _mm_cmple_ps(near, closest));
+    };
+    const auto nearestLane = [](const __m128 in, const __m128 mask) {
+        auto masked = _mm_or_ps(_mm_and_ps(mask, in), _mm_andnot_ps(mask, _mm_set1_ps(Miss)));
+        masked = _mm_min_ps(masked, _mm_shuffle_ps(masked, masked, _MM_SHUFFLE(2, 3, 0, 1)));
+        masked = _mm_min_ps(masked, _mm_shuffle_ps(masked, masked, _MM_SHUFFLE(1, 0, 3, 2)));
+        return _mm_cvtss_f32(masked);
+    };
+
+    const auto testLeaf = [&](const uint32_t leaf) {
+        const auto first = leaf & FirstMask;
+        const auto count = (leaf & ~LeafBit) >> CountShift;
+        for (auto i = first; i < first + count; i++) {
+            const auto& triangle = _triangles[i];
+            const auto e1x = _mm_set1_ps(triangle.Edge1.x), e1y = _mm_set1_ps(triangle.Edge1.y), e1z = _mm_set1_ps(triangle.Edge1.z);
+            const auto e2x = _mm_set1_ps(triangle.Edge2.x), e2y = _mm_set1_ps(triangle.Edge2.y), e2z = _mm_set1_ps(triangle.Edge2.z);
+
+            const auto px = _mm_sub_ps(_mm_mul_ps(directionY, e2z), _mm_mul_ps(directionZ, e2y));
+            const auto py = _mm_sub_ps(_mm_mul_ps(directionZ, e2x), _mm_mul_ps(directionX, e2z));
+            const auto pz = _mm_sub_ps(_mm_mul_ps(directionX, e2y), _mm_mul_ps(directionY, e2x));
+            const auto determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+            const auto inverseDeterminant = _mm_div_ps(one, determinant);
+
+            const auto sx = _mm_sub_ps(originX, _mm_set1_ps(triangle.Corner.x));
+            const auto sy = _mm_sub_ps(originY, _mm_set1_ps(triangle.Corner.y));
+            const auto sz = _mm_sub_ps(originZ, _mm_set1_ps(triangle.Corner.z));
+            const auto u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverseDeterminant);
+
+            const auto qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+            const auto qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+            const auto qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+            const auto v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(directionX, qx), _mm_mul_ps(directionY, qy)), _mm_mul_ps(directionZ, qz)), inverseDeterminant);
+            const auto t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverseDeterminant);
+
+            auto mask = _mm_cmpneq_ps(determinant, zero);
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+            mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), one));
+            mask = _mm_and_ps(mask, _mm_cmpgt_ps(t, zero));
+            mask = _mm_and_ps(mask, _mm_cmplt_ps(t, closest));
+            if (_mm_movemask_ps(mask) == 0)
+                continue;
+
+            const auto select = [mask](const __m128 a, const __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); };
+            closest = select(t, closest);
+            hitU = select(u, hitU);
+            hitV = select(v, hitV);
+            hitTriangle = _mm_castps_si128(select(_mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(_triangleIds[i]))), _mm_castsi128_ps(hitTriangle)));
+            hitMask = _mm_or_ps(hitMask, mask);
+        }
+    };
+
+    struct Entry {
+        uint32_t Node;
+        BeAABB Frame;
+    };
+    std::array<Entry, MaxDepth> stack;
+    auto size = 0u;
+    auto rootIn = zero;
+    if (_mm_movemask_ps(enter(_bounds, rootIn)) != 0)
+        stack[size++] = { 0, _bounds };
+
+    while (size > 0) {
+        const auto [index, frame] = stack[--size];
+        const auto& node = _nodes[index];
+        const BeAABB boxes[2] = { Dequantize(frame, node.ChildBounds[0]), Dequantize(frame, node.ChildBounds[1]) };
+        __m128 ins[2];
+        const __m128 masks[2] = { enter(boxes[0], ins[0]), enter(boxes[1], ins[1]) };
+        const bool entered[2] = { _mm_movemask_ps(masks[0]) != 0, _mm_movemask_ps(masks[1]) != 0 };
+        const auto near = nearestLane(ins[0], masks[0]) <= nearestLane(ins[1], masks[1]) ? 0 : 1;
+
+        for (const auto child : { near, 1 - near }) {
+            if (entered[child] && node.Children[child] & LeafBit)
+                testLeaf(node.Children[child]);
+        }
+        for (const auto child : { 1 - near, near }) {
+            if (!entered[child] || node.Children[child] & LeafBit)
+                continue;
+
+            assert(size < MaxDepth);
+            stack[size++] = { node.Children[child], boxes[child] };
+        }
+    }
+
+    alignas(16) float distances[4], us[4], vs[4];
+    alignas(16) uint32_t triangles[4];
+    _mm_store_ps(distances, closest);
+    _mm_store_ps(us, hitU);
+    _mm_store_ps(vs, hitV);
+    _mm_store_si128(reinterpret_cast<__m128i*>(triangles), hitTriangle);
+    const auto hitBits = _mm_movemask_ps(hitMask);
+    for (int lane = 0; lane < 4; lane++) {
+        if (hitBits & (1 << lane))
+            hits[lane] = BeRayHit { .Distance = distances[lane], .Triangle = triangles[lane], .Barycentrics = { us[lane], vs[lane] } };
+    }
+    return hits;
+}
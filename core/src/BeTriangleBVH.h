@@ -0,0 +1,101 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+#include <umbrellas/access-modifiers.hpp>
+#include <umbrellas/include-glm.h>
+
+#include "BeAABBTree.h"
+
+struct BeRay {
+    glm::vec3 Origin;
+    glm::vec3 Direction; // not necessarily normalised, distances are in its units
+    float MaxDistance = std::numeric_limits<float>::max();
+};
+
+struct BeRayHit {
+    float Distance;
+    uint32_t Triangle; // in the order of the corners it was built from, for a model through its draw slices in order
+    glm::vec2 Barycentrics; // weights of the second and third corner
+};
+
+// bounding volume hierarchy over the triangles of one mesh, for ray casts on the cpu. built once with a binned surface
+// area heuristic and never changed. nodes are 32 bytes and hold both children's boxes quantised to 16 bits inside
+// their own box, which traversal carries down from the root, so a node and everything to test its children is one
+// read. triangles are stored in leaf order, ready for the intersection test
+class BeTriangleBVH {
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose static constexpr uint32_t Bins = 16;
+    expose static constexpr uint32_t MaxLeafTriangles = 8;
+    expose static constexpr uint32_t MaxDepth = 64;
+
+    // three corners per triangle, see BeModel::BuildTriangleBVH for a model's
+    expose static auto Create(std::span<const glm::vec3> corners) -> std::shared_ptr<BeTriangleBVH>;
+
+
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide struct Node {
+        uint16_t ChildBounds[2][6]; // min xyz, max xyz in 1/65535ths of this node's box, rounded outwards
+        uint32_t Children[2]; // inner node index, or LeafBit | count << CountShift | first triangle
+    };
+    static_assert(sizeof(Node) == 32);
+    hide static constexpr uint32_t LeafBit = 1u << 31;
+    hide static constexpr uint32_t CountShift = 27;
+    hide static constexpr uint32_t FirstMask = (1u << CountShift) - 1;
+
+    hide struct Triangle {
+        glm::vec3 Corner;
+        glm::vec3 Edge1;
+        glm::vec3 Edge2;
+    };
+
+    hide struct BuildTriangle {
+        BeAABB Box;
+        glm::vec3 Centroid;
+    };
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide BeAABB _bounds { glm::vec3(0.f), glm::vec3(0.f) };
+    hide std::vector<Node> _nodes; // 0 is the root
+    hide std::vector<Triangle> _triangles;
+    hide std::vector<uint32_t> _triangleIds; // the original number of each stored triangle
+
+    // lifetime ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide BeTriangleBVH() = default;
+    expose ~BeTriangleBVH() = default;
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    // the closest hit, both sides of a triangle count
+    expose auto Intersect(const BeRay& ray) const -> std::optional<BeRayHit>;
+    // any hit, stops at the first one
+    expose auto IsOccluded(const BeRay& ray) const -> bool;
+    // four rays at once with sse, worth it when they're coherent (neighbouring pixels, samples around a point)
+    expose auto IntersectPacket(std::span<const BeRay, 4> rays) const -> std::array<std::optional<BeRayHit>, 4>;
+
+    expose auto GetBounds() const -> const BeAABB& { return _bounds; }
+    expose auto GetNodeCount() const -> size_t { return _nodes.size(); }
+    expose auto GetTriangleCount() const -> size_t { return _triangles.size(); }
+
+    // the box a child's quantised bounds stand for. build and traversal both go through here so they agree bit for bit
+    hide static auto Dequantize(const BeAABB& frame, const uint16_t (&bounds)[6]) -> BeAABB {
+        // mins count up from the frame's min and maxes down from its max, so both ends are exact
+        const auto step = (frame.Max - frame.Min) * (1.f / 65535.f);
+        const auto up = glm::vec3(bounds[0], bounds[1], bounds[2]);
+        const auto down = glm::vec3(65535 - bounds[3], 65535 - bounds[4], 65535 - bounds[5]);
+        return { frame.Min + up * step, frame.Max - down * step };
+    }
+    hide static auto Quantize(const BeAABB& frame, const BeAABB& box, uint16_t (&bounds)[6]) -> void;
+    hide auto BuildChild(
+        std::span<const BuildTriangle> buildTriangles,
+        std::span<uint32_t> ids,
+        std::span<const glm::vec3> corners,
+        const BeAABB& frame,
+        uint32_t depth
+    ) -> uint32_t;
+    template <bool AnyHit> auto Traverse(const BeRay& ray) const -> std::optional<BeRayHit>;
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <immintrin.h>
+
+// functions using avx2 and fma intrinsics are marked with this and only called once BeFrustumCuller::HasAVX2 said so.
+// msvc allows the intrinsics anywhere, gcc and clang need the target spelled out
+#if defined(_MSC_VER)
+    #include <intrin.h>
+    #define BE_TARGET_AVX2
+#else
+    #define BE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
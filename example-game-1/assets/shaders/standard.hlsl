@@ -10,7 +10,7 @@
     "DiffuseTexture: texture2d(0) = white",
     "SpecularTexture: texture2d(1) = black",
 
-    "InputSampler: sampler(0) = linear-clamp",
+    "InputSampler: sampler(0) = aniso8-clamp",
     //"InputSampler: sampler(0) = point-clamp",
 ]
 @be-end
@@ -36,7 +36,7 @@
 
 */
 
-#include "objectMaterial.hlsl"
+#include <BeBRPObjectMaterial.hlsli>
 
 cbuffer ModelBuffer: register(b1) {
     StandardObjectData _Object;
@@ -40,7 +40,7 @@
 */
 
 #include <BeUniformBuffer.hlsli>
-#include "objectMaterial.hlsl"
+#include <BeBRPObjectMaterial.hlsli>
 
 cbuffer ModelBuffer: register(b1) {
     StandardObjectData _Object;
@@ -39,7 +39,7 @@
 */
 
 #include <BeUniformBuffer.hlsli>
-#include "objectMaterial.hlsl"
+#include <BeBRPObjectMaterial.hlsli>
 
 cbuffer ModelBuffer: register(b1) {
     StandardObjectData _Object;
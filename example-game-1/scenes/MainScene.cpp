@@ -60,7 +60,7 @@ auto MainScene::Prepare() -> void {
         "assets/shaders/standard.hlsl", 
         "assets/shaders/tessellated.hlsl", 
         "assets/shaders/terrain.hlsl", 
-        "assets/shaders/objectMaterial.hlsl", 
+        "src/shaders/BeBRPObjectMaterial.hlsli",
         "assets/shaders/fullscreen-vertex.hlsl", 
         "assets/shaders/directionalLight.hlsl", 
         "assets/shaders/pointLight.hlsl", 
@@ -20,7 +20,7 @@
 {
     "topology": "triangle-list",
     "vertex": "VertexFunction",
-    "vertexLayout": ["position", "normal" ],
+    "vertexLayout": ["position", "normal", "instance-model"],
     "pixel": "PixelFunction",
     "materials": {
         "geometry-object": { "scheme": "object-material-for-geometry-pass", "slot": 1 },
@@ -36,7 +36,7 @@
 
 */
 
-#include "objectMaterial.hlsl"
+#include <BeBRPObjectMaterial.hlsli>
 
 cbuffer ModelBuffer: register(b1) {
     StandardObjectData _Object;
@@ -56,6 +56,7 @@ Texture2D SpecularTexture : register(t1);
 struct VertexInput {
     float3 Position : POSITION;
     float3 Normal : NORMAL;
+    BeBRPInstanceInput Instance;
 };
 
 struct VertexOutput {
@@ -71,12 +72,13 @@ struct PixelOutput {
 };
 
 VertexOutput VertexFunction(VertexInput input) {
-    float4 worldPosition = mul(float4(input.Position, 1.0), _Object.Model);
+    float4x4 model = BeBRPInstanceModel(input.Instance);
+    float4 worldPosition = mul(float4(input.Position, 1.0), model);
 
     VertexOutput output;
     output.Position = mul(worldPosition, _Object.ProjectionView);
     output.WorldPosition = worldPosition.xyz;
-    output.Normal = normalize(mul(input.Normal, (float3x3)_Object.Model));
+    output.Normal = normalize(mul(input.Normal, (float3x3)model));
 
     return output;
 }
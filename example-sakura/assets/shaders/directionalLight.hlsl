@@ -22,6 +22,7 @@
 @be-shader: directional-light
 {
     "topology": "triangle-strip",
+    "state": { "blend": "additive" },
     "vertex": "FullscreenVertexKernel",
     "pixel": "PixelFunction",
     "materials": {
@@ -10,6 +10,7 @@
 @be-shader: emissive-add
 {
     "topology": "triangle-strip",
+    "state": { "blend": "additive" },
     "vertex": "FullscreenVertexKernel",
     "pixel": "PixelFunction",
     "materials": {
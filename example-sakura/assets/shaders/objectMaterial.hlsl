@@ -1,19 +0,0 @@
-
-/*
-
-@be-material: object-material-for-geometry-pass
-[
-    "Model: matrix",
-    "ProjectionView: matrix",
-    "ViewerPosition: float3 = [0, 0, 0]",
-]
-@be-end
-
-*/
-
-
-struct StandardObjectData {
-    row_major float4x4 Model;
-    row_major float4x4 ProjectionView;
-    float3 ViewerPosition;
-};
\ No newline at end of file
@@ -23,6 +23,7 @@
 @be-shader: point-light
 {
     "topology": "triangle-strip",
+    "state": { "blend": "additive" },
     "vertex": "FullscreenVertexKernel",
     "pixel": "PixelFunction",
     "materials": {
@@ -12,7 +12,7 @@
     "SpecularTexture: texture2d(1) = black",
     "EmissiveTexture: texture2d(2) = white",
 
-    "InputSampler: sampler(0) = linear-clamp",
+    "InputSampler: sampler(0) = aniso8-clamp",
     //"InputSampler: sampler(0) = point-clamp",
 ]
 @be-end
@@ -22,7 +22,7 @@
 {
     "topology": "triangle-list",
     "vertex": "VertexFunction",
-    "vertexLayout": ["position", "normal", "uv0"],
+    "vertexLayout": ["position", "normal", "uv0", "instance-model"],
     "pixel": "PixelFunction",
     "materials": {
         "geometry-object": { "scheme": "object-material-for-geometry-pass", "slot": 1 },
@@ -39,7 +39,7 @@
 
 */
 
-#include "objectMaterial.hlsl"
+#include <BeBRPObjectMaterial.hlsli>
 
 cbuffer ModelBuffer: register(b1) {
     StandardObjectData _Object;
@@ -61,6 +61,7 @@ struct VertexInput {
     float3 Position : POSITION;
     float3 Normal : NORMAL;
     float2 UV    : TEXCOORD0;
+    BeBRPInstanceInput Instance;
 };
 
 struct VertexOutput {
@@ -77,11 +78,12 @@ struct PixelOutput {
 };
 
 VertexOutput VertexFunction(VertexInput input) {
-    float4 worldPosition = mul(float4(input.Position, 1.0), _Object.Model);
+    float4x4 model = BeBRPInstanceModel(input.Instance);
+    float4 worldPosition = mul(float4(input.Position, 1.0), model);
     
     VertexOutput output;
     output.Position = mul(worldPosition, _Object.ProjectionView);
-    output.Normal = normalize(mul(input.Normal, (float3x3)_Object.Model));
+    output.Normal = normalize(mul(input.Normal, (float3x3)model));
     output.UV = input.UV;
 
     return output;
@@ -1,6 +1,16 @@
+#include <string_view>
+
+#include "BeAssetRegistry.h"
+#include "BeShaderTools.h"
 #include "Game.h"
+#include "scenes/MainScene.h"
+
+int main(const int argc, char** argv) {
 
-int main() {
+    // build step, see premake5.lua. builds without a shader compiler use shader-cook instead
+    if (argc == 3 && std::string_view(argv[1]) == "--cook-shaders") {
+        return BeAssetRegistry::CookShaderPackage(BeShaderTools::ReadPathList(MainScene::ShaderListPath), argv[2]) ? 0 : 1;
+    }
 
     const auto game = new Game();
     const auto result = game->Run();
@@ -10,7 +10,9 @@
 #include "BeModel.h"
 #include "BeRenderer.h"
 #include "BeShader.h"
+#include "BeShaderTools.h"
 #include "BeTexture.h"
+#include "BeTriangleBVH.h"
 #include "BeWindow.h"
 #include "basic-render-pipeline/BeBackbufferPass.h"
 #include "basic-render-pipeline/BeBloomPass.h"
@@ -57,20 +59,19 @@ auto MainScene::Prepare() -> void {
     .BuildNoReturn(device);
 
     BeAssetRegistry::InjectRenderer(_renderer);
-    BeAssetRegistry::IndexShaderFiles({ 
-        "assets/shaders/objectMaterial.hlsl", 
-        "assets/shaders/standard.hlsl",
-        "assets/shaders/checkerboard.hlsl",
-        "assets/shaders/fullscreen-vertex.hlsl", 
-        "assets/shaders/directionalLight.hlsl", 
-        "assets/shaders/pointLight.hlsl", 
-        "assets/shaders/emissive-add.hlsl",
-        "assets/shaders/BeBloomAdd.hlsl", 
-        "assets/shaders/BeBloomBright.hlsl", 
-        "assets/shaders/BeBloomKawase.hlsl", 
-        "assets/shaders/tonemapper.hlsl", 
-        "assets/shaders/backbuffer.hlsl", 
-    });
+#if BE_SHADER_COMPILER && defined(_DEBUG)
+    BeAssetRegistry::IndexShaderFiles(BeShaderTools::ReadPathList(ShaderListPath));
+    BeAssetRegistry::EnableShaderHotReload();
+#elif BE_SHADER_COMPILER
+    // release builds cook the package after linking, the sources are only a fallback
+    if (std::filesystem::exists(ShaderPackagePath))
+        BeAssetRegistry::LoadShaderPackage(ShaderPackagePath);
+    else
+        BeAssetRegistry::IndexShaderFiles(BeShaderTools::ReadPathList(ShaderListPath));
+#else
+    // nothing to compile sources with, shader-cook wrote the package after linking
+    BeAssetRegistry::LoadShaderPackage(ShaderPackagePath);
+#endif
     
     const auto standardShader = BeAssetRegistry::GetShader("standard");
     const auto checkerboardShader = BeAssetRegistry::GetShader("checkerboard");
@@ -88,10 +89,10 @@ auto MainScene::Prepare() -> void {
     
     _anvil = BeModel::Create("assets/anvil/anvil.fbx", standardShader, *_renderer);
     _anvil->Materials[0]->SetFloat3("SpecularColor", glm::vec3(1.0f));
-    _anvil->Materials[0]->SetSampler("InputSampler", BeAssetRegistry::GetSampler("point-clamp"));
+    _anvil->Materials[0]->SetSampler("InputSampler", BeAssetRegistry::GetSampler("point-clamp"_sampler));
 
     _sakura = BeModel::Create("assets/sakura/scene.gltf", standardShader, *_renderer);
-    _sakura->Materials[0]->SetSampler("InputSampler", BeAssetRegistry::GetSampler("linear-wrap"));
+    _sakura->Materials[0]->SetSampler("InputSampler", BeAssetRegistry::GetSampler("aniso8-wrap"_sampler));
     
     _sakura2 = BeModel::Create("assets/stylized_sakura_tree.glb", standardShader, *_renderer);
     //_sakura2->Materials[0]
@@ -239,16 +240,40 @@ auto MainScene::OnLoad() -> void {
     
     _renderer->InitialisePasses();
     
+    _spatialIndex.Connect<TransformComponent, RenderComponent>(_registry, [](const entt::registry& registry, const entt::entity entity) {
+        const auto [transform, render] = registry.try_get<TransformComponent, RenderComponent>(entity);
+        if (!transform || !render || !render->Model || !render->Model->HasBounds())
+            return std::optional<BeAABB>();
+
+        const auto model = BeBRPGeometryEntry::CalculateModelMatrix(transform->Position, transform->Rotation, transform->Scale);
+        return std::optional(BeAABB { render->Model->BoundsMin, render->Model->BoundsMax }.Transformed(model));
+    });
+    _submissionSync.Connect<TransformComponent, RenderComponent>(_registry, *_submissionBuffer, [](const entt::registry& registry, const entt::entity entity) {
+        const auto [transform, render] = registry.try_get<TransformComponent, RenderComponent>(entity);
+        if (!transform || !render || !render->Model)
+            return std::optional<BeBRPGeometryEntry>();
+
+        auto entry = BeBRPGeometryEntry();
+        entry.Model = render->Model;
+        entry.CastShadows = render->CastShadows;
+        entry.Occluder = render->Occluder;
+        entry.Static = render->Static;
+        entry.MinScreenSize = render->MinScreenSize;
+        entry.MinShadowScreenSize = render->MinShadowScreenSize;
+        entry.Lods = render->Lods;
+        entry.ModelMatrix = BeBRPGeometryEntry::CalculateModelMatrix(transform->Position, transform->Rotation, transform->Scale);
+        return std::optional(std::move(entry));
+    });
     
     CreateEntity(_registry
         ,NameComponent { .Name = "Cube" }
         ,TransformComponent { .Position = glm::vec3(15, -30, -15), .Rotation = glm::quat(), .Scale = glm::vec3(30) }
-        ,RenderComponent { .Model = _cube, .CastShadows = true }
+        ,RenderComponent { .Model = _cube, .CastShadows = true, .Occluder = true, .Static = true }
     );
 
     CreateEntity(_registry
         ,NameComponent { .Name = "Anvil1" }
-        ,RenderComponent { .Model = _anvil }
+        ,RenderComponent { .Model = _anvil, .Static = true }
         ,TransformComponent { 
             .Position = {0, 0, 0}, 
             .Rotation = glm::quat(glm::vec3(0, 45_rad, 0)), 
@@ -268,7 +293,7 @@ auto MainScene::OnLoad() -> void {
     
     CreateEntity(_registry
         ,NameComponent { .Name = "Sakura2" }
-        ,RenderComponent { .Model = _sakura2 }
+        ,RenderComponent { .Model = _sakura2, .Static = true }
         ,TransformComponent { 
             .Position = {-3.f, -5.5, 2}, 
             .Rotation = glm::quat(glm::vec3(0, 45.0_rad, 0)), 
@@ -341,6 +366,7 @@ auto MainScene::OnLoad() -> void {
             ,RenderComponent {
                 .Model = _emissiveCube,
                 .CastShadows = false,
+                .MinScreenSize = 1.f,
             }
         );
     }
@@ -348,7 +374,6 @@ auto MainScene::OnLoad() -> void {
 
 
 auto MainScene::Tick(float deltaTime) -> void {
-    static const auto GeometryView = _registry.view<TransformComponent, RenderComponent>();
     static const auto SunView = _registry.view<SunLightComponent>();
     static const auto PointLightView = _registry.view<TransformComponent, PointLightComponent>();
     
@@ -405,6 +430,7 @@ auto MainScene::Tick(float deltaTime) -> void {
         _renderer->UniformData.NearFarPlane = {_camera->NearPlane, _camera->FarPlane};
         _renderer->UniformData.ProjectionView = _camera->GetProjectionMatrix() * _camera->GetViewMatrix();
         _renderer->UniformData.CameraPosition = _camera->Position;
+        _renderer->UniformData.ScreenScale = _camera->GetScreenScale();
     }
 
     {
@@ -414,31 +440,22 @@ auto MainScene::Tick(float deltaTime) -> void {
             angle -= glm::two_pi<float>();
 
         auto i = size_t(0);
-        for (const auto [entity, transform, _] : PointLightView.each()) {
+        for (const auto entity : PointLightView) {
             constexpr float radius = 13.0f;
 
             const auto add = glm::two_pi<float>() * (static_cast<float>(i) / static_cast<float>(PointLightView.size_hint()));
             const auto rad = radius * (0.7f + 0.3f * ((i + 1) % 2));
             const auto pos = glm::vec3(cos(angle + add) * rad, 4.0f + 4.0f * (i % 2), sin(angle + add) * rad);
-            transform.Position = pos;
+            // patched, so the spatial index sees the move
+            _registry.patch<TransformComponent>(entity, [&pos](TransformComponent& t) { t.Position = pos; });
             
             i++;
         }
     }
 
+    // geometry is retained, only what was patched this frame is rebuilt
     _submissionBuffer->ClearEntries();
-    for (const auto [entity, transform, render] : GeometryView.each()) {
-        auto entry = BeBRPGeometryEntry();
-        entry.Model = render.Model;
-        entry.CastShadows = render.CastShadows;
-        entry.ModelMatrix = BeBRPGeometryEntry::CalculateModelMatrix(
-            transform.Position,
-            transform.Rotation,
-            transform.Scale
-        );
-        
-        _submissionBuffer->SubmitGeometry(entry);
-    }
+    _submissionSync.Flush();
     
     for (const auto [entity, sunLight] : SunView.each()) {
         auto entry = BeBRPSunLightEntry();
@@ -474,6 +491,22 @@ auto MainScene::Tick(float deltaTime) -> void {
     };
 }
 
+auto MainScene::RayCast(const BeRay& ray) const -> std::optional<std::pair<entt::entity, BeRayHit>> {
+    return _spatialIndex.RayCast<BeRayHit>(ray.Origin, ray.Direction, ray.MaxDistance, [&](const entt::entity entity, const float maxDistance) {
+        const auto& [transform, render] = _registry.get<TransformComponent, RenderComponent>(entity);
+        if (!render.Model->TriangleBVH)
+            return std::optional<BeRayHit>();
+
+        // into the model's space. the direction isn't normalised again, so distances stay the world's
+        const auto toLocal = glm::inverse(BeBRPGeometryEntry::CalculateModelMatrix(transform.Position, transform.Rotation, transform.Scale));
+        return render.Model->TriangleBVH->Intersect({
+            .Origin = glm::vec3(toLocal * glm::vec4(ray.Origin, 1.f)),
+            .Direction = glm::vec3(toLocal * glm::vec4(ray.Direction, 0.f)),
+            .MaxDistance = maxDistance,
+        });
+    });
+}
+
 
 
 
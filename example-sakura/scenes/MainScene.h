@@ -1,5 +1,6 @@
 #pragma once
 
+#include <filesystem>
 #include <memory>
 #include <string>
 #include <vector>
@@ -8,16 +9,21 @@
 
 #include "entt/entt.hpp"
 #include "BaseScene.h"
+#include "scenes/BeSpatialIndex.h"
+#include "scenes/BeSubmissionSync.h"
 
 class BeTexture;
 struct BeBRPPointLightEntry;
 struct BeBRPSunLightEntry;
 class BeBRPSubmissionBuffer;
+struct BeBRPModelLod;
 class BeWindow;
 class BeInput;
 class BeCamera;
 class BeRenderer;
 struct BeModel;
+struct BeRay;
+struct BeRayHit;
 struct BePointLight;
 struct BeDirectionalLight;
 
@@ -30,6 +36,12 @@ struct TransformComponent {
 struct RenderComponent {
     std::shared_ptr<BeModel> Model;
     bool CastShadows = true;
+    bool Occluder = false;
+    bool Static = false; // cached in shadow maps, see BeShadowPass
+    // in pixels on screen, see BeBRPDetailSelector
+    float MinScreenSize = 0.f;
+    float MinShadowScreenSize = 0.f;
+    std::shared_ptr<const std::vector<BeBRPModelLod>> Lods;
 };
 
 struct NameComponent {
@@ -73,7 +85,9 @@ auto CreateEntity(entt::registry& registry, Components&&... components) -> entt:
 class MainScene : public BaseScene {
     hide
     entt::registry _registry;
+    BeSpatialIndex _spatialIndex; // after the registry, it disconnects before the registry goes
     std::shared_ptr<BeBRPSubmissionBuffer> _submissionBuffer;
+    BeSubmissionSync _submissionSync; // after the registry and the buffer, same as the index
     std::shared_ptr<BeRenderer> _renderer;
     std::shared_ptr<BeWindow> _window;
     std::shared_ptr<BeCamera> _camera;
@@ -82,6 +96,10 @@ class MainScene : public BaseScene {
     std::shared_ptr<BeModel> _cube, _anvil, _sakura, _sakura2, _emissiveCube;
     
     expose
+    // everything the scene indexes, also what gets cooked into the package
+    static constexpr auto ShaderListPath = "assets/shaders.txt";
+    static constexpr auto ShaderPackagePath = "assets/shaders.bepkg";
+    
     MainScene(
         const std::shared_ptr<BeRenderer>& renderer,
         const std::shared_ptr<BeWindow>& window,
@@ -94,5 +112,8 @@ class MainScene : public BaseScene {
     auto Tick(float deltaTime) -> void override;
     
     auto GetRegistry() -> entt::registry& { return _registry; }
+    auto GetSpatialIndex() const -> const BeSpatialIndex& { return _spatialIndex; }
+    // the closest model surface along a world space ray, picking and line of sight
+    auto RayCast(const BeRay& ray) const -> std::optional<std::pair<entt::entity, BeRayHit>>;
     auto GetCamera() -> std::shared_ptr<BeCamera> { return _camera; }
 };
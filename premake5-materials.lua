@@ -0,0 +1,171 @@
+-- premake5-materials.lua
+-- generates C++ structs for @be-material schemes, packed the same way as HLSL cbuffers (and BeMaterialScheme)
+
+
+local materials = {}
+
+local typeInfo = {
+    float  = { size = 4,  cpp = "float" },
+    float2 = { size = 8,  cpp = "glm::vec2" },
+    float3 = { size = 12, cpp = "glm::vec3" },
+    float4 = { size = 16, cpp = "glm::vec4" },
+    matrix = { size = 64, cpp = "glm::mat4" },
+}
+
+local registerSize = 16
+
+
+local function toPascalCase(name)
+    return (name:gsub("[%-_ ]*(%w+)", function(word)
+        return word:sub(1, 1):upper() .. word:sub(2)
+    end))
+end
+
+-- only cbuffer properties matter here, textures and samplers are skipped
+local function parseSchemes(src)
+    local schemes = {}
+
+    for name, body in src:gmatch("@be%-material:%s*([%w%-_]+)%s*(%b[])") do
+        local properties = {}
+
+        for rawLine in body:gmatch("[^\n]+") do
+            local line = rawLine:gsub("//.*$", "")
+            for entry in line:gmatch('"([^"]*)"') do
+                local propertyName, propertyType = entry:match("^%s*([%w_]+)%s*:%s*(%w+)")
+                if propertyName and typeInfo[propertyType] then
+                    table.insert(properties, { name = propertyName, type = propertyType })
+                end
+            end
+        end
+
+        table.insert(schemes, { name = name, properties = properties })
+    end
+
+    return schemes
+end
+
+local function packLayout(properties)
+    local fields = {}
+    local offset = 0
+    local padCount = 0
+
+    local function pad(toOffset)
+        local floats = (toOffset - offset) // 4
+        if floats == 0 then return end
+        local declaration = floats == 1 and "float _pad%d;" or ("float _pad%d[" .. floats .. "];")
+        table.insert(fields, { declaration = declaration:format(padCount), offset = offset })
+        padCount = padCount + 1
+        offset = toOffset
+    end
+
+    for _, property in ipairs(properties) do
+        local size = typeInfo[property.type].size
+        local positionInRegister = offset % registerSize
+
+        if positionInRegister ~= 0 and positionInRegister + size > registerSize then
+            pad(offset - positionInRegister + registerSize)
+        end
+
+        table.insert(fields, {
+            name = property.name,
+            declaration = typeInfo[property.type].cpp .. " " .. property.name .. ";",
+            offset = offset,
+        })
+        offset = offset + size
+    end
+
+    local size = (offset + registerSize - 1) // registerSize * registerSize
+    pad(size)
+
+    return fields, size
+end
+
+local function generateHeader(sourceName, schemes)
+    local lines = {
+        "// generated by `premake5 materials` from " .. sourceName .. ", do not edit",
+        "#pragma once",
+        "#include <array>",
+        "#include <cstddef>",
+        "#include <string_view>",
+        "#include <utility>",
+        "#include <umbrellas/include-glm.h>",
+        "",
+        "namespace BeMaterialData {",
+    }
+
+    for _, scheme in ipairs(schemes) do
+        local typeName = toPascalCase(scheme.name)
+        local fields = packLayout(scheme.properties)
+
+        table.insert(lines, "")
+        table.insert(lines, "struct alignas(16) " .. typeName .. " {")
+        table.insert(lines, "    static constexpr std::string_view SchemeName = \"" .. scheme.name .. "\";")
+        table.insert(lines, "")
+        for _, field in ipairs(fields) do
+            table.insert(lines, "    " .. field.declaration)
+        end
+        -- the real offsets, BeMaterial::Data checks them against the scheme's layout at runtime
+        table.insert(lines, "")
+        table.insert(lines, "    static constexpr auto Fields() {")
+        table.insert(lines, "        return std::to_array<std::pair<std::string_view, std::size_t>>({")
+        for _, field in ipairs(fields) do
+            if field.name then
+                table.insert(lines, ("            { \"%s\", offsetof(%s, %s) },"):format(field.name, typeName, field.name))
+            end
+        end
+        table.insert(lines, "        });")
+        table.insert(lines, "    }")
+        table.insert(lines, "};")
+    end
+
+    table.insert(lines, "")
+    table.insert(lines, "}")
+    table.insert(lines, "")
+
+    return table.concat(lines, "\n")
+end
+
+local function writeIfChanged(filePath, content)
+    -- keeps timestamps intact so prebuild runs don't trigger recompiles
+    if os.isfile(filePath) and io.readfile(filePath) == content then
+        return
+    end
+
+    os.mkdir(path.getdirectory(filePath))
+    io.writefile(filePath, content)
+    print("Generated " .. filePath)
+end
+
+
+-- sourcePatterns: list of os.matchfiles patterns, outputDirectory: where <SourceName>.h headers go
+function materials.generate(sourcePatterns, outputDirectory)
+    local generated = {}
+
+    for _, pattern in ipairs(sourcePatterns) do
+        for _, sourcePath in ipairs(os.matchfiles(pattern)) do
+            local schemes = {}
+            for _, scheme in ipairs(parseSchemes(io.readfile(sourcePath))) do
+                -- schemes without cbuffer properties have no buffer to map onto
+                if #scheme.properties > 0 then
+                    table.insert(schemes, scheme)
+                end
+            end
+
+            if #schemes > 0 then
+                local fileName = path.getbasename(sourcePath) .. ".h"
+                local headerPath = path.join(outputDirectory, fileName)
+                writeIfChanged(headerPath, generateHeader(path.getname(sourcePath), schemes))
+                generated[fileName] = true
+            end
+        end
+    end
+
+    -- drop headers whose source or schemes are gone
+    for _, headerPath in ipairs(os.matchfiles(path.join(outputDirectory, "*.h"))) do
+        if not generated[path.getname(headerPath)] then
+            os.remove(headerPath)
+        end
+    end
+end
+
+return materials
@@ -11,6 +11,15 @@ local function cleanGenerated()
     os.rmdir("example-game-1/obj")
     os.rmdir("example-sakura/bin")
     os.rmdir("example-sakura/obj")
+    os.rmdir("tools/shader-cook/bin")
+    os.rmdir("tools/shader-cook/obj")
+    os.rmdir("tests/bin")
+    os.rmdir("tests/obj")
+    os.rmdir("benchmarks/bin")
+    os.rmdir("benchmarks/obj")
+    os.rmdir("toolkit/generated")
+    os.rmdir("example-game-1/generated")
+    os.rmdir("example-sakura/generated")
     os.remove("**.sln")
     os.remove("**.vcxproj")
     os.remove("**.vcxproj.filters")
@@ -19,8 +28,29 @@ local function cleanGenerated()
     os.remove("**.vcxitems.filters")
 end
 
+
+-- material structs generated from @be-material blocks, see premake5-materials.lua
+local materials = dofile(path.join(_MAIN_SCRIPT_DIR, "premake5-materials.lua"))
+
+local function generateMaterials()
+    local root = _MAIN_SCRIPT_DIR
+    materials.generate(
+        { path.join(root, "toolkit/basic-render-pipeline/shaders/*.hlsli") },
+        path.join(root, "toolkit/generated/materials")
+    )
+    materials.generate(
+        { path.join(root, "example-game-1/assets/shaders/*.hlsl") },
+        path.join(root, "example-game-1/generated/materials")
+    )
+    materials.generate(
+        { path.join(root, "example-sakura/assets/shaders/*.hlsl") },
+        path.join(root, "example-sakura/generated/materials")
+    )
+end
+
 if _ACTION == "vs2022" or _ACTION == "vs2019" then
     cleanGenerated()
+    generateMaterials()
 end
 
 newaction {
@@ -31,6 +61,21 @@ newaction {
     end
 }
 
+newaction {
+    trigger = "materials",
+    description = "Generate C++ structs for @be-material schemes",
+    onStart = function()
+        generateMaterials()
+    end
+}
+
+newoption {
+    trigger = "no-shader-compiler",
+    description = "Build the engine without d3dcompiler, shaders then come from a package cooked by shader-cook"
+}
+
+local generateMaterialsCommand = "\"%{wks.location}/premake5.exe\" --file=\"%{wks.location}/premake5.lua\" materials"
+
 
 
 -- workspace and project definitions
@@ -41,6 +86,13 @@ workspace "be"
     location "."
     startproject "example-quick-start"
 
+    -- the imgui dx11 backend still compiles its two shaders at runtime and links d3dcompiler on its own
+    filter "options:no-shader-compiler"
+        defines { "BE_SHADER_COMPILER=0" }
+        removelinks { "d3dcompiler" }
+
+    filter {}
+
 
 -- core
 project "core"
@@ -124,10 +176,12 @@ project "toolkit"
         "%{prj.location}/**.c",
         "%{prj.location}/**.h",
         "%{prj.location}/**.hpp",
+        "%{prj.location}/**.hlsli",
     }
 
     includedirs {
         "%{prj.location}",
+        "%{prj.location}/generated",
         "core/src",
         "vendor",
         "vendor/libassert/%{cfg.buildcfg}/include",
@@ -143,6 +197,8 @@ project "toolkit"
         "assimp-vc143-mt"
     }
 
+    prebuildcommands { generateMaterialsCommand }
+
     -- filter { "files:**.hlsl" }
     --     buildaction "None"
 
@@ -162,11 +218,216 @@ project "toolkit"
     filter {}
 
 
+-- shader cook tool, only with no-shader-compiler. the engine can't cook its own packages then, so this builds core
+-- from source a second time with the compiler on
+if _OPTIONS["no-shader-compiler"] then
+project "shader-cook"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++23"
+    location "tools/shader-cook"
+
+    targetdir ("%{prj.location}/bin/%{cfg.architecture}/%{cfg.buildcfg}")
+    objdir    ("%{prj.location}/obj/%{cfg.architecture}/%{cfg.buildcfg}")
+
+    files {
+        "%{prj.location}/**.cpp",
+        "core/src/**.cpp",
+        "core/src/**.c",
+        "core/src/**.h",
+        "core/src/**.hpp",
+    }
+
+    includedirs {
+        "core/src",
+        "core/src/shaders",
+        "vendor/libassert/%{cfg.buildcfg}/include",
+        "vendor/Assimp/include",
+        "vendor"
+    }
+    libdirs {
+        "vendor/glfw/lib-vc2022",
+        "vendor/libassert/%{cfg.buildcfg}/lib",
+        "vendor/Assimp/lib/x64"
+    }
+    links {
+        "glfw3",
+        "assimp-vc143-mt",
+        "d3d11",
+        "dxgi",
+        "d3dcompiler",
+        "assert",
+        "cpptrace",
+        "dbghelp"
+    }
+
+    defines { "LIBASSERT_STATIC_DEFINE" }
+    removedefines { "BE_SHADER_COMPILER=0" }
+
+    postbuildcommands {
+        "{COPY} %{wks.location}/vendor/Assimp/bin/x64/assimp-vc143-mt.dll %{cfg.targetdir}"
+    }
+
+    filter "configurations:Debug"
+        symbols "On"
+        defines { "DEBUG" }
+        optimize "Off"
+
+    filter "configurations:Release"
+        symbols "Off"
+        defines { "NDEBUG" }
+        optimize "Full"
+
+    filter { "toolset:msc*", "language:C++" }
+        buildoptions { "/Zc:__cplusplus /Zc:preprocessor" }
+
+    filter {}
+end
+
+
+-- tests, for the parts of core and the toolkit that don't touch D3D. they compile those sources themselves instead of
+-- linking core, so they also build outside of windows, e.g. `premake5 gmake --os=linux && make tests`
+local testedCoreFiles = {
+    "core/src/BeAABBTree.cpp",
+    "core/src/BeFrustumCuller.cpp",
+    "core/src/BeLinearRing.cpp",
+    "core/src/BeMappedFile.cpp",
+    "core/src/BeOcclusionBuffer.cpp",
+    "core/src/BeRenderQueue.cpp",
+    "core/src/BeShaderPackage.cpp",
+    "core/src/BeTaskPool.cpp",
+    "toolkit/basic-render-pipeline/BeBRPDetailSelector.cpp",
+    "toolkit/basic-render-pipeline/BeBRPInstancing.cpp",
+    "toolkit/basic-render-pipeline/BeBRPShadowCache.cpp",
+    "toolkit/basic-render-pipeline/BeBRPShadowScheduler.cpp",
+    "toolkit/basic-render-pipeline/BeBRPSubmissionBuffer.cpp",
+    "toolkit/scenes/BeParallelExtractor.cpp",
+}
+
+project "tests"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++23"
+    location "tests"
+    system (os.target())
+
+    targetdir ("%{prj.location}/bin/%{cfg.architecture}/%{cfg.buildcfg}")
+    objdir    ("%{prj.location}/obj/%{cfg.architecture}/%{cfg.buildcfg}")
+
+    files { "%{prj.location}/**.cpp", "%{prj.location}/**.h", testedCoreFiles }
+
+    includedirs {
+        "core/src",
+        "toolkit",
+        "vendor"
+    }
+
+    filter "system:linux"
+        links { "pthread" }
+
+    -- on windows they link core and the toolkit instead, which also builds the ones in windows/ that need a device
+    filter "system:windows"
+        removefiles { testedCoreFiles }
+        includedirs {
+            "%{prj.location}",
+            "core/src/shaders",
+            "toolkit/generated",
+            "vendor/Assimp/include",
+            "vendor/libassert/%{cfg.buildcfg}/include",
+        }
+        links { "core", "toolkit" }
+        postbuildcommands { "{COPY} %{wks.location}/vendor/Assimp/bin/x64/assimp-vc143-mt.dll %{cfg.targetdir}" }
+
+    filter "system:not windows"
+        removefiles { "%{prj.location}/windows/**" }
+
+    filter "configurations:Debug"
+        symbols "On"
+        defines { "DEBUG" }
+        optimize "Off"
+
+    filter "configurations:Release"
+        symbols "Off"
+        defines { "NDEBUG" }
+        optimize "Full"
+
+    filter { "toolset:msc*", "language:C++" }
+        buildoptions { "/Zc:__cplusplus /Zc:preprocessor" }
+
+    filter {}
+
+
+-- benchmarks, same setup as the tests. only release numbers mean anything
+local benchmarkedCoreFiles = {
+    "core/src/BeAABBTree.cpp",
+    "core/src/BeFrustumCuller.cpp",
+    "core/src/BeOcclusionBuffer.cpp",
+    "core/src/BeTaskPool.cpp",
+    "core/src/BeTriangleBVH.cpp",
+    "toolkit/basic-render-pipeline/BeBRPSubmissionBuffer.cpp",
+    "toolkit/scenes/BeParallelExtractor.cpp",
+}
+
+project "benchmarks"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++23"
+    location "benchmarks"
+    system (os.target())
+
+    targetdir ("%{prj.location}/bin/%{cfg.architecture}/%{cfg.buildcfg}")
+    objdir    ("%{prj.location}/obj/%{cfg.architecture}/%{cfg.buildcfg}")
+    debugdir  ("%{wks.location}") -- the meshes are read from the example assets
+
+    files { "%{prj.location}/**.cpp", "%{prj.location}/**.h", benchmarkedCoreFiles }
+
+    includedirs {
+        "core/src",
+        "toolkit",
+        "vendor"
+    }
+
+    filter "system:linux"
+        links { "pthread" }
+
+    -- on windows they link core and the toolkit instead, which also builds the ones in windows/ that need a device
+    filter "system:windows"
+        removefiles { benchmarkedCoreFiles }
+        includedirs {
+            "%{prj.location}",
+            "core/src/shaders",
+            "toolkit/generated",
+            "vendor/Assimp/include",
+            "vendor/libassert/%{cfg.buildcfg}/include",
+        }
+        links { "core", "toolkit" }
+        postbuildcommands { "{COPY} %{wks.location}/vendor/Assimp/bin/x64/assimp-vc143-mt.dll %{cfg.targetdir}" }
+
+    filter "system:not windows"
+        removefiles { "%{prj.location}/windows/**" }
+
+    filter "configurations:Debug"
+        symbols "On"
+        defines { "DEBUG" }
+        optimize "Off"
+
+    filter "configurations:Release"
+        symbols "Off"
+        defines { "NDEBUG" }
+        optimize "Full"
+
+    filter { "toolset:msc*", "language:C++" }
+        buildoptions { "/Zc:__cplusplus /Zc:preprocessor" }
+
+    filter {}
+
+
 -- misc project
 project "misc-configuration"
     kind "Utility"
     files {
         "premake5.lua",
+        "premake5-materials.lua",
         ".gitignore",
         "README.md",
         "CLAUDE.md",
@@ -198,7 +459,9 @@ project "example-game-1"
         "core/src",
         "core/src/shaders",
         "toolkit",
+        "toolkit/generated",
         "%{prj.location}",
+        "%{prj.location}/generated",
         "vendor",
         "vendor/Assimp/include",
         "vendor/libassert/%{cfg.buildcfg}/include",
@@ -206,8 +469,11 @@ project "example-game-1"
 
     links { "core", "toolkit" }
 
+    prebuildcommands { generateMaterialsCommand }
+
     postbuildcommands {
         "{COPY} %{wks.location}/core/src/shaders %{cfg.targetdir}/src/shaders",
+        "{COPY} %{wks.location}/toolkit/basic-render-pipeline/shaders %{cfg.targetdir}/src/shaders",
         "{COPY} %{prj.location}/assets %{cfg.targetdir}/assets",
         "{COPY} %{wks.location}/vendor/Assimp/bin/x64/assimp-vc143-mt.dll %{cfg.targetdir}"
     }
@@ -256,7 +522,9 @@ project "example-sakura"
         "core/src",
         "core/src/shaders",
         "toolkit",
+        "toolkit/generated",
         "%{prj.location}",
+        "%{prj.location}/generated",
         "vendor",
         "vendor/Assimp/include",
         "vendor/libassert/%{cfg.buildcfg}/include",
@@ -264,8 +532,11 @@ project "example-sakura"
 
     links { "core", "toolkit" }
 
+    prebuildcommands { generateMaterialsCommand }
+
     postbuildcommands {
         "{COPY} %{wks.location}/core/src/shaders %{cfg.targetdir}/src/shaders",
+        "{COPY} %{wks.location}/toolkit/basic-render-pipeline/shaders %{cfg.targetdir}/src/shaders",
         "{COPY} %{prj.location}/assets %{cfg.targetdir}/assets",
         "{COPY} %{wks.location}/vendor/Assimp/bin/x64/assimp-vc143-mt.dll %{cfg.targetdir}"
     }
@@ -278,6 +549,17 @@ project "example-sakura"
         defines { "DEBUG" }
         optimize "Off"
 
+    -- shaders.bepkg next to the executable, loaded instead of the sources (see MainScene::Prepare). release builds cook
+    -- it themselves, builds without a compiler need it in every configuration and get it from shader-cook
+    filter { "configurations:Release", "options:not no-shader-compiler" }
+        postbuildcommands { "cd \"%{cfg.targetdir}\" && \"%{cfg.buildtarget.name}\" --cook-shaders assets/shaders.bepkg" }
+
+    filter "options:no-shader-compiler"
+        dependson { "shader-cook" }
+        postbuildcommands {
+            "cd \"%{cfg.targetdir}\" && \"%{wks.location}/tools/shader-cook/bin/%{cfg.architecture}/%{cfg.buildcfg}/shader-cook.exe\" assets/shaders.txt assets/shaders.bepkg"
+        }
+
     filter "configurations:Release"
         symbols "Off"
         defines { "NDEBUG" }
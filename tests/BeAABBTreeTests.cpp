@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "BeTest.h"
+#include "BeAABBTree.h"
+
+namespace {
+    // the tree next to a plain list of its proxies, which the queries are checked against one box at a time
+    struct Fuzz {
+        BeAABBTree Tree;
+        std::unordered_map<uint32_t, int32_t> Proxies; // user data to proxy
+        std::unordered_map<uint32_t, BeAABB> Boxes; // the exact box last given for it
+        std::mt19937 Random;
+        uint32_t NextUserData = 0;
+
+        explicit Fuzz(const uint32_t seed) : Random(seed) {}
+
+        auto RandomBox() -> BeAABB {
+            auto position = std::uniform_real_distribution(-100.f, 100.f);
+            auto size = std::uniform_real_distribution(0.f, 5.f);
+            const auto min = glm::vec3(position(Random), position(Random), position(Random));
+            return { min, min + glm::vec3(size(Random), size(Random), size(Random)) };
+        }
+
+        auto Step() -> void {
+            const auto action = Random() % 10;
+            if (action < 4 || Proxies.empty()) {
+                const auto box = RandomBox();
+                Proxies[NextUserData] = Tree.CreateProxy(box, NextUserData);
+                Boxes[NextUserData] = box;
+                NextUserData++;
+                return;
+            }
+
+            auto it = Proxies.begin();
+            std::advance(it, Random() % Proxies.size());
+            const auto [userData, proxy] = *it;
+            if (action < 6) {
+                Tree.DestroyProxy(proxy);
+                Proxies.erase(it);
+                Boxes.erase(userData);
+                return;
+            }
+
+            // mostly small moves that stay in the fattened box, some jumps across the world
+            auto nudge = std::uniform_real_distribution(-0.3f, 0.3f);
+            const auto displacement = action < 9 ? glm::vec3(nudge(Random), nudge(Random), nudge(Random)) : RandomBox().Min - Boxes[userData].Min;
+            const auto moved = BeAABB { Boxes[userData].Min + displacement, Boxes[userData].Max + displacement };
+            Tree.MoveProxy(proxy, moved, displacement);
+            Boxes[userData] = moved;
+        }
+
+        // what a query on the tree reports, sorted
+        template <typename Query>
+        auto Reported(const Query& query) const -> std::vector<uint32_t> {
+            auto reported = std::vector<uint32_t>();
+            query([&reported](const uint32_t userData) {
+                reported.push_back(userData);
+                return true;
+            });
+            std::ranges::sort(reported);
+            return reported;
+        }
+
+        // the proxies whose fattened box passes the test, sorted
+        template <typename Test>
+        auto Expected(const Test& test) const -> std::vector<uint32_t> {
+            auto expected = std::vector<uint32_t>();
+            for (const auto& [userData, proxy] : Proxies)
+                if (test(Tree.GetFatBox(proxy)))
+                    expected.push_back(userData);
+            std::ranges::sort(expected);
+            return expected;
+        }
+
+        auto Consistent() const -> bool {
+            auto consistent = Tree.GetProxyCount() == Proxies.size();
+            for (const auto& [userData, proxy] : Proxies)
+                consistent &= Tree.GetUserData(proxy) == userData && Tree.GetFatBox(proxy).Contains(Boxes.at(userData));
+            return consistent;
+        }
+    };
+
+    auto FrustumPlanes() -> std::vector<glm::vec4> {
+        const auto projection = glm::perspective(1.f, 1.5f, 0.5f, 120.f);
+        const auto view = glm::lookAt(glm::vec3(-30.f, 10.f, -90.f), glm::vec3(10.f, 0.f, 0.f), glm::vec3(0.f, 1.f, 0.f));
+        const auto row = [&](const int i) {
+            const auto projectionView = projection * view;
+            return glm::vec4(projectionView[0][i], projectionView[1][i], projectionView[2][i], projectionView[3][i]);
+        };
+        auto planes = std::vector { row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(2), row(3) - row(2) };
+        for (auto& plane : planes)
+            plane /= glm::length(glm::vec3(plane));
+        return planes;
+    }
+}
+
+BE_TEST("BeAABBTree: queries match brute force through creates, destroys and moves") {
+    auto fuzz = Fuzz(17);
+    const auto planes = FrustumPlanes();
+    auto matches = true;
+
+    for (auto round = 0; round < 40; round++) {
+        for (auto step = 0; step < 100; step++)
+            fuzz.Step();
+        matches &= fuzz.Consistent();
+
+        const auto box = fuzz.RandomBox();
+        const auto queryBox = BeAABB { box.Min - 10.f, box.Max + 10.f };
+        matches &= fuzz.Reported([&](const auto& callback) { fuzz.Tree.QueryBox(queryBox, callback); }) ==
+                   fuzz.Expected([&](const BeAABB& fat) { return fat.Overlaps(queryBox); });
+
+        const auto center = box.Min;
+        const auto radius = 25.f;
+        matches &= fuzz.Reported([&](const auto& callback) { fuzz.Tree.QuerySphere(center, radius, callback); }) ==
+                   fuzz.Expected([&](const BeAABB& fat) {
+                       const auto gap = glm::max(glm::max(fat.Min - center, center - fat.Max), glm::vec3(0.f));
+                       return glm::dot(gap, gap) <= radius * radius;
+                   });
+
+        matches &= fuzz.Reported([&](const auto& callback) { fuzz.Tree.QueryFrustum(planes, callback); }) ==
+                   fuzz.Expected([&](const BeAABB& fat) {
+                       const auto middle = (fat.Min + fat.Max) * 0.5f;
+                       const auto extents = (fat.Max - fat.Min) * 0.5f;
+                       return std::ranges::all_of(planes, [&](const glm::vec4& plane) {
+                           return glm::dot(glm::vec3(plane), middle) + plane.w + glm::dot(glm::abs(glm::vec3(plane)), extents) >= 0.f;
+                       });
+                   });
+
+        // a ray through the middle of the world from somewhere on its edge, with the distance it enters each box at
+        const auto origin = glm::vec3(-120.f, box.Min.y, box.Min.z);
+        const auto direction = glm::normalize(glm::vec3(1.f, -box.Min.y / 240.f, 0.3f));
+        auto hits = std::vector<std::pair<uint32_t, float>>();
+        fuzz.Tree.QueryRay(origin, direction, 200.f, [&hits](const uint32_t userData, const float distance) {
+            hits.emplace_back(userData, distance);
+            return true;
+        });
+        std::ranges::sort(hits);
+        auto expectedHits = std::vector<std::pair<uint32_t, float>>();
+        for (const auto& [userData, proxy] : fuzz.Proxies) {
+            const auto& fat = fuzz.Tree.GetFatBox(proxy);
+            const auto t0 = (fat.Min - origin) * (1.f / direction);
+            const auto t1 = (fat.Max - origin) * (1.f / direction);
+            const auto near = glm::min(t0, t1);
+            const auto far = glm::max(t0, t1);
+            const auto enter = std::max({ near.x, near.y, near.z, 0.f });
+            if (enter <= std::min({ far.x, far.y, far.z, 200.f }))
+                expectedHits.emplace_back(userData, enter);
+        }
+        std::ranges::sort(expectedHits);
+        matches &= hits == expectedHits;
+    }
+    BE_CHECK(matches);
+    BE_CHECK(fuzz.Tree.GetProxyCount() > 100);
+
+    // the rotations keep it shallow, a balanced tree of this many leaves is about 10 deep
+    BE_CHECK(fuzz.Tree.GetHeight() < 32);
+
+    // and everything can go again
+    for (const auto& [userData, proxy] : fuzz.Proxies)
+        fuzz.Tree.DestroyProxy(proxy);
+    BE_CHECK(fuzz.Tree.GetProxyCount() == 0);
+    BE_CHECK(fuzz.Tree.GetHeight() == 0);
+}
+
+BE_TEST("BeAABBTree: small moves stay in the fattened box") {
+    auto tree = BeAABBTree();
+    const auto box = BeAABB { glm::vec3(0.f), glm::vec3(1.f) };
+    const auto proxy = tree.CreateProxy(box, 7);
+
+    const auto nudge = glm::vec3(BeAABBTree::Margin * 0.5f, 0.f, 0.f);
+    BE_CHECK(!tree.MoveProxy(proxy, { box.Min + nudge, box.Max + nudge }, nudge));
+
+    // one past the margin is refit, stretched ahead in the direction it moved
+    const auto step = glm::vec3(1.f, 0.f, 0.f);
+    BE_CHECK(tree.MoveProxy(proxy, { box.Min + step, box.Max + step }, step));
+    BE_CHECK(tree.GetFatBox(proxy).Max.x >= box.Max.x + step.x * (1.f + BeAABBTree::DisplacementScale));
+    BE_CHECK(tree.GetUserData(proxy) == 7);
+}
+
+BE_TEST("BeAABBTree: a callback returning false stops the query, queries nest") {
+    auto tree = BeAABBTree();
+    for (uint32_t i = 0; i < 200; i++)
+        tree.CreateProxy({ glm::vec3(float(i % 10), float(i / 10), 0.f), glm::vec3(float(i % 10), float(i / 10), 0.f) + 0.5f }, i);
+
+    auto reported = 0;
+    tree.QueryBox({ glm::vec3(-1.f), glm::vec3(100.f) }, [&reported](uint32_t) {
+        reported++;
+        return false;
+    });
+    BE_CHECK(reported == 1);
+
+    // every query has its own traversal state, so one inside another's callback doesn't disturb it
+    auto outer = 0;
+    auto inner = 0;
+    tree.QueryBox({ glm::vec3(-1.f), glm::vec3(100.f) }, [&](uint32_t) {
+        outer++;
+        // the boxes at 0 0, 1 0 and 0 1 touch it, the one at 1 1 is just too far
+        tree.QuerySphere(glm::vec3(0.f), 1.f, [&inner](uint32_t) {
+            inner++;
+            return true;
+        });
+        return true;
+    });
+    BE_CHECK(outer == 200);
+    BE_CHECK(inner == 200 * 3);
+}
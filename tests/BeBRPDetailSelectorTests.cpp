@@ -0,0 +1,129 @@
+#include <array>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "BeTest.h"
+#include "basic-render-pipeline/BeBRPDetailSelector.h"
+
+namespace {
+    constexpr auto Infinite = std::numeric_limits<float>::infinity();
+
+    // the selector only hands models to the bounds function and compares their addresses, so stand-ins are distinct
+    // addresses without an owner, like in the instancing tests
+    std::array<char, 8> ModelStorage;
+
+    auto FakeModel(const size_t index) -> std::shared_ptr<BeModel> {
+        return { std::shared_ptr<void>(), reinterpret_cast<BeModel*>(&ModelStorage[index]) };
+    }
+
+    // model 0 is a box 2 across, model 1 has no bounds
+    auto Bounds(const BeModel& model) -> std::pair<glm::vec3, glm::vec3> {
+        if (&model == FakeModel(1).get())
+            return { glm::vec3(1.f), glm::vec3(-1.f) };
+        return { glm::vec3(-1.f), glm::vec3(1.f) };
+    }
+
+    auto Near(const float a, const float b) -> bool {
+        return std::abs(a - b) <= 1e-4f * std::max(std::abs(a), std::abs(b));
+    }
+
+    // model 0 at distance z down the z axis from a camera at the origin
+    auto EntryAt(const float z, const size_t model = 0) -> BeBRPGeometryEntry {
+        auto entry = BeBRPGeometryEntry();
+        entry.ModelMatrix = glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, z));
+        entry.Model = FakeModel(model);
+        entry.CastShadows = false;
+        return entry;
+    }
+}
+
+BE_TEST("BeBRPDetailSelector: sphere size across its cone") {
+    // radius 1 at distance 5, the tangent is sqrt(24) long
+    BE_CHECK(Near(BeBRPDetailSelector::ScreenSizeOf(glm::vec3(0.f, 0.f, 5.f), 1.f, glm::vec3(0.f), 100.f), 200.f / std::sqrt(24.f)));
+    // twice as far is about half as large
+    const auto near = BeBRPDetailSelector::ScreenSizeOf(glm::vec3(0.f, 0.f, 50.f), 1.f, glm::vec3(0.f), 100.f);
+    const auto far = BeBRPDetailSelector::ScreenSizeOf(glm::vec3(0.f, 0.f, 100.f), 1.f, glm::vec3(0.f), 100.f);
+    BE_CHECK(Near(near, 2.f * far * std::sqrt(9999.f / 10000.f) / std::sqrt(2499.f / 2500.f)));
+
+    // a camera inside the sphere, on its surface, or no screen scale at all sees it infinitely large
+    BE_CHECK(BeBRPDetailSelector::ScreenSizeOf(glm::vec3(0.f, 0.f, 0.5f), 1.f, glm::vec3(0.f), 100.f) == Infinite);
+    BE_CHECK(BeBRPDetailSelector::ScreenSizeOf(glm::vec3(0.f, 0.f, 1.f), 1.f, glm::vec3(0.f), 100.f) == Infinite);
+    BE_CHECK(BeBRPDetailSelector::ScreenSizeOf(glm::vec3(0.f, 0.f, 5.f), 1.f, glm::vec3(0.f), 0.f) == Infinite);
+}
+
+BE_TEST("BeBRPDetailSelector: bounds are the sphere around the box, scaled by the largest axis") {
+    const auto boundsMin = glm::vec3(-1.f, -1.f, -1.f);
+    const auto boundsMax = glm::vec3(1.f, 1.f, 1.f);
+    const auto camera = glm::vec3(0.f);
+
+    // the box's sphere has radius sqrt(3), moved to its center
+    const auto moved = glm::translate(glm::mat4(1.f), glm::vec3(3.f, 4.f, 20.f));
+    const auto sphere = BeBRPDetailSelector::ScreenSizeOf(glm::vec3(3.f, 4.f, 20.f), std::sqrt(3.f), camera, 100.f);
+    BE_CHECK(Near(BeBRPDetailSelector::ScreenSizeOf(boundsMin, boundsMax, moved, camera, 100.f), sphere));
+
+    // an off center box goes through the matrix with its center
+    const auto offCenter = BeBRPDetailSelector::ScreenSizeOf(boundsMin + 2.f, boundsMax + 2.f, moved, camera, 100.f);
+    BE_CHECK(Near(offCenter, BeBRPDetailSelector::ScreenSizeOf(glm::vec3(5.f, 6.f, 22.f), std::sqrt(3.f), camera, 100.f)));
+
+    // scaled 3 on one axis, the sphere is 3 times larger
+    const auto scaled = glm::scale(moved, glm::vec3(1.f, 3.f, 1.f));
+    const auto scaledSphere = BeBRPDetailSelector::ScreenSizeOf(glm::vec3(3.f, 4.f, 20.f), 3.f * std::sqrt(3.f), camera, 100.f);
+    BE_CHECK(Near(BeBRPDetailSelector::ScreenSizeOf(boundsMin, boundsMax, scaled, camera, 100.f), scaledSphere));
+
+    // inverted bounds have no size to judge by
+    BE_CHECK(BeBRPDetailSelector::ScreenSizeOf(boundsMax, boundsMin, moved, camera, 100.f) == Infinite);
+}
+
+BE_TEST("BeBRPDetailSelector: the smallest lod the size still fits") {
+    auto entry = EntryAt(10.f);
+    BE_CHECK(&BeBRPDetailSelector::ModelFor(entry, 1.f) == &entry.Model);
+
+    // listed in any order
+    entry.Lods = std::make_shared<const std::vector<BeBRPModelLod>>(std::vector<BeBRPModelLod> {
+        { FakeModel(3), 20.f },
+        { FakeModel(2), 100.f },
+    });
+    const auto& lods = *entry.Lods;
+    BE_CHECK(&BeBRPDetailSelector::ModelFor(entry, 150.f) == &entry.Model);
+    BE_CHECK(&BeBRPDetailSelector::ModelFor(entry, Infinite) == &entry.Model);
+    BE_CHECK(&BeBRPDetailSelector::ModelFor(entry, 100.f) == &lods[1].Model);
+    BE_CHECK(&BeBRPDetailSelector::ModelFor(entry, 50.f) == &lods[1].Model);
+    BE_CHECK(&BeBRPDetailSelector::ModelFor(entry, 20.f) == &lods[0].Model);
+    BE_CHECK(&BeBRPDetailSelector::ModelFor(entry, 0.f) == &lods[0].Model);
+}
+
+BE_TEST("BeBRPDetailSelector: entries below MinScreenSize are dropped, the rest get their lods") {
+    // model 0 is sqrt(3) in radius, 100 pixels per unit of tangent: at 10 about 35 pixels, at 100 about 3.5
+    auto entries = std::vector { EntryAt(10.f), EntryAt(100.f), EntryAt(1000.f), EntryAt(1000.f, 1), EntryAt(100.f) };
+    for (auto& entry : entries)
+        entry.MinScreenSize = 1.f;
+    entries[4].MinScreenSize = 0.f;
+    const auto lods = std::make_shared<const std::vector<BeBRPModelLod>>(std::vector<BeBRPModelLod> { { FakeModel(2), 10.f } });
+    entries[0].Lods = lods;
+    entries[1].Lods = lods;
+
+    auto selector = BeBRPDetailSelector();
+    const auto candidates = std::vector<uint32_t> { 0, 1, 2, 3, 4 };
+    const auto kept = selector.Select(entries, candidates, glm::vec3(0.f), 100.f, Bounds);
+
+    // the far one is too small, the one without bounds is always kept, 0 turns the check off
+    BE_CHECK(std::vector(kept.begin(), kept.end()) == std::vector<uint32_t>({ 0, 1, 3, 4 }));
+    BE_CHECK(selector.GetStats().Dropped == 1);
+
+    // a subset of the kept ones, the near one draws itself and the one at 100 its lod
+    const auto selection = std::vector<uint32_t> { 0, 1, 3 };
+    const auto models = selector.Models(entries, selection);
+    BE_REQUIRE(models.size() == 3);
+    BE_CHECK(models[0] == &entries[0].Model);
+    BE_CHECK(models[1] == &(*lods)[0].Model);
+    BE_CHECK(models[2] == &entries[3].Model);
+    BE_CHECK(selector.GetStats().Simplified == 1);
+
+    // without a screen scale nothing is dropped or simplified
+    BE_CHECK(selector.Select(entries, candidates, glm::vec3(0.f), 0.f, Bounds).size() == candidates.size());
+    BE_CHECK(selector.GetStats().Dropped == 0);
+    (void)selector.Models(entries, selection);
+    BE_CHECK(selector.GetStats().Simplified == 0);
+}
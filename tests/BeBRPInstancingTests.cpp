@@ -0,0 +1,137 @@
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "BeTest.h"
+#include "basic-render-pipeline/BeBRPInstancing.h"
+
+namespace {
+    // the batcher only compares models by address and hands them to the predicate, so stand-ins are distinct
+    // addresses without an owner. nothing here ever dereferences them
+    std::array<char, 8> ModelStorage;
+
+    auto FakeModel(const size_t index) -> std::shared_ptr<BeModel> {
+        return { std::shared_ptr<void>(), reinterpret_cast<BeModel*>(&ModelStorage[index]) };
+    }
+
+    // model i at x = entry index, so matrices tell which entry they came from
+    auto Entries(const std::vector<size_t>& models) -> std::vector<BeBRPGeometryEntry> {
+        auto entries = std::vector<BeBRPGeometryEntry>();
+        for (size_t i = 0; i < models.size(); i++) {
+            auto& entry = entries.emplace_back();
+            entry.ModelMatrix = glm::translate(glm::mat4(1.f), glm::vec3(float(i), 0.f, 0.f));
+            entry.Model = FakeModel(models[i]);
+            entry.CastShadows = i % 2 == 0;
+        }
+        return entries;
+    }
+
+    auto InstancedModels(std::unordered_set<const BeModel*> models) -> BeBRPInstanceBatcher::InstancedFunction {
+        return [models = std::move(models)](const BeModel& model) { return models.contains(&model); };
+    }
+
+    // "model:first+count" per batch, then the entry every matrix came from
+    auto Describe(const BeBRPInstanceBatcher& batcher) -> std::string {
+        auto text = std::string();
+        for (const auto& batch : batcher.GetBatches()) {
+            const auto model = reinterpret_cast<const char*>(batch.Model.get()) - ModelStorage.data();
+            text += std::to_string(model) + ":" + std::to_string(batch.FirstInstance) + "+" +
+                    std::to_string(batch.InstanceCount) + " ";
+        }
+        text += "|";
+        for (const auto& matrix : batcher.GetMatrices())
+            text += " " + std::to_string(int(matrix[3].x));
+        return text;
+    }
+}
+
+BE_TEST("BeBRPInstancing: instanced models group in order of their first entry") {
+    const auto entries = Entries({ 1, 0, 1, 2, 0, 1 });
+    const auto selection = std::vector<uint32_t> { 0, 1, 2, 3, 4, 5 };
+
+    auto batcher = BeBRPInstanceBatcher();
+    batcher.Build(entries, selection, InstancedModels({ FakeModel(0).get(), FakeModel(1).get(), FakeModel(2).get() }));
+
+    // model 1 first with entries 0, 2, 5, then model 0 with 1, 4, then model 2 with 3
+    BE_CHECK(Describe(batcher) == "1:0+3 0:3+2 2:5+1 | 0 2 5 1 4 3");
+}
+
+BE_TEST("BeBRPInstancing: models that can't instance draw once per entry") {
+    const auto entries = Entries({ 1, 0, 1, 0, 1 });
+    const auto selection = std::vector<uint32_t> { 0, 1, 2, 3, 4 };
+
+    // only model 0 instances, asked once per model and not once per entry
+    auto asked = 0;
+    const auto isInstanced = [&](const BeModel& model) {
+        asked++;
+        return &model == FakeModel(0).get();
+    };
+
+    auto batcher = BeBRPInstanceBatcher();
+    batcher.Build(entries, selection, isInstanced);
+    BE_CHECK(Describe(batcher) == "1:0+1 0:1+2 1:3+1 1:4+1 | 0 1 3 2 4");
+    BE_CHECK(asked == 2);
+}
+
+BE_TEST("BeBRPInstancing: selections and shadow casters") {
+    const auto entries = Entries({ 0, 0, 1, 0, 1, 1 });
+    const auto instanced = InstancedModels({ FakeModel(0).get(), FakeModel(1).get() });
+    auto batcher = BeBRPInstanceBatcher();
+
+    const auto selection = std::vector<uint32_t> { 1, 2, 5 };
+    batcher.Build(entries, selection, instanced);
+    BE_CHECK(Describe(batcher) == "0:0+1 1:1+2 | 1 2 5");
+
+    // the even entries cast shadows
+    batcher.Build(entries, true, instanced);
+    BE_CHECK(Describe(batcher) == "0:0+1 1:1+2 | 0 2 4");
+
+    batcher.Build(entries, std::vector<uint32_t>(), instanced);
+    BE_CHECK(Describe(batcher) == "|");
+}
+
+BE_TEST("BeBRPInstancing: replacement models group on their own") {
+    // entries of model 0 drawn with lod 2 batch with the entries that use model 2 themselves
+    const auto entries = Entries({ 0, 2, 0, 0 });
+    const auto selection = std::vector<uint32_t> { 0, 1, 2, 3 };
+    const auto own = FakeModel(0);
+    const auto lod = FakeModel(2);
+    const auto models = std::vector<const std::shared_ptr<BeModel>*> { &lod, &entries[1].Model, &own, &lod };
+
+    auto batcher = BeBRPInstanceBatcher();
+    batcher.Build(entries, selection, models, InstancedModels({ own.get(), lod.get() }));
+    BE_CHECK(Describe(batcher) == "2:0+3 0:3+1 | 0 1 3 2");
+}
+
+BE_TEST("BeBRPInstancing: batches cover the matrices back to back") {
+    auto models = std::vector<size_t>();
+    for (size_t i = 0; i < 500; i++)
+        models.push_back(i * 7 % 5);
+    const auto entries = Entries(models);
+    auto selection = std::vector<uint32_t>();
+    for (uint32_t i = 0; i < entries.size(); i += 2)
+        selection.push_back(i);
+
+    auto batcher = BeBRPInstanceBatcher();
+    batcher.Build(entries, selection, InstancedModels({ FakeModel(0).get(), FakeModel(3).get() }));
+
+    auto next = uint32_t(0);
+    auto covered = true;
+    for (const auto& batch : batcher.GetBatches()) {
+        covered &= batch.FirstInstance == next && batch.InstanceCount > 0;
+        next += batch.InstanceCount;
+
+        // every matrix in a batch comes from an entry of its model, in submission order
+        auto previous = -1;
+        for (uint32_t i = 0; i < batch.InstanceCount; i++) {
+            const auto entry = int(batcher.GetMatrices()[batch.FirstInstance + i][3].x);
+            covered &= entries[entry].Model == batch.Model && entry > previous;
+            previous = entry;
+        }
+    }
+    BE_CHECK(covered);
+    BE_CHECK(next == selection.size());
+    BE_CHECK(batcher.GetMatrices().size() == selection.size());
+}
@@ -0,0 +1,129 @@
+#include <vector>
+
+#include "BeTest.h"
+#include "basic-render-pipeline/BeBRPShadowCache.h"
+
+namespace {
+    using ViewUpdate = BeBRPShadowCache::ViewUpdate;
+    using ViewCache = BeBRPShadowCache::ViewCache;
+    using ViewState = BeBRPShadowCache::ViewState;
+
+    struct Caster {
+        bool Static;
+        uint64_t Version;
+        uint32_t Shader = 1;
+        bool Animated = false;
+    };
+
+    auto Light(const float x) -> glm::mat4 {
+        return glm::translate(glm::mat4(1.f), glm::vec3(x, 0.f, 0.f));
+    }
+
+    auto State(const glm::mat4& light, const std::vector<Caster>& casters) -> ViewState {
+        auto state = ViewState { .ViewProjection = light };
+        for (const auto& caster : casters)
+            BeBRPShadowCache::AddCaster(state, caster.Static, caster.Version, caster.Shader, caster.Animated);
+        return state;
+    }
+
+    // plans the view and, unless it's skipped, draws it the way it was planned
+    auto Step(ViewCache& cache, const ViewState& state) -> ViewUpdate {
+        const auto update = BeBRPShadowCache::Plan(cache, state);
+        if (update != ViewUpdate::Skip)
+            BeBRPShadowCache::Commit(cache, state, update);
+        return update;
+    }
+}
+
+BE_TEST("BeBRPShadowCache: a new view draws its layer, then skips while nothing changes") {
+    auto cache = ViewCache();
+    const auto casters = std::vector<Caster> { { true, 1 }, { true, 2 }, { false, 3 } };
+    BE_CHECK(Step(cache, State(Light(0.f), casters)) == ViewUpdate::RedrawLayered);
+    BE_CHECK(cache.Valid && cache.LayerValid);
+    BE_CHECK(Step(cache, State(Light(0.f), casters)) == ViewUpdate::Skip);
+}
+
+BE_TEST("BeBRPShadowCache: the order of the casters doesn't matter") {
+    auto cache = ViewCache();
+    (void)Step(cache, State(Light(0.f), { { true, 1 }, { true, 2 }, { false, 3 }, { false, 4 } }));
+    BE_CHECK(Step(cache, State(Light(0.f), { { false, 4 }, { true, 2 }, { false, 3 }, { true, 1 } })) == ViewUpdate::Skip);
+}
+
+BE_TEST("BeBRPShadowCache: static changes redraw the layer, dynamic ones composite over it") {
+    auto cache = ViewCache();
+    (void)Step(cache, State(Light(0.f), { { true, 1 }, { true, 2 }, { false, 3 } }));
+
+    // a dynamic caster updated, added and removed
+    BE_CHECK(Step(cache, State(Light(0.f), { { true, 1 }, { true, 2 }, { false, 4 } })) == ViewUpdate::Composite);
+    BE_CHECK(Step(cache, State(Light(0.f), { { true, 1 }, { true, 2 }, { false, 4 }, { false, 5 } })) == ViewUpdate::Composite);
+    BE_CHECK(Step(cache, State(Light(0.f), { { true, 1 }, { true, 2 }, { false, 5 } })) == ViewUpdate::Composite);
+
+    // a static caster updated, added and removed
+    BE_CHECK(Step(cache, State(Light(0.f), { { true, 1 }, { true, 6 }, { false, 5 } })) == ViewUpdate::RedrawLayered);
+    BE_CHECK(Step(cache, State(Light(0.f), { { true, 1 }, { true, 6 }, { true, 7 }, { false, 5 } })) == ViewUpdate::RedrawLayered);
+    BE_CHECK(Step(cache, State(Light(0.f), { { true, 1 }, { true, 7 }, { false, 5 } })) == ViewUpdate::RedrawLayered);
+    BE_CHECK(cache.LayerValid);
+}
+
+BE_TEST("BeBRPShadowCache: a caster drawn with another shader is a change") {
+    auto cache = ViewCache();
+    (void)Step(cache, State(Light(0.f), { { true, 1, 1 }, { false, 2, 1 } }));
+    BE_CHECK(Step(cache, State(Light(0.f), { { true, 1, 2 }, { false, 2, 1 } })) == ViewUpdate::RedrawLayered);
+    BE_CHECK(Step(cache, State(Light(0.f), { { true, 1, 2 }, { false, 2, 3 } })) == ViewUpdate::Composite);
+}
+
+BE_TEST("BeBRPShadowCache: a moving light redraws without a layer until it stops") {
+    auto cache = ViewCache();
+    const auto casters = std::vector<Caster> { { true, 1 }, { false, 2 } };
+    (void)Step(cache, State(Light(0.f), casters));
+
+    // the old layer is useless from the first move on, and a new one only lasts a frame while the light moves
+    BE_CHECK(Step(cache, State(Light(1.f), casters)) == ViewUpdate::Redraw);
+    BE_CHECK(!cache.LayerValid);
+    BE_CHECK(Step(cache, State(Light(2.f), casters)) == ViewUpdate::Redraw);
+
+    // stopped and nothing changed, the map is right as it is
+    BE_CHECK(Step(cache, State(Light(2.f), casters)) == ViewUpdate::Skip);
+    BE_CHECK(!cache.LayerValid);
+
+    // the next change rebuilds the layer once, and composites after that
+    BE_CHECK(Step(cache, State(Light(2.f), { { true, 1 }, { false, 3 } })) == ViewUpdate::RedrawLayered);
+    BE_CHECK(cache.LayerValid);
+    BE_CHECK(Step(cache, State(Light(2.f), { { true, 1 }, { false, 4 } })) == ViewUpdate::Composite);
+}
+
+BE_TEST("BeBRPShadowCache: one kind of caster doesn't get a layer") {
+    auto cache = ViewCache();
+    BE_CHECK(Step(cache, State(Light(0.f), { { true, 1 }, { true, 2 } })) == ViewUpdate::Redraw);
+    BE_CHECK(!cache.LayerValid);
+    BE_CHECK(Step(cache, State(Light(0.f), { { true, 1 } })) == ViewUpdate::Redraw);
+    BE_CHECK(Step(cache, State(Light(0.f), { { false, 3 } })) == ViewUpdate::Redraw);
+
+    // a static caster coming back needs its layer drawn first
+    BE_CHECK(Step(cache, State(Light(0.f), { { true, 1 }, { false, 3 } })) == ViewUpdate::RedrawLayered);
+
+    // and nothing at all still clears the map once
+    BE_CHECK(Step(cache, State(Light(0.f), {})) == ViewUpdate::Redraw);
+    BE_CHECK(Step(cache, State(Light(0.f), {})) == ViewUpdate::Skip);
+}
+
+BE_TEST("BeBRPShadowCache: an invalid map is drawn even when it matches") {
+    auto cache = ViewCache();
+    const auto state = State(Light(0.f), { { true, 1 }, { false, 2 } });
+    (void)Step(cache, state);
+    cache.Valid = false;
+    BE_CHECK(Step(cache, state) == ViewUpdate::RedrawLayered);
+}
+
+BE_TEST("BeBRPShadowCache: casters animated by their shader are never up to date") {
+    auto cache = ViewCache();
+    const auto casters = std::vector<Caster> { { true, 1 }, { false, 2, 1, true } };
+    BE_CHECK(Step(cache, State(Light(0.f), casters)) == ViewUpdate::RedrawLayered);
+    BE_CHECK(Step(cache, State(Light(0.f), casters)) == ViewUpdate::Composite);
+    BE_CHECK(Step(cache, State(Light(0.f), casters)) == ViewUpdate::Composite);
+
+    // on their own they redraw the map every frame
+    const auto alone = std::vector<Caster> { { false, 2, 1, true } };
+    BE_CHECK(Step(cache, State(Light(0.f), alone)) == ViewUpdate::Redraw);
+    BE_CHECK(Step(cache, State(Light(0.f), alone)) == ViewUpdate::Redraw);
+}
@@ -0,0 +1,185 @@
+#include <array>
+#include <string>
+#include <vector>
+
+#include "BeTest.h"
+#include "basic-render-pipeline/BeBRPShadowScheduler.h"
+
+namespace {
+    using ViewUpdate = BeBRPShadowScheduler::ViewUpdate;
+    using ViewDecision = BeBRPShadowScheduler::ViewDecision;
+    using SchedulePolicy = BeBRPShadowScheduler::SchedulePolicy;
+
+    // the scheduler only hashes maps by address, stand-ins are distinct addresses nothing dereferences
+    std::array<char, 8> MapStorage;
+
+    auto FakeMap(const size_t index) -> const BeTexture* {
+        return reinterpret_cast<const BeTexture*>(&MapStorage[index]);
+    }
+
+    // a cube face that was drawn before and wants a redraw, its priority only from its size on screen
+    auto Stale(const float screenSize, const uint32_t draws, const uint64_t triangles = 0) -> ViewDecision {
+        return {
+            .Map = nullptr,
+            .Face = 0,
+            .Wanted = ViewUpdate::Redraw,
+            .Update = ViewUpdate::Skip,
+            .ScreenSize = screenSize,
+            .Weight = 1.f,
+            .Priority = 0.f,
+            .Staleness = 0,
+            .Draws = draws,
+            .Triangles = triangles,
+            .Cached = true,
+        };
+    }
+
+    auto Schedule(std::vector<ViewDecision>& decisions, const SchedulePolicy& policy, const uint64_t frame) -> void {
+        auto order = std::vector<uint32_t>();
+        BeBRPShadowScheduler::Schedule(decisions, policy, frame, order);
+    }
+
+    // x for every view that was scheduled, . for the others
+    auto Scheduled(const std::vector<ViewDecision>& decisions) -> std::string {
+        auto scheduled = std::string();
+        for (const auto& decision : decisions)
+            scheduled += decision.Update != ViewUpdate::Skip ? 'x' : '.';
+        return scheduled;
+    }
+}
+
+BE_TEST("BeBRPShadowScheduler: everything is drawn without a budget") {
+    auto decisions = std::vector { Stale(1.f, 100, 1'000'000), Stale(2.f, 100, 1'000'000), Stale(3.f, 100, 1'000'000) };
+    decisions[1].Wanted = ViewUpdate::Composite;
+    Schedule(decisions, {}, 10);
+    BE_CHECK(decisions[0].Update == ViewUpdate::Redraw);
+    BE_CHECK(decisions[1].Update == ViewUpdate::Composite);
+    BE_CHECK(decisions[2].Update == ViewUpdate::Redraw);
+}
+
+BE_TEST("BeBRPShadowScheduler: views that are up to date stay skipped") {
+    auto decisions = std::vector { Stale(5.f, 1), Stale(1.f, 1) };
+    decisions[0].Wanted = ViewUpdate::Skip;
+    decisions[0].Update = ViewUpdate::Redraw; // whatever was there before is overwritten
+    Schedule(decisions, {}, 10);
+    BE_CHECK(decisions[0].Update == ViewUpdate::Skip);
+    BE_CHECK(decisions[1].Update == ViewUpdate::Redraw);
+}
+
+BE_TEST("BeBRPShadowScheduler: the budget is filled by priority") {
+    auto decisions = std::vector { Stale(1.f, 4), Stale(3.f, 4), Stale(2.f, 4), Stale(4.f, 4) };
+    Schedule(decisions, { .MaxDraws = 8 }, 10);
+    BE_CHECK(Scheduled(decisions) == ".x.x");
+}
+
+BE_TEST("BeBRPShadowScheduler: a cheaper view fills what a dearer one left") {
+    // 6, then 5 doesn't fit, then 2 does
+    auto decisions = std::vector { Stale(3.f, 6), Stale(2.f, 5), Stale(1.f, 2) };
+    Schedule(decisions, { .MaxDraws = 8 }, 10);
+    BE_CHECK(Scheduled(decisions) == "x.x");
+}
+
+BE_TEST("BeBRPShadowScheduler: triangles are budgeted too") {
+    auto decisions = std::vector { Stale(2.f, 1, 600), Stale(1.f, 1, 600) };
+    Schedule(decisions, { .MaxTriangles = 1000 }, 10);
+    BE_CHECK(Scheduled(decisions) == "x.");
+}
+
+BE_TEST("BeBRPShadowScheduler: the first view is drawn over any budget") {
+    auto decisions = std::vector { Stale(1.f, 50), Stale(2.f, 40) };
+    Schedule(decisions, { .MaxDraws = 10 }, 10);
+    BE_CHECK(Scheduled(decisions) == ".x");
+}
+
+BE_TEST("BeBRPShadowScheduler: maps never drawn go first and over the budget") {
+    auto decisions = std::vector { Stale(100.f, 8), Stale(1.f, 8), Stale(1.f, 8) };
+    decisions[1].Cached = false;
+    decisions[2].Cached = false;
+    Schedule(decisions, { .MaxDraws = 8 }, 10);
+    BE_CHECK(Scheduled(decisions) == ".xx");
+}
+
+BE_TEST("BeBRPShadowScheduler: priority is size on screen times weight times the frames waited") {
+    auto decisions = std::vector { Stale(10.f, 1), Stale(10.f, 1), Stale(10.f, 1) };
+    decisions[1].Weight = 0.1f;
+    decisions[2].Staleness = 2;
+    Schedule(decisions, {}, 10);
+    BE_CHECK(decisions[0].Priority == 10.f);
+    BE_CHECK(decisions[1].Priority == 1.f);
+    BE_CHECK(decisions[2].Priority == 30.f);
+}
+
+BE_TEST("BeBRPShadowScheduler: a deferred view isn't starved") {
+    // a view worth a tenth of another that needs drawing every frame. its priority grows with the frames it waited,
+    // so it wins once it's worth more
+    constexpr auto MaxFrames = 20;
+    auto staleness = 0u;
+    auto drawnAt = 0;
+    for (auto frame = 1; frame <= MaxFrames && drawnAt == 0; frame++) {
+        auto decisions = std::vector { Stale(10.f, 4), Stale(1.f, 4) };
+        decisions[1].Staleness = staleness;
+        Schedule(decisions, { .MaxDraws = 4 }, uint64_t(frame));
+        if (decisions[1].Update != ViewUpdate::Skip)
+            drawnAt = frame;
+        else
+            staleness++;
+    }
+    BE_CHECK(drawnAt != 0);
+    BE_CHECK(drawnAt <= 11);
+}
+
+BE_TEST("BeBRPShadowScheduler: distant faces take turns") {
+    // three distant lights with every face wanting a redraw, for a few intervals of each length
+    for (const auto interval : { 1u, 2u, 3u, 4u, 6u, 8u }) {
+        const auto policy = SchedulePolicy { .DistantScreenSize = 50.f, .DistantInterval = interval };
+        const auto perLight = (6 + interval - 1) / interval;
+
+        auto drawnFrames = std::vector<std::vector<uint64_t>>(18);
+        auto fair = true;
+        for (auto frame = uint64_t(100); frame < 100 + 3 * interval; frame++) {
+            auto decisions = std::vector<ViewDecision>();
+            for (size_t light = 0; light < 3; light++) {
+                for (uint32_t face = 0; face < 6; face++) {
+                    auto& decision = decisions.emplace_back(Stale(10.f, 1));
+                    decision.Map = FakeMap(light);
+                    decision.Face = face;
+                }
+            }
+            Schedule(decisions, policy, frame);
+
+            // never more than a light's share of its faces in one frame
+            for (size_t light = 0; light < 3; light++) {
+                auto scheduled = 0u;
+                for (size_t face = 0; face < 6; face++) {
+                    if (decisions[light * 6 + face].Update != ViewUpdate::Skip) {
+                        scheduled++;
+                        drawnFrames[light * 6 + face].push_back(frame);
+                    }
+                }
+                fair &= scheduled <= perLight;
+            }
+        }
+        BE_CHECK(fair);
+
+        // and every face once per interval, exactly that far apart
+        auto regular = true;
+        for (const auto& frames : drawnFrames) {
+            regular &= frames.size() == 3;
+            for (size_t i = 1; i < frames.size(); i++)
+                regular &= frames[i] - frames[i - 1] == interval;
+        }
+        BE_CHECK(regular);
+    }
+}
+
+BE_TEST("BeBRPShadowScheduler: near views and new maps ignore the turns") {
+    const auto policy = SchedulePolicy { .DistantScreenSize = 50.f, .DistantInterval = 4 };
+    for (auto frame = uint64_t(11); frame < 15; frame++) {
+        auto decisions = std::vector { Stale(100.f, 1), Stale(10.f, 1) };
+        decisions[0].Map = FakeMap(0);
+        decisions[1].Map = FakeMap(1);
+        decisions[1].Cached = false;
+        Schedule(decisions, policy, frame);
+        BE_CHECK(Scheduled(decisions) == "xx");
+    }
+}
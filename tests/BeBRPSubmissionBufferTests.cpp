@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "BeTest.h"
+#include "basic-render-pipeline/BeBRPSubmissionBuffer.h"
+
+namespace {
+    // entries carry a tag in their translation, retained ones positive, per frame ones negative
+    auto Tagged(const int tag) -> BeBRPGeometryEntry {
+        auto entry = BeBRPGeometryEntry();
+        entry.ModelMatrix = glm::translate(glm::mat4(1.f), glm::vec3(float(tag), 0.f, 0.f));
+        entry.CastShadows = false;
+        return entry;
+    }
+
+    auto TagOf(const BeBRPGeometryEntry& entry) -> int {
+        return int(entry.ModelMatrix[3].x);
+    }
+
+    // what the buffer should hold, by slot
+    struct Expected {
+        int Tag;
+        uint64_t Version; // as last seen, 0 for one that was just added or updated and is checked to be new
+    };
+
+    auto IndexOf(const BeBRPSubmissionBuffer& buffer, const BeBRPSubmissionBuffer::GeometrySlot slot) -> size_t {
+        return static_cast<size_t>(&buffer.GetGeometry(slot) - buffer.GetGeometryEntries().data());
+    }
+}
+
+BE_TEST("BeBRPSubmissionBuffer: slots keep pointing at their entries through adds, removes and updates") {
+    auto random = std::mt19937(5);
+    auto buffer = BeBRPSubmissionBuffer();
+    auto expected = std::map<BeBRPSubmissionBuffer::GeometrySlot, Expected>();
+    auto nextTag = 1;
+    auto highestVersion = uint64_t(0);
+    auto freed = std::set<BeBRPSubmissionBuffer::GeometrySlot>();
+    auto reused = 0;
+
+    auto slotsMatch = true;
+    auto versionsMatch = true;
+    auto retainedFirst = true;
+    auto frameEntriesMatch = true;
+
+    for (auto frame = 0; frame < 200; frame++) {
+        buffer.ClearEntries();
+
+        // some of this frame's entries go in before the retained changes, which have to stay in front of them
+        const auto early = static_cast<int>(random() % 3);
+        for (auto i = 0; i < early; i++)
+            buffer.SubmitGeometry(Tagged(-(i + 1)));
+
+        for (auto change = 0; change < 6; change++) {
+            const auto action = random() % 8;
+            if (action < 3 || expected.empty()) {
+                const auto slot = buffer.AddGeometry(Tagged(nextTag));
+                reused += freed.erase(slot) > 0;
+                slotsMatch &= !expected.contains(slot);
+                expected[slot] = { nextTag++, 0 };
+                continue;
+            }
+
+            auto it = expected.begin();
+            std::advance(it, random() % expected.size());
+            if (action < 5) {
+                buffer.RemoveGeometry(it->first);
+                freed.insert(it->first);
+                expected.erase(it);
+            }
+            else if (action < 7) {
+                buffer.UpdateGeometry(it->first, Tagged(nextTag));
+                it->second = { nextTag++, 0 };
+            }
+            else {
+                buffer.UpdateGeometryMatrix(it->first, Tagged(nextTag).ModelMatrix);
+                it->second = { nextTag++, 0 };
+            }
+        }
+
+        const auto late = static_cast<int>(random() % 4);
+        for (auto i = early; i < early + late; i++)
+            buffer.SubmitGeometry(Tagged(-(i + 1)));
+
+        const auto& entries = buffer.GetGeometryEntries();
+        const auto versions = buffer.GetGeometryVersions();
+        BE_REQUIRE(versions.size() == entries.size());
+        BE_REQUIRE(buffer.GetRetainedGeometryCount() == expected.size());
+        BE_REQUIRE(entries.size() == expected.size() + size_t(early + late));
+
+        // every live slot finds its own entry among the retained ones, each a different one
+        auto indices = std::set<size_t>();
+        auto newest = highestVersion;
+        for (auto& [slot, item] : expected) {
+            const auto index = IndexOf(buffer, slot);
+            slotsMatch &= index < expected.size() && TagOf(buffer.GetGeometry(slot)) == item.Tag;
+            indices.insert(index);
+
+            // untouched entries keep their version, even when a removal moved them. changed ones get one newer than
+            // anything before this frame, and no two share it
+            if (item.Version == 0) {
+                versionsMatch &= versions[index] > highestVersion;
+                item.Version = versions[index];
+            }
+            else
+                versionsMatch &= versions[index] == item.Version;
+            newest = std::max(newest, versions[index]);
+        }
+        slotsMatch &= indices.size() == expected.size();
+
+        // then this frame's, in the order they were submitted and each newer than everything retained
+        for (size_t i = expected.size(); i < entries.size(); i++) {
+            retainedFirst &= TagOf(entries[i]) < 0;
+            frameEntriesMatch &= TagOf(entries[i]) == -int(i - expected.size() + 1);
+            versionsMatch &= versions[i] > highestVersion;
+            newest = std::max(newest, versions[i]);
+        }
+        for (size_t i = 0; i < expected.size(); i++)
+            retainedFirst &= TagOf(entries[i]) > 0;
+
+        auto sorted = std::vector(versions.begin(), versions.end());
+        std::ranges::sort(sorted);
+        versionsMatch &= std::ranges::adjacent_find(sorted) == sorted.end();
+        highestVersion = newest;
+    }
+
+    BE_CHECK(slotsMatch);
+    BE_CHECK(versionsMatch);
+    BE_CHECK(retainedFirst);
+    BE_CHECK(frameEntriesMatch);
+    BE_CHECK(reused > 0);
+}
+
+BE_TEST("BeBRPSubmissionBuffer: per frame entries come and go, retained ones stay") {
+    auto buffer = BeBRPSubmissionBuffer();
+    const auto a = buffer.AddGeometry(Tagged(1));
+    const auto b = buffer.AddGeometry(Tagged(2));
+    buffer.SubmitGeometry(Tagged(-1));
+    const auto filled = buffer.SubmitGeometry(2);
+    BE_CHECK(filled.size() == 2);
+    BE_CHECK(buffer.GetGeometryEntries().size() == 5);
+
+    // a per frame entry gets a new version every time it's submitted, retained ones only when they change
+    const auto retainedVersion = buffer.GetGeometryVersions()[IndexOf(buffer, a)];
+    const auto frameVersion = buffer.GetGeometryVersions()[2];
+    buffer.ClearEntries();
+    BE_CHECK(buffer.GetGeometryEntries().size() == 2);
+    buffer.SubmitGeometry(Tagged(-1));
+    BE_CHECK(buffer.GetGeometryVersions()[2] > frameVersion);
+    BE_CHECK(buffer.GetGeometryVersions()[IndexOf(buffer, a)] == retainedVersion);
+
+    buffer.DiscardGeometry(1);
+    BE_CHECK(buffer.GetGeometryEntries().size() == 2);
+    BE_CHECK(TagOf(buffer.GetGeometry(b)) == 2);
+
+    // removing the first moves the last into its place, the freed slot comes back for the next add
+    buffer.RemoveGeometry(a);
+    BE_CHECK(IndexOf(buffer, b) == 0);
+    BE_CHECK(buffer.AddGeometry(Tagged(3)) == a);
+    BE_CHECK(TagOf(buffer.GetGeometry(a)) == 3);
+
+    buffer.SubmitGeometry(Tagged(-1));
+    buffer.ClearRetainedGeometry();
+    BE_CHECK(buffer.GetRetainedGeometryCount() == 0);
+    BE_REQUIRE(buffer.GetGeometryEntries().size() == 1);
+    BE_CHECK(TagOf(buffer.GetGeometryEntries()[0]) == -1);
+    BE_CHECK(buffer.GetGeometryVersions().size() == 1);
+}
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "BeTest.h"
+#include "BeFrustumCuller.h"
+
+namespace {
+    // random boxes around the origin, some of them straddling the planes
+    auto RandomCuller(const uint32_t count, const uint32_t seed) -> BeFrustumCuller {
+        auto random = std::mt19937(seed);
+        auto position = std::uniform_real_distribution(-60.f, 60.f);
+        auto size = std::uniform_real_distribution(0.f, 6.f);
+
+        auto culler = BeFrustumCuller();
+        for (uint32_t i = 0; i < count; i++)
+            culler.Push(glm::vec3(position(random), position(random), position(random)),
+                        glm::vec3(size(random), size(random), size(random)));
+        return culler;
+    }
+
+    auto TestPlanes() -> std::vector<glm::vec4> {
+        const auto projection = glm::perspective(1.1f, 16.f / 9.f, 0.1f, 80.f);
+        const auto view = glm::lookAt(glm::vec3(3.f, 2.f, -20.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+        const auto planes = BeFrustumCuller::ExtractPlanes(projection * view);
+        return { planes.begin(), planes.end() };
+    }
+
+    // how far the box reaches in front of its worst plane, in doubles. >= 0 is visible
+    auto PlaneMargin(const BeFrustumCuller& culler, const uint32_t index, const std::vector<glm::vec4>& planes) -> double {
+        const auto [center, extents] = culler.GetBox(index);
+        auto margin = HUGE_VAL;
+        for (const auto& plane : planes) {
+            const auto distance = double(plane.x) * center.x + double(plane.y) * center.y + double(plane.z) * center.z + plane.w;
+            const auto radius = std::abs(double(plane.x)) * extents.x + std::abs(double(plane.y)) * extents.y +
+                                std::abs(double(plane.z)) * extents.z;
+            margin = std::min(margin, distance + radius);
+        }
+        return margin;
+    }
+
+    // how much the squared radius exceeds the squared distance to the box. >= 0 is touching
+    auto SphereMargin(const BeFrustumCuller& culler, const uint32_t index, const glm::vec3& sphere, const float radius) -> double {
+        const auto [center, extents] = culler.GetBox(index);
+        auto distanceSquared = 0.0;
+        for (auto axis = 0; axis < 3; axis++) {
+            const auto gap = std::max(std::abs(double(sphere[axis]) - center[axis]) - extents[axis], 0.0);
+            distanceSquared += gap * gap;
+        }
+        return double(radius) * radius - distanceSquared;
+    }
+
+    // the culled indices have to be ascending and agree with the margins. a box right on the boundary may go either
+    // way, the paths round differently (fma or not)
+    template<typename Margin>
+    auto MatchesReference(const BeFrustumCuller& culler, const std::span<const uint32_t> visible, const Margin& margin) -> bool {
+        constexpr auto Tolerance = 1e-3;
+        if (!std::ranges::is_sorted(visible) || std::ranges::adjacent_find(visible) != visible.end())
+            return false;
+
+        auto next = visible.begin();
+        for (uint32_t i = 0; i < culler.GetCount(); i++) {
+            const auto culled = next == visible.end() || *next != i;
+            if (!culled)
+                ++next;
+            const auto reference = margin(i);
+            if (std::abs(reference) > Tolerance && culled == (reference >= 0.0))
+                return false;
+        }
+        return next == visible.end();
+    }
+
+    auto Paths() -> std::vector<BeFrustumCuller::Path> {
+        if (BeFrustumCuller::HasAVX2())
+            return { BeFrustumCuller::Path::SSE, BeFrustumCuller::Path::AVX2 };
+        return { BeFrustumCuller::Path::SSE };
+    }
+}
+
+BE_TEST("BeFrustumCuller: planes agree with a scalar reference on every path") {
+    const auto planes = TestPlanes();
+
+    // counts that end mid group and mid half group
+    for (const auto count : { 0u, 1u, 5u, 8u, 13u, 1003u }) {
+        auto culler = RandomCuller(count, count + 1);
+        for (const auto path : Paths()) {
+            const auto visible = culler.Cull(planes, path);
+            BE_CHECK(MatchesReference(culler, visible, [&](const uint32_t i) { return PlaneMargin(culler, i, planes); }));
+        }
+    }
+}
+
+BE_TEST("BeFrustumCuller: no planes keep everything, eight are all used, more are dropped") {
+    auto culler = RandomCuller(1003, 3);
+    auto planes = TestPlanes();
+
+    // two more planes cutting the frustum down, eight in all
+    planes.push_back(glm::vec4(glm::normalize(glm::vec3(1.f, 0.f, 1.f)), 5.f));
+    planes.push_back(glm::vec4(0.f, -1.f, 0.f, 4.f));
+    const auto extra = std::vector { glm::vec4(0.f, 0.f, -1.f, -1000.f) };
+
+    for (const auto path : Paths()) {
+        BE_CHECK(culler.Cull({}, path).size() == culler.GetCount());
+
+        const auto eight = culler.Cull(planes, path);
+        BE_CHECK(MatchesReference(culler, eight, [&](const uint32_t i) { return PlaneMargin(culler, i, planes); }));
+
+        // a ninth plane culling everything is past the limit and ignored
+        auto nine = planes;
+        nine.insert(nine.end(), extra.begin(), extra.end());
+        const auto clamped = culler.Cull(nine, path);
+        BE_CHECK(MatchesReference(culler, clamped, [&](const uint32_t i) { return PlaneMargin(culler, i, planes); }));
+        BE_CHECK(!clamped.empty());
+    }
+}
+
+BE_TEST("BeFrustumCuller: spheres agree with a scalar reference on every path") {
+    for (const auto count : { 0u, 3u, 8u, 1003u }) {
+        auto culler = RandomCuller(count, count + 11);
+        for (const auto& [center, radius] : { std::pair(glm::vec3(0.f), 20.f), std::pair(glm::vec3(50.f, -10.f, 5.f), 35.f),
+                                               std::pair(glm::vec3(1.f, 2.f, 3.f), 0.f) }) {
+            for (const auto path : Paths()) {
+                const auto visible = culler.CullSphere(center, radius, path);
+                BE_CHECK(MatchesReference(culler, visible, [&](const uint32_t i) { return SphereMargin(culler, i, center, radius); }));
+            }
+        }
+    }
+}
+
+BE_TEST("BeFrustumCuller: inverted bounds are never culled") {
+    auto culler = RandomCuller(6, 5);
+    const auto index = culler.PushTransformed(glm::vec3(1.f), glm::vec3(-1.f), glm::translate(glm::mat4(1.f), glm::vec3(5000.f)));
+    const auto planes = TestPlanes();
+
+    for (const auto path : Paths()) {
+        const auto visible = culler.Cull(planes, path);
+        BE_CHECK(std::ranges::find(visible, index) != visible.end());
+    }
+}
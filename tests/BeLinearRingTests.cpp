@@ -0,0 +1,128 @@
+#include "BeTest.h"
+#include "BeLinearRing.h"
+
+BE_TEST("BeLinearRing: first allocation starts at 0 and wraps") {
+    auto ring = BeLinearRing(1024);
+    const auto first = ring.Allocate(100, 16);
+    BE_REQUIRE(first);
+    BE_CHECK(first->Offset == 0);
+    BE_CHECK(first->Wrapped);
+    BE_CHECK(ring.GetHead() == 100);
+}
+
+BE_TEST("BeLinearRing: offsets are aligned") {
+    auto ring = BeLinearRing(4096);
+    (void)ring.Allocate(1, 1);
+
+    for (const auto alignment : { 1ull, 4ull, 16ull, 256ull }) {
+        const auto allocation = ring.Allocate(3, alignment);
+        BE_REQUIRE(allocation);
+        BE_CHECK(allocation->Offset % alignment == 0);
+        BE_CHECK(!allocation->Wrapped);
+    }
+
+    // 1, then 3 at 1, 3 at 4, 3 at 16, 3 at 256
+    BE_CHECK(ring.GetHead() == 259);
+}
+
+BE_TEST("BeLinearRing: allocations don't overlap") {
+    auto ring = BeLinearRing(1 << 16);
+    auto end = uint64_t(0);
+    for (uint64_t i = 0; i < 100; i++) {
+        const auto size = 1 + i * 7 % 61;
+        const auto allocation = ring.Allocate(size, 16);
+        BE_REQUIRE(allocation);
+        BE_CHECK(allocation->Offset >= end || allocation->Wrapped);
+        end = allocation->Offset + size;
+    }
+}
+
+BE_TEST("BeLinearRing: wraps when the rest doesn't fit") {
+    auto ring = BeLinearRing(256);
+    (void)ring.Allocate(200, 16);
+
+    // 64 at 208 would end at 272
+    const auto wrapped = ring.Allocate(64, 16);
+    BE_REQUIRE(wrapped);
+    BE_CHECK(wrapped->Offset == 0);
+    BE_CHECK(wrapped->Wrapped);
+    BE_CHECK(ring.GetHead() == 64);
+
+    const auto next = ring.Allocate(16, 16);
+    BE_REQUIRE(next);
+    BE_CHECK(next->Offset == 64);
+    BE_CHECK(!next->Wrapped);
+}
+
+BE_TEST("BeLinearRing: the alignment padding counts towards fitting") {
+    auto ring = BeLinearRing(256);
+    (void)ring.Allocate(241, 1);
+
+    // 15 bytes are left, but aligned to 16 the allocation would start at 256
+    const auto allocation = ring.Allocate(1, 16);
+    BE_REQUIRE(allocation);
+    BE_CHECK(allocation->Wrapped);
+    BE_CHECK(allocation->Offset == 0);
+}
+
+BE_TEST("BeLinearRing: fills up to the last byte without wrapping") {
+    auto ring = BeLinearRing(256);
+    (void)ring.Allocate(128, 16);
+
+    const auto last = ring.Allocate(128, 16);
+    BE_REQUIRE(last);
+    BE_CHECK(last->Offset == 128);
+    BE_CHECK(!last->Wrapped);
+    BE_CHECK(ring.GetHead() == ring.GetCapacity());
+}
+
+BE_TEST("BeLinearRing: more than the capacity is refused") {
+    auto ring = BeLinearRing(256);
+    BE_CHECK(!ring.Allocate(257, 1));
+    BE_CHECK(ring.Allocate(256, 1));
+
+    // a refused request leaves the ring alone
+    (void)ring.Allocate(16, 16);
+    const auto head = ring.GetHead();
+    BE_CHECK(!ring.Allocate(1024, 16));
+    BE_CHECK(ring.GetHead() == head);
+}
+
+BE_TEST("BeLinearRing: an empty ring refuses everything but empty requests") {
+    auto ring = BeLinearRing(0);
+    BE_CHECK(!ring.Allocate(1, 1));
+    BE_CHECK(ring.Allocate(0, 1));
+}
+
+BE_TEST("BeLinearRing: reset wraps the next allocation, every frame") {
+    auto ring = BeLinearRing(1024);
+    for (auto frame = 0; frame < 3; frame++) {
+        ring.Reset();
+
+        const auto first = ring.Allocate(32, 16);
+        BE_REQUIRE(first);
+        BE_CHECK(first->Offset == 0);
+        BE_CHECK(first->Wrapped);
+
+        const auto second = ring.Allocate(32, 16);
+        BE_REQUIRE(second);
+        BE_CHECK(second->Offset == 32);
+        BE_CHECK(!second->Wrapped);
+    }
+}
+
+BE_TEST("BeLinearRing: without a reset frames keep going where the last one stopped") {
+    auto ring = BeLinearRing(256);
+    auto wraps = 0;
+    auto offset = uint64_t(0);
+    for (auto frame = 0; frame < 10; frame++) {
+        const auto allocation = ring.Allocate(96, 16);
+        BE_REQUIRE(allocation);
+        wraps += allocation->Wrapped ? 1 : 0;
+        offset = allocation->Offset;
+    }
+
+    // 0, 96, wrap, 96, wrap... every other allocation after the first two
+    BE_CHECK(wraps == 5);
+    BE_CHECK(offset == 96);
+}
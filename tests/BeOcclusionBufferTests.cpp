@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "BeTest.h"
+#include "BeOcclusionBuffer.h"
+
+// world x and y are pixels and z is depth, so the numbers below can be read straight off the screen
+static auto PixelProjection() -> glm::mat4 {
+    return glm::ortho(0.f, float(BeOcclusionBuffer::Width), float(BeOcclusionBuffer::Height), 0.f, 0.f, 1.f);
+}
+
+// one triangle with its right angle at the corner and its legs three times the size along the two directions, so it
+// covers the rectangle between the corner and corner + size without an inner edge running through it
+static auto Cover(const glm::vec2 corner, const glm::vec2 size, const float depth) -> std::vector<glm::vec3> {
+    return {
+        glm::vec3(corner, depth),
+        glm::vec3(corner.x + size.x * 3.f, corner.y, depth),
+        glm::vec3(corner.x, corner.y + size.y * 3.f, depth),
+    };
+}
+
+static auto IsVisible(const BeOcclusionBuffer& buffer, const glm::vec2 min, const glm::vec2 max, const float nearest, const float farthest) -> bool {
+    const auto boxMin = glm::vec3(min, nearest), boxMax = glm::vec3(max, farthest);
+    return buffer.IsVisible((boxMin + boxMax) * 0.5f, (boxMax - boxMin) * 0.5f);
+}
+
+BE_TEST("BeOcclusionBuffer: nothing rasterized hides nothing") {
+    auto buffer = BeOcclusionBuffer();
+    buffer.Begin(PixelProjection());
+    BE_CHECK(IsVisible(buffer, { 10, 10 }, { 50, 50 }, 0.9f, 0.95f));
+}
+
+BE_TEST("BeOcclusionBuffer: hides what's behind, keeps what's in front or crossing") {
+    auto buffer = BeOcclusionBuffer();
+    buffer.Begin(PixelProjection());
+    // x up to 128, y up to 96
+    buffer.RasterizeOccluder(Cover({ 128, 96 }, { -112, -80 }, 0.5f), glm::mat4(1.f));
+
+    BE_CHECK(!IsVisible(buffer, { 40, 40 }, { 60, 60 }, 0.6f, 0.7f));
+    BE_CHECK(IsVisible(buffer, { 40, 40 }, { 60, 60 }, 0.3f, 0.4f));
+    BE_CHECK(IsVisible(buffer, { 40, 40 }, { 60, 60 }, 0.45f, 0.55f));
+    // sticking out on the side
+    BE_CHECK(IsVisible(buffer, { 100, 40 }, { 140, 60 }, 0.6f, 0.7f));
+}
+
+BE_TEST("BeOcclusionBuffer: a box is tested on every pixel it touches") {
+    auto buffer = BeOcclusionBuffer();
+    buffer.Begin(PixelProjection());
+    // the right edge runs just past the left side of pixel column 100. right on it, rounding could go either way
+    buffer.RasterizeOccluder(Cover({ 100.05f, 96 }, { -84, -80 }, 0.5f), glm::mat4(1.f));
+
+    // up to column 99
+    BE_CHECK(!IsVisible(buffer, { 50, 40 }, { 100.f, 60 }, 0.6f, 0.7f));
+    // reaching into column 100, but not as far as its center
+    BE_CHECK(IsVisible(buffer, { 50, 40 }, { 100.2f, 60 }, 0.6f, 0.7f));
+    BE_CHECK(IsVisible(buffer, { 99.6f, 40 }, { 100.4f, 60 }, 0.6f, 0.7f));
+}
+
+BE_TEST("BeOcclusionBuffer: occluders only cover pixels they cover entirely") {
+    auto buffer = BeOcclusionBuffer();
+    buffer.Begin(PixelProjection());
+    // the right edge runs through column 100 past its center
+    buffer.RasterizeOccluder(Cover({ 100.7f, 96 }, { -84, -80 }, 0.5f), glm::mat4(1.f));
+
+    BE_CHECK(!IsVisible(buffer, { 50, 40 }, { 99.9f, 60 }, 0.6f, 0.7f));
+    // the box is behind the occluder, but the pixel isn't covered all the way
+    BE_CHECK(IsVisible(buffer, { 100.1f, 40 }, { 100.6f, 60 }, 0.6f, 0.7f));
+}
+
+BE_TEST("BeOcclusionBuffer: depth is the farthest across a pixel") {
+    auto buffer = BeOcclusionBuffer();
+    buffer.Begin(PixelProjection());
+    // 0.2 + 0.002 per pixel to the right, over the whole screen
+    const auto slope = std::vector {
+        glm::vec3(0, 0, 0.2f),
+        glm::vec3(256, 0, 0.2f + 0.002f * 256),
+        glm::vec3(0, 288, 0.2f),
+    };
+    buffer.RasterizeOccluder(slope, glm::mat4(1.f));
+
+    // column 63 goes from 0.326 to 0.328, its center is at 0.327. a box starting between the center and the far side
+    // is only partly behind it
+    BE_CHECK(IsVisible(buffer, { 63.2f, 20 }, { 63.8f, 21 }, 0.3275f, 0.9f));
+    BE_CHECK(!IsVisible(buffer, { 63.2f, 20 }, { 63.8f, 21 }, 0.3285f, 0.9f));
+}
+
+BE_TEST("BeOcclusionBuffer: triangles in front of the near plane don't occlude") {
+    auto buffer = BeOcclusionBuffer();
+    buffer.Begin(PixelProjection());
+    auto reaching = Cover({ 128, 96 }, { -112, -80 }, 0.5f);
+    reaching[1].z = -0.1f;
+    buffer.RasterizeOccluder(reaching, glm::mat4(1.f));
+
+    BE_CHECK(IsVisible(buffer, { 40, 40 }, { 60, 60 }, 0.6f, 0.7f));
+}
+
+BE_TEST("BeOcclusionBuffer: partly covered tiles keep a working layer") {
+    auto buffer = BeOcclusionBuffer();
+    buffer.Begin(PixelProjection());
+    // x up to 36, the middle of the tiles from 32 to 40
+    buffer.RasterizeOccluder(Cover({ 36.05f, 48 }, { -20, -32 }, 0.4f), glm::mat4(1.f));
+
+    const auto& tile = buffer.GetTiles()[2 * BeOcclusionBuffer::TilesX + 4];
+    BE_CHECK(tile.Mask != 0 && tile.Mask != BeOcclusionBuffer::FullMask);
+    BE_CHECK(tile.Reference == 1.f);
+
+    BE_CHECK(!IsVisible(buffer, { 33, 20 }, { 36, 40 }, 0.5f, 0.6f));
+    BE_CHECK(IsVisible(buffer, { 33, 20 }, { 36.5f, 40 }, 0.5f, 0.6f));
+}
+
+BE_TEST("BeOcclusionBuffer: working layers that fill a tile become its reference") {
+    auto buffer = BeOcclusionBuffer();
+    buffer.Begin(PixelProjection());
+    // meeting at x 36, one from the left and one from the right
+    buffer.RasterizeOccluder(Cover({ 36.05f, 48.05f }, { -20, -32 }, 0.4f), glm::mat4(1.f));
+    buffer.RasterizeOccluder(Cover({ 35.95f, 48.05f }, { 20, -32 }, 0.5f), glm::mat4(1.f));
+
+    const auto& tile = buffer.GetTiles()[2 * BeOcclusionBuffer::TilesX + 4];
+    BE_CHECK(tile.Mask == 0);
+    BE_CHECK(std::abs(tile.Reference - 0.5f) < 1e-5f);
+
+    // across the seam, behind both and between the two
+    BE_CHECK(!IsVisible(buffer, { 30, 20 }, { 42, 40 }, 0.55f, 0.6f));
+    BE_CHECK(IsVisible(buffer, { 30, 20 }, { 42, 40 }, 0.45f, 0.6f));
+}
+
+BE_TEST("BeOcclusionBuffer: a much nearer triangle replaces the working layer") {
+    auto buffer = BeOcclusionBuffer();
+    buffer.Begin(PixelProjection());
+    buffer.RasterizeOccluder(Cover({ 36.05f, 48.05f }, { -20, -32 }, 0.8f), glm::mat4(1.f));
+    buffer.RasterizeOccluder(Cover({ 35.95f, 48.05f }, { 20, -32 }, 0.1f), glm::mat4(1.f));
+
+    const auto& tile = buffer.GetTiles()[2 * BeOcclusionBuffer::TilesX + 4];
+    BE_CHECK(std::abs(tile.Working - 0.1f) < 1e-5f);
+    BE_CHECK(tile.Reference == 1.f);
+
+    // the right half kept its near depth, the left half fell back to the reference
+    BE_CHECK(!IsVisible(buffer, { 37, 20 }, { 39, 40 }, 0.2f, 0.3f));
+    BE_CHECK(IsVisible(buffer, { 33, 20 }, { 35, 40 }, 0.9f, 0.95f));
+}
+
+BE_TEST("BeOcclusionBuffer: whatever is hidden is behind an occluder everywhere") {
+    auto random = std::mt19937(7);
+    auto coordinate = std::uniform_real_distribution(-20.f, 280.f);
+    auto depth = std::uniform_real_distribution(0.05f, 0.6f);
+    auto offset = std::uniform_real_distribution(0.f, 1.f);
+
+    auto triangles = std::vector<glm::vec3>();
+    for (auto i = 0; i < 40 * 3; i++)
+        triangles.emplace_back(coordinate(random), coordinate(random) * 0.6f, depth(random));
+
+    auto buffer = BeOcclusionBuffer();
+    buffer.Begin(PixelProjection());
+    buffer.RasterizeOccluder(triangles, glm::mat4(1.f));
+
+    // the depth of the nearest triangle at a point, 1 if there's none
+    const auto depthAt = [&triangles](const glm::vec2 point) {
+        auto nearest = 1.f;
+        for (size_t i = 0; i < triangles.size(); i += 3) {
+            const auto a = triangles[i], b = triangles[i + 1], c = triangles[i + 2];
+            const auto area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            const auto wa = ((b.x - point.x) * (c.y - point.y) - (b.y - point.y) * (c.x - point.x)) / area;
+            const auto wb = ((c.x - point.x) * (a.y - point.y) - (c.y - point.y) * (a.x - point.x)) / area;
+            const auto wc = 1.f - wa - wb;
+            if (wa >= 0.f && wb >= 0.f && wc >= 0.f)
+                nearest = std::min(nearest, wa * a.z + wb * b.z + wc * c.z);
+        }
+        return nearest;
+    };
+
+    auto hidden = 0;
+    for (auto i = 0; i < 400; i++) {
+        const auto min = glm::vec2(offset(random) * 240.f, offset(random) * 130.f);
+        const auto max = min + glm::vec2(0.3f + offset(random) * 12.f, 0.3f + offset(random) * 12.f);
+        const auto nearest = 0.1f + offset(random) * 0.8f;
+        if (IsVisible(buffer, min, max, nearest, nearest + 0.05f))
+            continue;
+
+        hidden++;
+        for (auto y = min.y; y <= max.y; y += 0.125f)
+            for (auto x = min.x; x <= max.x; x += 0.125f)
+                BE_REQUIRE(depthAt({ x, y }) < nearest);
+    }
+
+    // otherwise there's nothing to check
+    BE_CHECK(hidden > 20);
+}
@@ -0,0 +1,115 @@
+#include <random>
+
+#include "BeTest.h"
+#include "BeTaskPool.h"
+#include "scenes/BeParallelExtractor.h"
+
+namespace {
+    struct TestTransform {
+        glm::vec3 Position;
+        glm::quat Rotation;
+        glm::vec3 Scale;
+    };
+
+    struct TestRender {
+        bool CastShadows;
+        bool Hidden; // left out by the extraction
+    };
+
+    // transforms on every entity, renders on most, so the leading storage holds entities the view skips. some are
+    // destroyed again to leave holes in the storages
+    auto FillRegistry(entt::registry& registry, const size_t count) -> void {
+        auto random = std::mt19937(7);
+        auto unit = std::uniform_real_distribution(-1.f, 1.f);
+        auto entities = std::vector<entt::entity>(count);
+        registry.create(entities.begin(), entities.end());
+        for (const auto entity : entities) {
+            registry.emplace<TestTransform>(entity,
+                glm::vec3(unit(random), unit(random), unit(random)) * 100.f,
+                glm::normalize(glm::quat(unit(random), unit(random), unit(random), unit(random))),
+                glm::vec3(1.f + unit(random) * 0.5f));
+            if (random() % 8 != 0)
+                registry.emplace<TestRender>(entity, random() % 2 == 0, random() % 16 == 0);
+        }
+        for (size_t i = 0; i < count; i += 37)
+            registry.destroy(entities[i]);
+    }
+
+    auto Extract(const entt::registry& registry, const uint32_t workers, BeBRPSubmissionBuffer& buffer) -> size_t {
+        auto extractor = BeParallelExtractor(BeTaskPool::Create(workers));
+        const auto view = registry.view<const TestTransform, const TestRender>();
+        return extractor.ExtractGeometry(view, buffer, [&](const entt::entity entity, BeBRPGeometryEntry& entry) {
+            const auto& [transform, render] = view.get<const TestTransform, const TestRender>(entity);
+            if (render.Hidden)
+                return false;
+            entry.ModelMatrix = BeBRPGeometryEntry::CalculateModelMatrix(transform.Position, transform.Rotation, transform.Scale);
+            entry.CastShadows = render.CastShadows;
+            return true;
+        });
+    }
+}
+
+BE_TEST("BeParallelExtractor: submits what the view holds, in storage order") {
+    auto registry = entt::registry();
+    FillRegistry(registry, 5000);
+
+    auto buffer = BeBRPSubmissionBuffer();
+    const auto submitted = Extract(registry, 0, buffer);
+
+    auto expected = std::vector<glm::mat4>();
+    const auto view = registry.view<const TestTransform, const TestRender>();
+    const auto& leading = *view.handle();
+    for (size_t i = 0; i < leading.size(); i++) {
+        const auto entity = leading[i];
+        if (!view.contains(entity) || view.get<const TestRender>(entity).Hidden)
+            continue;
+        const auto& transform = view.get<const TestTransform>(entity);
+        expected.push_back(BeBRPGeometryEntry::CalculateModelMatrix(transform.Position, transform.Rotation, transform.Scale));
+    }
+
+    const auto& entries = buffer.GetGeometryEntries();
+    BE_REQUIRE(submitted == expected.size());
+    BE_REQUIRE(entries.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); i++)
+        BE_CHECK(entries[i].ModelMatrix == expected[i]);
+}
+
+BE_TEST("BeParallelExtractor: the same entries with and without workers") {
+    auto registry = entt::registry();
+    FillRegistry(registry, 20 * BeParallelExtractor::ChunkSize + 123);
+
+    auto serial = BeBRPSubmissionBuffer();
+    const auto serialCount = Extract(registry, 0, serial);
+
+    for (const auto workers : { 1u, 3u, 8u }) {
+        // twice per pool size, so a lucky schedule isn't enough
+        for (auto run = 0; run < 2; run++) {
+            auto parallel = BeBRPSubmissionBuffer();
+            BE_REQUIRE(Extract(registry, workers, parallel) == serialCount);
+
+            const auto& expected = serial.GetGeometryEntries();
+            const auto& entries = parallel.GetGeometryEntries();
+            BE_REQUIRE(entries.size() == expected.size());
+            auto mismatches = size_t(0);
+            for (size_t i = 0; i < entries.size(); i++)
+                mismatches += entries[i].ModelMatrix != expected[i].ModelMatrix || entries[i].CastShadows != expected[i].CastShadows;
+            BE_CHECK(mismatches == 0);
+        }
+    }
+}
+
+BE_TEST("BeParallelExtractor: per frame entries follow the retained ones") {
+    auto registry = entt::registry();
+    FillRegistry(registry, 3000);
+
+    auto buffer = BeBRPSubmissionBuffer();
+    auto retained = BeBRPGeometryEntry {};
+    retained.ModelMatrix = glm::mat4(2.f);
+    buffer.AddGeometry(retained);
+
+    const auto submitted = Extract(registry, 3, buffer);
+    const auto& entries = buffer.GetGeometryEntries();
+    BE_REQUIRE(entries.size() == submitted + 1);
+    BE_CHECK(entries[0].ModelMatrix == glm::mat4(2.f));
+    BE_CHECK(buffer.GetGeometryVersions().size() == entries.size());
+}
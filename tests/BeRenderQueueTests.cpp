@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "BeTest.h"
+#include "BeRenderQueue.h"
+
+namespace {
+    auto Field(const uint64_t key, const uint32_t bits, const uint32_t shift) -> uint64_t {
+        return key >> shift & ((1ull << bits) - 1);
+    }
+
+    auto Items(const BeRenderQueue& queue) -> std::vector<BeRenderQueue::Item> {
+        const auto items = queue.GetItems();
+        return { items.begin(), items.end() };
+    }
+}
+
+BE_TEST("BeRenderQueue: key fields land in their bits, high to low") {
+    const auto key = BeRenderQueue::MakeKey(3, 0xBEEF, 0x2A, 0xABCDE, 0x1234);
+    BE_CHECK(Field(key, BeRenderQueue::PassBits, BeRenderQueue::PassShift) == 3);
+    BE_CHECK(Field(key, BeRenderQueue::ShaderBits, BeRenderQueue::ShaderShift) == 0xBEEF);
+    BE_CHECK(Field(key, BeRenderQueue::StateBits, BeRenderQueue::StateShift) == 0x2A);
+    BE_CHECK(Field(key, BeRenderQueue::MaterialBits, BeRenderQueue::MaterialShift) == 0xABCDE);
+    BE_CHECK(Field(key, BeRenderQueue::DepthBits, 0) == 0x1234);
+
+    // the pass outranks everything below it, the shader everything but the pass, and so on
+    BE_CHECK(BeRenderQueue::MakeKey(1, 0, 0, 0, 0) > BeRenderQueue::MakeKey(0, 0xFFFF, 0xFF, 0xFFFFF, 0xFFFF));
+    BE_CHECK(BeRenderQueue::MakeKey(0, 1, 0, 0, 0) > BeRenderQueue::MakeKey(0, 0, 0xFF, 0xFFFFF, 0xFFFF));
+    BE_CHECK(BeRenderQueue::MakeKey(0, 0, 1, 0, 0) > BeRenderQueue::MakeKey(0, 0, 0, 0xFFFFF, 0xFFFF));
+    BE_CHECK(BeRenderQueue::MakeKey(0, 0, 0, 1, 0) > BeRenderQueue::MakeKey(0, 0, 0, 0, 0xFFFF));
+}
+
+BE_TEST("BeRenderQueue: ids wrap into their field without touching the others") {
+    const auto wrapped = BeRenderQueue::MakeKey(0x11, 0x1'0005, 0x1'07, 0x10'0009, 0x1'0002);
+    BE_CHECK(wrapped == BeRenderQueue::MakeKey(1, 5, 7, 9, 2));
+}
+
+BE_TEST("BeRenderQueue: depth buckets grow with distance and saturate") {
+    BE_CHECK(BeRenderQueue::DepthBucket(-5.f) == 0);
+    BE_CHECK(BeRenderQueue::DepthBucket(0.f) == 0);
+
+    auto previous = 0u;
+    for (auto distance = 0.5f; distance < 100'000.f; distance *= 1.5f) {
+        const auto bucket = BeRenderQueue::DepthBucket(distance);
+        BE_CHECK(bucket >= previous);
+        previous = bucket;
+    }
+    BE_CHECK(BeRenderQueue::DepthBucket(1e30f) == (1u << BeRenderQueue::DepthBits) - 1);
+
+    // near objects get the finer buckets
+    const auto near = BeRenderQueue::DepthBucket(2.f) - BeRenderQueue::DepthBucket(1.f);
+    const auto far = BeRenderQueue::DepthBucket(1001.f) - BeRenderQueue::DepthBucket(1000.f);
+    BE_CHECK(near > far);
+}
+
+BE_TEST("BeRenderQueue: sort matches a stable sort by key") {
+    auto random = std::mt19937_64(7);
+    auto queue = BeRenderQueue();
+
+    // few distinct keys, so plenty of ties to keep in order, spread over all the key bytes
+    auto keys = std::vector<uint64_t>();
+    for (auto i = 0; i < 16; i++)
+        keys.push_back(random());
+
+    for (uint32_t i = 0; i < 5000; i++)
+        queue.Push({ .Key = keys[random() % keys.size()], .Entry = i, .Slice = i % 3 });
+
+    auto expected = Items(queue);
+    std::ranges::stable_sort(expected, {}, &BeRenderQueue::Item::Key);
+    queue.Sort();
+
+    const auto sorted = Items(queue);
+    BE_REQUIRE(sorted.size() == expected.size());
+    auto same = true;
+    for (size_t i = 0; i < sorted.size(); i++)
+        same &= sorted[i].Key == expected[i].Key && sorted[i].Entry == expected[i].Entry;
+    BE_CHECK(same);
+}
+
+BE_TEST("BeRenderQueue: keys sharing bytes sort too") {
+    // only the depth byte differs, every other byte pass is skipped
+    auto queue = BeRenderQueue();
+    for (const auto depth : { 5u, 1u, 4u, 1u, 0u })
+        queue.Push({ .Key = BeRenderQueue::MakeKey(2, 7, 1, 9, depth), .Entry = depth });
+    queue.Sort();
+
+    auto depths = std::vector<uint64_t>();
+    for (const auto& item : queue.GetItems())
+        depths.push_back(Field(item.Key, BeRenderQueue::DepthBits, 0));
+    BE_CHECK(std::ranges::is_sorted(depths));
+    BE_CHECK(depths.size() == 5);
+
+    // and a single item or none at all
+    auto single = BeRenderQueue();
+    single.Push({ .Key = 42 });
+    single.Sort();
+    BE_CHECK(single.GetItems().size() == 1);
+    auto empty = BeRenderQueue();
+    empty.Sort();
+    BE_CHECK(empty.GetItems().empty());
+    BE_CHECK(empty.GetStats().Items == 0);
+}
+
+BE_TEST("BeRenderQueue: switches are counted before and after sorting") {
+    // two shaders alternating, each with two materials. a shader switch also counts as a state and material switch
+    auto queue = BeRenderQueue();
+    queue.Push({ .Key = BeRenderQueue::MakeKey(0, 1, 0, 10, 0) });
+    queue.Push({ .Key = BeRenderQueue::MakeKey(0, 2, 0, 20, 0) });
+    queue.Push({ .Key = BeRenderQueue::MakeKey(0, 1, 0, 11, 0) });
+    queue.Push({ .Key = BeRenderQueue::MakeKey(0, 2, 1, 20, 0) });
+    queue.Push({ .Key = BeRenderQueue::MakeKey(0, 1, 0, 10, 5) });
+    queue.Sort();
+
+    const auto& stats = queue.GetStats();
+    BE_CHECK(stats.Items == 5);
+    BE_CHECK(stats.UnsortedShaderSwitches == 5);
+    BE_CHECK(stats.UnsortedStateSwitches == 5);
+    BE_CHECK(stats.UnsortedMaterialSwitches == 5);
+
+    // sorted: shader 1 with materials 10, 10, 11, then shader 2 with state 0 and state 1, both material 20
+    BE_CHECK(stats.ShaderSwitches == 2);
+    BE_CHECK(stats.StateSwitches == 3);
+    BE_CHECK(stats.MaterialSwitches == 3);
+}
@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "BeTest.h"
+#include "BeMappedFile.h"
+#include "BeShaderPackage.h"
+
+namespace {
+    const auto VertexBytecode = std::array<uint8_t, 5> { 1, 2, 3, 4, 5 };
+    const auto PixelBytecode = std::array<uint8_t, 3> { 9, 8, 7 };
+    const auto ResourceStages = std::array<uint8_t, 4> { 0, 2, 0, 1 };
+    const auto SchemeJson = std::array<uint8_t, 2> { 0x90, 0x00 };
+
+    auto TwoShaders() -> BeShaderPackage::Contents {
+        auto contents = BeShaderPackage::Contents();
+
+        auto first = BeShaderPackage::Shader();
+        first.Name = "standard";
+        first.FilePath = "assets/shaders/standard.hlsl";
+        first.Blend = 1;
+        first.Cull = 2;
+        first.Depth = 3;
+        first.Topology = 4;
+        first.AnimatesGeometry = true;
+        first.VertexBytecode = VertexBytecode;
+        first.PixelBytecode = PixelBytecode;
+        first.VertexLayout = { "position", "normal", "uv0" };
+        first.MaterialLinks = { { "Object", "object-material", 1 }, { "Surface", "standard", 2 } };
+        first.Targets = { { "Color", 0 }, { "Normal", 1 } };
+        first.ResourceStages = ResourceStages;
+        contents.Shaders.push_back(first);
+
+        auto second = BeShaderPackage::Shader();
+        second.Name = "fullscreen";
+        second.Topology = 4;
+        second.PixelBytecode = PixelBytecode;
+        contents.Shaders.push_back(second);
+
+        contents.Schemes.push_back({ "standard", SchemeJson });
+        return contents;
+    }
+
+    auto Same(const std::span<const uint8_t> a, const std::span<const uint8_t> b) -> bool {
+        return std::ranges::equal(a, b);
+    }
+
+    auto TempPath(const std::string& name) -> std::filesystem::path {
+        return std::filesystem::temp_directory_path() / ("be-tests-" + name);
+    }
+
+    auto WriteFile(const std::filesystem::path& path, const std::span<const uint8_t> bytes) -> void {
+        auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    auto PatchU32(std::vector<uint8_t>& bytes, const size_t offset, const uint32_t value) -> void {
+        for (size_t i = 0; i < 4; i++)
+            bytes[offset + i] = uint8_t(value >> (i * 8));
+    }
+}
+
+BE_TEST("BeShaderPackage: write, map and read round trip") {
+    const auto path = TempPath("round-trip.besp");
+    WriteFile(path, BeShaderPackage::Write(TwoShaders()));
+
+    const auto file = BeMappedFile::Open(path);
+    BE_REQUIRE(file);
+    const auto read = BeShaderPackage::Read(file->GetBytes());
+    BE_REQUIRE(read.has_value());
+    BE_REQUIRE(read->Shaders.size() == 2);
+    BE_REQUIRE(read->Schemes.size() == 1);
+
+    const auto& shader = read->Shaders[0];
+    BE_CHECK(shader.Name == "standard");
+    BE_CHECK(shader.FilePath == "assets/shaders/standard.hlsl");
+    BE_CHECK(shader.Blend == 1 && shader.Cull == 2 && shader.Depth == 3 && shader.Topology == 4);
+    BE_CHECK(shader.AnimatesGeometry);
+    BE_CHECK(Same(shader.VertexBytecode, VertexBytecode));
+    BE_CHECK(shader.HullBytecode.empty());
+    BE_CHECK(shader.DomainBytecode.empty());
+    BE_CHECK(Same(shader.PixelBytecode, PixelBytecode));
+    BE_REQUIRE(shader.VertexLayout.size() == 3);
+    BE_CHECK(shader.VertexLayout[2] == "uv0");
+    BE_REQUIRE(shader.MaterialLinks.size() == 2);
+    BE_CHECK(shader.MaterialLinks[1].LinkName == "Surface");
+    BE_CHECK(shader.MaterialLinks[1].SchemeName == "standard");
+    BE_CHECK(shader.MaterialLinks[1].Slot == 2);
+    BE_REQUIRE(shader.Targets.size() == 2);
+    BE_CHECK(shader.Targets[1].Name == "Normal" && shader.Targets[1].Slot == 1);
+    BE_CHECK(Same(shader.ResourceStages, ResourceStages));
+
+    BE_CHECK(read->Shaders[1].Name == "fullscreen");
+    BE_CHECK(read->Shaders[1].VertexBytecode.empty());
+    BE_CHECK(!read->Shaders[1].AnimatesGeometry);
+    BE_CHECK(read->Schemes[0].Name == "standard");
+    BE_CHECK(Same(read->Schemes[0].Json, SchemeJson));
+
+    // the views point into the mapping, not into a copy
+    const auto bytes = file->GetBytes();
+    BE_CHECK(shader.PixelBytecode.data() >= bytes.data());
+    BE_CHECK(shader.PixelBytecode.data() + shader.PixelBytecode.size() <= bytes.data() + bytes.size());
+}
+
+BE_TEST("BeShaderPackage: every truncation is rejected") {
+    const auto bytes = BeShaderPackage::Write(TwoShaders());
+    for (size_t size = 0; size < bytes.size(); size++)
+        BE_CHECK(!BeShaderPackage::Read(std::span(bytes).first(size)).has_value());
+    BE_CHECK(BeShaderPackage::Read(bytes).has_value());
+}
+
+BE_TEST("BeShaderPackage: bad magic and version are rejected") {
+    auto badMagic = BeShaderPackage::Write(TwoShaders());
+    badMagic[0] ^= 0xFF;
+    const auto magic = BeShaderPackage::Read(badMagic);
+    BE_REQUIRE(!magic.has_value());
+    BE_CHECK(magic.error() == "Not a shader package");
+
+    auto badVersion = BeShaderPackage::Write(TwoShaders());
+    PatchU32(badVersion, 4, BeShaderPackage::Version + 1);
+    const auto version = BeShaderPackage::Read(badVersion);
+    BE_REQUIRE(!version.has_value());
+    BE_CHECK(version.error().starts_with("Shader package version"));
+}
+
+BE_TEST("BeShaderPackage: sizes and counts past the end of the file are rejected") {
+    const auto header = size_t(16);
+
+    // the first thing after the header is the first shader's name size
+    auto longName = BeShaderPackage::Write(TwoShaders());
+    PatchU32(longName, header, uint32_t(longName.size()));
+    BE_CHECK(!BeShaderPackage::Read(longName).has_value());
+
+    auto hugeName = BeShaderPackage::Write(TwoShaders());
+    PatchU32(hugeName, header, UINT32_MAX);
+    BE_CHECK(!BeShaderPackage::Read(hugeName).has_value());
+
+    // a shader count no file of this size could hold
+    auto manyShaders = BeShaderPackage::Write(TwoShaders());
+    PatchU32(manyShaders, 8, UINT32_MAX);
+    BE_CHECK(!BeShaderPackage::Read(manyShaders).has_value());
+
+    // one more scheme than written runs off the end
+    auto extraScheme = BeShaderPackage::Write(TwoShaders());
+    PatchU32(extraScheme, 12, 2);
+    BE_CHECK(!BeShaderPackage::Read(extraScheme).has_value());
+}
+
+BE_TEST("BeMappedFile: missing and empty files don't map") {
+    BE_CHECK(BeMappedFile::Open(TempPath("does-not-exist.besp")) == nullptr);
+
+    const auto empty = TempPath("empty.besp");
+    WriteFile(empty, {});
+    BE_CHECK(BeMappedFile::Open(empty) == nullptr);
+}
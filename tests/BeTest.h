@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdio>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// just enough of a test framework for core, the tests in windows/ make a WARP device of their own.
+// BE_TEST registers a test, BE_CHECK reports a failed condition and goes on, BE_REQUIRE also leaves the test
+namespace BeTest {
+    struct Case {
+        std::string_view Name;
+        std::function<void()> Run;
+    };
+
+    inline auto Cases() -> std::vector<Case>& {
+        static auto cases = std::vector<Case>();
+        return cases;
+    }
+
+    inline auto Failures() -> size_t& {
+        static auto failures = size_t(0);
+        return failures;
+    }
+
+    inline auto Fail(const char* file, const int line, const char* condition) -> void {
+        (void)std::fprintf(stderr, "  %s:%d: %s\n", file, line, condition);
+        Failures()++;
+    }
+
+    struct Registrar {
+        Registrar(const std::string_view name, std::function<void()> run) {
+            Cases().push_back({ name, std::move(run) });
+        }
+    };
+}
+
+#define BE_TEST_CONCAT_INNER(a, b) a##b
+#define BE_TEST_CONCAT(a, b) BE_TEST_CONCAT_INNER(a, b)
+
+#define BE_TEST(name) \
+    static auto BE_TEST_CONCAT(BeTestRun_, __LINE__)() -> void; \
+    static const BeTest::Registrar BE_TEST_CONCAT(BeTestRegistrar_, __LINE__) { name, &BE_TEST_CONCAT(BeTestRun_, __LINE__) }; \
+    static auto BE_TEST_CONCAT(BeTestRun_, __LINE__)() -> void
+
+#define BE_CHECK(condition) \
+    do { if (!(condition)) BeTest::Fail(__FILE__, __LINE__, #condition); } while (false)
+
+#define BE_REQUIRE(condition) \
+    do { if (!(condition)) { BeTest::Fail(__FILE__, __LINE__, #condition); return; } } while (false)
@@ -0,0 +1,27 @@
+#include <cstdio>
+#include <string_view>
+
+#include "BeTest.h"
+
+// tests [name filter], runs the tests whose name contains the filter. fails if any check did
+int main(const int argc, char** argv) {
+    const auto filter = argc > 1 ? std::string_view(argv[1]) : std::string_view();
+
+    auto run = size_t(0);
+    auto failed = size_t(0);
+    for (const auto& [name, test] : BeTest::Cases()) {
+        if (!filter.empty() && name.find(filter) == std::string_view::npos)
+            continue;
+
+        const auto failuresBefore = BeTest::Failures();
+        test();
+        run++;
+
+        const auto passed = BeTest::Failures() == failuresBefore;
+        failed += passed ? 0 : 1;
+        (void)std::printf("%s %.*s\n", passed ? "[ ok ]" : "[FAIL]", int(name.size()), name.data());
+    }
+
+    (void)std::printf("%zu of %zu passed\n", run - failed, run);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+#include <d3d11.h>
+#include <memory>
+#include <string>
+#include <wrl/client.h>
+
+#include "BeTest.h"
+#include "BeAssetRegistry.h"
+#include "BeMaterial.h"
+#include "BeMaterialScheme.h"
+#include "BePipeline.h"
+#include "BeRenderer.h"
+#include "BeShader.h"
+#include "BeStateCache.h"
+#include "BeTexture.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace {
+    // a WARP device is enough, nothing is drawn. the shader has no stages of its own, only the slots it reads:
+    // textures in pixel slots 0 and 2, so the two test materials bind separately
+    struct Fixture {
+        ComPtr<ID3D11Device> Device;
+        ComPtr<ID3D11DeviceContext> Context;
+        std::shared_ptr<BePipeline> Pipeline;
+        std::shared_ptr<BeShader> Shader;
+        std::shared_ptr<BeTexture> A;
+        std::shared_ptr<BeTexture> B;
+        std::shared_ptr<BeTexture> C;
+        std::shared_ptr<BeMaterial> MaterialA; // A in slot 0
+        std::shared_ptr<BeMaterial> MaterialB; // B in slot 2
+
+        Fixture() {
+            (void)D3D11CreateDevice(
+                nullptr, D3D_DRIVER_TYPE_WARP, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION, &Device, nullptr, &Context);
+            if (!Device)
+                return;
+
+            Pipeline = BePipeline::Create(Context, BeStateCache::Create(Device));
+
+            Shader = std::make_shared<BeShader>();
+            Shader->Name = "pipeline-test";
+            Shader->ShaderType = BeShaderType::Pixel;
+            Shader->State.Topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+            Shader->ResourceStages[0] = BeShaderType::Pixel;
+            Shader->ResourceStages[2] = BeShaderType::Pixel;
+
+            const auto texture = [&](const std::string& name) {
+                return BeTexture::Create(name)
+                    .SetBindFlags(D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET)
+                    .SetSize(4, 4)
+                    .AddToRegistry()
+                    .Build(Device);
+            };
+            A = texture("pipeline-test-a");
+            B = texture("pipeline-test-b");
+            C = texture("pipeline-test-c");
+
+            const auto renderer = BeRenderer(1, 1, nullptr);
+            MaterialA = BeMaterial::Create("a", BeMaterialScheme::CreateFromJson("pipeline-test-a",
+                Json::parse(R"(["Albedo: texture2d(0) = pipeline-test-a"])")), false, renderer);
+            MaterialB = BeMaterial::Create("b", BeMaterialScheme::CreateFromJson("pipeline-test-b",
+                Json::parse(R"(["Mask: texture2d(2) = pipeline-test-b"])")), false, renderer);
+        }
+
+        // binds the material with the test shader and reports what that cost
+        auto Bind(const std::shared_ptr<BeMaterial>& material) -> BePipeline::Stats {
+            Pipeline->BindShader(Shader, BeShaderType::All);
+            const auto before = Pipeline->GetStats();
+            Pipeline->BindMaterialManual(material, 0);
+            const auto after = Pipeline->GetStats();
+            Pipeline->Clear();
+            return { after.IssuedCalls - before.IssuedCalls, after.FilteredCalls - before.FilteredCalls, 0 };
+        }
+
+        auto BoundInPixelSlot(const UINT slot) const -> ID3D11ShaderResourceView* {
+            auto view = ComPtr<ID3D11ShaderResourceView>();
+            Context->PSGetShaderResources(slot, 1, &view);
+            return view.Get();
+        }
+    };
+}
+
+BE_TEST("BePipeline: repeated sets are filtered, changed ones are issued") {
+    auto fixture = Fixture();
+    BE_REQUIRE(fixture.Device);
+    const auto& pipeline = fixture.Pipeline;
+
+    auto viewport = D3D11_VIEWPORT { 0.f, 0.f, 4.f, 4.f, 0.f, 1.f };
+    pipeline->SetViewport(viewport);
+    pipeline->SetViewport(viewport);
+    viewport.Width = 2.f;
+    pipeline->SetViewport(viewport);
+    BE_CHECK(pipeline->GetStats().IssuedCalls == 2);
+    BE_CHECK(pipeline->GetStats().FilteredCalls == 1);
+
+    const auto rtv = fixture.C->GetRTV().Get();
+    pipeline->SetRenderTarget(rtv);
+    pipeline->SetRenderTargets({ &rtv, 1 }, nullptr);
+    BE_CHECK(pipeline->GetStats().IssuedCalls == 3);
+    BE_CHECK(pipeline->GetStats().FilteredCalls == 2);
+
+    const auto first = fixture.Bind(fixture.MaterialA);
+    BE_CHECK(first.IssuedCalls == 1);
+    BE_CHECK(fixture.BoundInPixelSlot(0) == fixture.A->GetSRV().Get());
+    const auto again = fixture.Bind(fixture.MaterialA);
+    BE_CHECK(again.IssuedCalls == 0);
+    BE_CHECK(again.FilteredCalls == 1);
+
+    // a different texture in the same slot goes out
+    fixture.MaterialA->SetTexture("Albedo", fixture.B);
+    const auto changed = fixture.Bind(fixture.MaterialA);
+    BE_CHECK(changed.IssuedCalls == 1);
+    BE_CHECK(fixture.BoundInPixelSlot(0) == fixture.B->GetSRV().Get());
+}
+
+BE_TEST("BePipeline: ClearCache re-issues everything, Clear keeps the context state") {
+    auto fixture = Fixture();
+    BE_REQUIRE(fixture.Device);
+    const auto& pipeline = fixture.Pipeline;
+
+    const auto viewport = D3D11_VIEWPORT { 0.f, 0.f, 4.f, 4.f, 0.f, 1.f };
+    pipeline->SetViewport(viewport);
+    (void)fixture.Bind(fixture.MaterialA);
+
+    // Clear only unbinds the shader logically, the same shader again commits nothing new
+    pipeline->BindShader(fixture.Shader, BeShaderType::All);
+    pipeline->Draw(0, 0);
+    pipeline->Clear();
+    pipeline->BindShader(fixture.Shader, BeShaderType::All);
+    const auto beforeDraw = pipeline->GetStats();
+    pipeline->Draw(0, 0);
+    pipeline->Clear();
+    BE_CHECK(pipeline->GetStats().IssuedCalls == beforeDraw.IssuedCalls);
+    BE_CHECK(fixture.Bind(fixture.MaterialA).IssuedCalls == 0);
+
+    // after ClearCache nothing is trusted, the same values go out again
+    pipeline->ClearCache();
+    const auto beforeViewport = pipeline->GetStats();
+    pipeline->SetViewport(viewport);
+    BE_CHECK(pipeline->GetStats().IssuedCalls == beforeViewport.IssuedCalls + 1);
+    BE_CHECK(fixture.Bind(fixture.MaterialA).IssuedCalls == 1);
+
+    pipeline->BindShader(fixture.Shader, BeShaderType::All);
+    const auto beforeCommit = pipeline->GetStats();
+    pipeline->Draw(0, 0);
+    pipeline->Clear();
+    BE_CHECK(pipeline->GetStats().IssuedCalls > beforeCommit.IssuedCalls);
+}
+
+BE_TEST("BePipeline: an output forgets only the inputs it aliases") {
+    auto fixture = Fixture();
+    BE_REQUIRE(fixture.Device);
+    const auto& pipeline = fixture.Pipeline;
+
+    (void)fixture.Bind(fixture.MaterialA);
+    (void)fixture.Bind(fixture.MaterialB);
+    BE_CHECK(fixture.BoundInPixelSlot(0) == fixture.A->GetSRV().Get());
+    BE_CHECK(fixture.BoundInPixelSlot(2) == fixture.B->GetSRV().Get());
+
+    // A still bound as an input, the runtime unbinds it. B is untouched and stays filtered
+    pipeline->SetRenderTarget(fixture.A->GetRTV().Get());
+    BE_CHECK(fixture.BoundInPixelSlot(0) == nullptr);
+    BE_CHECK(fixture.BoundInPixelSlot(2) == fixture.B->GetSRV().Get());
+    BE_CHECK(fixture.Bind(fixture.MaterialB).IssuedCalls == 0);
+
+    pipeline->SetRenderTarget(fixture.C->GetRTV().Get());
+    BE_CHECK(fixture.Bind(fixture.MaterialA).IssuedCalls == 1);
+    BE_CHECK(fixture.BoundInPixelSlot(0) == fixture.A->GetSRV().Get());
+}
+
+BE_TEST("BePipeline: an input refused for being an output isn't cached as bound") {
+    auto fixture = Fixture();
+    BE_REQUIRE(fixture.Device);
+    const auto& pipeline = fixture.Pipeline;
+
+    pipeline->SetRenderTarget(fixture.A->GetRTV().Get());
+    BE_CHECK(fixture.Bind(fixture.MaterialA).IssuedCalls == 1);
+    BE_CHECK(fixture.BoundInPixelSlot(0) == nullptr);
+
+    // C doesn't alias A, the bind still has to go out once A is free
+    pipeline->SetRenderTarget(fixture.C->GetRTV().Get());
+    BE_CHECK(fixture.Bind(fixture.MaterialA).IssuedCalls == 1);
+    BE_CHECK(fixture.BoundInPixelSlot(0) == fixture.A->GetSRV().Get());
+}
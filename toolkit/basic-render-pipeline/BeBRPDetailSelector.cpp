@@ -0,0 +1,96 @@
+#include "BeBRPDetailSelector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+auto BeBRPDetailSelector::ScreenSizeOf(
+    const glm::vec3& boundsMin,
+    const glm::vec3& boundsMax,
+    const glm::mat4& matrix,
+    const glm::vec3& cameraPosition,
+    const float screenScale
+) -> float {
+    constexpr auto infinite = std::numeric_limits<float>::infinity();
+    if (screenScale <= 0.f || boundsMin.x > boundsMax.x)
+        return infinite;
+
+    // the sphere around the local box, scaled by the largest axis
+    const auto center = glm::vec3(matrix * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.f));
+    const auto scale = std::max({ glm::length(glm::vec3(matrix[0])), glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2])) });
+    const auto radius = glm::length(boundsMax - boundsMin) * 0.5f * scale;
+    return ScreenSizeOf(center, radius, cameraPosition, screenScale);
+}
+
+auto BeBRPDetailSelector::ScreenSizeOf(
+    const glm::vec3& center,
+    const float radius,
+    const glm::vec3& cameraPosition,
+    const float screenScale
+) -> float {
+    constexpr auto infinite = std::numeric_limits<float>::infinity();
+    if (screenScale <= 0.f)
+        return infinite;
+
+    // across the cone the sphere fills, the camera inside it sees it everywhere
+    const auto offset = center - cameraPosition;
+    const auto tangentSquared = glm::dot(offset, offset) - radius * radius;
+    if (tangentSquared <= 0.f)
+        return infinite;
+    return 2.f * radius * screenScale / std::sqrt(tangentSquared);
+}
+
+auto BeBRPDetailSelector::ModelFor(const BeBRPGeometryEntry& entry, const float screenSize) -> const std::shared_ptr<BeModel>& {
+    if (!entry.Lods)
+        return entry.Model;
+
+    const BeBRPModelLod* best = nullptr;
+    for (const auto& lod : *entry.Lods)
+        if (screenSize <= lod.MaxScreenSize && (!best || lod.MaxScreenSize < best->MaxScreenSize))
+            best = &lod;
+    return best ? best->Model : entry.Model;
+}
+
+auto BeBRPDetailSelector::Select(
+    const std::span<const BeBRPGeometryEntry> entries,
+    const std::span<const uint32_t> candidates,
+    const glm::vec3& cameraPosition,
+    const float screenScale,
+    const BoundsFunction& bounds
+) -> std::span<const uint32_t> {
+    _kept.clear();
+    _screenSizes.clear();
+    _stats.Dropped = 0;
+    for (const auto index : candidates) {
+        const auto [boundsMin, boundsMax] = bounds(*entries[index].Model);
+        const auto screenSize = ScreenSizeOf(boundsMin, boundsMax, entries[index].ModelMatrix, cameraPosition, screenScale);
+        if (screenSize < entries[index].MinScreenSize) {
+            _stats.Dropped++;
+            continue;
+        }
+        _kept.push_back(index);
+        _screenSizes.push_back(screenSize);
+    }
+    return _kept;
+}
+
+auto BeBRPDetailSelector::Models(
+    const std::span<const BeBRPGeometryEntry> entries,
+    const std::span<const uint32_t> selection
+) -> std::span<const std::shared_ptr<BeModel>* const> {
+    // both ascending, one walk finds the size of each
+    _models.clear();
+    _stats.Simplified = 0;
+    size_t kept = 0;
+    for (const auto index : selection) {
+        while (kept < _kept.size() && _kept[kept] < index)
+            kept++;
+        assert(kept < _kept.size() && _kept[kept] == index);
+
+        const auto& model = ModelFor(entries[index], _screenSizes[kept]);
+        _stats.Simplified += &model != &entries[index].Model;
+        _models.push_back(&model);
+    }
+    return _models;
+}
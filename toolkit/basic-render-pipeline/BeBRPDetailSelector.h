@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+#include <umbrellas/access-modifiers.hpp>
+#include <umbrellas/include-glm.h>
+
+#include "BeBRPSubmissionBuffer.h"
+
+struct BeModel;
+
+// screen size policies of geometry entries: too small to draw, drawn with a lod, too small to cast shadows. the size
+// is how many pixels the entry's bounding sphere spans on the camera's screen, from the model's bounds, so every pass
+// gets the same answer. entries without bounds, and all of them while the screen scale is 0, are infinitely large
+class BeBRPDetailSelector {
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    // of local bounds under a model matrix
+    expose static auto ScreenSizeOf(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& matrix, const glm::vec3& cameraPosition, float screenScale) -> float;
+    expose static auto ScreenSizeOf(const glm::vec3& center, float radius, const glm::vec3& cameraPosition, float screenScale) -> float;
+    // the smallest of the entry's lods that the size still fits, the entry's own model if none does
+    expose static auto ModelFor(const BeBRPGeometryEntry& entry, float screenSize) -> const std::shared_ptr<BeModel>&;
+
+
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+    // local min and max of a model's bounds, min past max for a model without any. see BeModel::GetBounds
+    using BoundsFunction = std::function<std::pair<glm::vec3, glm::vec3>(const BeModel&)>;
+
+    expose struct Stats {
+        uint32_t Dropped = 0; // smaller than their MinScreenSize
+        uint32_t Simplified = 0; // drawn with a lod
+    };
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide std::vector<uint32_t> _kept;
+    hide std::vector<float> _screenSizes; // by kept entry
+    hide std::vector<const std::shared_ptr<BeModel>*> _models; // scratch
+    hide Stats _stats;
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    // candidates are ascending entry indices. returns the ascending ones that are large enough to draw
+    expose auto Select(
+        std::span<const BeBRPGeometryEntry> entries,
+        std::span<const uint32_t> candidates,
+        const glm::vec3& cameraPosition,
+        float screenScale,
+        const BoundsFunction& bounds
+    ) -> std::span<const uint32_t>;
+    // the model each of the selection draws with, parallel to it. the selection is ascending and out of the last Select
+    expose auto Models(
+        std::span<const BeBRPGeometryEntry> entries,
+        std::span<const uint32_t> selection
+    ) -> std::span<const std::shared_ptr<BeModel>* const>;
+
+    expose auto GetStats() const -> const Stats& { return _stats; }
+};
@@ -0,0 +1,31 @@
+#include "BeBRPInstanceBuffer.h"
+
+#include <bit>
+#include <cstring>
+
+#include "Utils.h"
+
+auto BeBRPInstanceBuffer::Upload(
+    ID3D11Device* device,
+    ID3D11DeviceContext* context,
+    const std::span<const glm::mat4> matrices
+) -> void {
+    if (matrices.empty())
+        return;
+
+    if (matrices.size() > _capacity) {
+        _capacity = std::bit_ceil(matrices.size());
+
+        D3D11_BUFFER_DESC bufferDesc = {};
+        bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        bufferDesc.ByteWidth = static_cast<UINT>(_capacity * Stride);
+        bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+        bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        Utils::Check << device->CreateBuffer(&bufferDesc, nullptr, _buffer.ReleaseAndGetAddressOf());
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    Utils::Check << context->Map(_buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+    memcpy(mappedResource.pData, matrices.data(), matrices.size_bytes());
+    context->Unmap(_buffer.Get(), 0);
+}
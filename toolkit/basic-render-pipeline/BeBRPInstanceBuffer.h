@@ -0,0 +1,24 @@
+#pragma once
+#include <d3d11.h>
+#include <span>
+#include <umbrellas/access-modifiers.hpp>
+#include <umbrellas/include-glm.h>
+#include <wrl/client.h>
+
+using Microsoft::WRL::ComPtr;
+
+// dynamic vertex buffer with one model matrix per instance, bound with BePipeline::SetInstanceBuffer.
+// rewritten whole with one discard map per upload, grows to the next power of two when it runs out
+class BeBRPInstanceBuffer {
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose static constexpr UINT Stride = sizeof(glm::mat4);
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide ComPtr<ID3D11Buffer> _buffer;
+    hide size_t _capacity = 0; // in matrices
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose auto Upload(ID3D11Device* device, ID3D11DeviceContext* context, std::span<const glm::mat4> matrices) -> void;
+    expose auto GetBuffer() const -> ID3D11Buffer* { return _buffer.Get(); }
+};
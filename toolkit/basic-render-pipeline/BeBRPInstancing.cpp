@@ -0,0 +1,67 @@
+#include "BeBRPInstancing.h"
+
+#include <cassert>
+
+auto BeBRPInstanceBatcher::Build(
+    const std::span<const BeBRPGeometryEntry> entries,
+    const bool shadowCastersOnly,
+    const InstancedFunction& isInstanced
+) -> void {
+    _selection.clear();
+    for (uint32_t i = 0; i < entries.size(); i++)
+        if (!shadowCastersOnly || entries[i].CastShadows)
+            _selection.push_back(i);
+    Build(entries, _selection, isInstanced);
+}
+
+auto BeBRPInstanceBatcher::Build(
+    const std::span<const BeBRPGeometryEntry> entries,
+    const std::span<const uint32_t> selection,
+    const InstancedFunction& isInstanced
+) -> void {
+    Build(entries, selection, {}, isInstanced);
+}
+
+auto BeBRPInstanceBatcher::Build(
+    const std::span<const BeBRPGeometryEntry> entries,
+    const std::span<const uint32_t> selection,
+    const std::span<const std::shared_ptr<BeModel>* const> models,
+    const InstancedFunction& isInstanced
+) -> void {
+    assert(models.empty() || models.size() == selection.size());
+    _batches.clear();
+    _matrices.clear();
+    _entryBatches.clear();
+    _batchByModel.clear();
+
+    // counting pass, batches in order of their first entry
+    for (size_t i = 0; i < selection.size(); i++) {
+        const auto& model = models.empty() ? entries[selection[i]].Model : *models[i];
+        const auto batch = static_cast<uint32_t>(_batches.size());
+        const auto [it, inserted] = _batchByModel.try_emplace(model.get(), batch);
+        if (inserted && !isInstanced(*model))
+            it->second = NotInstanced;
+
+        if (!inserted && it->second != NotInstanced) {
+            _batches[it->second].InstanceCount++;
+            _entryBatches.push_back(it->second);
+            continue;
+        }
+        _batches.push_back({ .Model = model, .FirstInstance = 0, .InstanceCount = 1 });
+        _entryBatches.push_back(batch);
+    }
+
+    // counts to offsets, then scatter the matrices
+    uint32_t offset = 0;
+    for (auto& batch : _batches) {
+        batch.FirstInstance = offset;
+        offset += batch.InstanceCount;
+        batch.InstanceCount = 0;
+    }
+
+    _matrices.resize(offset);
+    for (size_t i = 0; i < selection.size(); i++) {
+        auto& batch = _batches[_entryBatches[i]];
+        _matrices[batch.FirstInstance + batch.InstanceCount++] = entries[selection[i]].ModelMatrix;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <umbrellas/access-modifiers.hpp>
+#include <umbrellas/include-glm.h>
+
+#include "BeBRPSubmissionBuffer.h"
+
+struct BeModel;
+
+// entries that draw the same model, with the same shader and slice materials, in submission order.
+// their matrices are back to back at [FirstInstance, FirstInstance + InstanceCount)
+struct BeBRPInstanceBatch {
+    std::shared_ptr<BeModel> Model;
+    uint32_t FirstInstance = 0;
+    uint32_t InstanceCount = 0;
+};
+
+// groups geometry entries by model, cpu only. models that can't instance get one batch per entry
+class BeBRPInstanceBatcher {
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+    // whether a model's draws read their matrix from the instance stream, asked once per model and build
+    using InstancedFunction = std::function<bool(const BeModel&)>;
+
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide static constexpr uint32_t NotInstanced = UINT32_MAX;
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide std::vector<BeBRPInstanceBatch> _batches;
+    hide std::vector<glm::mat4> _matrices;
+    hide std::vector<uint32_t> _entryBatches; // by included entry, scratch
+    hide std::unordered_map<const BeModel*, uint32_t> _batchByModel; // NotInstanced for models that can't, scratch
+    hide std::vector<uint32_t> _selection; // scratch
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose auto Build(
+        std::span<const BeBRPGeometryEntry> entries,
+        bool shadowCastersOnly,
+        const InstancedFunction& isInstanced
+    ) -> void;
+    // only the entries at the given ascending indices, e.g. what survived culling
+    expose auto Build(
+        std::span<const BeBRPGeometryEntry> entries,
+        std::span<const uint32_t> selection,
+        const InstancedFunction& isInstanced
+    ) -> void;
+    // same, with the models the selection draws with in place of the entries' own, e.g. lods
+    expose auto Build(
+        std::span<const BeBRPGeometryEntry> entries,
+        std::span<const uint32_t> selection,
+        std::span<const std::shared_ptr<BeModel>* const> models,
+        const InstancedFunction& isInstanced
+    ) -> void;
+
+    expose auto GetBatches() const -> std::span<const BeBRPInstanceBatch> { return _batches; }
+    expose auto GetMatrices() const -> std::span<const glm::mat4> { return _matrices; }
+};
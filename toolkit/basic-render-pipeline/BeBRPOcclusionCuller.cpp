@@ -0,0 +1,77 @@
+#include "BeBRPOcclusionCuller.h"
+
+#include <algorithm>
+#include <array>
+
+#include "BeFrustumCuller.h"
+#include "BeModel.h"
+
+auto BeBRPOccluderMesh::FromModel(const BeModel& model, const uint32_t maxTriangles) -> BeBRPOccluderMesh {
+    struct Triangle {
+        std::array<glm::vec3, 3> Corners;
+        float Area;
+    };
+
+    auto triangles = std::vector<Triangle>();
+    for (const auto& slice : model.DrawSlices) {
+        for (uint32_t i = 0; i + 2 < slice.IndexCount; i += 3) {
+            const auto corner = [&](const uint32_t k) {
+                const auto index = model.Indices[slice.StartIndexLocation + i + k];
+                return model.FullVertices[slice.BaseVertexLocation + index].Position;
+            };
+            const auto a = corner(0), b = corner(1), c = corner(2);
+            triangles.push_back({ .Corners = {a, b, c}, .Area = glm::length(glm::cross(b - a, c - a)) });
+        }
+    }
+
+    // largest first, ties by submission order so the result doesn't depend on the sort
+    const auto count = std::min<size_t>(maxTriangles, triangles.size());
+    std::ranges::stable_sort(triangles, std::greater(), &Triangle::Area);
+
+    auto mesh = BeBRPOccluderMesh();
+    mesh.Triangles.reserve(count * 3);
+    for (size_t i = 0; i < count; i++)
+        mesh.Triangles.insert(mesh.Triangles.end(), triangles[i].Corners.begin(), triangles[i].Corners.end());
+    return mesh;
+}
+
+auto BeBRPOcclusionCuller::Cull(
+    const std::span<const BeBRPGeometryEntry> entries,
+    const std::span<const uint32_t> candidates,
+    const BeFrustumCuller& boxes,
+    const glm::mat4& projectionView
+) -> std::span<const uint32_t> {
+    _visible.clear();
+    _occludedCount = 0;
+
+    const auto hasOccluders = std::ranges::any_of(candidates, [&entries](const uint32_t index) {
+        return entries[index].Occluder;
+    });
+    if (!hasOccluders) {
+        _visible.assign(candidates.begin(), candidates.end());
+        return _visible;
+    }
+
+    _buffer.Begin(projectionView);
+    for (const auto index : candidates)
+        if (entries[index].Occluder)
+            _buffer.RasterizeOccluder(GetOccluderMesh(entries[index].Model).Triangles, entries[index].ModelMatrix);
+
+    for (const auto index : candidates) {
+        const auto [center, extents] = boxes.GetBox(index);
+        if (entries[index].Occluder || _buffer.IsVisible(center, extents))
+            _visible.push_back(index);
+        else
+            _occludedCount++;
+    }
+    return _visible;
+}
+
+auto BeBRPOcclusionCuller::GetOccluderMesh(const std::shared_ptr<BeModel>& model) -> const BeBRPOccluderMesh& {
+    auto& cached = _occluders[model.get()];
+    if (cached.Model.lock() != model) {
+        cached.Model = model;
+        cached.Mesh = BeBRPOccluderMesh::FromModel(*model, OccluderTriangles);
+    }
+    return cached.Mesh;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <umbrellas/access-modifiers.hpp>
+#include <umbrellas/include-glm.h>
+
+#include "BeBRPSubmissionBuffer.h"
+#include "BeOcclusionBuffer.h"
+
+class BeFrustumCuller;
+struct BeModel;
+
+// the largest triangles of a model, three corners each. a subset of the real surface, so it never hides anything the
+// model itself wouldn't
+struct BeBRPOccluderMesh {
+    std::vector<glm::vec3> Triangles;
+
+    static auto FromModel(const BeModel& model, uint32_t maxTriangles) -> BeBRPOccluderMesh;
+};
+
+// hides geometry entries behind entries marked as occluders, entirely on the cpu and deterministic. the occluder
+// meshes of the frame's occluders go into a BeOcclusionBuffer and the boxes of everything else are tested against it
+class BeBRPOcclusionCuller {
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose static constexpr uint32_t OccluderTriangles = 512; // per model
+
+
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide struct CachedOccluder {
+        std::weak_ptr<BeModel> Model; // a different model may come to live at the same address
+        BeBRPOccluderMesh Mesh;
+    };
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide BeOcclusionBuffer _buffer;
+    hide std::unordered_map<const BeModel*, CachedOccluder> _occluders;
+    hide std::vector<uint32_t> _visible;
+    hide uint32_t _occludedCount = 0;
+
+    // lifetime ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose BeBRPOcclusionCuller() = default;
+    expose ~BeBRPOcclusionCuller() = default;
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    // one frame for a geometry pass. boxes are the frustum culler's, by entry index. candidates are ascending entry
+    // indices, occluders among them always stay. returns the ascending entry indices that are left
+    expose auto Cull(
+        std::span<const BeBRPGeometryEntry> entries,
+        std::span<const uint32_t> candidates,
+        const BeFrustumCuller& boxes,
+        const glm::mat4& projectionView
+    ) -> std::span<const uint32_t>;
+
+    expose auto GetBuffer() const -> const BeOcclusionBuffer& { return _buffer; }
+    expose auto GetOccludedCount() const -> uint32_t { return _occludedCount; }
+
+    hide auto GetOccluderMesh(const std::shared_ptr<BeModel>& model) -> const BeBRPOccluderMesh&;
+};
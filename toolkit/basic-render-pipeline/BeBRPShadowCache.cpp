@@ -0,0 +1,63 @@
+#include "BeBRPShadowCache.h"
+
+#include <cassert>
+
+// spreads a value over all bits, so sums of them don't collide for neighbouring values (splitmix64's finaliser)
+static auto Spread(uint64_t value) -> uint64_t {
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+auto BeBRPShadowCache::AddCaster(
+    ViewState& state,
+    const bool isStatic,
+    const uint64_t version,
+    const uint32_t shaderID,
+    const bool animated
+) -> void {
+    assert(!isStatic || !animated);
+    state.Animated |= animated;
+
+    const auto signature = Spread(version ^ Spread(shaderID));
+    if (isStatic) {
+        state.StaticSignature += signature;
+        state.StaticCount++;
+    }
+    else {
+        state.DynamicSignature += signature;
+        state.DynamicCount++;
+    }
+}
+
+auto BeBRPShadowCache::Plan(const ViewCache& cache, const ViewState& state) -> ViewUpdate {
+    // the light's matrix covers its position, direction, range and planes. a light that moves invalidates the layer
+    // along with the map, so a layer is only worth drawing once it stops
+    if (cache.Valid && cache.ViewProjection != state.ViewProjection)
+        return ViewUpdate::Redraw;
+
+    const auto staticChanged = !cache.Valid || cache.StaticSignature != state.StaticSignature;
+    const auto dynamicChanged = state.Animated || cache.DynamicSignature != state.DynamicSignature;
+    if (!staticChanged && !dynamicChanged)
+        return ViewUpdate::Skip;
+
+    // with only one kind of caster a layer wouldn't save anything
+    if (state.StaticCount == 0 || state.DynamicCount == 0)
+        return ViewUpdate::Redraw;
+    return staticChanged || !cache.LayerValid ? ViewUpdate::RedrawLayered : ViewUpdate::Composite;
+}
+
+auto BeBRPShadowCache::Commit(ViewCache& cache, const ViewState& state, const ViewUpdate update) -> void {
+    assert(update != ViewUpdate::Skip);
+    cache.ViewProjection = state.ViewProjection;
+    cache.StaticSignature = state.StaticSignature;
+    cache.DynamicSignature = state.DynamicSignature;
+    cache.Valid = true;
+    cache.Staleness = 0;
+
+    // a plain redraw leaves the layer behind, a composite keeps it
+    if (update == ViewUpdate::Redraw)
+        cache.LayerValid = false;
+    else if (update == ViewUpdate::RedrawLayered)
+        cache.LayerValid = true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <umbrellas/access-modifiers.hpp>
+#include <umbrellas/include-glm.h>
+
+#include "BeBRPShadowScheduler.h"
+
+// whether a cached shadow view needs drawing and how, see BeShadowPass. apart from the pass, since it only looks at
+// the light's matrix and signatures of the casters the view sees. a signature is a sum over the casters, so entries
+// moving around the submission buffer don't count as a change
+class BeBRPShadowCache {
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+    using ViewUpdate = BeBRPShadowScheduler::ViewUpdate;
+
+    // what a view's map holds
+    expose struct ViewCache {
+        glm::mat4 ViewProjection {0.f};
+        uint64_t StaticSignature = 0; // of the static casters
+        uint64_t DynamicSignature = 0;
+        bool Valid = false; // the map holds what the view saw
+        bool LayerValid = false; // the static layer does
+        uint32_t Staleness = 0; // frames the view waited for its update so far
+    };
+
+    // what a view sees this frame
+    expose struct ViewState {
+        glm::mat4 ViewProjection {0.f};
+        uint64_t StaticSignature = 0;
+        uint64_t DynamicSignature = 0;
+        uint32_t StaticCount = 0;
+        uint32_t DynamicCount = 0;
+        bool Animated = false; // a caster moves with the time, so the dynamic part never stays the same
+    };
+
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    // a caster the view sees, by its version in the submission buffer and the shader that draws it. casters whose
+    // shader animates them can't be in the static layer and come in as dynamic
+    expose static auto AddCaster(ViewState& state, bool isStatic, uint64_t version, uint32_t shaderID, bool animated) -> void;
+    // what the view needs for the map to hold what it sees
+    expose static auto Plan(const ViewCache& cache, const ViewState& state) -> ViewUpdate;
+    // the view got update, anything but Skip
+    expose static auto Commit(ViewCache& cache, const ViewState& state, ViewUpdate update) -> void;
+};
@@ -0,0 +1,55 @@
+#include "BeBRPShadowScheduler.h"
+
+#include <algorithm>
+
+// the frame a view's turn is offset by. faces of a map follow each other, so at most every interval-th face of a
+// light comes up in a frame, and lights are spread by their map
+static auto PhaseOf(const BeTexture* map, const uint32_t face) -> uint64_t {
+    const auto address = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(map));
+    return ((address >> 4) * 0x9e3779b97f4a7c15ull >> 32) + face;
+}
+
+auto BeBRPShadowScheduler::Schedule(
+    const std::span<ViewDecision> decisions,
+    const SchedulePolicy& policy,
+    const uint64_t frame,
+    std::vector<uint32_t>& order
+) -> void {
+    // the views that want drawing and may, distant ones wait for their turn unless their map was never drawn
+    const auto interval = std::max(policy.DistantInterval, 1u);
+    order.clear();
+    for (uint32_t view = 0; view < decisions.size(); view++) {
+        auto& decision = decisions[view];
+        decision.Update = ViewUpdate::Skip;
+        decision.Priority = decision.ScreenSize * decision.Weight * static_cast<float>(1 + decision.Staleness);
+        if (decision.Wanted == ViewUpdate::Skip)
+            continue;
+        const auto distant = decision.ScreenSize < policy.DistantScreenSize;
+        if (decision.Cached && distant && (frame + PhaseOf(decision.Map, decision.Face)) % interval != 0)
+            continue;
+        order.push_back(view);
+    }
+
+    // never drawn first, then by priority. stable, so ties go in drawing order
+    std::ranges::stable_sort(order, [&](const uint32_t a, const uint32_t b) {
+        if (decisions[a].Cached != decisions[b].Cached)
+            return !decisions[a].Cached;
+        return decisions[a].Priority > decisions[b].Priority;
+    });
+
+    // the rest of the budget can still fit a cheaper view after a dear one didn't
+    auto draws = uint64_t(0);
+    auto triangles = uint64_t(0);
+    auto scheduledAny = false;
+    for (const auto view : order) {
+        auto& decision = decisions[view];
+        const auto fits = draws + decision.Draws <= policy.MaxDraws && triangles + decision.Triangles <= policy.MaxTriangles;
+        if (decision.Cached && !fits && scheduledAny)
+            continue;
+
+        decision.Update = decision.Wanted;
+        draws += decision.Draws;
+        triangles += decision.Triangles;
+        scheduledAny = true;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+#include <umbrellas/access-modifiers.hpp>
+
+class BeTexture;
+
+// which of the shadow views that need drawing get drawn this frame, see BeShadowPass. apart from the pass, since it
+// only looks at the decisions, the policy and the frame
+class BeBRPShadowScheduler {
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose enum class ViewUpdate {
+        Skip, // the map still holds what the view sees
+        Redraw, // cleared, every caster drawn
+        RedrawLayered, // static casters drawn into the static layer, then composited
+        Composite, // the static layer copied over, dynamic casters drawn on top
+    };
+
+    // views are drawn by priority until the budget is spent: how large the light is on screen, times the view's weight,
+    // times one more for every frame the view waited. views of a map that was never drawn are always drawn, and so is
+    // the first view of a frame however much it costs
+    expose struct SchedulePolicy {
+        uint32_t MaxDraws = std::numeric_limits<uint32_t>::max(); // draw calls over all views of a frame
+        uint64_t MaxTriangles = std::numeric_limits<uint64_t>::max(); // triangles over all views of a frame
+        float DistantScreenSize = 0.f; // point lights spanning fewer pixels are distant...
+        uint32_t DistantInterval = 4; // ...and their faces take turns, each drawn at most every this many frames
+        float HiddenFaceWeight = 0.1f; // these only shadow what's off screen
+    };
+
+    expose struct ViewDecision {
+        const BeTexture* Map;
+        uint32_t Face; // 0 for the sun
+        ViewUpdate Wanted; // by what changed
+        ViewUpdate Update; // what it got, Skip when deferred
+        float ScreenSize; // of the light, infinite for the sun
+        float Weight; // 1, or HiddenFaceWeight for cube faces outside the camera's frustum
+        float Priority; // set by Schedule
+        uint32_t Staleness; // frames it waited before this one
+        uint32_t Draws; // what Wanted costs
+        uint64_t Triangles;
+        bool Cached; // the map holds an earlier update of the view
+    };
+
+
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    // sets the Priority and the Update of every decision, Wanted or Skip. nothing else is written. order is scratch
+    // the caller keeps, so scheduling doesn't allocate once it's grown
+    expose static auto Schedule(
+        std::span<ViewDecision> decisions,
+        const SchedulePolicy& policy,
+        uint64_t frame,
+        std::vector<uint32_t>& order
+    ) -> void;
+};
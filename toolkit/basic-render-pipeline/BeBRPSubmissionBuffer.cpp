@@ -1,5 +1,7 @@
 #include "BeBRPSubmissionBuffer.h"
 
+#include <cassert>
+
 
 auto BeBRPGeometryEntry::CalculateModelMatrix(glm::vec3 pos, glm::quat rot, glm::vec3 scale) -> glm::mat4 {
     const glm::mat4x4 modelMatrix =
@@ -19,13 +21,29 @@ auto BeBRPSunLightEntry::CalculateViewProj(glm::vec3 direction, float shadowCame
 }
 
 auto BeBRPSubmissionBuffer::ClearEntries() -> void {
-    _geometryEntries.clear();
+    _geometryEntries.erase(_geometryEntries.begin() + static_cast<ptrdiff_t>(_entrySlots.size()), _geometryEntries.end());
+    _geometryVersions.resize(_entrySlots.size());
     _sunLightEntries.clear();
     _pointLightEntries.clear();
 }
 
 auto BeBRPSubmissionBuffer::SubmitGeometry(const BeBRPGeometryEntry& entry) -> void {
     _geometryEntries.push_back(entry);
+    _geometryVersions.push_back(++_lastVersion);
+}
+
+auto BeBRPSubmissionBuffer::SubmitGeometry(const size_t count) -> std::span<BeBRPGeometryEntry> {
+    const auto first = _geometryEntries.size();
+    _geometryEntries.resize(first + count);
+    for (size_t i = 0; i < count; i++)
+        _geometryVersions.push_back(++_lastVersion);
+    return std::span(_geometryEntries).subspan(first);
+}
+
+auto BeBRPSubmissionBuffer::DiscardGeometry(const size_t count) -> void {
+    assert(count <= _geometryEntries.size() - _entrySlots.size());
+    _geometryEntries.resize(_geometryEntries.size() - count);
+    _geometryVersions.resize(_geometryEntries.size());
 }
 
 auto BeBRPSubmissionBuffer::SubmitSunLight(const BeBRPSunLightEntry& entry) -> void {
@@ -36,6 +54,69 @@ auto BeBRPSubmissionBuffer::SubmitPointLight(const BeBRPPointLightEntry& entry)
     _pointLightEntries.push_back(entry);
 }
 
+auto BeBRPSubmissionBuffer::AddGeometry(BeBRPGeometryEntry entry) -> GeometrySlot {
+    GeometrySlot slot;
+    if (_freeSlots.empty()) {
+        slot = static_cast<GeometrySlot>(_slotEntries.size());
+        _slotEntries.push_back(InvalidSlot);
+    }
+    else {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+
+    // in front of this frame's entries, if any were submitted already
+    const auto index = static_cast<uint32_t>(_entrySlots.size());
+    _geometryEntries.insert(_geometryEntries.begin() + index, std::move(entry));
+    _geometryVersions.insert(_geometryVersions.begin() + index, ++_lastVersion);
+    _entrySlots.push_back(slot);
+    _slotEntries[slot] = index;
+    return slot;
+}
+
+auto BeBRPSubmissionBuffer::UpdateGeometry(const GeometrySlot slot, BeBRPGeometryEntry entry) -> void {
+    assert(slot < _slotEntries.size() && _slotEntries[slot] != InvalidSlot);
+    _geometryEntries[_slotEntries[slot]] = std::move(entry);
+    _geometryVersions[_slotEntries[slot]] = ++_lastVersion;
+}
+
+auto BeBRPSubmissionBuffer::UpdateGeometryMatrix(const GeometrySlot slot, const glm::mat4& modelMatrix) -> void {
+    assert(slot < _slotEntries.size() && _slotEntries[slot] != InvalidSlot);
+    _geometryEntries[_slotEntries[slot]].ModelMatrix = modelMatrix;
+    _geometryVersions[_slotEntries[slot]] = ++_lastVersion;
+}
+
+auto BeBRPSubmissionBuffer::RemoveGeometry(const GeometrySlot slot) -> void {
+    assert(slot < _slotEntries.size() && _slotEntries[slot] != InvalidSlot);
+    const auto index = _slotEntries[slot];
+    const auto last = static_cast<uint32_t>(_entrySlots.size() - 1);
+    if (index != last) {
+        _geometryEntries[index] = std::move(_geometryEntries[last]);
+        _geometryVersions[index] = _geometryVersions[last];
+        _entrySlots[index] = _entrySlots[last];
+        _slotEntries[_entrySlots[index]] = index;
+    }
+
+    _geometryEntries.erase(_geometryEntries.begin() + last);
+    _geometryVersions.erase(_geometryVersions.begin() + last);
+    _entrySlots.pop_back();
+    _slotEntries[slot] = InvalidSlot;
+    _freeSlots.push_back(slot);
+}
+
+auto BeBRPSubmissionBuffer::ClearRetainedGeometry() -> void {
+    _geometryEntries.erase(_geometryEntries.begin(), _geometryEntries.begin() + static_cast<ptrdiff_t>(_entrySlots.size()));
+    _geometryVersions.erase(_geometryVersions.begin(), _geometryVersions.begin() + static_cast<ptrdiff_t>(_entrySlots.size()));
+    _slotEntries.clear();
+    _entrySlots.clear();
+    _freeSlots.clear();
+}
+
+auto BeBRPSubmissionBuffer::GetGeometry(const GeometrySlot slot) const -> const BeBRPGeometryEntry& {
+    assert(slot < _slotEntries.size() && _slotEntries[slot] != InvalidSlot);
+    return _geometryEntries[_slotEntries[slot]];
+}
+
 auto BeBRPSubmissionBuffer::GetGeometryEntries() const -> const std::vector<BeBRPGeometryEntry>& {
     return _geometryEntries;
 }
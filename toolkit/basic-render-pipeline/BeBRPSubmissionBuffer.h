@@ -1,5 +1,8 @@
 #pragma once
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <span>
 #include <vector>
 #include <umbrellas/access-modifiers.hpp>
 #include <umbrellas/include-glm.h>
@@ -7,10 +10,23 @@
 class BeTexture;
 struct BeModel;
 
+// a simpler model drawn in place of an entry's own while the entry is at most MaxScreenSize pixels across
+struct BeBRPModelLod {
+    std::shared_ptr<BeModel> Model;
+    float MaxScreenSize;
+};
+
 struct BeBRPGeometryEntry {
     glm::mat4 ModelMatrix;
     std::shared_ptr<BeModel> Model;
     bool CastShadows;
+    bool Occluder = false; // hides what's behind it before the geometry pass, see BeBRPOcclusionCuller
+    bool Static = false; // rarely changes, shadow maps keep it in a cached layer, see BeShadowPass
+
+    // screen size policies, in pixels across the bounding sphere, see BeBRPDetailSelector. 0 turns a check off
+    float MinScreenSize = 0.f; // not drawn when smaller
+    float MinShadowScreenSize = 0.f; // casts no shadows when smaller
+    std::shared_ptr<const std::vector<BeBRPModelLod>> Lods; // any order, the smallest that still fits is drawn
     
     static auto CalculateModelMatrix(
         glm::vec3 pos,
@@ -52,13 +68,27 @@ struct BeBRPPointLightEntry {
     std::weak_ptr<BeTexture> ShadowMap; 
 };
 
+// geometry entries are either retained or per frame. retained ones are added once, get a stable slot and stay until
+// removed, so a scene only pays for what changed. per frame ones and all lights are dropped by ClearEntries. passes see
+// one dense array, retained entries first, in no particular order. every entry has a version next to it that's new
+// whenever the entry changes, per frame entries get a new one every time they're submitted
 class BeBRPSubmissionBuffer {
     
+public:
+    using GeometrySlot = uint32_t;
+    static constexpr GeometrySlot InvalidSlot = std::numeric_limits<uint32_t>::max();
+    
     hide
-    std::vector<BeBRPGeometryEntry> _geometryEntries;
+    std::vector<BeBRPGeometryEntry> _geometryEntries; // retained ones, then this frame's
+    std::vector<uint64_t> _geometryVersions; // by entry
+    uint64_t _lastVersion = 0;
     std::vector<BeBRPSunLightEntry> _sunLightEntries;
     std::vector<BeBRPPointLightEntry> _pointLightEntries;
     
+    std::vector<uint32_t> _slotEntries; // slot -> index of its entry, InvalidSlot while free
+    std::vector<GeometrySlot> _entrySlots; // retained entry -> its slot
+    std::vector<GeometrySlot> _freeSlots;
+    
     expose
     explicit BeBRPSubmissionBuffer() = default;
     ~BeBRPSubmissionBuffer() = default;
@@ -66,11 +96,26 @@ class BeBRPSubmissionBuffer {
     expose
     auto ClearEntries () -> void;
     auto SubmitGeometry (const BeBRPGeometryEntry& entry) -> void;
+    // count default entries for the caller to fill in, e.g. from several threads at once
+    auto SubmitGeometry (size_t count) -> std::span<BeBRPGeometryEntry>;
+    // drops the last count of this frame's entries
+    auto DiscardGeometry (size_t count) -> void;
     auto SubmitSunLight(const BeBRPSunLightEntry& entry) -> void;
     auto SubmitPointLight(const BeBRPPointLightEntry& entry) -> void;
     
+    expose
+    auto AddGeometry(BeBRPGeometryEntry entry) -> GeometrySlot;
+    auto UpdateGeometry(GeometrySlot slot, BeBRPGeometryEntry entry) -> void;
+    auto UpdateGeometryMatrix(GeometrySlot slot, const glm::mat4& modelMatrix) -> void;
+    // the last retained entry moves into the freed place
+    auto RemoveGeometry(GeometrySlot slot) -> void;
+    auto ClearRetainedGeometry() -> void;
+    auto GetGeometry(GeometrySlot slot) const -> const BeBRPGeometryEntry&;
+    auto GetRetainedGeometryCount() const -> size_t { return _entrySlots.size(); }
+    
     expose
     auto GetGeometryEntries () const -> const std::vector<BeBRPGeometryEntry>&;
+    auto GetGeometryVersions () const -> std::span<const uint64_t> { return _geometryVersions; }
     auto GetSunLightEntries () const -> const std::vector<BeBRPSunLightEntry>&;
     auto GetPointLightEntries () const -> const std::vector<BeBRPPointLightEntry>&;
 };
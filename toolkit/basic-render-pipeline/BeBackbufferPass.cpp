@@ -25,17 +25,17 @@ auto BeBackbufferPass::Render() -> void {
     auto backbufferTarget = _renderer->GetBackbufferTarget();
     auto fullClearColor = glm::vec4(ClearColor, 1.0f);
     context->ClearRenderTargetView(backbufferTarget.Get(), reinterpret_cast<FLOAT*>(&fullClearColor));
-    context->OMSetRenderTargets(1, backbufferTarget.GetAddressOf(), nullptr);
+    pipeline->SetRenderTarget(backbufferTarget.Get());
 
     // shaders
     pipeline->BindShader(_backbufferShader, BeShaderType::Vertex | BeShaderType::Pixel);
     pipeline->BindMaterialAutomatic( _backbufferMaterial);
 
     // draw
-    context->Draw(4, 0);
+    pipeline->Draw(4, 0);
 
     // clear
     pipeline->Clear();
-    context->OMSetRenderTargets(1, Utils::NullRTVs, nullptr);
+    pipeline->ClearRenderTargets();
 }
 
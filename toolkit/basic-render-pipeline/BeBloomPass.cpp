@@ -93,18 +93,18 @@ auto BeBloomPass::RenderBrightPass() const -> void {
 
     // targets
     context->ClearRenderTargetView(bloomMip0->GetRTV().Get(), glm::value_ptr(glm::vec4(0.0f)));
-    context->OMSetRenderTargets(1, bloomMip0->GetRTV().GetAddressOf(), nullptr);
+    pipeline->SetRenderTarget(bloomMip0->GetRTV().Get());
 
     // shaders
     pipeline->BindShader(_brightShader, BeShaderType::Vertex | BeShaderType::Pixel);
     pipeline->BindMaterialAutomatic(_brightMaterial);
     
     // draw
-    context->Draw(4, 0);
+    pipeline->Draw(4, 0);
 
     // clear
     pipeline->Clear();
-    context->OMSetRenderTargets(1, Utils::NullRTVs, nullptr);
+    pipeline->ClearRenderTargets();
     
 }
 
@@ -112,9 +112,7 @@ auto BeBloomPass::RenderDownsamplePasses() -> void {
     const auto context = _renderer->GetContext();
     const auto& pipeline = _renderer->GetPipeline();
     
-    uint32_t numberOfPreviousViewports = 1;
-    D3D11_VIEWPORT previousViewport;
-    context->RSGetViewports(&numberOfPreviousViewports, &previousViewport);
+    const auto previousViewport = pipeline->GetViewport();
 
     pipeline->BindShader(_kawaseShader, BeShaderType::Vertex | BeShaderType::Pixel);
     
@@ -127,49 +125,34 @@ auto BeBloomPass::RenderDownsamplePasses() -> void {
         viewport.Height = static_cast<float>(targetMip->Height);
         viewport.MinDepth = 0.0f;
         viewport.MaxDepth = 1.0f;
-        context->RSSetViewports(1, &viewport);
+        pipeline->SetViewport(viewport);
 
         // target
         context->ClearRenderTargetView(targetMip->GetRTV().Get(), glm::value_ptr(glm::vec4(0.0f)));
-        context->OMSetRenderTargets(1, targetMip->GetRTV().GetAddressOf(), nullptr);
+        pipeline->SetRenderTarget(targetMip->GetRTV().Get());
 
         // material
         pipeline->BindMaterialAutomatic(_downsampleMaterials[mipTarget]);
         
         // draw
-        context->Draw(4, 0);
+        pipeline->Draw(4, 0);
 
-        context->OMSetRenderTargets(1, Utils::NullRTVs, nullptr);
+        pipeline->ClearRenderTargets();
     }
 
     pipeline->Clear();
-    context->RSSetViewports(1, &previousViewport);
-    context->OMSetRenderTargets(1, Utils::NullRTVs, nullptr);
+    pipeline->SetViewport(previousViewport);
+    pipeline->ClearRenderTargets();
 }
 
 auto BeBloomPass::RenderUpsamplePasses() -> void {
-    const auto context = _renderer->GetContext();
     const auto& pipeline = _renderer->GetPipeline();
     
-    uint32_t numberOfPreviousViewports = 1;
-    D3D11_VIEWPORT previousViewport;
-    context->RSGetViewports(&numberOfPreviousViewports, &previousViewport);
+    const auto previousViewport = pipeline->GetViewport();
     
-    // Set additive blend state for upsampling (accumulate into mips)
-    ID3D11BlendState* additiveBlendState = nullptr;
-    D3D11_BLEND_DESC blendDesc = {};
-    blendDesc.RenderTarget[0].BlendEnable = TRUE;
-    blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
-    blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
-    blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
-    blendDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
-    blendDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ZERO;
-    blendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ONE;
-    blendDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
-    Utils::Check << _renderer->GetDevice()->CreateBlendState(&blendDesc, &additiveBlendState);
-    context->OMSetBlendState(additiveBlendState, nullptr, 0xFFFFFFFF);
-
-    pipeline->BindShader(_kawaseShader, BeShaderType::Vertex | BeShaderType::Pixel);
+    // upsampling accumulates into the mips, keeping their alpha
+    const auto upsampleState = _kawaseShader->State.WithBlend(BeBlendMode::AdditiveKeepAlpha);
+    pipeline->BindShader(_kawaseShader, BeShaderType::Vertex | BeShaderType::Pixel, upsampleState);
 
     for (int32_t mipTarget = BloomMipCount - 2; mipTarget >= 0; --mipTarget) {
         const auto targetMip = BloomMipTextures[mipTarget].lock();
@@ -179,22 +162,19 @@ auto BeBloomPass::RenderUpsamplePasses() -> void {
         viewport.Height = static_cast<float>(targetMip->Height);
         viewport.MinDepth = 0.0f;
         viewport.MaxDepth = 1.0f;
-        context->RSSetViewports(1, &viewport);
-        context->OMSetRenderTargets(1, targetMip->GetRTV().GetAddressOf(), nullptr);
+        pipeline->SetViewport(viewport);
+        pipeline->SetRenderTarget(targetMip->GetRTV().Get());
 
         pipeline->BindMaterialAutomatic(_upsampleMaterials[mipTarget]);
 
-        context->Draw(4, 0);
+        pipeline->Draw(4, 0);
 
-        context->OMSetRenderTargets(1, Utils::NullRTVs, nullptr);
+        pipeline->ClearRenderTargets();
     }
 
-    context->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFF);
-    if (additiveBlendState) additiveBlendState->Release();
-
     pipeline->Clear();
-    context->OMSetRenderTargets(1, Utils::NullRTVs, nullptr);
-    context->RSSetViewports(1, &previousViewport);
+    pipeline->ClearRenderTargets();
+    pipeline->SetViewport(previousViewport);
 }
 
 auto BeBloomPass::RenderAddPass() const -> void {
@@ -203,13 +183,13 @@ auto BeBloomPass::RenderAddPass() const -> void {
     
     const auto outputTexture = OutputTexture.lock();
     context->ClearRenderTargetView(outputTexture->GetRTV().Get(), glm::value_ptr(glm::vec4(0.0f)));
-    context->OMSetRenderTargets(1, outputTexture->GetRTV().GetAddressOf(), nullptr);
+    pipeline->SetRenderTarget(outputTexture->GetRTV().Get());
 
     pipeline->BindShader(_addShader, BeShaderType::Vertex | BeShaderType::Pixel);
     pipeline->BindMaterialAutomatic(_addMaterial);
     
-    context->Draw(4, 0);
+    pipeline->Draw(4, 0);
 
     pipeline->Clear();
-    context->OMSetRenderTargets(1, Utils::NullRTVs, nullptr);   
+    pipeline->ClearRenderTargets();
 }
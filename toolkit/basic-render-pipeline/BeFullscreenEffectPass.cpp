@@ -13,7 +13,6 @@ auto BeFullscreenEffectPass::Initialise() -> void {}
 
 auto BeFullscreenEffectPass::Render() -> void {
     const auto& pipeline = _renderer->GetPipeline();
-    const auto context = _renderer->GetContext();
     
     // render targets
     std::vector<ID3D11RenderTargetView*> renderTargets;
@@ -21,7 +20,7 @@ auto BeFullscreenEffectPass::Render() -> void {
         const auto resource = BeAssetRegistry::GetTexture(outputTextureName).lock();
         renderTargets.push_back(resource->GetRTV().Get());
     }
-    context->OMSetRenderTargets(renderTargets.size(), renderTargets.data(), nullptr);
+    pipeline->SetRenderTargets(renderTargets, nullptr);
 
     // shaders
     pipeline->BindShader(Shader.lock(), BeShaderType::Vertex | BeShaderType::Pixel);
@@ -30,9 +29,9 @@ auto BeFullscreenEffectPass::Render() -> void {
     }
 
     // draw
-    context->Draw(4, 0);
+    pipeline->Draw(4, 0);
 
     // clear
     pipeline->Clear();
-    context->OMSetRenderTargets(OutputTextureNames.size(), Utils::NullRTVs, nullptr);
+    pipeline->ClearRenderTargets();
 }
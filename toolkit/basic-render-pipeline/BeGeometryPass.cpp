@@ -1,11 +1,15 @@
 ﻿#include "BeGeometryPass.h"
 
+#include <algorithm>
 #include <cassert>
+#include <limits>
 #include <scope_guard/scope_guard.hpp>
 #include <umbrellas/include-glm.h>
+#include <materials/BeBRPObjectMaterial.h>
 
 #include "BeAssetRegistry.h"
 #include "BeBRPSubmissionBuffer.h"
+#include "BeConstantRing.h"
 #include "BeMaterial.h"
 #include "BeModel.h"
 #include "BePipeline.h"
@@ -45,48 +49,138 @@ auto BeGeometryPass::Render() -> void {
         gbufferResource2->GetRTV().Get(),
         gbufferResource3->GetRTV().Get()
     };
-    context->OMSetRenderTargets(4, gbufferRTVs, depthResource->GetDSV().Get());
-    SCOPE_EXIT { context->OMSetRenderTargets(4, Utils::NullRTVs, nullptr); };
+    pipeline->SetRenderTargets(gbufferRTVs, depthResource->GetDSV().Get());
+    SCOPE_EXIT { pipeline->ClearRenderTargets(); };
 
     
     // Set vertex and index buffers
-    uint32_t stride = sizeof(BeFullVertex);
-    uint32_t offset = 0;
-    context->IASetVertexBuffers(0, 1, _renderer->GetShaderVertexBuffer().GetAddressOf(), &stride, &offset);
-    context->IASetIndexBuffer(_renderer->GetShaderIndexBuffer().Get(), DXGI_FORMAT_R32_UINT, 0);
+    pipeline->SetVertexBuffer(_renderer->GetShaderVertexBuffer().Get(), sizeof(BeFullVertex));
+    pipeline->SetIndexBuffer(_renderer->GetShaderIndexBuffer().Get(), DXGI_FORMAT_R32_UINT);
     SCOPE_EXIT {
-        context->IASetVertexBuffers(0, 1, Utils::NullBuffers, &stride, &offset);
-        context->IASetIndexBuffer(nullptr, DXGI_FORMAT_R32_UINT, 0);
+        pipeline->SetVertexBuffer(nullptr, 0);
+        pipeline->SetIndexBuffer(nullptr, DXGI_FORMAT_R32_UINT);
     };
 
     
-    // Draw all objects
+    // Cull against the camera frustum, then what's too small on screen, then behind occluders. group what's left by
+    // the model it draws with at its size and upload every instance matrix at once
     const auto& entries = SubmissionBuffer.lock()->GetGeometryEntries();
-    for (const auto& entry : entries) {
-        const auto shader = entry.Model->Shader;
+    const auto& projectionView = _renderer->UniformData.ProjectionView;
+    _culler.Clear();
+    _culler.Reserve(entries.size());
+    for (const auto& entry : entries)
+        _culler.PushTransformed(entry.Model->BoundsMin, entry.Model->BoundsMax, entry.ModelMatrix);
+    const auto frustumPlanes = BeFrustumCuller::ExtractPlanes(projectionView);
+    const auto inFrustum = _culler.Cull(frustumPlanes);
+    const auto largeEnough = _detailSelector.Select(entries, inFrustum, _renderer->UniformData.CameraPosition, _renderer->UniformData.ScreenScale, &BeModel::GetBounds);
+    const auto visibleEntries = _occlusionCuller.Cull(entries, largeEnough, _culler, projectionView);
+    _batcher.Build(entries, visibleEntries, _detailSelector.Models(entries, visibleEntries), &BeModel::IsInstanced);
+    const auto batches = _batcher.GetBatches();
+    const auto matrices = _batcher.GetMatrices();
+    _instances.Upload(_renderer->GetDevice().Get(), context.Get(), matrices);
+    pipeline->SetInstanceBuffer(_instances.GetBuffer(), BeBRPInstanceBuffer::Stride);
+    SCOPE_EXIT { pipeline->SetInstanceBuffer(nullptr, 0); };
+
+    
+    // Queue one item per batch slice, sorted by shader, state, material and then front to back
+    const auto& viewerPosition = _renderer->UniformData.CameraPosition;
+    _queue.Clear();
+    _batchSlices.clear();
+    for (uint32_t batchIndex = 0; batchIndex < batches.size(); batchIndex++) {
+        const auto& batch = batches[batchIndex];
+        const auto& shader = batch.Model->Shader;
         assert(shader);
         
-        pipeline->BindShader(shader, BeShaderType::All);
-        SCOPE_EXIT { pipeline->Clear(); };
+        const auto& drawSlices = _renderer->GetDrawSlicesForModel(batch.Model);
+        _batchSlices.push_back(&drawSlices);
         
-        _objectMaterial->SetMatrix("Model", entry.ModelMatrix);
-        _objectMaterial->SetMatrix("ProjectionView", _renderer->UniformData.ProjectionView);
-        _objectMaterial->SetFloat3("ViewerPosition", _renderer->UniformData.CameraPosition);
-        _objectMaterial->UpdateGPUBuffers(context);
-        pipeline->BindMaterialAutomatic(_objectMaterial);
-
-        const auto & drawSlices = _renderer->GetDrawSlicesForModel(entry.Model);
-        for (const auto& slice : drawSlices) {
-            if (slice.TwoSided) {
-                context->RSSetState(_renderer->GetRasterizerCullNone().Get());
-            }
+        auto nearest = std::numeric_limits<float>::max();
+        for (const auto& matrix : matrices.subspan(batch.FirstInstance, batch.InstanceCount))
+            nearest = std::min(nearest, glm::distance(glm::vec3(matrix[3]), viewerPosition));
+        const auto depthBucket = BeRenderQueue::DepthBucket(nearest);
+        
+        for (uint32_t sliceIndex = 0; sliceIndex < drawSlices.size(); sliceIndex++) {
+            const auto& slice = drawSlices[sliceIndex];
+            const auto state = slice.TwoSided ? shader->State.WithCull(BeCullMode::None) : shader->State;
+            _queue.Push({
+                .Key = BeRenderQueue::MakeKey(
+                    0, shader->UniqueID, state.FixedFunctionBits(), slice.Material->GetUniqueID(), depthBucket),
+                .Entry = batchIndex,
+                .Slice = sliceIndex,
+            });
+        }
+    }
+    _queue.Sort();
 
-            pipeline->BindMaterialAutomatic(slice.Material);
-            context->DrawIndexed(slice.IndexCount, slice.StartIndexLocation, slice.BaseVertexLocation);
+    
+    // Object constants of every batch in one map, instanced batches only use the view part
+    const auto objectDataOf = [&](const BeBRPInstanceBatch& batch) {
+        auto data = BeMaterialData::ObjectMaterialForGeometryPass();
+        data.Model = batch.Model->Shader->IsInstanced ? glm::mat4(1.f) : matrices[batch.FirstInstance];
+        data.ProjectionView = _renderer->UniformData.ProjectionView;
+        data.ViewerPosition = viewerPosition;
+        return data;
+    };
+    const auto constantRing = _renderer->GetConstantRing();
+    auto objectBlocks = std::optional<BeConstantRing::Blocks>();
+    if (constantRing && !batches.empty())
+        objectBlocks = constantRing->Map(context.Get(), static_cast<uint32_t>(batches.size()), sizeof(BeMaterialData::ObjectMaterialForGeometryPass));
+    if (objectBlocks) {
+        for (uint32_t batchIndex = 0; batchIndex < batches.size(); batchIndex++)
+            objectBlocks->At<BeMaterialData::ObjectMaterialForGeometryPass>(batchIndex) = objectDataOf(batches[batchIndex]);
+        constantRing->Unmap(context.Get());
+    }
 
-            if (slice.TwoSided) {
-                context->RSSetState(_renderer->GetRasterizerCullBack().Get());
+    
+    // Draw, binding only what differs from the previous item
+    const BeShader* boundShader = nullptr;
+    const BeMaterial* boundMaterial = nullptr;
+    auto boundState = BePipelineState();
+    auto objectBatch = UINT32_MAX;
+    SCOPE_EXIT { if (boundShader) pipeline->Clear(); };
+    
+    for (const auto& item : _queue.GetItems()) {
+        const auto& batch = batches[item.Entry];
+        const auto& shader = batch.Model->Shader;
+        const auto& slice = (*_batchSlices[item.Entry])[item.Slice];
+        
+        if (shader.get() != boundShader) {
+            if (boundShader)
+                pipeline->Clear();
+            pipeline->BindShader(shader, BeShaderType::All);
+            boundShader = shader.get();
+            boundState = shader->State;
+            boundMaterial = nullptr;
+            objectBatch = UINT32_MAX;
+        }
+        
+        if (item.Entry != objectBatch) {
+            if (objectBlocks) {
+                const auto slot = _objectMaterial->GetSlotIn(*shader);
+                pipeline->BindConstantRange(slot, constantRing->GetBuffer(), objectBlocks->ConstantOf(item.Entry), objectBlocks->ConstantCount());
+            }
+            else {
+                _objectMaterial->Data<BeMaterialData::ObjectMaterialForGeometryPass>() = objectDataOf(batch);
+                _objectMaterial->UpdateGPUBuffers(context);
+                pipeline->BindMaterialAutomatic(_objectMaterial);
             }
+            objectBatch = item.Entry;
         }
+        
+        const auto state = slice.TwoSided ? shader->State.WithCull(BeCullMode::None) : shader->State;
+        if (state != boundState) {
+            pipeline->SetState(state);
+            boundState = state;
+        }
+        
+        if (slice.Material.get() != boundMaterial) {
+            pipeline->BindMaterialAutomatic(slice.Material);
+            boundMaterial = slice.Material.get();
+        }
+        
+        if (shader->IsInstanced)
+            pipeline->DrawIndexedInstanced(slice.IndexCount, batch.InstanceCount, slice.StartIndexLocation, slice.BaseVertexLocation, batch.FirstInstance);
+        else
+            pipeline->DrawIndexed(slice.IndexCount, slice.StartIndexLocation, slice.BaseVertexLocation);
     }
 }
@@ -1,13 +1,21 @@
 ﻿#pragma once
 
 #include <memory>
+#include <vector>
 
+#include "BeBRPDetailSelector.h"
+#include "BeBRPInstanceBuffer.h"
+#include "BeBRPInstancing.h"
+#include "BeBRPOcclusionCuller.h"
+#include "BeFrustumCuller.h"
 #include "BeRenderPass.h"
+#include "BeRenderQueue.h"
 
 class BeBRPSubmissionBuffer;
 class BeTexture;
 class BeMaterial;
 class BeShader;
+struct BeDrawSlice;
 
 class BeGeometryPass final : public BeRenderPass {
     
@@ -22,6 +30,13 @@ class BeGeometryPass final : public BeRenderPass {
 
     hide 
     std::shared_ptr<BeMaterial> _objectMaterial;
+    BeFrustumCuller _culler; // one box per geometry entry, rebuilt every frame
+    BeBRPDetailSelector _detailSelector;
+    BeBRPOcclusionCuller _occlusionCuller;
+    BeBRPInstanceBatcher _batcher;
+    BeBRPInstanceBuffer _instances;
+    BeRenderQueue _queue; // one item per batch and draw slice, rebuilt every frame
+    std::vector<const std::vector<BeDrawSlice>*> _batchSlices; // by batch index, saves a lookup per item
     
     expose
     explicit BeGeometryPass();
@@ -31,4 +46,10 @@ class BeGeometryPass final : public BeRenderPass {
     auto Initialise() -> void override;
     auto Render() -> void override;
     auto GetPassName() const -> const std::string override { return "Geometry Pass"; }
+    // shader, state and material switches of the last frame, sorted and as submitted
+    auto GetQueueStats() const -> const BeRenderQueue::Stats& { return _queue.GetStats(); }
+    // entries of the last frame that were in the frustum but hidden behind occluders
+    auto GetOccludedCount() const -> uint32_t { return _occlusionCuller.GetOccludedCount(); }
+    // entries of the last frame dropped or simplified for their size on screen
+    auto GetDetailStats() const -> const BeBRPDetailSelector::Stats& { return _detailSelector.GetStats(); }
 };
@@ -17,20 +17,6 @@ BeLightingPass::BeLightingPass() = default;
 BeLightingPass::~BeLightingPass() = default;
 
 void BeLightingPass::Initialise() {
-    const auto device = _renderer->GetDevice();
-
-    D3D11_BLEND_DESC lightingBlendDesc = {};
-    lightingBlendDesc.RenderTarget[0].BlendEnable = TRUE;
-    lightingBlendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
-    lightingBlendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
-    lightingBlendDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
-    lightingBlendDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
-    lightingBlendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ONE;
-    lightingBlendDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
-    lightingBlendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
-
-    Utils::Check << device->CreateBlendState(&lightingBlendDesc, _lightingBlendState.GetAddressOf());
-    
     _directionalLightShader = BeAssetRegistry::GetShader( "directional-light").lock();
     const auto& directionalScheme = BeAssetRegistry::GetMaterialScheme("directional-light-material");;
     _directionalLightMaterial = BeMaterial::Create("DirectionalLightMaterial", directionalScheme, true, *_renderer);
@@ -38,6 +24,14 @@ void BeLightingPass::Initialise() {
     _directionalLightMaterial->SetTexture("Diffuse", InputTexture0.lock());
     _directionalLightMaterial->SetTexture("WorldNormal", InputTexture1.lock());
     _directionalLightMaterial->SetTexture("Specular_Shininess", InputTexture2.lock());
+    _directionalIds = {
+        .HasShadowMap = _directionalLightMaterial->GetPropertyId("HasShadowMap"_prop),
+        .Direction = _directionalLightMaterial->GetPropertyId("Direction"_prop),
+        .Color = _directionalLightMaterial->GetPropertyId("Color"_prop),
+        .Power = _directionalLightMaterial->GetPropertyId("Power"_prop),
+        .ProjectionView = _directionalLightMaterial->GetPropertyId("ProjectionView"_prop),
+        .TexelSize = _directionalLightMaterial->GetPropertyId("TexelSize"_prop),
+    };
     
     _pointLightShader = BeAssetRegistry::GetShader("point-light").lock();
     const auto& pointScheme = BeAssetRegistry::GetMaterialScheme("point-light-material");
@@ -46,6 +40,15 @@ void BeLightingPass::Initialise() {
     _pointLightMaterial->SetTexture("Diffuse", InputTexture0.lock());
     _pointLightMaterial->SetTexture("WorldNormal", InputTexture1.lock());
     _pointLightMaterial->SetTexture("Specular_Shininess", InputTexture2.lock());
+    _pointIds = {
+        .Position = _pointLightMaterial->GetPropertyId("Position"_prop),
+        .Radius = _pointLightMaterial->GetPropertyId("Radius"_prop),
+        .Color = _pointLightMaterial->GetPropertyId("Color"_prop),
+        .Power = _pointLightMaterial->GetPropertyId("Power"_prop),
+        .HasShadowMap = _pointLightMaterial->GetPropertyId("HasShadowMap"_prop),
+        .ShadowMapResolution = _pointLightMaterial->GetPropertyId("ShadowMapResolution"_prop),
+        .ShadowNearPlane = _pointLightMaterial->GetPropertyId("ShadowNearPlane"_prop),
+    };
     
     _emissiveAddShader = BeAssetRegistry::GetShader("emissive-add").lock();
     const auto& emissiveScheme = BeAssetRegistry::GetMaterialScheme("emissive-add-material");
@@ -60,27 +63,23 @@ auto BeLightingPass::Render() -> void {
     
     const auto lightingResource  = OutputTexture.lock();
     context->ClearRenderTargetView(lightingResource->GetRTV().Get(), glm::value_ptr(glm::vec4(0.0f)));
-    context->OMSetRenderTargets(1, lightingResource->GetRTV().GetAddressOf(), nullptr);
-    context->OMSetBlendState(_lightingBlendState.Get(), nullptr, 0xFFFFFFFF);
-    SCOPE_EXIT {
-        context->OMSetRenderTargets(1, Utils::NullRTVs, nullptr);
-        context->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFF);
-    };
+    pipeline->SetRenderTarget(lightingResource->GetRTV().Get());
+    SCOPE_EXIT { pipeline->ClearRenderTargets(); };
 
     // directional light
     pipeline->BindShader(_directionalLightShader, BeShaderType::Vertex | BeShaderType::Pixel);
         
     const auto& sunLight = submissionBuffer.GetSunLightEntries()[0];
-    _directionalLightMaterial->SetFloat("HasShadowMap", sunLight.CastsShadows ? 1.0f : 0.0f);
-    _directionalLightMaterial->SetFloat3("Direction", sunLight.Direction);
-    _directionalLightMaterial->SetFloat3("Color", sunLight.Color);
-    _directionalLightMaterial->SetFloat("Power", sunLight.Power);
-    _directionalLightMaterial->SetMatrix("ProjectionView", sunLight.ShadowViewProjection);
-    _directionalLightMaterial->SetFloat("TexelSize", 1.0f / sunLight.ShadowMapResolution);
+    _directionalLightMaterial->SetFloat(_directionalIds.HasShadowMap, sunLight.CastsShadows ? 1.0f : 0.0f);
+    _directionalLightMaterial->SetFloat3(_directionalIds.Direction, sunLight.Direction);
+    _directionalLightMaterial->SetFloat3(_directionalIds.Color, sunLight.Color);
+    _directionalLightMaterial->SetFloat(_directionalIds.Power, sunLight.Power);
+    _directionalLightMaterial->SetMatrix(_directionalIds.ProjectionView, sunLight.ShadowViewProjection);
+    _directionalLightMaterial->SetFloat(_directionalIds.TexelSize, 1.0f / sunLight.ShadowMapResolution);
     _directionalLightMaterial->SetTexture("ShadowMap", sunLight.ShadowMap.lock());
     pipeline->BindMaterialAutomatic(_directionalLightMaterial);
     
-    context->Draw(4, 0);
+    pipeline->Draw(4, 0);
     _directionalLightMaterial->SetTexture("ShadowMap", nullptr);
     pipeline->Clear();
 
@@ -88,18 +87,18 @@ auto BeLightingPass::Render() -> void {
     // point lights
     pipeline->BindShader(_pointLightShader, BeShaderType::Vertex | BeShaderType::Pixel);
     for (const auto& pointLight : submissionBuffer.GetPointLightEntries()) {
-        _pointLightMaterial->SetFloat3("Position", pointLight.Position);
-        _pointLightMaterial->SetFloat("Radius", pointLight.Radius);
-        _pointLightMaterial->SetFloat3("Color", pointLight.Color);
-        _pointLightMaterial->SetFloat("Power", pointLight.Power);
-        _pointLightMaterial->SetFloat("HasShadowMap", pointLight.CastsShadows ? 1.0f : 0.0f);
-        _pointLightMaterial->SetFloat("ShadowMapResolution", pointLight.ShadowMapResolution);
-        _pointLightMaterial->SetFloat("ShadowNearPlane", pointLight.ShadowNearPlane);
+        _pointLightMaterial->SetFloat3(_pointIds.Position, pointLight.Position);
+        _pointLightMaterial->SetFloat(_pointIds.Radius, pointLight.Radius);
+        _pointLightMaterial->SetFloat3(_pointIds.Color, pointLight.Color);
+        _pointLightMaterial->SetFloat(_pointIds.Power, pointLight.Power);
+        _pointLightMaterial->SetFloat(_pointIds.HasShadowMap, pointLight.CastsShadows ? 1.0f : 0.0f);
+        _pointLightMaterial->SetFloat(_pointIds.ShadowMapResolution, pointLight.ShadowMapResolution);
+        _pointLightMaterial->SetFloat(_pointIds.ShadowNearPlane, pointLight.ShadowNearPlane);
         // TODO: super uncool, material shouldnt own anything ideally. or should it?
         _pointLightMaterial->SetTexture("PointLightShadowMap", pointLight.ShadowMap.lock()); 
         pipeline->BindMaterialAutomatic(_pointLightMaterial);
     
-        context->Draw(4, 0);
+        pipeline->Draw(4, 0);
     }
     
     _pointLightMaterial->SetTexture("PointLightShadowMap", nullptr);
@@ -109,6 +108,6 @@ auto BeLightingPass::Render() -> void {
     // emissive add
     pipeline->BindShader(_emissiveAddShader, BeShaderType::Vertex | BeShaderType::Pixel);
     pipeline->BindMaterialAutomatic(_emissiveMaterial);
-    context->Draw(4, 0);
+    pipeline->Draw(4, 0);
     pipeline->Clear();
 }
\ No newline at end of file
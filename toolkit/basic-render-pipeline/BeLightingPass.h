@@ -3,6 +3,7 @@
 #include <memory>
 #include <span>
 
+#include "BeMaterialScheme.h"
 #include "BeRenderPass.h"
 
 class BeBRPSubmissionBuffer;
@@ -25,7 +26,6 @@ class BeLightingPass final : public BeRenderPass {
     std::weak_ptr<BeTexture> OutputTexture;
     
     hide
-    ComPtr<ID3D11BlendState> _lightingBlendState;
 
     std::shared_ptr<BeShader> _directionalLightShader;
     std::shared_ptr<BeMaterial> _directionalLightMaterial;
@@ -33,6 +33,14 @@ class BeLightingPass final : public BeRenderPass {
     std::shared_ptr<BeMaterial> _pointLightMaterial;
     std::shared_ptr<BeShader> _emissiveAddShader;
     std::shared_ptr<BeMaterial> _emissiveMaterial;
+
+    struct {
+        BeMaterialPropertyId HasShadowMap, Direction, Color, Power, ProjectionView, TexelSize;
+    } _directionalIds;
+
+    struct {
+        BeMaterialPropertyId Position, Radius, Color, Power, HasShadowMap, ShadowMapResolution, ShadowNearPlane;
+    } _pointIds;
     
     expose
     explicit BeLightingPass();
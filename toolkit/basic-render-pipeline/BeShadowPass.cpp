@@ -1,14 +1,22 @@
 #include "BeShadowPass.h"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <iterator>
+#include <limits>
 #include <umbrellas/include-glm.h>
+#include <materials/BeBRPObjectMaterial.h>
 #include <scope_guard/scope_guard.hpp>
 
 #include "BeAssetRegistry.h"
+#include "BeBRPDetailSelector.h"
 #include "BeBRPSubmissionBuffer.h"
 #include "BeMaterial.h"
 #include "BeModel.h"
 #include "BePipeline.h"
 #include "BeRenderer.h"
+#include "BeShader.h"
 #include "BeTexture.h"
 
 auto BeShadowPass::Initialise() -> void {
@@ -18,39 +26,138 @@ auto BeShadowPass::Initialise() -> void {
 
 auto BeShadowPass::Render() -> void {
     const auto context = _renderer->GetContext();
+    const auto& pipeline = _renderer->GetPipeline();
 
-    UINT numViewports = 1;
-    D3D11_VIEWPORT previousViewport = {};
-    context->RSGetViewports(&numViewports,  &previousViewport);
-    SCOPE_EXIT { context->RSSetViewports(1, &previousViewport); };
+    const auto previousViewport = pipeline->GetViewport();
+    SCOPE_EXIT { pipeline->SetViewport(previousViewport); };
 
     const auto& submissionBuffer = *SubmissionBuffer.lock();
-    
+    const auto& entries = submissionBuffer.GetGeometryEntries();
     const auto& sunLights = submissionBuffer.GetSunLightEntries();
+    const auto& pointLights = submissionBuffer.GetPointLightEntries();
+
+    // boxes of every caster large enough on the camera's screen, each view only draws the ones inside it
+    const auto& cameraPosition = _renderer->UniformData.CameraPosition;
+    const auto screenScale = _renderer->UniformData.ScreenScale;
+    _casterCuller.Clear();
+    _casterEntries.clear();
+    _smallCasterCount = 0;
+    for (uint32_t i = 0; i < entries.size(); i++) {
+        if (!entries[i].CastShadows)
+            continue;
+        const auto& model = *entries[i].Model;
+        if (entries[i].MinShadowScreenSize > 0.f &&
+            BeBRPDetailSelector::ScreenSizeOf(model.BoundsMin, model.BoundsMax, entries[i].ModelMatrix, cameraPosition, screenScale) < entries[i].MinShadowScreenSize) {
+            _smallCasterCount++;
+            continue;
+        }
+        _casterCuller.PushTransformed(model.BoundsMin, model.BoundsMax, entries[i].ModelMatrix);
+        _casterEntries.push_back(i);
+    }
+
+    // every view in the order it's drawn with what it sees, how badly it needs drawing and what that costs
+    const auto versions = submissionBuffer.GetGeometryVersions();
+    const auto cameraPlanes = BeFrustumCuller::ExtractPlanes(_renderer->UniformData.ProjectionView);
+    _frame++;
+    _cacheStats = {};
+    _views.clear();
+    _plans.clear();
+    _viewCasters.clear();
+    _decisions.clear();
+    for (const auto& sunLight : sunLights) {
+        if (!sunLight.CastsShadows)
+            continue;
+
+        // the sun's box without its near plane, casters between the sun and the box still shadow what's inside
+        const auto& viewProjection = sunLight.ShadowViewProjection;
+        const auto planes = BeFrustumCuller::ExtractPlanes(viewProjection);
+        const auto extrudedPlanes = std::array {planes[0], planes[1], planes[2], planes[3], planes[5]};
+        auto& mapCache = CacheOf(sunLight.ShadowMap.lock());
+        const auto visibleCasters = _casterCuller.Cull(extrudedPlanes);
+        AddView(entries, versions, mapCache, 0, viewProjection, glm::vec3(0.f), visibleCasters, _casterEntries, std::numeric_limits<float>::infinity(), 1.f);
+    }
+    for (const auto& pointLight : pointLights) {
+        if (!pointLight.CastsShadows)
+            continue;
+
+        // casters touching the light's sphere, then each face takes only those in its own frustum
+        _lightCuller.Clear();
+        _lightCasterEntries.clear();
+        for (const auto caster : _casterCuller.CullSphere(pointLight.Position, pointLight.Radius)) {
+            const auto [center, extents] = _casterCuller.GetBox(caster);
+            _lightCuller.Push(center, extents);
+            _lightCasterEntries.push_back(_casterEntries[caster]);
+        }
+
+        auto& mapCache = CacheOf(pointLight.ShadowMap.lock());
+        const auto screenSize = BeBRPDetailSelector::ScreenSizeOf(pointLight.Position, pointLight.Radius, cameraPosition, screenScale);
+        for (uint32_t face = 0; face < 6; face++) {
+            const auto viewProjection = CalculatePointLightFaceViewProjection(pointLight, static_cast<int>(face));
+            const auto planes = BeFrustumCuller::ExtractPlanes(viewProjection);
+            const auto weight = IsFaceVisible(pointLight, face, cameraPlanes) ? 1.f : Schedule.HiddenFaceWeight;
+            AddView(entries, versions, mapCache, face, viewProjection, pointLight.Position, _lightCuller.Cull(planes), _lightCasterEntries, screenSize, weight);
+        }
+    }
+
+    // maps that weren't drawn from this frame, their lights are gone or stopped casting
+    std::erase_if(_mapCaches, [this](const auto& item) { return item.second.LastFrame != _frame; });
+    // and costs of models that are gone
+    std::erase_if(_modelCosts, [](const auto& item) { return item.second.Model.expired(); });
+
+    // then only what fits the budget is batched
+    BeBRPShadowScheduler::Schedule(_decisions, Schedule, _frame, _scheduleOrder);
+    _batches.clear();
+    _matrices.clear();
+    for (uint32_t view = 0; view < _views.size(); view++)
+        CommitView(entries, view);
+
+    // one upload for the instances of all views
+    _instances.Upload(_renderer->GetDevice().Get(), context.Get(), _matrices);
+    pipeline->SetVertexBuffer(_renderer->GetShaderVertexBuffer().Get(), sizeof(BeFullVertex));
+    pipeline->SetIndexBuffer(_renderer->GetShaderIndexBuffer().Get(), DXGI_FORMAT_R32_UINT);
+    pipeline->SetInstanceBuffer(_instances.GetBuffer(), BeBRPInstanceBuffer::Stride);
+    SCOPE_EXIT {
+        pipeline->SetVertexBuffer(nullptr, 0);
+        pipeline->SetIndexBuffer(nullptr, DXGI_FORMAT_R32_UINT);
+        pipeline->SetInstanceBuffer(nullptr, 0);
+    };
+
+    // and one map for their object constants
+    const auto constantRing = _renderer->GetConstantRing();
+    _objectBlocks.reset();
+    if (constantRing && !_batches.empty())
+        _objectBlocks = constantRing->Map(context.Get(), static_cast<uint32_t>(_batches.size()), sizeof(BeMaterialData::ObjectMaterialForGeometryPass));
+    if (_objectBlocks) {
+        for (const auto& view : _views)
+            for (uint32_t batch = view.FirstBatch; batch < view.FirstBatch + view.BatchCount; batch++)
+                _objectBlocks->At<BeMaterialData::ObjectMaterialForGeometryPass>(batch) = ObjectDataOf(view, _batches[batch]);
+        constantRing->Unmap(context.Get());
+    }
+    
+    uint32_t viewIndex = 0;
     for (size_t i = 0; i < sunLights.size(); ++i) {
         if (!sunLights[i].CastsShadows)
             continue;
         
         Utils::BeDebugAnnotation directionalLightAnnotation(context, "Directional Light Shadows " + std::to_string(i));
-        RenderDirectionalShadows(sunLights[0], submissionBuffer);
+        RenderDirectionalShadows(sunLights[i], viewIndex);
+        viewIndex++;
     }
 
-    const auto& pointLights = submissionBuffer.GetPointLightEntries();
     for (size_t i = 0; i < pointLights.size(); i++) {
         if (!pointLights[i].CastsShadows)
             continue;
 
         Utils::BeDebugAnnotation pointLightAnnotation(context, "Point Light Shadows " + std::to_string(i));
-        RenderPointLightShadows(pointLights[i], submissionBuffer);
+        RenderPointLightShadows(pointLights[i], viewIndex);
+        viewIndex += 6;
     }
 }
 
-auto BeShadowPass::RenderDirectionalShadows(
-    const BeBRPSunLightEntry& sunLight,
-    const BeBRPSubmissionBuffer& submissionBuffer
-) const -> void {
-    const auto& context = _renderer->GetContext();
+auto BeShadowPass::RenderDirectionalShadows(const BeBRPSunLightEntry& sunLight, const uint32_t viewIndex) const -> void {
     const auto& pipeline = _renderer->GetPipeline();
+    if (_views[viewIndex].Update == ViewUpdate::Skip)
+        return;
     
     // sort out viewport
     D3D11_VIEWPORT viewport = {};
@@ -58,71 +165,18 @@ auto BeShadowPass::RenderDirectionalShadows(
     viewport.Height = sunLight.ShadowMapResolution;
     viewport.MinDepth = 0.0f;
     viewport.MaxDepth = 1.0f;
-    context->RSSetViewports(1, &viewport);
-
-    // sort out render target
-    context->OMSetRenderTargets(0, Utils::NullRTVs, sunLight.ShadowMap.lock()->GetDSV().Get());
-    context->ClearDepthStencilView(sunLight.ShadowMap.lock()->GetDSV().Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-    SCOPE_EXIT { context->OMSetRenderTargets(0, nullptr, nullptr); };
-
-    // Set vertex and index buffers
-    uint32_t stride = sizeof(BeFullVertex);
-    uint32_t offset = 0;
-    context->IASetVertexBuffers(0, 1, _renderer->GetShaderVertexBuffer().GetAddressOf(), &stride, &offset);
-    context->IASetIndexBuffer(_renderer->GetShaderIndexBuffer().Get(), DXGI_FORMAT_R32_UINT, 0);
-    SCOPE_EXIT {
-        context->IASetVertexBuffers(0, 1, Utils::NullBuffers, &stride, &offset);
-        context->IASetIndexBuffer(nullptr, DXGI_FORMAT_R32_UINT, 0);
-    };
-
-    const auto& entries = submissionBuffer.GetGeometryEntries();
-    for (const auto& entry : entries) {
-        if (!entry.CastShadows)
-            continue;
+    pipeline->SetViewport(viewport);
 
-        pipeline->BindShader(entry.Model->Shader, BeShaderType::Vertex | BeShaderType::Tesselation);
-        
-        _objectMaterial->SetMatrix("Model", entry.ModelMatrix);
-        _objectMaterial->SetMatrix("ProjectionView", sunLight.ShadowViewProjection);
-        _objectMaterial->SetFloat3("ViewerPosition", glm::vec3(0.f));
-        _objectMaterial->UpdateGPUBuffers(context);
-        pipeline->BindMaterialAutomatic(_objectMaterial);
-        
-        const auto & drawSlices = _renderer->GetDrawSlicesForModel(entry.Model);
-        for (const auto& slice : drawSlices) {
-            if (slice.TwoSided) {
-                context->RSSetState(_renderer->GetRasterizerCullNone().Get());
-            }
-
-            pipeline->BindMaterialAutomatic(slice.Material);
-            context->DrawIndexed(slice.IndexCount, slice.StartIndexLocation, slice.BaseVertexLocation);
-
-            if (slice.TwoSided) {
-                context->RSSetState(_renderer->GetRasterizerCullBack().Get());
-            }
-        }
-
-        pipeline->Clear();
-    }
+    const auto map = sunLight.ShadowMap.lock();
+    const auto& staticLayer = _mapCaches.at(map.get()).StaticLayer;
+    RenderView(viewIndex, *map, map->GetDSV().Get(), staticLayer.get(), staticLayer ? staticLayer->GetDSV().Get() : nullptr, 0);
 }
 
-auto BeShadowPass::RenderPointLightShadows(
-    const BeBRPPointLightEntry& pointLight, 
-    const BeBRPSubmissionBuffer& submissionBuffer
-) const -> void {
+auto BeShadowPass::RenderPointLightShadows(const BeBRPPointLightEntry& pointLight, const uint32_t firstViewIndex) const -> void {
     // get what we need
-    const auto& context = _renderer->GetContext();
     const auto& pipeline = _renderer->GetPipeline();
-    
-    // sort out vertex and index buffers
-    uint32_t stride = sizeof(BeFullVertex);
-    uint32_t offset = 0;
-    context->IASetVertexBuffers(0, 1, _renderer->GetShaderVertexBuffer().GetAddressOf(), &stride, &offset);
-    context->IASetIndexBuffer(_renderer->GetShaderIndexBuffer().Get(), DXGI_FORMAT_R32_UINT, 0);
-    SCOPE_EXIT {
-        context->IASetVertexBuffers(0, 1, Utils::NullBuffers, &stride, &offset);
-        context->IASetIndexBuffer(nullptr, DXGI_FORMAT_R32_UINT, 0);
-    };
+    const auto map = pointLight.ShadowMap.lock();
+    const auto& staticLayer = _mapCaches.at(map.get()).StaticLayer;
     
     // sort out viewport
     D3D11_VIEWPORT viewport = {};
@@ -130,51 +184,312 @@ auto BeShadowPass::RenderPointLightShadows(
     viewport.Height = pointLight.ShadowMapResolution;
     viewport.MinDepth = 0.0f;
     viewport.MaxDepth = 1.0f;
-    context->RSSetViewports(1, &viewport);
-
-    // render each face
-    for (int face = 0; face < 6; face++) {
-        // sort out render target
-        auto cubemapDSV = pointLight.ShadowMap.lock()->GetCubemapDSV(face);
-        context->ClearDepthStencilView(cubemapDSV.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-        context->OMSetRenderTargets(0, nullptr, cubemapDSV.Get());
-
-        const glm::mat4x4 faceViewProj = CalculatePointLightFaceViewProjection(pointLight, face);
-
-        // for each object
-        const auto& entries = submissionBuffer.GetGeometryEntries();
-        for (const auto& entry : entries) {
-            if (!entry.CastShadows)
-                continue;
-
-            pipeline->BindShader(entry.Model->Shader, BeShaderType::Vertex | BeShaderType::Tesselation);
-            
-            _objectMaterial->SetMatrix("Model", entry.ModelMatrix);
-            _objectMaterial->SetMatrix("ProjectionView", faceViewProj);
-            _objectMaterial->SetFloat3("ViewerPosition", pointLight.Position);
+    pipeline->SetViewport(viewport);
+
+    // render each face that needs it
+    for (uint32_t face = 0; face < 6; face++) {
+        const auto subresource = D3D11CalcSubresource(0, face, map->Mips);
+        RenderView(
+            firstViewIndex + face,
+            *map,
+            map->GetCubemapDSV(face).Get(),
+            staticLayer.get(),
+            staticLayer ? staticLayer->GetCubemapDSV(face).Get() : nullptr,
+            subresource
+        );
+    }
+}
+
+auto BeShadowPass::RenderView(
+    const uint32_t viewIndex,
+    BeTexture& map,
+    ID3D11DepthStencilView* mapDSV,
+    const BeTexture* staticLayer,
+    ID3D11DepthStencilView* staticLayerDSV,
+    const uint32_t subresource
+) const -> void {
+    const auto& context = _renderer->GetContext();
+    const auto& pipeline = _renderer->GetPipeline();
+    const auto& view = _views[viewIndex];
+    SCOPE_EXIT { pipeline->ClearRenderTargets(); };
+
+    switch (view.Update) {
+        case ViewUpdate::Skip:
+            return;
+
+        case ViewUpdate::Redraw:
+            context->ClearDepthStencilView(mapDSV, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+            pipeline->SetRenderTargets({}, mapDSV);
+            DrawCasters(view, view.FirstBatch, view.BatchCount);
+            return;
+
+        case ViewUpdate::RedrawLayered:
+            context->ClearDepthStencilView(staticLayerDSV, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+            pipeline->SetRenderTargets({}, staticLayerDSV);
+            DrawCasters(view, view.FirstBatch, view.StaticBatchCount);
+            pipeline->ClearRenderTargets();
+            [[fallthrough]];
+
+        case ViewUpdate::Composite:
+            assert(staticLayer);
+            context->CopySubresourceRegion(map.GetTexture().Get(), subresource, 0, 0, 0, staticLayer->GetTexture().Get(), subresource, nullptr);
+            pipeline->SetRenderTargets({}, mapDSV);
+            DrawCasters(view, view.FirstBatch + view.StaticBatchCount, view.BatchCount - view.StaticBatchCount);
+            return;
+    }
+}
+
+auto BeShadowPass::CacheOf(const std::shared_ptr<BeTexture>& map) -> MapCache& {
+    auto& cache = _mapCaches[map.get()];
+    if (cache.Map.expired()) {
+        cache = MapCache();
+        cache.Map = map;
+    }
+    cache.LastFrame = _frame;
+    return cache;
+}
+
+auto BeShadowPass::AddView(
+    const std::span<const BeBRPGeometryEntry> entries,
+    const std::span<const uint64_t> versions,
+    MapCache& mapCache,
+    const uint32_t face,
+    const glm::mat4& viewProjection,
+    const glm::vec3& viewerPosition,
+    const std::span<const uint32_t> visibleCasters,
+    const std::span<const uint32_t> casterEntries,
+    const float screenSize,
+    const float weight
+) -> void {
+    // static casters first and dynamic ones after, each kind with a signature of their versions and shaders. casters
+    // animated by their shader move every frame whatever their entry says, so they go with the dynamic ones
+    auto plan = ViewPlan {
+        .Cache = &mapCache,
+        .Face = face,
+        .State = { .ViewProjection = viewProjection },
+        .FirstCaster = static_cast<uint32_t>(_viewCasters.size()),
+    };
+    const auto shaderOf = [&entries](const uint32_t entry) -> const std::shared_ptr<BeShader>& {
+        return entries[entry].Model->Shader;
+    };
+    const auto isAnimated = [&](const uint32_t entry) {
+        return shaderOf(entry) && shaderOf(entry)->AnimatesGeometry;
+    };
+    const auto addCaster = [&](const uint32_t entry, const bool isStatic) {
+        const auto shaderID = shaderOf(entry) ? shaderOf(entry)->UniqueID : 0u;
+        _viewCasters.push_back(entry);
+        BeBRPShadowCache::AddCaster(plan.State, isStatic, versions[entry], shaderID, isAnimated(entry));
+    };
+    for (const auto caster : visibleCasters) {
+        const auto entry = casterEntries[caster];
+        if (entries[entry].Static && !isAnimated(entry))
+            addCaster(entry, true);
+    }
+    for (const auto caster : visibleCasters) {
+        const auto entry = casterEntries[caster];
+        if (!entries[entry].Static || isAnimated(entry))
+            addCaster(entry, false);
+    }
+
+    const auto& cache = mapCache.Views[face];
+    const auto wanted = ShadowCaching ? BeBRPShadowCache::Plan(cache, plan.State) : ViewUpdate::Redraw;
+    const auto casters = std::span(_viewCasters).subspan(plan.FirstCaster, plan.State.StaticCount + plan.State.DynamicCount);
+    const auto statics = casters.first(plan.State.StaticCount);
+    const auto dynamics = casters.last(plan.State.DynamicCount);
+    auto cost = std::pair<uint32_t, uint64_t>(0, 0);
+    if (wanted == ViewUpdate::Redraw || wanted == ViewUpdate::RedrawLayered) {
+        // a plain redraw batches both kinds together, so this overestimates its draws a little
+        cost = CostOf(entries, statics);
+        const auto [draws, triangles] = CostOf(entries, dynamics);
+        cost.first += draws;
+        cost.second += triangles;
+    }
+    else if (wanted == ViewUpdate::Composite)
+        cost = CostOf(entries, dynamics);
+
+    _plans.push_back(plan);
+    _views.push_back({
+        .ViewProjection = viewProjection,
+        .ViewerPosition = viewerPosition,
+        .Update = ViewUpdate::Skip,
+        .FirstBatch = 0,
+        .StaticBatchCount = 0,
+        .BatchCount = 0,
+    });
+    _decisions.push_back({
+        .Map = mapCache.Map.lock().get(),
+        .Face = face,
+        .Wanted = wanted,
+        .Update = ViewUpdate::Skip,
+        .ScreenSize = screenSize,
+        .Weight = weight,
+        .Priority = 0.f,
+        .Staleness = cache.Staleness,
+        .Draws = cost.first,
+        .Triangles = cost.second,
+        .Cached = cache.Valid,
+    });
+}
+
+auto BeShadowPass::CommitView(const std::span<const BeBRPGeometryEntry> entries, const uint32_t viewIndex) -> void {
+    const auto& plan = _plans[viewIndex];
+    const auto& decision = _decisions[viewIndex];
+    auto& mapCache = *plan.Cache;
+    auto& cache = mapCache.Views[plan.Face];
+    auto& view = _views[viewIndex];
+    view.Update = decision.Update;
+    view.FirstBatch = static_cast<uint32_t>(_batches.size());
+
+    if (decision.Update == ViewUpdate::Skip) {
+        if (decision.Wanted == ViewUpdate::Skip)
+            _cacheStats.Skipped++;
+        else {
+            _cacheStats.Deferred++;
+            cache.Staleness++;
+        }
+        return;
+    }
+
+    // the map holds what the view sees from here on. without caching it's never trusted, so it's always drawn first
+    BeBRPShadowCache::Commit(cache, plan.State, decision.Update);
+    cache.Valid = ShadowCaching;
+
+    if (decision.Update == ViewUpdate::RedrawLayered && !mapCache.StaticLayer) {
+        const auto map = mapCache.Map.lock();
+        mapCache.StaticLayer = BeTexture::Create(map->Name + "_StaticLayer")
+            .SetBindFlags(D3D11_BIND_DEPTH_STENCIL)
+            .SetFormat(map->Format)
+            .SetCubemap(map->IsCubemap)
+            .SetSize(map->Width, map->Height)
+            .Build(_renderer->GetDevice());
+    }
+
+    const auto casters = std::span(_viewCasters).subspan(plan.FirstCaster, plan.State.StaticCount + plan.State.DynamicCount);
+    const auto statics = casters.first(plan.State.StaticCount);
+    const auto dynamics = casters.last(plan.State.DynamicCount);
+    switch (decision.Update) {
+        case ViewUpdate::Skip:
+            break;
+        case ViewUpdate::Redraw:
+            _selection.clear();
+            std::ranges::merge(statics, dynamics, std::back_inserter(_selection));
+            view.BatchCount = AddBatches(entries, _selection);
+            _cacheStats.Redrawn++;
+            break;
+        case ViewUpdate::RedrawLayered:
+            view.StaticBatchCount = AddBatches(entries, statics);
+            view.BatchCount = view.StaticBatchCount + AddBatches(entries, dynamics);
+            _cacheStats.Redrawn++;
+            break;
+        case ViewUpdate::Composite:
+            view.BatchCount = AddBatches(entries, dynamics);
+            _cacheStats.Composited++;
+            break;
+    }
+}
+
+auto BeShadowPass::CostOf(const std::span<const BeBRPGeometryEntry> entries, const std::span<const uint32_t> casters) -> std::pair<uint32_t, uint64_t> {
+    // instanced models are one draw per slice however many casters share them, the rest one per caster and slice
+    _costStamp++;
+    auto draws = uint32_t(0);
+    auto triangles = uint64_t(0);
+    for (const auto index : casters) {
+        const auto& model = entries[index].Model;
+        auto& cost = _modelCosts[model.get()];
+        if (cost.Model.lock() != model) {
+            const auto& slices = _renderer->GetDrawSlicesForModel(model);
+            cost = { .Model = model, .Triangles = 0, .Slices = static_cast<uint32_t>(slices.size()), .Stamp = 0 };
+            for (const auto& slice : slices)
+                cost.Triangles += slice.IndexCount / 3;
+        }
+
+        const auto instanced = model->Shader && model->Shader->IsInstanced;
+        if (!instanced || cost.Stamp != _costStamp)
+            draws += cost.Slices;
+        cost.Stamp = _costStamp;
+        triangles += cost.Triangles;
+    }
+    return { draws, triangles };
+}
+
+auto BeShadowPass::IsFaceVisible(
+    const BeBRPPointLightEntry& pointLight,
+    const uint32_t face,
+    const std::span<const glm::vec4> cameraPlanes
+) -> bool {
+    // the box around the face's pyramid, from the light out to its radius
+    const auto axis = face / 2;
+    const auto sign = face % 2 == 0 ? 1.f : -1.f;
+    auto center = pointLight.Position;
+    auto extents = glm::vec3(pointLight.Radius);
+    center[axis] += sign * pointLight.Radius * 0.5f;
+    extents[axis] = pointLight.Radius * 0.5f;
+
+    for (const auto& plane : cameraPlanes)
+        if (glm::dot(glm::vec3(plane), center) + plane.w + glm::dot(glm::abs(glm::vec3(plane)), extents) < 0.f)
+            return false;
+    return true;
+}
+
+auto BeShadowPass::AddBatches(const std::span<const BeBRPGeometryEntry> entries, const std::span<const uint32_t> selection) -> uint32_t {
+    _batcher.Build(entries, selection, &BeModel::IsInstanced);
+
+    const auto batches = _batcher.GetBatches();
+    const auto matrices = _batcher.GetMatrices();
+    const auto firstInstance = static_cast<uint32_t>(_matrices.size());
+    for (auto batch : batches) {
+        batch.FirstInstance += firstInstance;
+        _batches.push_back(std::move(batch));
+    }
+    _matrices.insert(_matrices.end(), matrices.begin(), matrices.end());
+    return static_cast<uint32_t>(batches.size());
+}
+
+auto BeShadowPass::DrawCasters(const ShadowView& view, const uint32_t firstBatch, const uint32_t batchCount) const -> void {
+    const auto& context = _renderer->GetContext();
+    const auto& pipeline = _renderer->GetPipeline();
+    const auto constantRing = _renderer->GetConstantRing();
+
+    for (uint32_t batchIndex = firstBatch; batchIndex < firstBatch + batchCount; batchIndex++) {
+        const auto& batch = _batches[batchIndex];
+        const auto& shader = batch.Model->Shader;
+        pipeline->BindShader(shader, BeShaderType::Vertex | BeShaderType::Tesselation);
+        const auto& shaderState = shader->State;
+
+        if (_objectBlocks) {
+            const auto slot = _objectMaterial->GetSlotIn(*shader);
+            pipeline->BindConstantRange(slot, constantRing->GetBuffer(), _objectBlocks->ConstantOf(batchIndex), _objectBlocks->ConstantCount());
+        }
+        else {
+            _objectMaterial->Data<BeMaterialData::ObjectMaterialForGeometryPass>() = ObjectDataOf(view, batch);
             _objectMaterial->UpdateGPUBuffers(context);
             pipeline->BindMaterialAutomatic(_objectMaterial);
-            
-            // draw
-            const auto& drawSlices = _renderer->GetDrawSlicesForModel(entry.Model);
-            for (const auto& slice : drawSlices) {
-                if (slice.TwoSided) {
-                    context->RSSetState(_renderer->GetRasterizerCullNone().Get());
-                }
-
-                pipeline->BindMaterialAutomatic(slice.Material);
-                context->DrawIndexed(slice.IndexCount, slice.StartIndexLocation, slice.BaseVertexLocation);
-
-                if (slice.TwoSided) {
-                    context->RSSetState(_renderer->GetRasterizerCullBack().Get());
-                }
-            }
-
-            pipeline->Clear();
         }
+        
+        const auto& drawSlices = _renderer->GetDrawSlicesForModel(batch.Model);
+        for (const auto& slice : drawSlices) {
+            pipeline->SetState(slice.TwoSided ? shaderState.WithCull(BeCullMode::None) : shaderState);
+            pipeline->BindMaterialAutomatic(slice.Material);
+            if (shader->IsInstanced)
+                pipeline->DrawIndexedInstanced(slice.IndexCount, batch.InstanceCount, slice.StartIndexLocation, slice.BaseVertexLocation, batch.FirstInstance);
+            else
+                pipeline->DrawIndexed(slice.IndexCount, slice.StartIndexLocation, slice.BaseVertexLocation);
+        }
+
+        pipeline->Clear();
     }
-    
-    context->OMSetRenderTargets(0, nullptr, nullptr);
+}
+
+// instanced shaders take their model matrix from the instance stream, the others from the object constants
+auto BeShadowPass::ObjectDataOf(
+    const ShadowView& view,
+    const BeBRPInstanceBatch& batch
+) const -> BeMaterialData::ObjectMaterialForGeometryPass {
+    auto data = BeMaterialData::ObjectMaterialForGeometryPass();
+    data.Model = batch.Model->Shader->IsInstanced ? glm::mat4(1.f) : _matrices[batch.FirstInstance];
+    data.ProjectionView = view.ViewProjection;
+    data.ViewerPosition = view.ViewerPosition;
+    return data;
 }
 
 auto BeShadowPass::CalculatePointLightFaceViewProjection(
@@ -1,29 +1,110 @@
 ﻿#pragma once
+#include <array>
 #include <d3d11.h>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <span>
 #include <string>
+#include <unordered_map>
+#include <vector>
+#include <materials/BeBRPObjectMaterial.h>
 #include <umbrellas/include-glm.h>
 
+#include "BeBRPInstanceBuffer.h"
+#include "BeBRPInstancing.h"
+#include "BeBRPShadowCache.h"
+#include "BeBRPShadowScheduler.h"
 #include "BeBRPSubmissionBuffer.h"
-#include "BeBRPSubmissionBuffer.h"
-#include "BeBRPSubmissionBuffer.h"
-#include "BeBRPSubmissionBuffer.h"
-#include "BeBRPSubmissionBuffer.h"
+#include "BeConstantRing.h"
+#include "BeFrustumCuller.h"
 #include "BeRenderPass.h"
 
 class BeBRPSubmissionBuffer;
 class BeMaterial;
+class BeTexture;
 struct BePointLight;
 struct BeDirectionalLight;
 
+// shadow maps are cached. a view (the sun's map or a cube face) is only drawn again when the light moved or a caster
+// it sees changed, by the versions of the submission buffer. static casters of a view that also sees dynamic ones are
+// kept in a static layer, a second depth texture, so a dynamic caster moving costs a copy of the layer and its own draw.
+// views that need drawing are scheduled under a per frame budget, the ones left over keep their old map and move up,
+// see BeBRPShadowScheduler
 class BeShadowPass final : public BeRenderPass {
+public:
+    // the scheduler's, GetDecisions and Schedule use them
+    using ViewUpdate = BeBRPShadowScheduler::ViewUpdate;
+    using SchedulePolicy = BeBRPShadowScheduler::SchedulePolicy;
+    using ViewDecision = BeBRPShadowScheduler::ViewDecision;
+    using ViewCache = BeBRPShadowCache::ViewCache;
+
+    hide struct ShadowView {
+        glm::mat4 ViewProjection;
+        glm::vec3 ViewerPosition;
+        ViewUpdate Update;
+        uint32_t FirstBatch; // in _batches
+        uint32_t StaticBatchCount; // the first ones, drawn into the static layer
+        uint32_t BatchCount;
+    };
+
+    hide struct MapCache {
+        std::weak_ptr<BeTexture> Map; // the key's owner, a new map at the same address starts over
+        std::array<ViewCache, 6> Views; // by cube face, sun maps use the first
+        std::shared_ptr<BeTexture> StaticLayer; // made the first time a view needs it
+        uint64_t LastFrame = 0;
+    };
+
+    // what a view sees, between collecting the views and drawing the scheduled ones
+    hide struct ViewPlan {
+        MapCache* Cache;
+        uint32_t Face;
+        BeBRPShadowCache::ViewState State;
+        uint32_t FirstCaster; // in _viewCasters, State.StaticCount static casters then the dynamic ones
+    };
+
+    hide struct ModelCost {
+        std::weak_ptr<BeModel> Model; // counted again when a new model takes the key's address
+        uint32_t Triangles;
+        uint32_t Slices;
+        uint32_t Stamp; // the caster group that counted its draws last
+    };
+
+    expose struct CacheStats {
+        uint32_t Skipped = 0; // up to date, deferred ones aren't counted here
+        uint32_t Redrawn = 0; // including the layered ones
+        uint32_t Composited = 0;
+        uint32_t Deferred = 0; // needed drawing, left for a later frame
+    };
 
     expose
     std::weak_ptr<BeBRPSubmissionBuffer> SubmissionBuffer;
+    bool ShadowCaching = true; // false draws every view every frame
+    SchedulePolicy Schedule;
 
     hide
     std::shared_ptr<BeMaterial> _objectMaterial;
+    BeFrustumCuller _casterCuller; // one box per caster
+    std::vector<uint32_t> _casterEntries; // entry index by caster
+    BeFrustumCuller _lightCuller; // casters in the current point light's sphere, scratch
+    std::vector<uint32_t> _lightCasterEntries; // scratch
+    std::vector<uint32_t> _selection; // scratch
+    std::vector<ViewPlan> _plans; // by view
+    std::vector<uint32_t> _viewCasters; // entry indices of every view
+    std::vector<ViewDecision> _decisions; // by view
+    std::vector<uint32_t> _scheduleOrder; // scratch
+    std::unordered_map<const BeModel*, ModelCost> _modelCosts; // dropped with their models
+    uint32_t _costStamp = 0;
+    BeBRPInstanceBatcher _batcher; // one view at a time
+    BeBRPInstanceBuffer _instances;
+    std::vector<ShadowView> _views; // in the order they're drawn
+    std::vector<BeBRPInstanceBatch> _batches; // of all views, instances index _matrices
+    std::vector<glm::mat4> _matrices;
+    std::optional<BeConstantRing::Blocks> _objectBlocks; // one per batch
+    uint32_t _smallCasterCount = 0;
+    std::unordered_map<const BeTexture*, MapCache> _mapCaches;
+    uint64_t _frame = 0;
+    CacheStats _cacheStats;
     
     expose
     explicit BeShadowPass() = default;
@@ -32,10 +113,43 @@ class BeShadowPass final : public BeRenderPass {
     auto Initialise() -> void override;
     auto Render() -> void override;
     auto GetPassName() const -> const std::string override { return "Shadow Pass"; }
+    // casters of the last frame left out for being smaller on screen than their MinShadowScreenSize
+    auto GetSmallCasterCount() const -> uint32_t { return _smallCasterCount; }
+    // views of the last frame by what was done about them
+    auto GetCacheStats() const -> const CacheStats& { return _cacheStats; }
+    // one per view of the last frame, in the order they're drawn
+    auto GetDecisions() const -> std::span<const ViewDecision> { return _decisions; }
 
     hide
-    auto RenderDirectionalShadows(const BeBRPSunLightEntry& sunLight, const BeBRPSubmissionBuffer& submissionBuffer) const -> void;
-    auto RenderPointLightShadows(const BeBRPPointLightEntry& pointLight, const BeBRPSubmissionBuffer& submissionBuffer) const -> void;
+    auto RenderDirectionalShadows(const BeBRPSunLightEntry& sunLight, uint32_t viewIndex) const -> void;
+    auto RenderPointLightShadows(const BeBRPPointLightEntry& pointLight, uint32_t firstViewIndex) const -> void;
+    auto RenderView(
+        uint32_t viewIndex,
+        BeTexture& map,
+        ID3D11DepthStencilView* mapDSV,
+        const BeTexture* staticLayer,
+        ID3D11DepthStencilView* staticLayerDSV,
+        uint32_t subresource
+    ) const -> void;
+    auto CacheOf(const std::shared_ptr<BeTexture>& map) -> MapCache&;
+    auto AddView(
+        std::span<const BeBRPGeometryEntry> entries,
+        std::span<const uint64_t> versions,
+        MapCache& mapCache,
+        uint32_t face,
+        const glm::mat4& viewProjection,
+        const glm::vec3& viewerPosition,
+        std::span<const uint32_t> visibleCasters,
+        std::span<const uint32_t> casterEntries,
+        float screenSize,
+        float weight
+    ) -> void;
+    auto CommitView(std::span<const BeBRPGeometryEntry> entries, uint32_t viewIndex) -> void;
+    auto CostOf(std::span<const BeBRPGeometryEntry> entries, std::span<const uint32_t> casters) -> std::pair<uint32_t, uint64_t>;
+    static auto IsFaceVisible(const BeBRPPointLightEntry& pointLight, uint32_t face, std::span<const glm::vec4> cameraPlanes) -> bool;
+    auto AddBatches(std::span<const BeBRPGeometryEntry> entries, std::span<const uint32_t> selection) -> uint32_t;
+    auto DrawCasters(const ShadowView& view, uint32_t firstBatch, uint32_t batchCount) const -> void;
+    auto ObjectDataOf(const ShadowView& view, const BeBRPInstanceBatch& batch) const -> BeMaterialData::ObjectMaterialForGeometryPass;
 
     auto CalculatePointLightFaceViewProjection(const BeBRPPointLightEntry& pointLight, int faceIndex) const -> glm::mat4;
 };
@@ -0,0 +1,32 @@
+
+/*
+
+@be-material: object-material-for-geometry-pass
+[
+    "Model: matrix",
+    "ProjectionView: matrix",
+    "ViewerPosition: float3 = [0, 0, 0]",
+]
+@be-end
+
+*/
+
+
+struct StandardObjectData {
+    row_major float4x4 Model;
+    row_major float4x4 ProjectionView;
+    float3 ViewerPosition;
+};
+
+// rows of the model matrix from the instance stream. shaders with "instance-model" in their vertexLayout
+// take this into their vertex input and ignore _Object.Model
+struct BeBRPInstanceInput {
+    float4 Model0 : INSTANCE_MODEL0;
+    float4 Model1 : INSTANCE_MODEL1;
+    float4 Model2 : INSTANCE_MODEL2;
+    float4 Model3 : INSTANCE_MODEL3;
+};
+
+float4x4 BeBRPInstanceModel(BeBRPInstanceInput instance) {
+    return float4x4(instance.Model0, instance.Model1, instance.Model2, instance.Model3);
+}
@@ -4,6 +4,7 @@
 #include <imgui/backends/imgui_impl_glfw.h>
 #include <imgui/backends/imgui_impl_dx11.h>
 
+#include "BePipeline.h"
 #include "BeRenderer.h"
 #include "BeWindow.h"
 
@@ -40,7 +41,7 @@ auto BeImGuiPass::Render() -> void {
 
     ImGui::Render();
 
-    const auto context = _renderer->GetContext();
+    const auto& pipeline = _renderer->GetPipeline();
     const auto backbuffer = _renderer->GetBackbufferTarget();
 
     D3D11_VIEWPORT viewport{};
@@ -48,14 +49,14 @@ auto BeImGuiPass::Render() -> void {
     viewport.Height = static_cast<float>(_renderer->GetHeight());
     viewport.MinDepth = 0.0f;
     viewport.MaxDepth = 1.0f;
-    context->RSSetViewports(1, &viewport);
-
-    ID3D11RenderTargetView* rtv = backbuffer.Get();
-    context->OMSetRenderTargets(1, &rtv, nullptr);
+    pipeline->SetViewport(viewport);
+    pipeline->SetRenderTarget(backbuffer.Get());
 
     ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+    // the backend sets its own state behind the pipeline's back
+    pipeline->ClearCache();
 
-    context->OMSetRenderTargets(0, nullptr, nullptr);
+    pipeline->ClearRenderTargets();
 }
 
 auto BeImGuiPass::SetUICallback(const std::function<void()>& callback) -> void {
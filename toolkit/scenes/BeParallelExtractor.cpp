@@ -0,0 +1,22 @@
+#include "BeParallelExtractor.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+BeParallelExtractor::BeParallelExtractor(std::shared_ptr<BeTaskPool> pool)
+    : _pool(std::move(pool)) {
+    assert(_pool);
+}
+
+auto BeParallelExtractor::Compact(const std::span<BeBRPGeometryEntry> entries) const -> size_t {
+    // the first chunk is in place already, moving the others down only swaps pointers
+    auto kept = size_t(_chunkCounts.empty() ? 0 : _chunkCounts[0]);
+    for (size_t chunk = 1; chunk < _chunkCounts.size(); chunk++) {
+        const auto first = chunk * ChunkSize;
+        if (kept != first)
+            std::move(entries.begin() + first, entries.begin() + first + _chunkCounts[chunk], entries.begin() + kept);
+        kept += _chunkCounts[chunk];
+    }
+    return kept;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include <umbrellas/access-modifiers.hpp>
+
+#include "BeTaskPool.h"
+#include "basic-render-pipeline/BeBRPSubmissionBuffer.h"
+#include "entt/entt.hpp"
+
+// fills a BeBRPSubmissionBuffer's per frame geometry from an entt view on the threads of a BeTaskPool. the view's
+// leading storage is split into chunks and every chunk writes into its own range of entries sized for all of it, so
+// nothing is shared while they run. the ranges are then closed up in chunk order, which keeps the entries in the order
+// of the leading storage no matter how the chunks were scheduled. a pool without workers skips the chunks
+class BeParallelExtractor {
+    // static part /////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose static constexpr uint32_t ChunkSize = 1024;
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide std::shared_ptr<BeTaskPool> _pool;
+    hide std::vector<uint32_t> _chunkCounts; // entries each chunk wrote
+
+    // lifetime ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose explicit BeParallelExtractor(std::shared_ptr<BeTaskPool> pool);
+    expose ~BeParallelExtractor() = default;
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    // extract(entt::entity, BeBRPGeometryEntry&) -> bool fills in the entry of an entity of the view, false leaves it
+    // out. it runs on several threads at once, so it may only read the registry. returns how many were submitted
+    template <typename View, typename Extract> auto ExtractGeometry(
+        const View& view,
+        BeBRPSubmissionBuffer& buffer,
+        Extract&& extract
+    ) -> size_t;
+
+    hide auto Compact(std::span<BeBRPGeometryEntry> entries) const -> size_t;
+};
+
+template <typename View, typename Extract>
+auto BeParallelExtractor::ExtractGeometry(const View& view, BeBRPSubmissionBuffer& buffer, Extract&& extract) -> size_t {
+    const auto* leading = view.handle();
+    if (!leading || leading->empty())
+        return 0;
+
+    const auto count = leading->size();
+    const auto entries = buffer.SubmitGeometry(count);
+
+    // a range of the leading storage, written from the range's own first entry on. returns how many it kept
+    const auto extractRange = [&](const size_t first, const size_t last) {
+        auto written = first;
+        for (auto i = first; i < last; i++) {
+            // the leading storage holds entities the other storages of the view may lack
+            const auto entity = (*leading)[i];
+            if (view.contains(entity) && extract(entity, entries[written]))
+                written++;
+        }
+        return written - first;
+    };
+
+    // without workers the chunks are only overhead, it's all one range written in place
+    auto kept = size_t(0);
+    if (_pool->GetWorkerCount() == 0)
+        kept = extractRange(0, count);
+    else {
+        const auto chunkCount = static_cast<uint32_t>((count + ChunkSize - 1) / ChunkSize);
+        _chunkCounts.assign(chunkCount, 0);
+        _pool->ParallelFor(chunkCount, [&](const uint32_t chunk) {
+            const auto first = size_t(chunk) * ChunkSize;
+            _chunkCounts[chunk] = static_cast<uint32_t>(extractRange(first, std::min(first + ChunkSize, count)));
+        });
+        kept = Compact(entries);
+    }
+
+    buffer.DiscardGeometry(count - kept);
+    return kept;
+}
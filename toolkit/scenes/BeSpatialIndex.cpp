@@ -0,0 +1,45 @@
+#include "BeSpatialIndex.h"
+
+auto BeSpatialIndex::Disconnect() -> void {
+    _connections.clear();
+    _proxies.clear();
+    _tree.Clear();
+    _registry = nullptr;
+}
+
+auto BeSpatialIndex::Refresh(const entt::entity entity) -> void {
+    const auto bounds = _bounds(*_registry, entity);
+    const auto found = _proxies.find(entity);
+    if (!bounds) {
+        if (found != _proxies.end())
+            Remove(entity);
+        return;
+    }
+
+    const auto center = (bounds->Min + bounds->Max) * 0.5f;
+    if (found == _proxies.end()) {
+        const auto id = _tree.CreateProxy(*bounds, entt::to_integral(entity));
+        _proxies.emplace(entity, Proxy { .Id = id, .Center = center });
+        return;
+    }
+
+    _tree.MoveProxy(found->second.Id, *bounds, center - found->second.Center);
+    found->second.Center = center;
+}
+
+auto BeSpatialIndex::Remove(const entt::entity entity) -> void {
+    const auto found = _proxies.find(entity);
+    if (found == _proxies.end())
+        return;
+
+    _tree.DestroyProxy(found->second.Id);
+    _proxies.erase(found);
+}
+
+auto BeSpatialIndex::OnChanged(entt::registry&, const entt::entity entity) -> void {
+    Refresh(entity);
+}
+
+auto BeSpatialIndex::OnRemoved(entt::registry&, const entt::entity entity) -> void {
+    Remove(entity);
+}
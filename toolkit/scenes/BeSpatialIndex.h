@@ -0,0 +1,136 @@
+#pragma once
+#include <functional>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <umbrellas/access-modifiers.hpp>
+#include <umbrellas/include-glm.h>
+
+#include "BeAABBTree.h"
+#include "entt/entt.hpp"
+
+// a BeAABBTree over the entities of a registry, kept in sync through the registry's signals. an entity is refit when
+// one of the tracked components is emplaced, patched or replaced and leaves the tree when one is removed. components
+// written to in place, without patch or replace, go unnoticed like they would for any other on_update listener
+class BeSpatialIndex {
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+    // world space bounds of an entity, nullopt for one that shouldn't be indexed (yet)
+    using BoundsFunction = std::function<std::optional<BeAABB>(const entt::registry&, entt::entity)>;
+
+    hide struct Proxy {
+        int32_t Id;
+        glm::vec3 Center; // at the last refit, how far it moved since is the displacement
+    };
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide entt::registry* _registry = nullptr;
+    hide BoundsFunction _bounds;
+    hide BeAABBTree _tree;
+    hide std::unordered_map<entt::entity, Proxy> _proxies;
+    hide std::vector<entt::scoped_connection> _connections;
+
+    // lifetime ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose BeSpatialIndex() = default;
+    expose ~BeSpatialIndex() = default;
+    // the registry holds on to this
+    expose BeSpatialIndex(const BeSpatialIndex&) = delete;
+    expose auto operator=(const BeSpatialIndex&) -> BeSpatialIndex& = delete;
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    // starts listening to the registry and indexes the entities that already have every tracked component
+    template <typename... Tracked> auto Connect(entt::registry& registry, BoundsFunction bounds) -> void;
+    expose auto Disconnect() -> void;
+    // by hand, for changes the signals don't see
+    expose auto Refresh(entt::entity entity) -> void;
+    expose auto Remove(entt::entity entity) -> void;
+
+    // callback(entt::entity) -> bool, false stops the query. boxes are fattened, so results are a superset
+    template <typename Callback> auto QueryBox(const BeAABB& box, Callback&& callback) const -> void;
+    template <typename Callback> auto QuerySphere(const glm::vec3& center, float radius, Callback&& callback) const -> void;
+    template <typename Callback> auto QueryFrustum(std::span<const glm::vec4> planes, Callback&& callback) const -> void;
+    // callback(entt::entity, float distance) -> bool
+    template <typename Callback> auto QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Callback&& callback) const -> void;
+    // the closest hit over the entities along the ray, the top level of a two level cast. intersect(entt::entity,
+    // float maxDistance) -> std::optional<Hit> does the bottom level, Hit has a float Distance. entities whose box the
+    // ray enters beyond the closest hit so far are skipped
+    template <typename Hit, typename Intersect> auto RayCast(
+        const glm::vec3& origin,
+        const glm::vec3& direction,
+        float maxDistance,
+        Intersect&& intersect
+    ) const -> std::optional<std::pair<entt::entity, Hit>>;
+
+    expose auto GetTree() const -> const BeAABBTree& { return _tree; }
+    expose auto GetCount() const -> size_t { return _proxies.size(); }
+
+    hide auto OnChanged(entt::registry& registry, entt::entity entity) -> void;
+    hide auto OnRemoved(entt::registry& registry, entt::entity entity) -> void;
+    hide static auto ToEntity(const uint32_t userData) -> entt::entity { return static_cast<entt::entity>(userData); }
+};
+
+template <typename... Tracked>
+auto BeSpatialIndex::Connect(entt::registry& registry, BoundsFunction bounds) -> void {
+    Disconnect();
+    _registry = &registry;
+    _bounds = std::move(bounds);
+
+    (_connections.emplace_back(registry.on_construct<Tracked>().template connect<&BeSpatialIndex::OnChanged>(*this)), ...);
+    (_connections.emplace_back(registry.on_update<Tracked>().template connect<&BeSpatialIndex::OnChanged>(*this)), ...);
+    (_connections.emplace_back(registry.on_destroy<Tracked>().template connect<&BeSpatialIndex::OnRemoved>(*this)), ...);
+
+    for (const auto entity : registry.view<Tracked...>())
+        Refresh(entity);
+}
+
+template <typename Callback>
+auto BeSpatialIndex::QueryBox(const BeAABB& box, Callback&& callback) const -> void {
+    _tree.QueryBox(box, [&callback](const uint32_t userData) { return callback(ToEntity(userData)); });
+}
+
+template <typename Callback>
+auto BeSpatialIndex::QuerySphere(const glm::vec3& center, const float radius, Callback&& callback) const -> void {
+    _tree.QuerySphere(center, radius, [&callback](const uint32_t userData) { return callback(ToEntity(userData)); });
+}
+
+template <typename Callback>
+auto BeSpatialIndex::QueryFrustum(const std::span<const glm::vec4> planes, Callback&& callback) const -> void {
+    _tree.QueryFrustum(planes, [&callback](const uint32_t userData) { return callback(ToEntity(userData)); });
+}
+
+template <typename Callback>
+auto BeSpatialIndex::QueryRay(
+    const glm::vec3& origin,
+    const glm::vec3& direction,
+    const float maxDistance,
+    Callback&& callback
+) const -> void {
+    _tree.QueryRay(origin, direction, maxDistance, [&callback](const uint32_t userData, const float distance) {
+        return callback(ToEntity(userData), distance);
+    });
+}
+
+template <typename Hit, typename Intersect>
+auto BeSpatialIndex::RayCast(
+    const glm::vec3& origin,
+    const glm::vec3& direction,
+    const float maxDistance,
+    Intersect&& intersect
+) const -> std::optional<std::pair<entt::entity, Hit>> {
+    auto closest = std::optional<std::pair<entt::entity, Hit>>();
+    auto closestDistance = maxDistance;
+    QueryRay(origin, direction, maxDistance, [&](const entt::entity entity, const float enter) {
+        if (enter > closestDistance)
+            return true;
+
+        if (const auto hit = intersect(entity, closestDistance); hit && hit->Distance < closestDistance) {
+            closestDistance = hit->Distance;
+            closest.emplace(entity, *hit);
+        }
+        return true;
+    });
+    return closest;
+}
@@ -0,0 +1,62 @@
+#include "BeSubmissionSync.h"
+
+auto BeSubmissionSync::Disconnect() -> void {
+    _connections.clear();
+    for (const auto& [entity, record] : _records)
+        if (record.Slot != BeBRPSubmissionBuffer::InvalidSlot)
+            _buffer->RemoveGeometry(record.Slot);
+    _records.clear();
+    _dirty.clear();
+    _registry = nullptr;
+    _buffer = nullptr;
+}
+
+auto BeSubmissionSync::MarkDirty(const entt::entity entity) -> void {
+    auto& record = _records[entity];
+    if (record.Dirty)
+        return;
+
+    record.Dirty = true;
+    _dirty.push_back(entity);
+}
+
+auto BeSubmissionSync::Flush() -> void {
+    for (const auto entity : _dirty) {
+        // removed since it was marked
+        const auto found = _records.find(entity);
+        if (found == _records.end() || !found->second.Dirty)
+            continue;
+
+        auto& record = found->second;
+        record.Dirty = false;
+        auto entry = _entry(*_registry, entity);
+        if (!entry) {
+            if (record.Slot != BeBRPSubmissionBuffer::InvalidSlot)
+                _buffer->RemoveGeometry(record.Slot);
+            record.Slot = BeBRPSubmissionBuffer::InvalidSlot;
+        }
+        else if (record.Slot == BeBRPSubmissionBuffer::InvalidSlot)
+            record.Slot = _buffer->AddGeometry(std::move(*entry));
+        else
+            _buffer->UpdateGeometry(record.Slot, std::move(*entry));
+    }
+    _dirty.clear();
+}
+
+auto BeSubmissionSync::Remove(const entt::entity entity) -> void {
+    const auto found = _records.find(entity);
+    if (found == _records.end())
+        return;
+
+    if (found->second.Slot != BeBRPSubmissionBuffer::InvalidSlot)
+        _buffer->RemoveGeometry(found->second.Slot);
+    _records.erase(found);
+}
+
+auto BeSubmissionSync::OnChanged(entt::registry&, const entt::entity entity) -> void {
+    MarkDirty(entity);
+}
+
+auto BeSubmissionSync::OnRemoved(entt::registry&, const entt::entity entity) -> void {
+    Remove(entity);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <umbrellas/access-modifiers.hpp>
+
+#include "basic-render-pipeline/BeBRPSubmissionBuffer.h"
+#include "entt/entt.hpp"
+
+// keeps the retained geometry of a BeBRPSubmissionBuffer in sync with the entities of a registry. an entity is marked
+// when one of the tracked components is emplaced, patched or replaced, and Flush rebuilds the entries of the marked
+// ones only, however often they changed since. entities leave the buffer when a tracked component is removed. like with
+// BeSpatialIndex, components written to in place without patch or replace go unnoticed
+class BeSubmissionSync {
+    // types ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+    // the entry of an entity, nullopt for one that shouldn't be drawn (yet)
+    using EntryFunction = std::function<std::optional<BeBRPGeometryEntry>(const entt::registry&, entt::entity)>;
+
+    hide struct Record {
+        BeBRPSubmissionBuffer::GeometrySlot Slot = BeBRPSubmissionBuffer::InvalidSlot;
+        bool Dirty = false;
+    };
+
+
+    // fields //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    hide entt::registry* _registry = nullptr;
+    hide BeBRPSubmissionBuffer* _buffer = nullptr;
+    hide EntryFunction _entry;
+    hide std::unordered_map<entt::entity, Record> _records;
+    hide std::vector<entt::entity> _dirty;
+    hide std::vector<entt::scoped_connection> _connections;
+
+    // lifetime ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    expose BeSubmissionSync() = default;
+    expose ~BeSubmissionSync() = default;
+    // the registry holds on to this
+    expose BeSubmissionSync(const BeSubmissionSync&) = delete;
+    expose auto operator=(const BeSubmissionSync&) -> BeSubmissionSync& = delete;
+
+    // interface ///////////////////////////////////////////////////////////////////////////////////////////////////////
+    // starts listening to the registry and marks the entities that already have every tracked component. the buffer
+    // has to outlive the connection
+    template <typename... Tracked> auto Connect(entt::registry& registry, BeBRPSubmissionBuffer& buffer, EntryFunction entry) -> void;
+    // takes this sync's entries out of the buffer
+    expose auto Disconnect() -> void;
+    // by hand, for changes the signals don't see
+    expose auto MarkDirty(entt::entity entity) -> void;
+    // once a frame before the passes run, costs as much as the entities marked since the last one
+    expose auto Flush() -> void;
+
+    expose auto GetCount() const -> size_t { return _records.size(); }
+    expose auto GetDirtyCount() const -> size_t { return _dirty.size(); }
+
+    hide auto Remove(entt::entity entity) -> void;
+    hide auto OnChanged(entt::registry& registry, entt::entity entity) -> void;
+    hide auto OnRemoved(entt::registry& registry, entt::entity entity) -> void;
+};
+
+template <typename... Tracked>
+auto BeSubmissionSync::Connect(entt::registry& registry, BeBRPSubmissionBuffer& buffer, EntryFunction entry) -> void {
+    Disconnect();
+    _registry = &registry;
+    _buffer = &buffer;
+    _entry = std::move(entry);
+
+    (_connections.emplace_back(registry.on_construct<Tracked>().template connect<&BeSubmissionSync::OnChanged>(*this)), ...);
+    (_connections.emplace_back(registry.on_update<Tracked>().template connect<&BeSubmissionSync::OnChanged>(*this)), ...);
+    (_connections.emplace_back(registry.on_destroy<Tracked>().template connect<&BeSubmissionSync::OnRemoved>(*this)), ...);
+
+    for (const auto entity : registry.view<Tracked...>())
+        MarkDirty(entity);
+}
@@ -0,0 +1,16 @@
+#include <cstdio>
+
+#include "BeAssetRegistry.h"
+#include "BeShaderTools.h"
+
+// cooks a shader package on the build machine, for builds made with --no-shader-compiler that can't do it themselves.
+// it compiles core on its own with the compiler on, see premake5.lua
+int main(const int argc, char** argv) {
+    if (argc != 3) {
+        (void)std::fprintf(stderr, "usage: shader-cook <shader list> <package>\n");
+        return 1;
+    }
+
+    // the paths in the list are relative to the working directory
+    return BeAssetRegistry::CookShaderPackage(BeShaderTools::ReadPathList(argv[1]), argv[2]) ? 0 : 1;
+}